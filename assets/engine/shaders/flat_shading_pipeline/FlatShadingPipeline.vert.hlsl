@@ -1,7 +1,7 @@
 struct VSIn {
-    float3 position : POSITION0;
-    float2 baseColorUV : TEXCOORD0;
-    float3 normal : NORMAL;
+    float4 position : POSITION0;        // Unorm16, relative to the mesh bounds
+    float2 baseColorUV : TEXCOORD0;     // Half float
+    float2 normal : NORMAL;             // Snorm16 octahedral
 };
 
 struct VSOut {
@@ -19,6 +19,8 @@ ConstantBuffer <ViewProjectionBuffer> vpBuff: register(b0, space0);
 struct PushConsts
 {
     float4x4 model;
+    float4 positionMin;
+    float4 positionExtent;
 };
 
 [[vk::push_constant]]
@@ -26,13 +28,24 @@ cbuffer {
     PushConsts pushConsts;
 };
 
+float3 OctahedralDecode(float2 encoded) {
+    float3 normal = float3(encoded.x, encoded.y, 1.0 - abs(encoded.x) - abs(encoded.y));
+    float t = saturate(-normal.z);
+    normal.x += normal.x >= 0.0 ? -t : t;
+    normal.y += normal.y >= 0.0 ? -t : t;
+    return normalize(normal);
+}
+
 VSOut main(VSIn input) {
     VSOut output;
 
+    float3 position = pushConsts.positionMin.xyz + input.position.xyz * pushConsts.positionExtent.xyz;
+    float3 normal = OctahedralDecode(input.normal);
+
     float4x4 mvpMatrix = mul(vpBuff.viewProjection, pushConsts.model);
-    output.position = mul(mvpMatrix, float4(input.position, 1.0));
+    output.position = mul(mvpMatrix, float4(position, 1.0));
     output.baseColorUV = input.baseColorUV;
-    output.worldNormal = mul(pushConsts.model, float4(input.normal, 0.0f)).xyz;
+    output.worldNormal = mul(pushConsts.model, float4(normal, 0.0f)).xyz;
 
     return output;
 }
\ No newline at end of file
@@ -2,10 +2,245 @@
 
 #include "BedrockAssert.hpp"
 #include "BedrockMath.hpp"
+#include "JobSystem.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_set>
 
 namespace MFA::Asset::GLTF
 {
 
+    namespace
+    {
+
+        struct WeldResult
+        {
+            std::vector<Vertex> vertices{};
+            std::vector<Index> indices{};           // Relative to the first vertex of the primitive
+        };
+
+        //-------------------------------------------------------------------------------------------------
+
+        template<typename T>
+        bool IsNear(T const & a, T const & b, float const epsilon)
+        {
+            auto const delta = a - b;
+            return glm::dot(delta, delta) <= epsilon * epsilon;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        bool CanWeld(Vertex const & a, Vertex const & b, VertexWeldParams const & params)
+        {
+            if (IsNear(a.position, b.position, params.positionEpsilon) == false ||
+                IsNear(a.normal, b.normal, params.normalEpsilon) == false ||
+                IsNear(a.tangent, b.tangent, params.normalEpsilon) == false ||
+                IsNear(a.color, b.color, params.colorEpsilon) == false ||
+                IsNear(a.baseColorUV, b.baseColorUV, params.uvEpsilon) == false ||
+                IsNear(a.normalMapUV, b.normalMapUV, params.uvEpsilon) == false ||
+                IsNear(a.metallicUV, b.metallicUV, params.uvEpsilon) == false ||
+                IsNear(a.roughnessUV, b.roughnessUV, params.uvEpsilon) == false ||
+                IsNear(a.emissionUV, b.emissionUV, params.uvEpsilon) == false ||
+                IsNear(a.occlusionUV, b.occlusionUV, params.uvEpsilon) == false)
+            {
+                return false;
+            }
+            if (a.hasSkin != b.hasSkin)
+            {
+                return false;
+            }
+            for (int i = 0; i < 4; ++i)
+            {
+                if (a.jointIndices[i] != b.jointIndices[i] ||
+                    std::abs(a.jointWeights[i] - b.jointWeights[i]) > params.weightEpsilon)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        using Cell = glm::i64vec3;
+
+        Cell ComputeCell(glm::vec3 const & position, float const inverseCellSize)
+        {
+            // Clamped so far away or broken positions cannot overflow the integer conversion
+            static constexpr double MaxCell = static_cast<double>(1ll << 40);
+            glm::dvec3 const cell = glm::clamp(
+                glm::floor(glm::dvec3{position} * static_cast<double>(inverseCellSize)),
+                glm::dvec3{-MaxCell},
+                glm::dvec3{MaxCell}
+            );
+            return Cell{cell};
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        uint64_t HashCell(Cell const & cell)
+        {
+            // Large primes from the "Optimized Spatial Hashing for Collision Detection of Deformable Objects" paper
+            return static_cast<uint64_t>(cell.x) * 73856093ull ^
+                static_cast<uint64_t>(cell.y) * 19349663ull ^
+                static_cast<uint64_t>(cell.z) * 83492791ull;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        // Greedy weld in O(V + I): Every vertex only looks at the unique vertices of the cells that its epsilon box touches.
+        // Cells are twice the epsilon wide so the box never covers more than two cells per axis.
+        WeldResult WeldPrimitive(
+            Primitive const & primitive,
+            Vertex const * vertices,
+            Index const * indices,
+            VertexWeldParams const & params
+        )
+        {
+            auto const * primitiveVertices = vertices + primitive.verticesStartingIndex;
+            auto const * primitiveIndices = indices + primitive.indicesStartingIndex;
+            auto const vertexCount = primitive.vertexCount;
+
+            float const epsilon = std::max(params.positionEpsilon, 0.0f);
+            float const inverseCellSize = 1.0f / std::max(epsilon * 2.0f, std::numeric_limits<float>::epsilon());
+
+            // Cell of each corner of the epsilon box. Independent per vertex so it can run on the workers.
+            std::vector<Cell> minCells(vertexCount);
+            std::vector<Cell> maxCells(vertexCount);
+            auto const computeCells = [&](int const begin, int const end)->void
+            {
+                for (int i = begin; i < end; ++i)
+                {
+                    auto const & position = primitiveVertices[i].position;
+                    minCells[i] = ComputeCell(position - epsilon, inverseCellSize);
+                    maxCells[i] = ComputeCell(position + epsilon, inverseCellSize);
+                }
+            };
+            if (JS::Instance != nullptr)
+            {
+                JS::Instance->ParallelFor(static_cast<int>(vertexCount), 4096, computeCells);
+            }
+            else
+            {
+                computeCells(0, static_cast<int>(vertexCount));
+            }
+
+            WeldResult result{};
+            result.vertices.reserve(vertexCount);
+
+            // Unique vertices of each cell are stored as a linked list inside nextInCell
+            std::unordered_map<uint64_t, uint32_t> cellHeads{};
+            cellHeads.reserve(vertexCount);
+            std::vector<uint32_t> nextInCell{};
+            nextInCell.reserve(vertexCount);
+            static constexpr uint32_t EndOfList = std::numeric_limits<uint32_t>::max();
+
+            std::vector<uint32_t> remap(vertexCount);
+
+            for (uint32_t i = 0; i < vertexCount; ++i)
+            {
+                auto const & vertex = primitiveVertices[i];
+                auto const & minCell = minCells[i];
+                auto const & maxCell = maxCells[i];
+
+                uint32_t match = EndOfList;
+                for (auto x = minCell.x; x <= maxCell.x && match == EndOfList; ++x)
+                {
+                    for (auto y = minCell.y; y <= maxCell.y && match == EndOfList; ++y)
+                    {
+                        for (auto z = minCell.z; z <= maxCell.z && match == EndOfList; ++z)
+                        {
+                            auto const findResult = cellHeads.find(HashCell(Cell{x, y, z}));
+                            if (findResult == cellHeads.end())
+                            {
+                                continue;
+                            }
+                            for (auto candidate = findResult->second; candidate != EndOfList; candidate = nextInCell[candidate])
+                            {
+                                if (CanWeld(result.vertices[candidate], vertex, params))
+                                {
+                                    match = candidate;
+                                    break;
+                                }
+                            }
+                        }
+                    }
+                }
+
+                if (match == EndOfList)
+                {
+                    match = static_cast<uint32_t>(result.vertices.size());
+                    result.vertices.emplace_back(vertex);
+
+                    auto const homeCell = ComputeCell(vertex.position, inverseCellSize);
+                    auto [cellHead, isNew] = cellHeads.try_emplace(HashCell(homeCell), match);
+                    if (isNew)
+                    {
+                        nextInCell.emplace_back(EndOfList);
+                    }
+                    else
+                    {
+                        nextInCell.emplace_back(cellHead->second);
+                        cellHead->second = match;
+                    }
+                }
+                remap[i] = match;
+            }
+
+            // Welding can collapse triangles and turn overlapping ones into exact duplicates
+            struct TriangleHash
+            {
+                size_t operator()(glm::uvec3 const & triangle) const noexcept
+                {
+                    return triangle.x * 73856093ull ^ triangle.y * 19349663ull ^ triangle.z * 83492791ull;
+                }
+            };
+            std::unordered_set<glm::uvec3, TriangleHash> triangles{};
+            triangles.reserve(primitive.indicesCount / 3);
+            result.indices.reserve(primitive.indicesCount);
+
+            for (uint32_t i = 0; i + 2 < primitive.indicesCount; i += 3)
+            {
+                glm::uvec3 triangle{};
+                for (int j = 0; j < 3; ++j)
+                {
+                    auto const index = primitiveIndices[i + j];
+                    MFA_ASSERT(index >= primitive.verticesStartingIndex);
+                    MFA_ASSERT(index < primitive.verticesStartingIndex + vertexCount);
+                    triangle[j] = remap[index - primitive.verticesStartingIndex];
+                }
+
+                if (params.removeDegenerateTriangles &&
+                    (triangle.x == triangle.y || triangle.y == triangle.z || triangle.x == triangle.z))
+                {
+                    continue;
+                }
+
+                if (params.removeDuplicateTriangles)
+                {
+                    // Rotating keeps the winding so back faces of double sided geometry are not treated as duplicates
+                    auto key = triangle;
+                    while (key.x > key.y || key.x > key.z)
+                    {
+                        key = glm::uvec3{key.y, key.z, key.x};
+                    }
+                    if (triangles.emplace(key).second == false)
+                    {
+                        continue;
+                    }
+                }
+
+                result.indices.emplace_back(triangle.x);
+                result.indices.emplace_back(triangle.y);
+                result.indices.emplace_back(triangle.z);
+            }
+
+            return result;
+        }
+
+    }
+
     //-------------------------------------------------------------------------------------------------
 
     Node::Node() = default;
@@ -54,6 +289,38 @@ namespace MFA::Asset::GLTF
 
 	//-------------------------------------------------------------------------------------------------
 
+	Mesh::Mesh(
+		uint32_t const vertexCount,
+		uint32_t const indexCount,
+		std::shared_ptr<Blob> vertexBuffer,
+		std::shared_ptr<Blob> indexBuffer,
+		std::shared_ptr<MeshData> data,
+		bool const isCentered,
+		bool const isOptimized
+	)
+	{
+		MFA_ASSERT(vertexBuffer->IsValid() == true);
+		MFA_ASSERT(indexBuffer->IsValid() == true);
+		MFA_ASSERT(data != nullptr);
+
+		mVertexCount = vertexCount;
+		mVertexData = std::move(vertexBuffer);
+		mIndexCount = indexCount;
+		mIndexData = std::move(indexBuffer);
+		mData = std::move(data);
+
+		// Buffers are full so nothing else can be inserted
+		mVerticesStartingIndex = vertexCount;
+		mIndicesStartingIndex = indexCount;
+		mNextVertexOffset = mVertexData->Len();
+		mNextIndexOffset = mIndexData->Len();
+
+		mIsCentered = isCentered;
+		mIsOptimized = isOptimized;
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
 	Mesh::~Mesh() = default;
 
 	//-------------------------------------------------------------------------------------------------
@@ -110,6 +377,64 @@ namespace MFA::Asset::GLTF
                 mData->rootNodes.emplace_back(i);
             }
         }
+        // Step three: Flatten the hierarchy level by level so a linear pass can compute the world matrices
+        auto & flatNodes = mData->flatNodes;
+        flatNodes.clear();
+        flatNodes.reserve(mData->nodes.size());
+        mData->levelOffsets.clear();
+        mData->flatMeshNodes.clear();
+
+        for (auto const rootNode : mData->rootNodes)
+        {
+            flatNodes.emplace_back(MeshData::FlatNode{
+                .nodeIndex = rootNode,
+                .parent = -1,
+                .subMeshIndex = mData->nodes[rootNode].subMeshIndex
+            });
+        }
+
+        uint32_t levelBegin = 0;
+        while (levelBegin < static_cast<uint32_t>(flatNodes.size()))
+        {
+            mData->levelOffsets.emplace_back(levelBegin);
+            auto const levelEnd = static_cast<uint32_t>(flatNodes.size());
+            for (uint32_t flatIdx = levelBegin; flatIdx < levelEnd; ++flatIdx)
+            {
+                for (auto const child : mData->nodes[flatNodes[flatIdx].nodeIndex].children)
+                {
+                    flatNodes.emplace_back(MeshData::FlatNode{
+                        .nodeIndex = static_cast<uint32_t>(child),
+                        .parent = static_cast<int>(flatIdx),
+                        .subMeshIndex = mData->nodes[child].subMeshIndex
+                    });
+                }
+            }
+            levelBegin = levelEnd;
+        }
+        mData->levelOffsets.emplace_back(static_cast<uint32_t>(flatNodes.size()));
+        MFA_ASSERT(flatNodes.size() == mData->nodes.size());
+
+        // Step four: Name lookup table so callers never compare strings
+        mData->nodeNameToIndex.clear();
+        for (uint32_t i = 0; i < static_cast<uint32_t>(mData->nodes.size()); ++i)
+        {
+            auto const & name = mData->nodes[i].name;
+            if (name.empty() == false)
+            {
+                // First node wins when names are duplicated, same as a linear search
+                mData->nodeNameToIndex.try_emplace(StringId::Intern(name), i);
+            }
+        }
+
+        mData->nodeToFlatNode.resize(flatNodes.size());
+        for (uint32_t flatIdx = 0; flatIdx < static_cast<uint32_t>(flatNodes.size()); ++flatIdx)
+        {
+            mData->nodeToFlatNode[flatNodes[flatIdx].nodeIndex] = flatIdx;
+            if (flatNodes[flatIdx].subMeshIndex >= 0)
+            {
+                mData->flatMeshNodes.emplace_back(flatIdx);
+            }
+        }
 	}
 
 	//-------------------------------------------------------------------------------------------------
@@ -131,11 +456,27 @@ namespace MFA::Asset::GLTF
         Index* indices
 	)
 	{
-        MFA_ASSERT(vertexCount > 0);
-        MFA_ASSERT(indicesCount > 0);
         MFA_ASSERT(vertices != nullptr);
         MFA_ASSERT(indices != nullptr);
 
+        auto const & reserved = ReservePrimitive(subMeshIndex, primitive, vertexCount, indicesCount);
+
+        ::memcpy(mVertexData->Ptr() + reserved.verticesOffset, vertices, sizeof(Vertex) * vertexCount);
+        ::memcpy(mIndexData->Ptr() + reserved.indicesOffset, indices, sizeof(Index) * indicesCount);
+	}
+
+    //-------------------------------------------------------------------------------------------------
+
+	Primitive const & Mesh::ReservePrimitive(
+        uint32_t subMeshIndex,
+        Primitive primitive,
+        uint32_t vertexCount,
+        uint32_t indicesCount
+	)
+	{
+        MFA_ASSERT(vertexCount > 0);
+        MFA_ASSERT(indicesCount > 0);
+
 		primitive.vertexCount = vertexCount;
         primitive.indicesCount = indicesCount;
         primitive.indicesOffset = mNextIndexOffset;
@@ -148,9 +489,6 @@ namespace MFA::Asset::GLTF
 		MFA_ASSERT(mNextVertexOffset + verticesSize <= mVertexData->Len());
         MFA_ASSERT(mNextIndexOffset + indicesSize <= mIndexData->Len());
 
-        ::memcpy(mVertexData->Ptr() + mNextVertexOffset, vertices, verticesSize);
-        ::memcpy(mIndexData->Ptr() + mNextIndexOffset, indices, indicesSize);
-
         MFA_ASSERT(subMeshIndex < mData->subMeshes.size());
         auto& subMesh = mData->subMeshes[subMeshIndex];
 
@@ -185,12 +523,12 @@ namespace MFA::Asset::GLTF
                 subMesh.positionMax[2] = primitive.positionMax[2];
             }
         }
-        subMesh.primitives.emplace_back(primitive);
-
         mNextVertexOffset += verticesSize;
         mNextIndexOffset += indicesSize;
         mIndicesStartingIndex += indicesCount;
         mVerticesStartingIndex += vertexCount;
+
+        return subMesh.primitives.emplace_back(primitive);
 	}
 
     //-------------------------------------------------------------------------------------------------
@@ -263,6 +601,18 @@ namespace MFA::Asset::GLTF
 
 	//-------------------------------------------------------------------------------------------------
 
+	void Mesh::ReplaceIndexData(uint32_t const indexCount, std::shared_ptr<Blob> indexData)
+	{
+		MFA_ASSERT(indexData != nullptr);
+		MFA_ASSERT(indexData->Len() == sizeof(Index) * indexCount);
+		mIndexCount = indexCount;
+		mIndexData = std::move(indexData);
+		mNextIndexOffset = mIndexData->Len();
+		mIndicesStartingIndex = indexCount;
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
     void Mesh::CenterMesh()
     {
         auto * vertices = mVertexData->As<Vertex>();
@@ -271,7 +621,7 @@ namespace MFA::Asset::GLTF
 		glm::vec3 maximum{};
 		bool minMaxSetOnce = false;
 
-		for (int i = 0; i < mVertexCount; ++i)
+		for (uint32_t i = 0; i < mVertexCount; ++i)
 		{
             auto const & vertex = vertices[i];
 
@@ -314,105 +664,106 @@ namespace MFA::Asset::GLTF
 
 		glm::vec3 const center = (maximum + minimum) * 0.5f;
 
-		for (int i = 0; i < mVertexCount; ++i)
+		for (uint32_t i = 0; i < mVertexCount; ++i)
 		{
 			vertices[i].position -= center;
 		}
 
+		for (auto & meshlet : mData->meshlets)
+		{
+			meshlet.center -= center;
+		}
+
         mIsCentered = true;
     }
 
 	//-------------------------------------------------------------------------------------------------
 
-    void Mesh::Optimize()
+    void Mesh::Optimize(VertexWeldParams const & params)
     {
-        auto * vertices = mVertexData->As<Vertex>();
-        auto * indices = mIndexData->As<Index>();
-
-        std::vector<Vertex> vertices2 {};
+        auto const * vertices = mVertexData->As<Vertex>();
+        auto const * indices = mIndexData->As<Index>();
 
-        for (int i = 0; i < mVertexCount; ++i)
+        std::vector<Primitive *> primitives{};
+        for (auto & subMesh : mData->subMeshes)
         {
-            bool isDuplicate = false;
-            int nIdx = i;
-
-            for (int j = 0; j < vertices2.size(); ++j)
+            for (auto & primitive : subMesh.primitives)
             {
-                if (glm::length2(vertices2[j].position - vertices[i].position) < glm::epsilon<float>())
-                {
-                    isDuplicate = true;
-                    nIdx = j;
-                    break;
-                }
-            }
-
-            if (isDuplicate == false)
-            {
-                nIdx = vertices2.size();
-                vertices2.emplace_back(vertices[i]);
+                primitives.emplace_back(&primitive);
             }
+        }
 
-            for (int k = 0; k < mIndexCount; ++k)
+        // Primitives never share vertices so each one is welded on its own and the vertex ranges stay valid
+        std::vector<WeldResult> results(primitives.size());
+        auto const weldPrimitives = [&](int const begin, int const end)->void
+        {
+            for (int i = begin; i < end; ++i)
             {
-                if (indices[k] == i)
-                {
-                    indices[k] = nIdx;
-                }
+                results[i] = WeldPrimitive(*primitives[i], vertices, indices, params);
             }
-
+        };
+        if (JS::Instance != nullptr)
+        {
+            JS::Instance->ParallelFor(static_cast<int>(primitives.size()), 1, weldPrimitives);
         }
-
-        mVertexData = Memory::Alloc(vertices2.data(), vertices2.size());
-        mVertexCount = vertices2.size();
-
-        std::vector<Index> indices2{};
-
-        for (int i = 0; i < mIndexCount / 3; ++i)
+        else
         {
+            weldPrimitives(0, static_cast<int>(primitives.size()));
+        }
 
-            auto const idV1x0 = indices[i * 3];
-            auto const idV1x1 = indices[i * 3 + 1];
-            auto const idV1x2 = indices[i * 3 + 2];
-
-            bool isDuplicate = false;
-            for (int j = 0; j < indices2.size() / 3; ++j)
-            {
-                auto const idV2x0 = indices2[j * 3];
-                auto const idV2x1 = indices2[j * 3 + 1];
-                auto const idV2x2 = indices2[j * 3 + 2];
+        uint32_t vertexCount = 0;
+        uint32_t indexCount = 0;
+        for (auto const & result : results)
+        {
+            vertexCount += static_cast<uint32_t>(result.vertices.size());
+            indexCount += static_cast<uint32_t>(result.indices.size());
+        }
 
-                MFA_ASSERT(idV2x0 != idV2x1);
-                MFA_ASSERT(idV2x0 != idV2x2);
-                MFA_ASSERT(idV2x1 != idV2x2);
+        auto vertexData = Memory::AllocSize(sizeof(Vertex) * vertexCount);
+        auto indexData = Memory::AllocSize(sizeof(Index) * indexCount);
+        auto * newVertices = vertexData->As<Vertex>();
+        auto * newIndices = indexData->As<Index>();
 
-                if (idV1x0 == idV2x0 || 
-                    idV1x0 == idV2x1 ||
-                    idV1x0 == idV2x2)
-                {
-                    if (idV1x1 == idV2x0 || 
-                        idV1x1 == idV2x1 ||
-                        idV1x1 == idV2x2)
-                    {
-                        if (idV1x2 == idV2x0 || 
-                            idV1x2 == idV2x1 ||
-                            idV1x2 == idV2x2)
-                        {
-                            isDuplicate = true;    
-                            break;
-                        }
-                    }
-                }
-            }
-            if (isDuplicate == false)
+        uint32_t verticesStartingIndex = 0;
+        uint32_t indicesStartingIndex = 0;
+        for (size_t i = 0; i < primitives.size(); ++i)
+        {
+            auto & primitive = *primitives[i];
+            auto const & result = results[i];
+
+            primitive.vertexCount = static_cast<uint32_t>(result.vertices.size());
+            primitive.indicesCount = static_cast<uint32_t>(result.indices.size());
+            primitive.verticesStartingIndex = verticesStartingIndex;
+            primitive.indicesStartingIndex = indicesStartingIndex;
+            primitive.verticesOffset = static_cast<uint64_t>(verticesStartingIndex) * sizeof(Vertex);
+            primitive.indicesOffset = static_cast<uint64_t>(indicesStartingIndex) * sizeof(Index);
+            // Index buffer changed so the meshlets and levels have to be built again
+            primitive.meshletStartingIndex = 0;
+            primitive.meshletCount = 0;
+            primitive.lodCount = 0;
+
+            std::copy(result.vertices.begin(), result.vertices.end(), newVertices + verticesStartingIndex);
+            for (size_t j = 0; j < result.indices.size(); ++j)
             {
-                indices2.emplace_back(idV1x0);
-                indices2.emplace_back(idV1x1);
-                indices2.emplace_back(idV1x2);
+                newIndices[indicesStartingIndex + j] = result.indices[j] + verticesStartingIndex;
             }
+
+            verticesStartingIndex += primitive.vertexCount;
+            indicesStartingIndex += primitive.indicesCount;
         }
 
-        mIndexData = Memory::Alloc(indices2.data(), indices2.size());
-        mIndexCount = indices2.size();
+        mData->meshlets.clear();
+        mData->lodErrors.clear();
+
+        mVertexData = std::move(vertexData);
+        mVertexCount = vertexCount;
+        mIndexData = std::move(indexData);
+        mIndexCount = indexCount;
+
+        mNextVertexOffset = mVertexData->Len();
+        mNextIndexOffset = mIndexData->Len();
+        mVerticesStartingIndex = vertexCount;
+        mIndicesStartingIndex = indexCount;
 
         mIsOptimized = true;
     }
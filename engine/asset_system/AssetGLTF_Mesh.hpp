@@ -1,12 +1,14 @@
 #pragma once
 
 #include "BedrockMemory.hpp"
+#include "BedrockStringId.hpp"
 #include "Transform.hpp"
 
 #include <cstdint>
 #include <memory>
 #include <vector>
 #include <string>
+#include <unordered_map>
 #include <detail/type_quat.hpp>
 
 #include <glm/ext/matrix_transform.hpp>
@@ -25,6 +27,8 @@ namespace MFA::Asset::GLTF
 
 	using Index = uint32_t;
 
+	inline static constexpr uint32_t MaxLodCount = 4;
+
 	struct Vertex
 	{
 	public:
@@ -95,6 +99,31 @@ namespace MFA::Asset::GLTF
 			std::numeric_limits<float>::min(),
 			std::numeric_limits<float>::min()
 		};
+
+		uint32_t meshletStartingIndex = 0;          // Inside MeshData::meshlets
+		uint32_t meshletCount = 0;                  // Zero when the meshlets are not built
+
+		// Simplified versions of the primitive, from fine to coarse. They use the vertices of the primitive.
+		struct Lod
+		{
+			uint32_t indicesStartingIndex = 0;
+			uint32_t indicesCount = 0;
+			float error = 0.0f;                     // Geometric error in the units of the mesh
+		};
+		Lod lods[MaxLodCount]{};
+		uint32_t lodCount = 0;
+	};
+
+	// Small cluster of triangles that can be culled on its own. Its triangles are contiguous inside the index buffer.
+	struct Meshlet
+	{
+		uint32_t indicesStartingIndex = 0;
+		uint32_t indicesCount = 0;
+		uint32_t vertexCount = 0;                   // Unique vertices that the triangles use
+		glm::vec3 center{};                         // Bounding sphere in the space of the mesh
+		float radius = 0.0f;
+		glm::vec3 coneAxis{};                       // Average facing direction of the triangles
+		float coneCutoff = 1.0f;                    // Sine of the cone half angle. One means the cone can not be used for culling
 	};
 
 	struct SubMesh
@@ -207,6 +236,21 @@ namespace MFA::Asset::GLTF
         std::vector<Animation> animations{};
         std::vector<uint32_t> rootNodes{};         // Nodes that have no parent
 
+        // Flattened copy of the hierarchy sorted by depth. Parents always come before their children
+        struct FlatNode
+        {
+            uint32_t nodeIndex = 0;                 // Index inside nodes
+            int parent = -1;                        // Index inside flatNodes
+            int subMeshIndex = -1;
+        };
+        std::vector<FlatNode> flatNodes{};
+        std::vector<uint32_t> levelOffsets{};      // Start of each depth level inside flatNodes, last item is flatNodes.size()
+        std::vector<uint32_t> flatMeshNodes{};     // Indices of flatNodes that have a subMesh
+        std::vector<uint32_t> nodeToFlatNode{};    // Position of each node inside flatNodes
+        std::unordered_map<StringId, uint32_t> nodeNameToIndex{};     // Unnamed nodes are not included
+        std::vector<Meshlet> meshlets{};            // Grouped by primitive, see Primitive::meshletStartingIndex
+        std::vector<float> lodErrors{};             // Largest error of each level between all primitives
+
         // We could do this with a T-Pose for more accurate result
         bool hasPositionMinMax = false;
 
@@ -226,6 +270,18 @@ namespace MFA::Asset::GLTF
 		bool IsValid() const;
 	};
 
+	// Two vertices are merged only when every attribute is within its epsilon. Joint indices must match exactly.
+	struct VertexWeldParams
+	{
+		float positionEpsilon = 1e-5f;
+		float normalEpsilon = 1e-3f;                // Used for tangents too
+		float uvEpsilon = 1e-5f;
+		float colorEpsilon = 1e-3f;
+		float weightEpsilon = 1e-3f;
+		bool removeDegenerateTriangles = true;
+		bool removeDuplicateTriangles = true;
+	};
+
 	class Mesh
 	{
 	public:
@@ -236,6 +292,18 @@ namespace MFA::Asset::GLTF
 			std::shared_ptr<Blob> vertexBuffer,
 			std::shared_ptr<Blob> indexBuffer
 		);
+
+		// For meshes that are already finalized, for example the cooked ones
+		explicit Mesh(
+			uint32_t vertexCount,
+			uint32_t indexCount,
+			std::shared_ptr<Blob> vertexBuffer,
+			std::shared_ptr<Blob> indexBuffer,
+			std::shared_ptr<MeshData> data,
+			bool isCentered,
+			bool isOptimized
+		);
+
 		~Mesh();
 
 		Mesh(Mesh const&) noexcept = delete;
@@ -258,6 +326,16 @@ namespace MFA::Asset::GLTF
 			Index * indices
 		);
 
+		// Takes the next ranges of the buffers for the primitive without filling them, so the caller can write the
+		// vertices and indices later, for example from several threads. Indices are global like InsertPrimitive.
+		// The reference is invalidated by the next primitive of the same subMesh.
+		Primitive const & ReservePrimitive(
+			uint32_t subMeshIndex,
+			Primitive primitive,
+			uint32_t vertexCount,
+			uint32_t indicesCount
+		);
+
 		[[nodiscard]]
         Node & InsertNode() const;
 
@@ -284,11 +362,14 @@ namespace MFA::Asset::GLTF
 		[[nodiscard]]
 		std::shared_ptr<Blob> const& GetIndexData() const;
 		
+		// For passes that add or remove indices. Primitive ranges have to be updated by the caller.
+		void ReplaceIndexData(uint32_t indexCount, std::shared_ptr<Blob> indexData);
+
 		// Moves the mesh to the origin
 		void CenterMesh();
 
-		// Removes duplicate vertices
-		void Optimize();
+		// Welds duplicate vertices inside each primitive and removes the triangles that become degenerate or duplicated
+		void Optimize(VertexWeldParams const & params = {});
 
 		[[nodiscard]]
 		bool IsCentered() const noexcept;
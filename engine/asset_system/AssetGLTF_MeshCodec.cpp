@@ -0,0 +1,604 @@
+#include "AssetGLTF_MeshCodec.hpp"
+
+#include "BedrockAssert.hpp"
+#include "BedrockCpu.hpp"
+#include "JobSystem.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MFA_MESH_CODEC_SSE2
+#include <immintrin.h>
+#endif
+
+namespace MFA::Asset::GLTF::MeshCodec
+{
+
+    namespace
+    {
+
+        constexpr uint32_t Magic = 0x5643464D;              // MFCV
+        constexpr uint32_t BlockSize = 8192;                // Vertices, keeps the planes of one word inside L1
+        constexpr uint32_t GroupSize = 16;
+
+        struct StreamHeader
+        {
+            uint32_t magic = Magic;
+            uint32_t count = 0;
+            uint32_t stride = 0;
+            uint32_t blockCount = 0;
+            // Followed by blockCount + 1 offsets from the start of the block data
+        };
+
+        enum GroupMode : uint8_t
+        {
+            Zero = 0,
+            Bits2 = 1,
+            Bits4 = 2,
+            Bits8 = 3
+        };
+
+        constexpr uint32_t GroupPayloadSize[4]{0, 4, 8, 16};
+
+        //-------------------------------------------------------------------------------------------------
+
+        uint32_t ZigZag(uint32_t const value)
+        {
+            return (value << 1) ^ static_cast<uint32_t>(static_cast<int32_t>(value) >> 31);
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        [[maybe_unused]]
+        uint32_t UnZigZag(uint32_t const value)
+        {
+            return (value >> 1) ^ (0u - (value & 1u));
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        // Plane size is padded to GroupSize with zeros
+        void EncodePlane(std::vector<uint8_t> & outData, uint8_t const * plane, uint32_t const planeSize)
+        {
+            auto const groupCount = (planeSize + GroupSize - 1) / GroupSize;
+            auto const headerOffset = outData.size();
+            outData.resize(headerOffset + (groupCount + 3) / 4, 0);
+
+            for (uint32_t group = 0; group < groupCount; ++group)
+            {
+                uint8_t const * values = plane + group * GroupSize;
+                uint8_t maxValue = 0;
+                for (uint32_t i = 0; i < GroupSize; ++i)
+                {
+                    maxValue = std::max(maxValue, values[i]);
+                }
+                GroupMode const mode = maxValue == 0 ? Zero : maxValue < 4 ? Bits2 : maxValue < 16 ? Bits4 : Bits8;
+                outData[headerOffset + group / 4] |= static_cast<uint8_t>(mode << ((group % 4) * 2));
+
+                switch (mode)
+                {
+                case Zero:
+                    break;
+                case Bits2:
+                    for (uint32_t i = 0; i < GroupSize; i += 4)
+                    {
+                        outData.emplace_back(static_cast<uint8_t>(
+                            values[i] | (values[i + 1] << 2) | (values[i + 2] << 4) | (values[i + 3] << 6)
+                        ));
+                    }
+                    break;
+                case Bits4:
+                    for (uint32_t i = 0; i < GroupSize; i += 2)
+                    {
+                        outData.emplace_back(static_cast<uint8_t>(values[i] | (values[i + 1] << 4)));
+                    }
+                    break;
+                case Bits8:
+                    outData.insert(outData.end(), values, values + GroupSize);
+                    break;
+                }
+            }
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        // Returns the number of bytes that the plane used or zero when the data is too short
+        size_t DecodePlane(uint8_t * plane, uint32_t const planeSize, uint8_t const * data, size_t const dataSize)
+        {
+            auto const groupCount = (planeSize + GroupSize - 1) / GroupSize;
+            size_t readOffset = (groupCount + 3) / 4;
+            if (readOffset > dataSize)
+            {
+                return 0;
+            }
+
+            for (uint32_t group = 0; group < groupCount; ++group)
+            {
+                auto const mode = static_cast<GroupMode>((data[group / 4] >> ((group % 4) * 2)) & 3);
+                auto const payloadSize = GroupPayloadSize[mode];
+                if (readOffset + payloadSize > dataSize)
+                {
+                    return 0;
+                }
+                uint8_t const * payload = data + readOffset;
+                uint8_t * values = plane + group * GroupSize;
+                readOffset += payloadSize;
+
+#ifdef MFA_MESH_CODEC_SSE2
+                __m128i result{};
+                switch (mode)
+                {
+                case Zero:
+                    result = _mm_setzero_si128();
+                    break;
+                case Bits2:
+                {
+                    int packed = 0;
+                    std::memcpy(&packed, payload, sizeof(packed));
+                    auto const source = _mm_cvtsi32_si128(packed);
+                    auto const mask = _mm_set1_epi8(3);
+                    auto const a0 = _mm_and_si128(source, mask);
+                    auto const a1 = _mm_and_si128(_mm_srli_epi16(source, 2), mask);
+                    auto const a2 = _mm_and_si128(_mm_srli_epi16(source, 4), mask);
+                    auto const a3 = _mm_and_si128(_mm_srli_epi16(source, 6), mask);
+                    result = _mm_unpacklo_epi16(_mm_unpacklo_epi8(a0, a1), _mm_unpacklo_epi8(a2, a3));
+                    break;
+                }
+                case Bits4:
+                {
+                    auto const source = _mm_loadl_epi64(reinterpret_cast<__m128i const *>(payload));
+                    auto const mask = _mm_set1_epi8(15);
+                    result = _mm_unpacklo_epi8(
+                        _mm_and_si128(source, mask),
+                        _mm_and_si128(_mm_srli_epi16(source, 4), mask)
+                    );
+                    break;
+                }
+                case Bits8:
+                    result = _mm_loadu_si128(reinterpret_cast<__m128i const *>(payload));
+                    break;
+                }
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(values), result);
+#else
+                switch (mode)
+                {
+                case Zero:
+                    std::memset(values, 0, GroupSize);
+                    break;
+                case Bits2:
+                    for (uint32_t i = 0; i < GroupSize; ++i)
+                    {
+                        values[i] = (payload[i / 4] >> ((i % 4) * 2)) & 3;
+                    }
+                    break;
+                case Bits4:
+                    for (uint32_t i = 0; i < GroupSize; ++i)
+                    {
+                        values[i] = (payload[i / 2] >> ((i % 2) * 4)) & 15;
+                    }
+                    break;
+                case Bits8:
+                    std::memcpy(values, payload, GroupSize);
+                    break;
+                }
+#endif
+            }
+            return readOffset;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        void EncodeBlock(
+            std::vector<uint8_t> & outData,
+            uint8_t const * vertices,
+            uint32_t const vertexCount,
+            uint32_t const vertexSize
+        )
+        {
+            auto const paddedCount = (vertexCount + GroupSize - 1) / GroupSize * GroupSize;
+            std::vector<uint8_t> planes(static_cast<size_t>(paddedCount) * 4, 0);
+
+            for (uint32_t word = 0; word < vertexSize / 4; ++word)
+            {
+                uint32_t previous = 0;
+                for (uint32_t i = 0; i < vertexCount; ++i)
+                {
+                    uint32_t value = 0;
+                    std::memcpy(&value, vertices + static_cast<size_t>(i) * vertexSize + word * 4, sizeof(value));
+                    auto const coded = ZigZag(value - previous);
+                    previous = value;
+                    for (uint32_t byte = 0; byte < 4; ++byte)
+                    {
+                        planes[byte * paddedCount + i] = static_cast<uint8_t>(coded >> (byte * 8));
+                    }
+                }
+                for (uint32_t byte = 0; byte < 4; ++byte)
+                {
+                    EncodePlane(outData, planes.data() + byte * paddedCount, paddedCount);
+                }
+            }
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        // Writes the first count words of a group to the first word of each vertex
+        void StoreWords(
+            uint8_t * destination,
+            uint32_t const count,
+            uint32_t const vertexSize,
+            uint32_t const * words
+        )
+        {
+            if (vertexSize == 4)
+            {
+                std::memcpy(destination, words, count * 4);
+            }
+            else
+            {
+                for (uint32_t j = 0; j < count; ++j)
+                {
+                    std::memcpy(destination + static_cast<size_t>(j) * vertexSize, words + j, 4);
+                }
+            }
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+#ifdef MFA_MESH_CODEC_SSE2
+
+        void RebuildWordsSSE2(
+            uint8_t * destination,
+            uint32_t const vertexCount,
+            uint32_t const vertexSize,
+            uint8_t const * plane0,
+            uint8_t const * plane1,
+            uint8_t const * plane2,
+            uint8_t const * plane3
+        )
+        {
+            auto const one = _mm_set1_epi32(1);
+            auto previous = _mm_setzero_si128();
+            alignas(16) uint32_t words[GroupSize]{};
+
+            for (uint32_t i = 0; i < vertexCount; i += GroupSize)
+            {
+                auto const b0 = _mm_loadu_si128(reinterpret_cast<__m128i const *>(plane0 + i));
+                auto const b1 = _mm_loadu_si128(reinterpret_cast<__m128i const *>(plane1 + i));
+                auto const b2 = _mm_loadu_si128(reinterpret_cast<__m128i const *>(plane2 + i));
+                auto const b3 = _mm_loadu_si128(reinterpret_cast<__m128i const *>(plane3 + i));
+                auto const low01 = _mm_unpacklo_epi8(b0, b1);
+                auto const high01 = _mm_unpackhi_epi8(b0, b1);
+                auto const low23 = _mm_unpacklo_epi8(b2, b3);
+                auto const high23 = _mm_unpackhi_epi8(b2, b3);
+                __m128i quads[4]{
+                    _mm_unpacklo_epi16(low01, low23),
+                    _mm_unpackhi_epi16(low01, low23),
+                    _mm_unpacklo_epi16(high01, high23),
+                    _mm_unpackhi_epi16(high01, high23)
+                };
+                for (uint32_t q = 0; q < 4; ++q)
+                {
+                    auto value = quads[q];
+                    value = _mm_xor_si128(
+                        _mm_srli_epi32(value, 1),
+                        _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(value, one))
+                    );
+                    // Prefix sum inside the four lanes, then carry the last value of the previous quad
+                    value = _mm_add_epi32(value, _mm_slli_si128(value, 4));
+                    value = _mm_add_epi32(value, _mm_slli_si128(value, 8));
+                    value = _mm_add_epi32(value, previous);
+                    previous = _mm_shuffle_epi32(value, _MM_SHUFFLE(3, 3, 3, 3));
+                    _mm_store_si128(reinterpret_cast<__m128i *>(words + q * 4), value);
+                }
+
+                auto const count = std::min(GroupSize, vertexCount - i);
+                StoreWords(destination + static_cast<size_t>(i) * vertexSize, count, vertexSize, words);
+            }
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        MFA_TARGET_AVX2
+        __m256i WidenBytesAVX2(uint8_t const * bytes)
+        {
+            return _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<__m128i const *>(bytes)));
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        // Eight words per step, each plane is widened straight into its byte of the words so nothing has to be
+        // shuffled across the two halves of the register
+        MFA_TARGET_AVX2
+        void RebuildWordsAVX2(
+            uint8_t * destination,
+            uint32_t const vertexCount,
+            uint32_t const vertexSize,
+            uint8_t const * plane0,
+            uint8_t const * plane1,
+            uint8_t const * plane2,
+            uint8_t const * plane3
+        )
+        {
+            auto const one = _mm256_set1_epi32(1);
+            auto const lastLane = _mm256_set1_epi32(7);
+            auto const middleLane = _mm256_set1_epi32(3);
+            auto previous = _mm256_setzero_si256();
+            alignas(32) uint32_t words[GroupSize]{};
+
+            for (uint32_t i = 0; i < vertexCount; i += GroupSize)
+            {
+                for (uint32_t half = 0; half < GroupSize; half += 8)
+                {
+                    auto const offset = i + half;
+                    auto value = _mm256_or_si256(
+                        _mm256_or_si256(
+                            WidenBytesAVX2(plane0 + offset),
+                            _mm256_slli_epi32(WidenBytesAVX2(plane1 + offset), 8)
+                        ),
+                        _mm256_or_si256(
+                            _mm256_slli_epi32(WidenBytesAVX2(plane2 + offset), 16),
+                            _mm256_slli_epi32(WidenBytesAVX2(plane3 + offset), 24)
+                        )
+                    );
+                    value = _mm256_xor_si256(
+                        _mm256_srli_epi32(value, 1),
+                        _mm256_sub_epi32(_mm256_setzero_si256(), _mm256_and_si256(value, one))
+                    );
+                    // Prefix sum inside each half, then the lower half carries into the upper one
+                    value = _mm256_add_epi32(value, _mm256_slli_si256(value, 4));
+                    value = _mm256_add_epi32(value, _mm256_slli_si256(value, 8));
+                    value = _mm256_add_epi32(
+                        value,
+                        _mm256_blend_epi32(
+                            _mm256_setzero_si256(),
+                            _mm256_permutevar8x32_epi32(value, middleLane),
+                            0xF0
+                        )
+                    );
+                    value = _mm256_add_epi32(value, previous);
+                    previous = _mm256_permutevar8x32_epi32(value, lastLane);
+                    _mm256_store_si256(reinterpret_cast<__m256i *>(words + half), value);
+                }
+
+                auto const count = std::min(GroupSize, vertexCount - i);
+                StoreWords(destination + static_cast<size_t>(i) * vertexSize, count, vertexSize, words);
+            }
+        }
+
+#endif
+
+        //-------------------------------------------------------------------------------------------------
+
+        // Joins the byte planes back into words, reverts the zigzag and accumulates the deltas
+        void RebuildWords(
+            uint8_t * destination,
+            uint32_t const vertexCount,
+            uint32_t const vertexSize,
+            uint8_t const * planes,
+            uint32_t const paddedCount
+        )
+        {
+            uint8_t const * plane0 = planes;
+            uint8_t const * plane1 = planes + paddedCount;
+            uint8_t const * plane2 = planes + paddedCount * 2;
+            uint8_t const * plane3 = planes + paddedCount * 3;
+
+#ifdef MFA_MESH_CODEC_SSE2
+            if (Cpu::GetFeatures().avx2)
+            {
+                RebuildWordsAVX2(destination, vertexCount, vertexSize, plane0, plane1, plane2, plane3);
+            }
+            else
+            {
+                RebuildWordsSSE2(destination, vertexCount, vertexSize, plane0, plane1, plane2, plane3);
+            }
+#else
+            // Arm builds have no vector path yet and take this loop as well
+            uint32_t previous = 0;
+            for (uint32_t i = 0; i < vertexCount; ++i)
+            {
+                uint32_t const coded =
+                    static_cast<uint32_t>(plane0[i]) |
+                    (static_cast<uint32_t>(plane1[i]) << 8) |
+                    (static_cast<uint32_t>(plane2[i]) << 16) |
+                    (static_cast<uint32_t>(plane3[i]) << 24);
+                previous += UnZigZag(coded);
+                std::memcpy(destination + static_cast<size_t>(i) * vertexSize, &previous, sizeof(previous));
+            }
+#endif
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        bool DecodeBlock(
+            uint8_t * destination,
+            uint32_t const vertexCount,
+            uint32_t const vertexSize,
+            uint8_t const * data,
+            size_t const dataSize
+        )
+        {
+            auto const paddedCount = (vertexCount + GroupSize - 1) / GroupSize * GroupSize;
+            std::vector<uint8_t> planes(static_cast<size_t>(paddedCount) * 4);
+
+            size_t readOffset = 0;
+            for (uint32_t word = 0; word < vertexSize / 4; ++word)
+            {
+                for (uint32_t byte = 0; byte < 4; ++byte)
+                {
+                    auto const usedSize = DecodePlane(
+                        planes.data() + byte * paddedCount,
+                        paddedCount,
+                        data + readOffset,
+                        dataSize - readOffset
+                    );
+                    if (usedSize == 0)
+                    {
+                        return false;
+                    }
+                    readOffset += usedSize;
+                }
+                RebuildWords(destination + word * 4, vertexCount, vertexSize, planes.data(), paddedCount);
+            }
+            return readOffset == dataSize;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        template<typename Function>
+        void ForEachBlock(uint32_t const blockCount, Function const & function)
+        {
+            auto const job = [&function](int const begin, int const end)->void
+            {
+                for (int i = begin; i < end; ++i)
+                {
+                    function(static_cast<uint32_t>(i));
+                }
+            };
+            if (JS::Instance != nullptr)
+            {
+                JS::Instance->ParallelFor(static_cast<int>(blockCount), 1, job);
+            }
+            else
+            {
+                job(0, static_cast<int>(blockCount));
+            }
+        }
+
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    void EncodeVertexBuffer(
+        std::vector<uint8_t> & outData,
+        void const * vertices,
+        uint32_t const vertexCount,
+        uint32_t const vertexSize
+    )
+    {
+        MFA_ASSERT(vertexSize > 0 && vertexSize % 4 == 0);
+        auto const * source = static_cast<uint8_t const *>(vertices);
+        auto const blockCount = (vertexCount + BlockSize - 1) / BlockSize;
+
+        std::vector<std::vector<uint8_t>> blocks(blockCount);
+        ForEachBlock(blockCount, [&](uint32_t const block)->void
+        {
+            auto const first = block * BlockSize;
+            EncodeBlock(
+                blocks[block],
+                source + static_cast<size_t>(first) * vertexSize,
+                std::min(BlockSize, vertexCount - first),
+                vertexSize
+            );
+        });
+
+        StreamHeader const header{
+            .count = vertexCount,
+            .stride = vertexSize,
+            .blockCount = blockCount
+        };
+        std::vector<uint32_t> blockOffsets(blockCount + 1, 0);
+        for (uint32_t i = 0; i < blockCount; ++i)
+        {
+            blockOffsets[i + 1] = blockOffsets[i] + static_cast<uint32_t>(blocks[i].size());
+        }
+
+        auto const * headerBytes = reinterpret_cast<uint8_t const *>(&header);
+        outData.insert(outData.end(), headerBytes, headerBytes + sizeof(header));
+        auto const * offsetBytes = reinterpret_cast<uint8_t const *>(blockOffsets.data());
+        outData.insert(outData.end(), offsetBytes, offsetBytes + blockOffsets.size() * sizeof(uint32_t));
+        for (auto const & block : blocks)
+        {
+            outData.insert(outData.end(), block.begin(), block.end());
+        }
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    bool DecodeVertexBuffer(
+        void * destination,
+        uint32_t const vertexCount,
+        uint32_t const vertexSize,
+        uint8_t const * data,
+        size_t const dataSize
+    )
+    {
+        if (dataSize < sizeof(StreamHeader) || vertexSize == 0 || vertexSize % 4 != 0)
+        {
+            return false;
+        }
+        StreamHeader header{};
+        std::memcpy(&header, data, sizeof(header));
+        auto const blockCount = (vertexCount + BlockSize - 1) / BlockSize;
+        if (
+            header.magic != Magic ||
+            header.count != vertexCount ||
+            header.stride != vertexSize ||
+            header.blockCount != blockCount
+        )
+        {
+            return false;
+        }
+
+        auto const offsetsSize = sizeof(uint32_t) * (blockCount + 1);
+        if (dataSize - sizeof(StreamHeader) < offsetsSize)
+        {
+            return false;
+        }
+        std::vector<uint32_t> blockOffsets(blockCount + 1);
+        std::memcpy(blockOffsets.data(), data + sizeof(StreamHeader), offsetsSize);
+
+        auto const * blockData = data + sizeof(StreamHeader) + offsetsSize;
+        auto const blockDataSize = dataSize - sizeof(StreamHeader) - offsetsSize;
+        if (blockOffsets[0] != 0 || blockOffsets[blockCount] != blockDataSize)
+        {
+            return false;
+        }
+        for (uint32_t i = 0; i < blockCount; ++i)
+        {
+            if (blockOffsets[i] > blockOffsets[i + 1])
+            {
+                return false;
+            }
+        }
+
+        auto * target = static_cast<uint8_t *>(destination);
+        std::atomic<bool> isValid = true;
+        ForEachBlock(blockCount, [&](uint32_t const block)->void
+        {
+            auto const first = block * BlockSize;
+            bool const success = DecodeBlock(
+                target + static_cast<size_t>(first) * vertexSize,
+                std::min(BlockSize, vertexCount - first),
+                vertexSize,
+                blockData + blockOffsets[block],
+                blockOffsets[block + 1] - blockOffsets[block]
+            );
+            if (success == false)
+            {
+                isValid = false;
+            }
+        });
+        return isValid;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    void EncodeIndexBuffer(std::vector<uint8_t> & outData, Index const * indices, uint32_t const indexCount)
+    {
+        static_assert(sizeof(Index) == 4);
+        EncodeVertexBuffer(outData, indices, indexCount, sizeof(Index));
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    bool DecodeIndexBuffer(Index * destination, uint32_t const indexCount, uint8_t const * data, size_t const dataSize)
+    {
+        return DecodeVertexBuffer(destination, indexCount, sizeof(Index), data, dataSize);
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+}
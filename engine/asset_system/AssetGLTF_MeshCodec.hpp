@@ -0,0 +1,41 @@
+#pragma once
+
+#include "AssetGLTF_Mesh.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Lossless compression for vertex and index buffers on disk. Each 32 bit word of a vertex is delta coded against the
+// same word of the previous vertex and zigzag coded, then the four bytes of every word go to separate byte planes.
+// Planes are stored in groups of 16 bytes that use 0, 2, 4 or 8 bits per byte, so mostly constant attributes
+// cost almost nothing. Vertices are split into blocks that are decoded in parallel.
+// Decoding uses SSE2 when it is available and a scalar path otherwise.
+namespace MFA::Asset::GLTF::MeshCodec
+{
+
+    // Vertex size has to be a multiple of four. Appends the result to outData.
+    void EncodeVertexBuffer(
+        std::vector<uint8_t> & outData,
+        void const * vertices,
+        uint32_t vertexCount,
+        uint32_t vertexSize
+    );
+
+    // Returns false when the data is corrupt or does not match the count and size
+    [[nodiscard]]
+    bool DecodeVertexBuffer(
+        void * destination,
+        uint32_t vertexCount,
+        uint32_t vertexSize,
+        uint8_t const * data,
+        size_t dataSize
+    );
+
+    // Indices compress best after MeshOptimizer has ordered them
+    void EncodeIndexBuffer(std::vector<uint8_t> & outData, Index const * indices, uint32_t indexCount);
+
+    [[nodiscard]]
+    bool DecodeIndexBuffer(Index * destination, uint32_t indexCount, uint8_t const * data, size_t dataSize);
+
+}
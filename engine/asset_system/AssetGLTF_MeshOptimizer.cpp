@@ -0,0 +1,752 @@
+#include "AssetGLTF_MeshOptimizer.hpp"
+
+#include "BedrockAssert.hpp"
+#include "JobSystem.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+#include <glm/geometric.hpp>
+
+namespace MFA::Asset::GLTF::MeshOptimizer
+{
+
+    namespace
+    {
+
+        // Fifo cache that uses timestamps instead of a queue. A vertex is a hit while it is younger than the cache size.
+        class FifoCache
+        {
+        public:
+
+            explicit FifoCache(uint32_t const vertexCount, uint32_t const cacheSize)
+                : _timestamps(vertexCount, 0)
+                , _cacheSize(cacheSize)
+                , _time(cacheSize + 1)
+            {}
+
+            // Returns true on a miss
+            bool Access(Index const vertex)
+            {
+                if (_time - _timestamps[vertex] > _cacheSize)
+                {
+                    _timestamps[vertex] = _time++;
+                    return true;
+                }
+                return false;
+            }
+
+            void Flush()
+            {
+                _time += _cacheSize + 1;
+            }
+
+            [[nodiscard]]
+            bool IsCached(Index const vertex) const
+            {
+                return _time - _timestamps[vertex] <= _cacheSize;
+            }
+
+            [[nodiscard]]
+            uint32_t GetAge(Index const vertex) const
+            {
+                return _time - _timestamps[vertex];
+            }
+
+        private:
+
+            std::vector<uint32_t> _timestamps;
+            uint32_t const _cacheSize;
+            uint32_t _time;
+
+        };
+
+        //-------------------------------------------------------------------------------------------------
+
+        // Triangles that use each vertex, stored as a compressed row list
+        struct Adjacency
+        {
+            std::vector<uint32_t> offsets{};
+            std::vector<uint32_t> triangles{};
+            std::vector<uint32_t> liveCounts{};
+        };
+
+        Adjacency BuildAdjacency(Index const * indices, uint32_t const indexCount, uint32_t const vertexCount)
+        {
+            Adjacency adjacency{};
+            adjacency.liveCounts.assign(vertexCount, 0);
+            for (uint32_t i = 0; i < indexCount; ++i)
+            {
+                MFA_ASSERT(indices[i] < vertexCount);
+                ++adjacency.liveCounts[indices[i]];
+            }
+
+            adjacency.offsets.assign(vertexCount + 1, 0);
+            for (uint32_t i = 0; i < vertexCount; ++i)
+            {
+                adjacency.offsets[i + 1] = adjacency.offsets[i] + adjacency.liveCounts[i];
+            }
+
+            adjacency.triangles.resize(indexCount);
+            std::vector<uint32_t> cursors(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+            for (uint32_t i = 0; i < indexCount; ++i)
+            {
+                adjacency.triangles[cursors[indices[i]]++] = i / 3;
+            }
+            return adjacency;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        uint32_t CountMisses(Index const * indices, uint32_t const indexCount, FifoCache & cache)
+        {
+            uint32_t misses = 0;
+            for (uint32_t i = 0; i < indexCount; ++i)
+            {
+                misses += cache.Access(indices[i]) ? 1 : 0;
+            }
+            return misses;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        // Local copy of the primitive indices with the vertex offset removed
+        std::vector<Index> ToLocalIndices(Primitive const & primitive, Index const * indices)
+        {
+            std::vector<Index> localIndices(primitive.indicesCount);
+            for (uint32_t i = 0; i < primitive.indicesCount; ++i)
+            {
+                localIndices[i] = indices[primitive.indicesStartingIndex + i] - primitive.verticesStartingIndex;
+            }
+            return localIndices;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        void ComputeMeshletBounds(Meshlet & meshlet, Vertex const * vertices, Index const * indices)
+        {
+            auto const begin = meshlet.indicesStartingIndex;
+            auto const end = begin + meshlet.indicesCount;
+
+            glm::vec3 minimum{std::numeric_limits<float>::max()};
+            glm::vec3 maximum{std::numeric_limits<float>::lowest()};
+            for (auto i = begin; i < end; ++i)
+            {
+                minimum = glm::min(minimum, vertices[indices[i]].position);
+                maximum = glm::max(maximum, vertices[indices[i]].position);
+            }
+            meshlet.center = (minimum + maximum) * 0.5f;
+
+            float radiusSquared = 0.0f;
+            for (auto i = begin; i < end; ++i)
+            {
+                auto const delta = vertices[indices[i]].position - meshlet.center;
+                radiusSquared = std::max(radiusSquared, glm::dot(delta, delta));
+            }
+            meshlet.radius = std::sqrt(radiusSquared);
+
+            std::vector<glm::vec3> normals{};
+            normals.reserve(meshlet.indicesCount / 3);
+            glm::vec3 axis{};
+            for (auto i = begin; i + 2 < end; i += 3)
+            {
+                auto const & p0 = vertices[indices[i]].position;
+                auto const & p1 = vertices[indices[i + 1]].position;
+                auto const & p2 = vertices[indices[i + 2]].position;
+                auto const normal = glm::cross(p1 - p0, p2 - p0);
+                float const length = glm::length(normal);
+                if (length > 0.0f)
+                {
+                    normals.emplace_back(normal / length);
+                    axis += normals.back();
+                }
+            }
+
+            float const axisLength = glm::length(axis);
+            if (normals.empty() || axisLength <= 0.0f)
+            {
+                meshlet.coneAxis = glm::vec3{0.0f, 0.0f, 1.0f};
+                meshlet.coneCutoff = 1.0f;
+                return;
+            }
+            meshlet.coneAxis = axis / axisLength;
+
+            float minimumDot = 1.0f;
+            for (auto const & normal : normals)
+            {
+                minimumDot = std::min(minimumDot, glm::dot(normal, meshlet.coneAxis));
+            }
+            // Cones that are wider than a hemisphere never reject anything
+            meshlet.coneCutoff = minimumDot <= 0.1f ? 1.0f : std::sqrt(1.0f - minimumDot * minimumDot);
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        std::vector<Meshlet> BuildPrimitiveMeshlets(
+            Primitive const & primitive,
+            Vertex const * vertices,
+            Index const * indices,
+            MeshletParams const & params
+        )
+        {
+            MFA_ASSERT(params.maxVertices >= 3);
+            MFA_ASSERT(params.maxTriangles >= 1);
+
+            std::vector<Meshlet> meshlets{};
+
+            // Id of the last meshlet that used each vertex, so counting the unique vertices needs no set
+            static constexpr uint32_t NoMeshlet = std::numeric_limits<uint32_t>::max();
+            std::vector<uint32_t> vertexMarks(primitive.vertexCount, NoMeshlet);
+
+            Meshlet current{.indicesStartingIndex = primitive.indicesStartingIndex};
+            auto const finishMeshlet = [&]()->void
+            {
+                if (current.indicesCount > 0)
+                {
+                    ComputeMeshletBounds(current, vertices, indices);
+                    meshlets.emplace_back(current);
+                }
+                current = Meshlet{.indicesStartingIndex = current.indicesStartingIndex + current.indicesCount};
+            };
+
+            auto const indicesEnd = primitive.indicesStartingIndex + primitive.indicesCount - primitive.indicesCount % 3;
+            for (auto i = primitive.indicesStartingIndex; i < indicesEnd; i += 3)
+            {
+                uint32_t localVertices[3]{};
+                bool isUnique[3]{};                 // Degenerate triangles repeat a vertex
+                for (uint32_t j = 0; j < 3; ++j)
+                {
+                    localVertices[j] = indices[i + j] - primitive.verticesStartingIndex;
+                    MFA_ASSERT(localVertices[j] < primitive.vertexCount);
+                    isUnique[j] = (j < 1 || localVertices[j] != localVertices[0]) &&
+                        (j < 2 || localVertices[j] != localVertices[1]);
+                }
+
+                auto const countNewVertices = [&]()->uint32_t
+                {
+                    auto const meshletId = static_cast<uint32_t>(meshlets.size());
+                    uint32_t count = 0;
+                    for (uint32_t j = 0; j < 3; ++j)
+                    {
+                        count += isUnique[j] && vertexMarks[localVertices[j]] != meshletId ? 1 : 0;
+                    }
+                    return count;
+                };
+
+                auto newVertexCount = countNewVertices();
+                if (current.indicesCount / 3 + 1 > params.maxTriangles ||
+                    current.vertexCount + newVertexCount > params.maxVertices)
+                {
+                    finishMeshlet();
+                    newVertexCount = countNewVertices();
+                }
+
+                auto const meshletId = static_cast<uint32_t>(meshlets.size());
+                for (auto const vertex : localVertices)
+                {
+                    vertexMarks[vertex] = meshletId;
+                }
+                current.vertexCount += newVertexCount;
+                current.indicesCount += 3;
+            }
+            finishMeshlet();
+
+            return meshlets;
+        }
+
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    VertexCacheStats AnalyzeVertexCache(
+        Index const * indices,
+        uint32_t const indexCount,
+        uint32_t const vertexCount,
+        uint32_t const cacheSize
+    )
+    {
+        VertexCacheStats stats{};
+        if (indexCount < 3 || vertexCount == 0)
+        {
+            return stats;
+        }
+
+        FifoCache cache{vertexCount, cacheSize};
+        auto const misses = CountMisses(indices, indexCount, cache);
+
+        std::vector<bool> isUsed(vertexCount, false);
+        uint32_t usedCount = 0;
+        for (uint32_t i = 0; i < indexCount; ++i)
+        {
+            if (isUsed[indices[i]] == false)
+            {
+                isUsed[indices[i]] = true;
+                ++usedCount;
+            }
+        }
+
+        stats.acmr = static_cast<float>(misses) / static_cast<float>(indexCount / 3);
+        stats.atvr = static_cast<float>(misses) / static_cast<float>(usedCount);
+        return stats;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    void OptimizeVertexCache(
+        Index * destination,
+        Index const * indices,
+        uint32_t const indexCount,
+        uint32_t const vertexCount,
+        uint32_t const cacheSize,
+        std::vector<uint32_t> * clusterStarts
+    )
+    {
+        MFA_ASSERT(indexCount % 3 == 0);
+        MFA_ASSERT(destination != indices);
+
+        if (clusterStarts != nullptr)
+        {
+            clusterStarts->clear();
+        }
+        if (indexCount == 0)
+        {
+            return;
+        }
+
+        auto adjacency = BuildAdjacency(indices, indexCount, vertexCount);
+        auto & liveCounts = adjacency.liveCounts;
+
+        FifoCache cache{vertexCount, cacheSize};
+        std::vector<bool> isEmitted(indexCount / 3, false);
+        std::vector<Index> deadEnds{};
+        std::vector<Index> candidates{};
+        uint32_t outputCount = 0;
+        uint32_t scanCursor = 0;
+
+        // Next vertex with live triangles. Recently used vertices are preferred over a linear scan.
+        auto const skipDeadEnd = [&]()->int64_t
+        {
+            while (deadEnds.empty() == false)
+            {
+                auto const vertex = deadEnds.back();
+                deadEnds.pop_back();
+                if (liveCounts[vertex] > 0)
+                {
+                    return vertex;
+                }
+            }
+            while (scanCursor < vertexCount)
+            {
+                if (liveCounts[scanCursor] > 0)
+                {
+                    return scanCursor;
+                }
+                ++scanCursor;
+            }
+            return -1;
+        };
+
+        int64_t fanVertex = skipDeadEnd();
+        bool isColdStart = true;
+        while (fanVertex >= 0)
+        {
+            if (isColdStart && clusterStarts != nullptr)
+            {
+                clusterStarts->emplace_back(outputCount);
+            }
+
+            candidates.clear();
+            auto const begin = adjacency.offsets[fanVertex];
+            auto const end = adjacency.offsets[fanVertex + 1];
+            for (auto i = begin; i < end; ++i)
+            {
+                auto const triangle = adjacency.triangles[i];
+                if (isEmitted[triangle])
+                {
+                    continue;
+                }
+                isEmitted[triangle] = true;
+                for (uint32_t j = 0; j < 3; ++j)
+                {
+                    auto const vertex = indices[triangle * 3 + j];
+                    destination[outputCount++] = vertex;
+                    deadEnds.emplace_back(vertex);
+                    candidates.emplace_back(vertex);
+                    --liveCounts[vertex];
+                    cache.Access(vertex);
+                }
+            }
+
+            // Pick the oldest candidate that stays in the cache while its remaining triangles are emitted
+            int64_t nextVertex = -1;
+            uint32_t bestPriority = 0;
+            for (auto const vertex : candidates)
+            {
+                if (liveCounts[vertex] == 0)
+                {
+                    continue;
+                }
+                uint32_t priority = 0;
+                if (cache.IsCached(vertex) && cache.GetAge(vertex) + 2 * liveCounts[vertex] <= cacheSize)
+                {
+                    priority = cache.GetAge(vertex);
+                }
+                if (nextVertex < 0 || priority > bestPriority)
+                {
+                    bestPriority = priority;
+                    nextVertex = vertex;
+                }
+            }
+
+            isColdStart = nextVertex < 0;
+            if (isColdStart)
+            {
+                nextVertex = skipDeadEnd();
+            }
+            fanVertex = nextVertex;
+        }
+
+        MFA_ASSERT(outputCount == indexCount);
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    void OptimizeOverdraw(
+        Index * destination,
+        Index const * indices,
+        uint32_t const indexCount,
+        Vertex const * vertices,
+        uint32_t const vertexCount,
+        std::vector<uint32_t> const & clusterStarts,
+        float const threshold,
+        uint32_t const cacheSize
+    )
+    {
+        MFA_ASSERT(indexCount % 3 == 0);
+        MFA_ASSERT(destination != indices);
+        if (indexCount == 0)
+        {
+            return;
+        }
+
+        // Step one: Split the hard clusters wherever the acmr of the part so far is already good enough
+        std::vector<uint32_t> hardStarts = clusterStarts;
+        if (hardStarts.empty() || hardStarts.front() != 0)
+        {
+            hardStarts.insert(hardStarts.begin(), 0);
+        }
+
+        std::vector<uint32_t> softStarts{};
+        FifoCache cache{vertexCount, cacheSize};
+        for (size_t i = 0; i < hardStarts.size(); ++i)
+        {
+            auto const begin = hardStarts[i];
+            auto const end = i + 1 < hardStarts.size() ? hardStarts[i + 1] : indexCount;
+
+            cache.Flush();
+            float const clusterAcmr = static_cast<float>(CountMisses(indices + begin, end - begin, cache)) /
+                static_cast<float>((end - begin) / 3);
+
+            cache.Flush();
+            softStarts.emplace_back(begin);
+            uint32_t misses = 0;
+            uint32_t triangleCount = 0;
+            for (auto index = begin; index < end; index += 3)
+            {
+                misses += CountMisses(indices + index, 3, cache);
+                ++triangleCount;
+                float const acmr = static_cast<float>(misses) / static_cast<float>(triangleCount);
+                if (index + 3 < end && acmr <= clusterAcmr * threshold)
+                {
+                    softStarts.emplace_back(index + 3);
+                    cache.Flush();
+                    misses = 0;
+                    triangleCount = 0;
+                }
+            }
+        }
+
+        // Step two: Area weighted centroid and normal of each cluster
+        struct Cluster
+        {
+            uint32_t begin = 0;
+            uint32_t end = 0;
+            glm::vec3 centroid{};
+            glm::vec3 normal{};
+            float sortKey = 0.0f;
+        };
+        std::vector<Cluster> clusters(softStarts.size());
+
+        glm::vec3 meshCentroid{};
+        float meshArea = 0.0f;
+        for (size_t i = 0; i < softStarts.size(); ++i)
+        {
+            auto & cluster = clusters[i];
+            cluster.begin = softStarts[i];
+            cluster.end = i + 1 < softStarts.size() ? softStarts[i + 1] : indexCount;
+
+            float area = 0.0f;
+            for (auto index = cluster.begin; index < cluster.end; index += 3)
+            {
+                auto const & p0 = vertices[indices[index]].position;
+                auto const & p1 = vertices[indices[index + 1]].position;
+                auto const & p2 = vertices[indices[index + 2]].position;
+                auto const crossProduct = glm::cross(p1 - p0, p2 - p0);
+                float const triangleArea = glm::length(crossProduct);
+                cluster.centroid += (p0 + p1 + p2) * (triangleArea / 3.0f);
+                cluster.normal += crossProduct;
+                area += triangleArea;
+            }
+
+            meshCentroid += cluster.centroid;
+            meshArea += area;
+
+            if (area > 0.0f)
+            {
+                cluster.centroid /= area;
+            }
+            float const normalLength = glm::length(cluster.normal);
+            if (normalLength > 0.0f)
+            {
+                cluster.normal /= normalLength;
+            }
+        }
+        if (meshArea > 0.0f)
+        {
+            meshCentroid /= meshArea;
+        }
+
+        // Step three: Clusters that face away from the center are more likely to occlude the others so they go first
+        for (auto & cluster : clusters)
+        {
+            cluster.sortKey = glm::dot(cluster.centroid - meshCentroid, cluster.normal);
+        }
+        std::stable_sort(clusters.begin(), clusters.end(), [](Cluster const & a, Cluster const & b)->bool
+        {
+            return a.sortKey > b.sortKey;
+        });
+
+        uint32_t outputCount = 0;
+        for (auto const & cluster : clusters)
+        {
+            std::copy(indices + cluster.begin, indices + cluster.end, destination + outputCount);
+            outputCount += cluster.end - cluster.begin;
+        }
+        MFA_ASSERT(outputCount == indexCount);
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    void OptimizeVertexFetch(
+        Vertex * destination,
+        Index * indices,
+        uint32_t const indexCount,
+        Vertex const * vertices,
+        uint32_t const vertexCount
+    )
+    {
+        MFA_ASSERT(destination != vertices);
+
+        static constexpr Index Unassigned = std::numeric_limits<Index>::max();
+        std::vector<Index> remap(vertexCount, Unassigned);
+
+        Index nextVertex = 0;
+        for (uint32_t i = 0; i < indexCount; ++i)
+        {
+            auto & newIndex = remap[indices[i]];
+            if (newIndex == Unassigned)
+            {
+                newIndex = nextVertex++;
+                destination[newIndex] = vertices[indices[i]];
+            }
+            indices[i] = newIndex;
+        }
+
+        // Keeps the vertex count of the primitive the same so the buffer offsets do not move
+        for (uint32_t i = 0; i < vertexCount; ++i)
+        {
+            if (remap[i] == Unassigned)
+            {
+                destination[nextVertex++] = vertices[i];
+            }
+        }
+        MFA_ASSERT(nextVertex == vertexCount);
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    Report Optimize(Mesh & mesh, Params const & params)
+    {
+        auto * vertices = mesh.GetVertexData()->As<Vertex>();
+        auto * indices = mesh.GetIndexData()->As<Index>();
+
+        std::vector<Primitive const *> primitives{};
+        for (auto const & subMesh : mesh.GetMeshData()->subMeshes)
+        {
+            for (auto const & primitive : subMesh.primitives)
+            {
+                primitives.emplace_back(&primitive);
+            }
+        }
+
+        struct PrimitiveMisses
+        {
+            uint32_t before = 0;
+            uint32_t after = 0;
+            uint32_t usedVertices = 0;
+        };
+        std::vector<PrimitiveMisses> primitiveMisses(primitives.size());
+
+        // Primitives own disjoint ranges of both buffers so they can be processed in parallel
+        auto const optimizePrimitives = [&](int const begin, int const end)->void
+        {
+            for (int i = begin; i < end; ++i)
+            {
+                auto const & primitive = *primitives[i];
+                MFA_ASSERT(primitive.lodCount == 0);
+                auto const vertexCount = primitive.vertexCount;
+                auto const indexCount = primitive.indicesCount - primitive.indicesCount % 3;
+                if (indexCount == 0)
+                {
+                    continue;
+                }
+                auto * primitiveVertices = vertices + primitive.verticesStartingIndex;
+                auto * primitiveIndices = indices + primitive.indicesStartingIndex;
+
+                auto localIndices = ToLocalIndices(primitive, indices);
+                std::vector<Index> reorderedIndices(indexCount);
+                auto & misses = primitiveMisses[i];
+
+                auto const before = AnalyzeVertexCache(localIndices.data(), indexCount, vertexCount, params.cacheSize);
+                misses.before = static_cast<uint32_t>(before.acmr * static_cast<float>(indexCount / 3) + 0.5f);
+
+                std::vector<uint32_t> clusterStarts{};
+                OptimizeVertexCache(
+                    reorderedIndices.data(),
+                    localIndices.data(),
+                    indexCount,
+                    vertexCount,
+                    params.cacheSize,
+                    &clusterStarts
+                );
+                std::swap(localIndices, reorderedIndices);
+
+                if (params.optimizeOverdraw)
+                {
+                    OptimizeOverdraw(
+                        reorderedIndices.data(),
+                        localIndices.data(),
+                        indexCount,
+                        primitiveVertices,
+                        vertexCount,
+                        clusterStarts,
+                        params.overdrawThreshold,
+                        params.cacheSize
+                    );
+                    std::swap(localIndices, reorderedIndices);
+                }
+
+                if (params.optimizeVertexFetch)
+                {
+                    std::vector<Vertex> reorderedVertices(vertexCount);
+                    OptimizeVertexFetch(
+                        reorderedVertices.data(),
+                        localIndices.data(),
+                        indexCount,
+                        primitiveVertices,
+                        vertexCount
+                    );
+                    std::copy(reorderedVertices.begin(), reorderedVertices.end(), primitiveVertices);
+                }
+
+                auto const after = AnalyzeVertexCache(localIndices.data(), indexCount, vertexCount, params.cacheSize);
+                misses.after = static_cast<uint32_t>(after.acmr * static_cast<float>(indexCount / 3) + 0.5f);
+                misses.usedVertices = after.atvr > 0.0f
+                    ? static_cast<uint32_t>(static_cast<float>(misses.after) / after.atvr + 0.5f)
+                    : 0;
+
+                for (uint32_t j = 0; j < indexCount; ++j)
+                {
+                    primitiveIndices[j] = localIndices[j] + primitive.verticesStartingIndex;
+                }
+            }
+        };
+        if (JS::Instance != nullptr)
+        {
+            JS::Instance->ParallelFor(static_cast<int>(primitives.size()), 1, optimizePrimitives);
+        }
+        else
+        {
+            optimizePrimitives(0, static_cast<int>(primitives.size()));
+        }
+
+        uint32_t missesBefore = 0;
+        uint32_t missesAfter = 0;
+        uint32_t usedVertices = 0;
+        uint32_t triangleCount = 0;
+        for (size_t i = 0; i < primitives.size(); ++i)
+        {
+            missesBefore += primitiveMisses[i].before;
+            missesAfter += primitiveMisses[i].after;
+            usedVertices += primitiveMisses[i].usedVertices;
+            triangleCount += primitives[i]->indicesCount / 3;
+        }
+
+        Report report{};
+        if (triangleCount > 0 && usedVertices > 0)
+        {
+            report.before.acmr = static_cast<float>(missesBefore) / static_cast<float>(triangleCount);
+            report.before.atvr = static_cast<float>(missesBefore) / static_cast<float>(usedVertices);
+            report.after.acmr = static_cast<float>(missesAfter) / static_cast<float>(triangleCount);
+            report.after.atvr = static_cast<float>(missesAfter) / static_cast<float>(usedVertices);
+        }
+        return report;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    void BuildMeshlets(Mesh & mesh, MeshletParams const & params)
+    {
+        auto const * vertices = mesh.GetVertexData()->As<Vertex>();
+        auto const * indices = mesh.GetIndexData()->As<Index>();
+        auto & meshData = *mesh.GetMeshData();
+
+        std::vector<Primitive *> primitives{};
+        for (auto & subMesh : meshData.subMeshes)
+        {
+            for (auto & primitive : subMesh.primitives)
+            {
+                primitives.emplace_back(&primitive);
+            }
+        }
+
+        std::vector<std::vector<Meshlet>> primitiveMeshlets(primitives.size());
+        auto const buildMeshlets = [&](int const begin, int const end)->void
+        {
+            for (int i = begin; i < end; ++i)
+            {
+                primitiveMeshlets[i] = BuildPrimitiveMeshlets(*primitives[i], vertices, indices, params);
+            }
+        };
+        if (JS::Instance != nullptr)
+        {
+            JS::Instance->ParallelFor(static_cast<int>(primitives.size()), 1, buildMeshlets);
+        }
+        else
+        {
+            buildMeshlets(0, static_cast<int>(primitives.size()));
+        }
+
+        meshData.meshlets.clear();
+        for (size_t i = 0; i < primitives.size(); ++i)
+        {
+            auto & primitive = *primitives[i];
+            primitive.meshletStartingIndex = static_cast<uint32_t>(meshData.meshlets.size());
+            primitive.meshletCount = static_cast<uint32_t>(primitiveMeshlets[i].size());
+            meshData.meshlets.insert(meshData.meshlets.end(), primitiveMeshlets[i].begin(), primitiveMeshlets[i].end());
+        }
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+}
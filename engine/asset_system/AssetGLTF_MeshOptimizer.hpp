@@ -0,0 +1,91 @@
+#pragma once
+
+#include "AssetGLTF_Mesh.hpp"
+
+#include <cstdint>
+#include <vector>
+
+// Passes that reorder the primitives of a mesh for the gpu. None of them change what is drawn.
+// Functions that take raw index arrays expect indices relative to the first vertex of the primitive.
+namespace MFA::Asset::GLTF::MeshOptimizer
+{
+
+    inline static constexpr uint32_t DefaultCacheSize = 16;
+
+    struct VertexCacheStats
+    {
+        float acmr = 0.0f;              // Average cache miss ratio, transformed vertices per triangle. Best case is around 0.5
+        float atvr = 0.0f;              // Average transformed vertex ratio, transformed vertices per used vertex. Best case is 1
+    };
+
+    // Simulates a fifo post transform cache
+    [[nodiscard]]
+    VertexCacheStats AnalyzeVertexCache(
+        Index const * indices,
+        uint32_t indexCount,
+        uint32_t vertexCount,
+        uint32_t cacheSize = DefaultCacheSize
+    );
+
+    // Tipsify, Sander et al. 2007. Writes the reordered triangles to destination and fills clusterStarts with the
+    // first index of every run that starts with a cold cache. Destination must not overlap indices.
+    void OptimizeVertexCache(
+        Index * destination,
+        Index const * indices,
+        uint32_t indexCount,
+        uint32_t vertexCount,
+        uint32_t cacheSize = DefaultCacheSize,
+        std::vector<uint32_t> * clusterStarts = nullptr
+    );
+
+    // Splits the cache optimized triangles into clusters and sorts them so the outer facing ones come first.
+    // Clusters are only split where the acmr stays below threshold times the acmr of the whole run.
+    void OptimizeOverdraw(
+        Index * destination,
+        Index const * indices,
+        uint32_t indexCount,
+        Vertex const * vertices,
+        uint32_t vertexCount,
+        std::vector<uint32_t> const & clusterStarts,
+        float threshold = 1.05f,
+        uint32_t cacheSize = DefaultCacheSize
+    );
+
+    // Reorders the vertices by first use and rewrites the indices. Unused vertices are moved to the end.
+    void OptimizeVertexFetch(
+        Vertex * destination,
+        Index * indices,
+        uint32_t indexCount,
+        Vertex const * vertices,
+        uint32_t vertexCount
+    );
+
+    struct Params
+    {
+        uint32_t cacheSize = DefaultCacheSize;
+        bool optimizeOverdraw = true;
+        float overdrawThreshold = 1.05f;
+        bool optimizeVertexFetch = true;
+    };
+
+    struct Report
+    {
+        VertexCacheStats before{};
+        VertexCacheStats after{};
+    };
+
+    // Runs all the passes on every primitive of the mesh. The report covers the whole mesh.
+    // Vertices move, so it has to run before the levels of detail are built.
+    Report Optimize(Mesh & mesh, Params const & params = {});
+
+    struct MeshletParams
+    {
+        uint32_t maxVertices = 64;
+        uint32_t maxTriangles = 124;
+    };
+
+    // Cuts the triangles of every primitive into meshlets in their current order, so it should run after Optimize.
+    // Replaces MeshData::meshlets.
+    void BuildMeshlets(Mesh & mesh, MeshletParams const & params = {});
+
+}
@@ -0,0 +1,505 @@
+#include "AssetGLTF_MeshSimplifier.hpp"
+
+#include "AssetGLTF_MeshOptimizer.hpp"
+#include "BedrockAssert.hpp"
+#include "JobSystem.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <tuple>
+#include <unordered_map>
+
+#include <glm/geometric.hpp>
+
+namespace MFA::Asset::GLTF::MeshSimplifier
+{
+
+    namespace
+    {
+
+        // Sum of squared distances to a set of planes: p^T A p + 2 b^T p + c. Weight is the area that it covers.
+        struct Quadric
+        {
+            double a00 = 0.0, a01 = 0.0, a02 = 0.0, a11 = 0.0, a12 = 0.0, a22 = 0.0;
+            double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+            double c = 0.0;
+            double weight = 0.0;
+
+            static Quadric FromPlane(glm::dvec3 const & normal, double const distance, double const weight)
+            {
+                return Quadric{
+                    .a00 = normal.x * normal.x * weight,
+                    .a01 = normal.x * normal.y * weight,
+                    .a02 = normal.x * normal.z * weight,
+                    .a11 = normal.y * normal.y * weight,
+                    .a12 = normal.y * normal.z * weight,
+                    .a22 = normal.z * normal.z * weight,
+                    .b0 = normal.x * distance * weight,
+                    .b1 = normal.y * distance * weight,
+                    .b2 = normal.z * distance * weight,
+                    .c = distance * distance * weight,
+                    .weight = weight
+                };
+            }
+
+            void Add(Quadric const & other)
+            {
+                a00 += other.a00; a01 += other.a01; a02 += other.a02;
+                a11 += other.a11; a12 += other.a12; a22 += other.a22;
+                b0 += other.b0; b1 += other.b1; b2 += other.b2;
+                c += other.c;
+                weight += other.weight;
+            }
+
+            // Average squared distance of the point to the planes
+            [[nodiscard]]
+            double Evaluate(glm::dvec3 const & p) const
+            {
+                double const error =
+                    a00 * p.x * p.x + 2.0 * a01 * p.x * p.y + 2.0 * a02 * p.x * p.z +
+                    a11 * p.y * p.y + 2.0 * a12 * p.y * p.z +
+                    a22 * p.z * p.z +
+                    2.0 * (b0 * p.x + b1 * p.y + b2 * p.z) +
+                    c;
+                return weight > 0.0 ? std::abs(error) / weight : 0.0;
+            }
+        };
+
+        //-------------------------------------------------------------------------------------------------
+
+        struct Collapse
+        {
+            Index from = 0;
+            Index to = 0;
+            double cost = 0.0;
+        };
+
+        //-------------------------------------------------------------------------------------------------
+
+        uint64_t EdgeKey(Index const a, Index const b)
+        {
+            return a < b
+                ? (static_cast<uint64_t>(a) << 32) | b
+                : (static_cast<uint64_t>(b) << 32) | a;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        // Vertices that share their position with another vertex sit on an attribute seam and vertices of edges
+        // with a single triangle sit on an open border. Moving either of them opens cracks.
+        std::vector<bool> FindLockedVertices(
+            std::vector<Index> const & indices,
+            Vertex const * vertices,
+            uint32_t const vertexCount
+        )
+        {
+            std::vector<bool> isLocked(vertexCount, false);
+
+            std::vector<Index> sortedVertices(vertexCount);
+            std::iota(sortedVertices.begin(), sortedVertices.end(), 0);
+            auto const lessPosition = [vertices](Index const a, Index const b)->bool
+            {
+                auto const & pa = vertices[a].position;
+                auto const & pb = vertices[b].position;
+                return std::tie(pa.x, pa.y, pa.z) < std::tie(pb.x, pb.y, pb.z);
+            };
+            std::sort(sortedVertices.begin(), sortedVertices.end(), lessPosition);
+            for (uint32_t i = 1; i < vertexCount; ++i)
+            {
+                if (vertices[sortedVertices[i]].position == vertices[sortedVertices[i - 1]].position)
+                {
+                    isLocked[sortedVertices[i]] = true;
+                    isLocked[sortedVertices[i - 1]] = true;
+                }
+            }
+
+            std::unordered_map<uint64_t, uint32_t> edgeUseCounts{};
+            edgeUseCounts.reserve(indices.size());
+            for (size_t i = 0; i < indices.size(); i += 3)
+            {
+                for (size_t j = 0; j < 3; ++j)
+                {
+                    ++edgeUseCounts[EdgeKey(indices[i + j], indices[i + (j + 1) % 3])];
+                }
+            }
+            for (auto const & [edge, useCount] : edgeUseCounts)
+            {
+                if (useCount == 1)
+                {
+                    isLocked[static_cast<Index>(edge >> 32)] = true;
+                    isLocked[static_cast<Index>(edge & 0xFFFFFFFFull)] = true;
+                }
+            }
+            return isLocked;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        std::vector<Quadric> ComputeQuadrics(
+            std::vector<Index> const & indices,
+            Vertex const * vertices,
+            uint32_t const vertexCount
+        )
+        {
+            std::vector<Quadric> quadrics(vertexCount);
+            for (size_t i = 0; i < indices.size(); i += 3)
+            {
+                glm::dvec3 const p0 = vertices[indices[i]].position;
+                glm::dvec3 const p1 = vertices[indices[i + 1]].position;
+                glm::dvec3 const p2 = vertices[indices[i + 2]].position;
+                auto normal = glm::cross(p1 - p0, p2 - p0);
+                double const length = glm::length(normal);
+                if (length <= 0.0)
+                {
+                    continue;
+                }
+                normal /= length;
+                auto const quadric = Quadric::FromPlane(normal, -glm::dot(normal, p0), length * 0.5);
+                for (size_t j = 0; j < 3; ++j)
+                {
+                    quadrics[indices[i + j]].Add(quadric);
+                }
+            }
+            return quadrics;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        // Rejects collapses that rotate a remaining triangle by too much, which usually means that it folds over
+        bool DoesCollapseFlip(
+            Collapse const & collapse,
+            std::vector<Index> const & indices,
+            std::vector<uint32_t> const & adjacencyOffsets,
+            std::vector<uint32_t> const & adjacencyTriangles,
+            Vertex const * vertices
+        )
+        {
+            for (auto i = adjacencyOffsets[collapse.from]; i < adjacencyOffsets[collapse.from + 1]; ++i)
+            {
+                auto const triangle = adjacencyTriangles[i];
+                Index corners[3]{indices[triangle * 3], indices[triangle * 3 + 1], indices[triangle * 3 + 2]};
+                if (corners[0] == collapse.to || corners[1] == collapse.to || corners[2] == collapse.to)
+                {
+                    continue;               // Becomes degenerate and disappears
+                }
+
+                auto const normalBefore = glm::cross(
+                    vertices[corners[1]].position - vertices[corners[0]].position,
+                    vertices[corners[2]].position - vertices[corners[0]].position
+                );
+                for (auto & corner : corners)
+                {
+                    corner = corner == collapse.from ? collapse.to : corner;
+                }
+                auto const normalAfter = glm::cross(
+                    vertices[corners[1]].position - vertices[corners[0]].position,
+                    vertices[corners[2]].position - vertices[corners[0]].position
+                );
+
+                float const lengths = glm::length(normalBefore) * glm::length(normalAfter);
+                if (glm::dot(normalBefore, normalAfter) <= 0.25f * lengths)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        std::vector<Index> ToLocalIndices(Primitive const & primitive, Index const * indices)
+        {
+            auto const indexCount = primitive.indicesCount - primitive.indicesCount % 3;
+            std::vector<Index> localIndices(indexCount);
+            for (uint32_t i = 0; i < indexCount; ++i)
+            {
+                localIndices[i] = indices[primitive.indicesStartingIndex + i] - primitive.verticesStartingIndex;
+            }
+            return localIndices;
+        }
+
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    float Simplify(
+        std::vector<Index> & outIndices,
+        Index const * indices,
+        uint32_t const indexCount,
+        Vertex const * vertices,
+        uint32_t const vertexCount,
+        Params const & params
+    )
+    {
+        outIndices.assign(indices, indices + (indexCount - indexCount % 3));
+        if (outIndices.size() <= params.targetIndexCount || vertexCount == 0)
+        {
+            return 0.0f;
+        }
+
+        glm::vec3 minimum{std::numeric_limits<float>::max()};
+        glm::vec3 maximum{std::numeric_limits<float>::lowest()};
+        for (auto const index : outIndices)
+        {
+            MFA_ASSERT(index < vertexCount);
+            minimum = glm::min(minimum, vertices[index].position);
+            maximum = glm::max(maximum, vertices[index].position);
+        }
+        auto const extents = maximum - minimum;
+        double const errorLimit = static_cast<double>(params.maxError) * std::max({extents.x, extents.y, extents.z});
+        double const errorLimitSquared = errorLimit * errorLimit;
+
+        auto const isLocked = FindLockedVertices(outIndices, vertices, vertexCount);
+        auto quadrics = ComputeQuadrics(outIndices, vertices, vertexCount);
+
+        std::vector<uint32_t> adjacencyOffsets(vertexCount + 1);
+        std::vector<uint32_t> adjacencyTriangles{};
+        std::vector<Collapse> collapses{};
+        std::vector<bool> isTouched(vertexCount);
+        std::vector<Index> remap(vertexCount);
+        double maxAppliedError = 0.0;
+
+        // Every pass collapses a batch of independent edges, cheapest first, and then rebuilds the triangles
+        while (outIndices.size() > params.targetIndexCount)
+        {
+            // Step one: Triangles around each vertex
+            std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+            for (auto const index : outIndices)
+            {
+                ++adjacencyOffsets[index + 1];
+            }
+            std::partial_sum(adjacencyOffsets.begin(), adjacencyOffsets.end(), adjacencyOffsets.begin());
+            adjacencyTriangles.resize(outIndices.size());
+            {
+                std::vector<uint32_t> cursors(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+                for (uint32_t i = 0; i < static_cast<uint32_t>(outIndices.size()); ++i)
+                {
+                    adjacencyTriangles[cursors[outIndices[i]]++] = i / 3;
+                }
+            }
+
+            // Step two: Cost of moving each end of every edge onto the other end
+            collapses.clear();
+            for (size_t i = 0; i < outIndices.size(); i += 3)
+            {
+                for (size_t j = 0; j < 3; ++j)
+                {
+                    auto const a = outIndices[i + j];
+                    auto const b = outIndices[i + (j + 1) % 3];
+                    for (auto const & [from, to] : {std::pair{a, b}, std::pair{b, a}})
+                    {
+                        if (isLocked[from])
+                        {
+                            continue;
+                        }
+                        auto quadric = quadrics[from];
+                        quadric.Add(quadrics[to]);
+                        collapses.emplace_back(Collapse{
+                            .from = from,
+                            .to = to,
+                            .cost = quadric.Evaluate(vertices[to].position)
+                        });
+                    }
+                }
+            }
+            std::sort(collapses.begin(), collapses.end(), [](Collapse const & a, Collapse const & b)->bool
+            {
+                return a.cost < b.cost;
+            });
+
+            // Step three: Apply the cheapest collapses that do not touch each other
+            std::fill(isTouched.begin(), isTouched.end(), false);
+            std::iota(remap.begin(), remap.end(), 0);
+            auto const trianglesToRemove = (outIndices.size() - params.targetIndexCount) / 3;
+            size_t removedTriangles = 0;
+            uint32_t collapseCount = 0;
+            for (auto const & collapse : collapses)
+            {
+                if (collapse.cost > errorLimitSquared || removedTriangles >= trianglesToRemove)
+                {
+                    break;
+                }
+                if (isTouched[collapse.from] || isTouched[collapse.to])
+                {
+                    continue;
+                }
+                if (DoesCollapseFlip(collapse, outIndices, adjacencyOffsets, adjacencyTriangles, vertices))
+                {
+                    continue;
+                }
+
+                for (auto i = adjacencyOffsets[collapse.from]; i < adjacencyOffsets[collapse.from + 1]; ++i)
+                {
+                    auto const triangle = adjacencyTriangles[i];
+                    bool containsTarget = false;
+                    for (size_t j = 0; j < 3; ++j)
+                    {
+                        isTouched[outIndices[triangle * 3 + j]] = true;
+                        containsTarget |= outIndices[triangle * 3 + j] == collapse.to;
+                    }
+                    removedTriangles += containsTarget ? 1 : 0;
+                }
+
+                remap[collapse.from] = collapse.to;
+                quadrics[collapse.to].Add(quadrics[collapse.from]);
+                maxAppliedError = std::max(maxAppliedError, collapse.cost);
+                ++collapseCount;
+            }
+
+            if (collapseCount == 0)
+            {
+                break;
+            }
+
+            // Step four: Move the indices and drop the triangles that collapsed
+            size_t writeIndex = 0;
+            for (size_t i = 0; i < outIndices.size(); i += 3)
+            {
+                auto const a = remap[outIndices[i]];
+                auto const b = remap[outIndices[i + 1]];
+                auto const c = remap[outIndices[i + 2]];
+                if (a == b || b == c || a == c)
+                {
+                    continue;
+                }
+                outIndices[writeIndex++] = a;
+                outIndices[writeIndex++] = b;
+                outIndices[writeIndex++] = c;
+            }
+            outIndices.resize(writeIndex);
+        }
+
+        return static_cast<float>(std::sqrt(maxAppliedError));
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    void BuildLods(Mesh & mesh, LodParams const & params)
+    {
+        MFA_ASSERT(params.targetRatios.size() <= MaxLodCount);
+        auto const lodCount = static_cast<uint32_t>(std::min<size_t>(params.targetRatios.size(), MaxLodCount));
+
+        auto const * vertices = mesh.GetVertexData()->As<Vertex>();
+        auto const * indices = mesh.GetIndexData()->As<Index>();
+        auto & meshData = *mesh.GetMeshData();
+
+        std::vector<Primitive *> primitives{};
+        for (auto & subMesh : meshData.subMeshes)
+        {
+            for (auto & primitive : subMesh.primitives)
+            {
+                primitives.emplace_back(&primitive);
+            }
+        }
+
+        struct Level
+        {
+            std::vector<Index> indices{};
+            float error = 0.0f;
+        };
+        std::vector<std::vector<Level>> primitiveLevels(primitives.size());
+
+        // Each level starts from the previous one, which is faster and keeps the chain consistent
+        auto const buildLevels = [&](int const begin, int const end)->void
+        {
+            for (int i = begin; i < end; ++i)
+            {
+                auto const & primitive = *primitives[i];
+                auto previousIndices = ToLocalIndices(primitive, indices);
+                auto const triangleCount = static_cast<uint32_t>(previousIndices.size() / 3);
+                float previousError = 0.0f;
+
+                auto & levels = primitiveLevels[i];
+                levels.resize(lodCount);
+                for (uint32_t level = 0; level < lodCount; ++level)
+                {
+                    auto const targetTriangles = static_cast<uint32_t>(
+                        static_cast<float>(triangleCount) * params.targetRatios[level]
+                    );
+
+                    std::vector<Index> simplifiedIndices{};
+                    float const error = Simplify(
+                        simplifiedIndices,
+                        previousIndices.data(),
+                        static_cast<uint32_t>(previousIndices.size()),
+                        vertices + primitive.verticesStartingIndex,
+                        primitive.vertexCount,
+                        Params{
+                            .targetIndexCount = std::max(targetTriangles, 1u) * 3,
+                            .maxError = params.maxError
+                        }
+                    );
+
+                    levels[level].indices.resize(simplifiedIndices.size());
+                    MeshOptimizer::OptimizeVertexCache(
+                        levels[level].indices.data(),
+                        simplifiedIndices.data(),
+                        static_cast<uint32_t>(simplifiedIndices.size()),
+                        primitive.vertexCount
+                    );
+                    // Errors of the chain add up in the worst case
+                    previousError += error;
+                    levels[level].error = previousError;
+                    previousIndices = std::move(simplifiedIndices);
+                }
+            }
+        };
+        if (JS::Instance != nullptr)
+        {
+            JS::Instance->ParallelFor(static_cast<int>(primitives.size()), 1, buildLevels);
+        }
+        else
+        {
+            buildLevels(0, static_cast<int>(primitives.size()));
+        }
+
+        // Levels are appended after the indices of the primitives. Levels of an older build are dropped.
+        uint32_t baseIndexCount = 0;
+        for (auto const * primitive : primitives)
+        {
+            baseIndexCount = std::max(baseIndexCount, primitive->indicesStartingIndex + primitive->indicesCount);
+        }
+        uint32_t indexCount = baseIndexCount;
+        for (auto const & levels : primitiveLevels)
+        {
+            for (auto const & level : levels)
+            {
+                indexCount += static_cast<uint32_t>(level.indices.size());
+            }
+        }
+
+        std::shared_ptr<Blob> indexData = Memory::AllocSize(sizeof(Index) * indexCount);
+        auto * newIndices = indexData->As<Index>();
+        std::copy(indices, indices + baseIndexCount, newIndices);
+
+        meshData.lodErrors.assign(lodCount, 0.0f);
+        auto nextIndex = baseIndexCount;
+        for (size_t i = 0; i < primitives.size(); ++i)
+        {
+            auto & primitive = *primitives[i];
+            primitive.lodCount = lodCount;
+            for (uint32_t level = 0; level < lodCount; ++level)
+            {
+                auto const & levelData = primitiveLevels[i][level];
+                primitive.lods[level] = Primitive::Lod{
+                    .indicesStartingIndex = nextIndex,
+                    .indicesCount = static_cast<uint32_t>(levelData.indices.size()),
+                    .error = levelData.error
+                };
+                for (auto const index : levelData.indices)
+                {
+                    newIndices[nextIndex++] = index + primitive.verticesStartingIndex;
+                }
+                meshData.lodErrors[level] = std::max(meshData.lodErrors[level], levelData.error);
+            }
+        }
+        MFA_ASSERT(nextIndex == indexCount);
+
+        mesh.ReplaceIndexData(indexCount, std::move(indexData));
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+}
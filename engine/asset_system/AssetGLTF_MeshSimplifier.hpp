@@ -0,0 +1,40 @@
+#pragma once
+
+#include "AssetGLTF_Mesh.hpp"
+
+#include <cstdint>
+#include <vector>
+
+// Quadric error edge collapse, Garland and Heckbert 1997. Vertices only collapse onto their neighbours so a
+// simplified index list still references the original vertices and every level can share one vertex buffer.
+namespace MFA::Asset::GLTF::MeshSimplifier
+{
+
+    struct Params
+    {
+        uint32_t targetIndexCount = 0;
+        float maxError = 0.02f;                 // Relative to the size of the primitive
+    };
+
+    // Indices are relative to the first vertex. Vertices on open borders and on attribute seams are never moved.
+    // Returns the geometric error of the result in the units of the vertex positions.
+    float Simplify(
+        std::vector<Index> & outIndices,
+        Index const * indices,
+        uint32_t indexCount,
+        Vertex const * vertices,
+        uint32_t vertexCount,
+        Params const & params
+    );
+
+    struct LodParams
+    {
+        std::vector<float> targetRatios{0.5f, 0.25f, 0.1f};        // Triangle ratio of each level to the original
+        float maxError = 0.05f;
+    };
+
+    // Builds the levels of every primitive and appends their indices to the index buffer of the mesh.
+    // Levels that fail to reach their target keep the closest result so every primitive has the same level count.
+    void BuildLods(Mesh & mesh, LodParams const & params = {});
+
+}
@@ -49,7 +49,14 @@ namespace MFA::Asset
 	size_t Texture::MipSizeBytes(Format format, uint16_t slices, Dimensions const& mipLevelDimension)
 	{
 		auto const& d = mipLevelDimension;
-		size_t const p = FormatTable[static_cast<unsigned>(format)].bits_total / 8;
+		auto const& formatInfo = FormatTable[static_cast<unsigned>(format)];
+		if (formatInfo.compression != 0)
+		{
+			size_t const blockSize = formatInfo.bits_total * 16 / 8;
+			size_t const blockCount = static_cast<size_t>((d.width + 3) / 4) * ((d.height + 3) / 4);
+			return blockSize * blockCount * slices * d.depth;
+		}
+		size_t const p = formatInfo.bits_total / 8;
 		return p * slices * d.width * d.height * d.depth;
 	}
 
@@ -112,8 +119,17 @@ namespace MFA::Asset
 		size_t dataLength
 	)
 	{
-		MFA_ASSERT(mPreviousMipWidth == -1 || mPreviousMipWidth > static_cast<int>(dimension.width));
-		MFA_ASSERT(mPreviousMipHeight == -1 || mPreviousMipHeight > static_cast<int>(dimension.height));
+		auto * mipData = addMipmap(dimension, dataLength);
+		memcpy(mipData, dataPtr, dataLength);
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	uint8_t * Texture::addMipmap(Dimensions const & dimension, size_t const dataLength)
+	{
+		// A side that has reached 1 stays 1 while the other one keeps halving
+		MFA_ASSERT(mPreviousMipWidth == -1 || mPreviousMipWidth >= static_cast<int>(dimension.width));
+		MFA_ASSERT(mPreviousMipHeight == -1 || mPreviousMipHeight >= static_cast<int>(dimension.height));
 		mPreviousMipWidth = static_cast<int>(dimension.width);
 		mPreviousMipHeight = static_cast<int>(dimension.height);
 
@@ -128,10 +144,11 @@ namespace MFA::Asset
 		uint64_t const nextOffset = mCurrentOffset + dataLen;
 		MFA_ASSERT(mBuffer->Ptr() != nullptr);
 		MFA_ASSERT(nextOffset <= mBuffer->Len());
-		memcpy(mBuffer->Ptr() + mCurrentOffset, dataPtr, dataLength);
+		auto * mipData = mBuffer->Ptr() + mCurrentOffset;
 		mCurrentOffset = nextOffset;
 
 		++mMipCount;
+		return mipData;
 	}
 
 	//-------------------------------------------------------------------------------------------------
@@ -141,7 +158,8 @@ namespace MFA::Asset
 		size_t ret = 0;
 		if (mip_level < mMipCount && slice_index < mSlices)
 		{
-			ret = mMipmapInfos[mip_level].offset + slice_index * mMipmapInfos[mip_level].size;
+			// The size of a level covers all of its slices
+			ret = mMipmapInfos[mip_level].offset + slice_index * (mMipmapInfos[mip_level].size / mSlices);
 		}
 		return ret;
 	}
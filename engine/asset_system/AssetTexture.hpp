@@ -36,6 +36,11 @@ namespace MFA::Asset
             BC4_UNorm_Linear_R = 14,
             BC4_SNorm_Linear_R = 15,
 
+            BC1_UNorm_Linear_RGB = 16,
+            BC1_UNorm_sRGB_RGB = 17,
+            BC1_UNorm_Linear_RGBA = 18,                     // One bit alpha
+            BC1_UNorm_sRGB_RGBA = 19,
+
             Count
         };
         
@@ -49,7 +54,7 @@ namespace MFA::Asset
         struct MipmapInfo
         {
             uint64_t offset{};
-            uint32_t size{};
+            uint32_t size{};                                // All slices of the level
             Dimensions dimension{};
         };
 
@@ -57,12 +62,12 @@ namespace MFA::Asset
         struct InternalFormatTableType
         {
             Format texture_format;
-            uint8_t compression;                            // 0: uncompressed, 1: basis?, ...
+            uint8_t compression;                            // 0: uncompressed, otherwise the BCn number
             uint8_t component_count;                        // 1..4
             uint8_t component_format;                       // 0: UNorm, 1: SNorm, 2: UInt, 3: SInt, 4: UFloat, 5: SFloat
             uint8_t color_space;                            // 0: Linear, 1: sRGB
             uint8_t bits_r, bits_g, bits_b, bits_a;         // each 0..32
-            uint8_t bits_total;                             // 1..128
+            uint8_t bits_total;                             // 1..128, per pixel for block formats
         };
     public:
         static constexpr InternalFormatTableType FormatTable[] = {
@@ -83,10 +88,15 @@ namespace MFA::Asset
             {Format::BC6H_SFloat_Linear_RGB                  , 6, 3, 5, 0, 16, 16, 16, 0, 8},
 
             {Format::BC5_UNorm_Linear_RG                     , 5, 2, 0, 0, 8, 8, 0, 0, 8},
-            {Format::BC5_SNorm_Linear_RG                     , 5, 2, 0, 1, 8, 8, 0, 0, 8},
+            {Format::BC5_SNorm_Linear_RG                     , 5, 2, 1, 0, 8, 8, 0, 0, 8},
+
+            {Format::BC4_UNorm_Linear_R                      , 4, 1, 0, 0, 8, 0, 0, 0, 4},
+            {Format::BC4_SNorm_Linear_R                      , 4, 1, 1, 0, 8, 0, 0, 0, 4},
 
-            {Format::BC4_UNorm_Linear_R                      , 5, 2, 0, 0, 8, 8, 0, 0, 16},
-            {Format::BC4_SNorm_Linear_R                      , 5, 2, 0, 1, 8, 8, 0, 0, 16},
+            {Format::BC1_UNorm_Linear_RGB                    , 1, 3, 0, 0, 5, 6, 5, 0, 4},
+            {Format::BC1_UNorm_sRGB_RGB                      , 1, 3, 0, 1, 5, 6, 5, 0, 4},
+            {Format::BC1_UNorm_Linear_RGBA                   , 1, 4, 0, 0, 5, 6, 5, 1, 4},
+            {Format::BC1_UNorm_sRGB_RGBA                     , 1, 4, 0, 1, 5, 6, 5, 1, 4},
 
         };
         
@@ -107,9 +117,7 @@ namespace MFA::Asset
 
         static uint8_t ComputeMipCount(Dimensions const& dimensions);
 
-        /*
-         * This function result is only correct for uncompressed data
-         */
+        // Block formats are stored as 4x4 blocks, partial blocks at the edges are padded
         [[nodiscard]]
         static size_t MipSizeBytes(
             Format format,
@@ -130,7 +138,6 @@ namespace MFA::Asset
         );
 
         /*
-        * This function result is only correct for uncompressed data
         * Returns space required for both mipmaps and TextureHeader
         */
         [[nodiscard]]
@@ -152,6 +159,13 @@ namespace MFA::Asset
             size_t length
         );
 
+        // Adds a level without copying anything, the returned memory inside the texture buffer has to be filled
+        [[nodiscard]]
+        uint8_t * addMipmap(
+            Dimensions const& dimension,
+            size_t length
+        );
+
         [[nodiscard]]
         size_t mipOffsetInBytes(uint8_t mip_level, uint8_t slice_index = 0) const;
 
@@ -0,0 +1,226 @@
+#include "BedrockBounds.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include <glm/geometric.hpp>
+#include <glm/common.hpp>
+
+namespace MFA
+{
+
+    //-------------------------------------------------------------------------------------------------
+
+    AABB AABB::FromCenterAndExtents(glm::vec3 const & center, glm::vec3 const & extents)
+    {
+        return AABB{ .min = center - extents, .max = center + extents };
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    bool AABB::IsValid() const
+    {
+        return min.x <= max.x && min.y <= max.y && min.z <= max.z;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    glm::vec3 AABB::Center() const
+    {
+        return (min + max) * 0.5f;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    glm::vec3 AABB::Extents() const
+    {
+        return (max - min) * 0.5f;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    float AABB::SurfaceArea() const
+    {
+        auto const size = max - min;
+        return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    void AABB::Expand(glm::vec3 const & point)
+    {
+        min = glm::min(min, point);
+        max = glm::max(max, point);
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    void AABB::Expand(AABB const & other)
+    {
+        min = glm::min(min, other.min);
+        max = glm::max(max, other.max);
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    AABB AABB::Fatten(float const margin) const
+    {
+        return AABB{ .min = min - glm::vec3{margin}, .max = max + glm::vec3{margin} };
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    bool AABB::Contains(AABB const & other) const
+    {
+        return min.x <= other.min.x && min.y <= other.min.y && min.z <= other.min.z &&
+            max.x >= other.max.x && max.y >= other.max.y && max.z >= other.max.z;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    bool AABB::Intersects(AABB const & other) const
+    {
+        return min.x <= other.max.x && max.x >= other.min.x &&
+            min.y <= other.max.y && max.y >= other.min.y &&
+            min.z <= other.max.z && max.z >= other.min.z;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    // Arvo's method: Each axis of the new box is built from the projection of the old extents
+    AABB AABB::Transform(glm::mat4 const & transform) const
+    {
+        glm::vec3 const center = transform * glm::vec4{ Center(), 1.0f };
+        glm::vec3 const extents = Extents();
+        glm::vec3 newExtents{};
+        for (int i = 0; i < 3; ++i)
+        {
+            newExtents[i] =
+                std::abs(transform[0][i]) * extents.x +
+                std::abs(transform[1][i]) * extents.y +
+                std::abs(transform[2][i]) * extents.z;
+        }
+        return FromCenterAndExtents(center, newExtents);
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    AABB AABB::Merge(AABB const & a, AABB const & b)
+    {
+        return AABB{ .min = glm::min(a.min, b.min), .max = glm::max(a.max, b.max) };
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    bool Sphere::Intersects(AABB const & aabb) const
+    {
+        auto const closestPoint = glm::clamp(center, aabb.min, aabb.max);
+        auto const delta = closestPoint - center;
+        return glm::dot(delta, delta) <= radius * radius;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    bool Ray::Intersects(AABB const & aabb, float const maxDistance, float & outDistance) const
+    {
+        float tMin = 0.0f;
+        float tMax = maxDistance;
+        for (int i = 0; i < 3; ++i)
+        {
+            if (std::abs(direction[i]) < 1e-8f)
+            {
+                if (origin[i] < aabb.min[i] || origin[i] > aabb.max[i])
+                {
+                    return false;
+                }
+                continue;
+            }
+            float const invDirection = 1.0f / direction[i];
+            float t0 = (aabb.min[i] - origin[i]) * invDirection;
+            float t1 = (aabb.max[i] - origin[i]) * invDirection;
+            if (t0 > t1)
+            {
+                std::swap(t0, t1);
+            }
+            tMin = std::max(tMin, t0);
+            tMax = std::min(tMax, t1);
+            if (tMin > tMax)
+            {
+                return false;
+            }
+        }
+        outDistance = tMin;
+        return true;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    // Gribb-Hartmann plane extraction. glm matrices are column major so row i is m[0][i], m[1][i], ...
+    Frustum Frustum::FromViewProjection(glm::mat4 const & viewProjection)
+    {
+        auto const row = [&viewProjection](int const i)->glm::vec4
+        {
+            return glm::vec4{ viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i] };
+        };
+
+        auto const row0 = row(0);
+        auto const row1 = row(1);
+        auto const row2 = row(2);
+        auto const row3 = row(3);
+
+        Frustum frustum{};
+        frustum.planes[Left] = row3 + row0;
+        frustum.planes[Right] = row3 - row0;
+        frustum.planes[Bottom] = row3 + row1;
+        frustum.planes[Top] = row3 - row1;
+        frustum.planes[Near] = row2;                // Depth range is zero to one
+        frustum.planes[Far] = row3 - row2;
+
+        for (auto & plane : frustum.planes)
+        {
+            float const length = glm::length(glm::vec3{ plane });
+            if (length > 0.0f)
+            {
+                plane /= length;
+            }
+        }
+        return frustum;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    bool Frustum::Intersects(AABB const & aabb) const
+    {
+        for (auto const & plane : planes)
+        {
+            // Corner that is furthest along the plane normal
+            glm::vec3 const positiveVertex{
+                plane.x >= 0.0f ? aabb.max.x : aabb.min.x,
+                plane.y >= 0.0f ? aabb.max.y : aabb.min.y,
+                plane.z >= 0.0f ? aabb.max.z : aabb.min.z,
+            };
+            if (glm::dot(glm::vec3{ plane }, positiveVertex) + plane.w < 0.0f)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    bool Frustum::Intersects(Sphere const & sphere) const
+    {
+        for (auto const & plane : planes)
+        {
+            if (glm::dot(glm::vec3{ plane }, sphere.center) + plane.w < -sphere.radius)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+}
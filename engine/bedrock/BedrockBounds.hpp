@@ -0,0 +1,101 @@
+#pragma once
+
+#include <limits>
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+
+namespace MFA
+{
+
+    struct AABB
+    {
+        glm::vec3 min{ std::numeric_limits<float>::max() };
+        glm::vec3 max{ -std::numeric_limits<float>::max() };
+
+        [[nodiscard]]
+        static AABB FromCenterAndExtents(glm::vec3 const & center, glm::vec3 const & extents);
+
+        [[nodiscard]]
+        bool IsValid() const;
+
+        [[nodiscard]]
+        glm::vec3 Center() const;
+
+        // Half size of the box
+        [[nodiscard]]
+        glm::vec3 Extents() const;
+
+        [[nodiscard]]
+        float SurfaceArea() const;
+
+        void Expand(glm::vec3 const & point);
+
+        void Expand(AABB const & other);
+
+        // Grows the box by margin in each direction
+        [[nodiscard]]
+        AABB Fatten(float margin) const;
+
+        [[nodiscard]]
+        bool Contains(AABB const & other) const;
+
+        [[nodiscard]]
+        bool Intersects(AABB const & other) const;
+
+        // Returns the box that encloses this box after applying the transform
+        [[nodiscard]]
+        AABB Transform(glm::mat4 const & transform) const;
+
+        [[nodiscard]]
+        static AABB Merge(AABB const & a, AABB const & b);
+    };
+
+    struct Sphere
+    {
+        glm::vec3 center{};
+        float radius = 0.0f;
+
+        [[nodiscard]]
+        bool Intersects(AABB const & aabb) const;
+    };
+
+    struct Ray
+    {
+        glm::vec3 origin{};
+        glm::vec3 direction{};          // Does not need to be normalized
+
+        // Slab test. outDistance is in units of direction length
+        [[nodiscard]]
+        bool Intersects(AABB const & aabb, float maxDistance, float & outDistance) const;
+    };
+
+    struct Frustum
+    {
+        enum Plane
+        {
+            Left = 0,
+            Right = 1,
+            Bottom = 2,
+            Top = 3,
+            Near = 4,
+            Far = 5,
+            Count = 6
+        };
+
+        // Plane normals are pointing inside the frustum
+        glm::vec4 planes[Count]{};
+
+        // Extracts planes from a zero to one depth view-projection matrix
+        [[nodiscard]]
+        static Frustum FromViewProjection(glm::mat4 const & viewProjection);
+
+        [[nodiscard]]
+        bool Intersects(AABB const & aabb) const;
+
+        [[nodiscard]]
+        bool Intersects(Sphere const & sphere) const;
+    };
+
+}
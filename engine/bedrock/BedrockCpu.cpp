@@ -0,0 +1,51 @@
+#include "BedrockCpu.hpp"
+
+#if defined(MFA_CPU_X86) && defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace MFA::Cpu
+{
+
+    //-------------------------------------------------------------------------------------------------
+
+    static Features DetectFeatures()
+    {
+        Features features{};
+#if defined(MFA_CPU_X86) && (defined(__GNUC__) || defined(__clang__))
+        __builtin_cpu_init();
+        features.sse2 = __builtin_cpu_supports("sse2") != 0;
+        features.ssse3 = __builtin_cpu_supports("ssse3") != 0;
+        features.sse41 = __builtin_cpu_supports("sse4.1") != 0;
+        features.avx2 = __builtin_cpu_supports("avx2") != 0;
+#elif defined(MFA_CPU_X86) && defined(_MSC_VER)
+        int registers[4]{};
+        __cpuid(registers, 0);
+        auto const maxLeaf = registers[0];
+
+        __cpuid(registers, 1);
+        features.sse2 = (registers[3] & (1 << 26)) != 0;
+        features.ssse3 = (registers[2] & (1 << 9)) != 0;
+        features.sse41 = (registers[2] & (1 << 19)) != 0;
+        bool const osSavesYmm = (registers[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+
+        if (maxLeaf >= 7 && osSavesYmm)
+        {
+            __cpuidex(registers, 7, 0);
+            features.avx2 = (registers[1] & (1 << 5)) != 0;
+        }
+#endif
+        return features;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    Features const & GetFeatures()
+    {
+        static Features const features = DetectFeatures();
+        return features;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+}
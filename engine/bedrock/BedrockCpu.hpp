@@ -0,0 +1,33 @@
+#pragma once
+
+// Instruction sets that are picked at runtime. SSE2 is part of x86-64 so it is used through compile time checks,
+// wider kernels are compiled with MFA_TARGET_AVX2 and only called when the cpu reports support.
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define MFA_CPU_X86
+#endif
+
+#if defined(MFA_CPU_X86) && (defined(__GNUC__) || defined(__clang__))
+#define MFA_TARGET_SSSE3 __attribute__((target("ssse3")))
+#define MFA_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+// Msvc accepts every intrinsic without a target flag
+#define MFA_TARGET_SSSE3
+#define MFA_TARGET_AVX2
+#endif
+
+namespace MFA::Cpu
+{
+
+    struct Features
+    {
+        bool sse2 = false;
+        bool ssse3 = false;
+        bool sse41 = false;
+        bool avx2 = false;              // Also means the os saves the ymm registers
+    };
+
+    // Detected once, safe to call from any thread
+    [[nodiscard]]
+    Features const & GetFeatures();
+
+}
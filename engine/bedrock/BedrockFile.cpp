@@ -7,6 +7,18 @@
 #include "BedrockAssert.hpp"
 #include "BedrockLog.hpp"
 
+#ifdef __PLATFORM_WIN__
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 
 namespace MFA::File
 {
@@ -39,4 +51,129 @@ namespace MFA::File
         }
         return nullptr;
     }
-}
\ No newline at end of file
+
+    //-------------------------------------------------------------------------------------------------
+
+    std::shared_ptr<MappedFile> MappedFile::Open(std::string const & path)
+    {
+        std::shared_ptr<MappedFile> file(new MappedFile());
+#ifdef __PLATFORM_WIN__
+        file->_fileHandle = CreateFileA(
+            path.c_str(),
+            GENERIC_READ,
+            FILE_SHARE_READ,
+            nullptr,
+            OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+            nullptr
+        );
+        if (file->_fileHandle == INVALID_HANDLE_VALUE)
+        {
+            file->_fileHandle = nullptr;
+            return nullptr;
+        }
+        LARGE_INTEGER size{};
+        if (GetFileSizeEx(file->_fileHandle, &size) == FALSE || size.QuadPart <= 0)
+        {
+            return nullptr;
+        }
+        file->_len = static_cast<size_t>(size.QuadPart);
+        file->_mappingHandle = CreateFileMappingA(file->_fileHandle, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+        if (file->_mappingHandle == nullptr)
+        {
+            return nullptr;
+        }
+        file->_ptr = static_cast<uint8_t *>(MapViewOfFile(file->_mappingHandle, FILE_MAP_COPY, 0, 0, 0));
+#else
+        file->_fileDescriptor = open(path.c_str(), O_RDONLY);
+        if (file->_fileDescriptor < 0)
+        {
+            return nullptr;
+        }
+        struct stat fileStat {};
+        if (fstat(file->_fileDescriptor, &fileStat) != 0 || fileStat.st_size <= 0)
+        {
+            return nullptr;
+        }
+        file->_len = static_cast<size_t>(fileStat.st_size);
+        void * ptr = mmap(nullptr, file->_len, PROT_READ | PROT_WRITE, MAP_PRIVATE, file->_fileDescriptor, 0);
+        if (ptr == MAP_FAILED)
+        {
+            return nullptr;
+        }
+        file->_ptr = static_cast<uint8_t *>(ptr);
+#endif
+        if (file->_ptr == nullptr)
+        {
+            MFA_LOG_WARN("Failed to map file %s", path.c_str());
+            return nullptr;
+        }
+        return file;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    MappedFile::~MappedFile()
+    {
+#ifdef __PLATFORM_WIN__
+        if (_ptr != nullptr)
+        {
+            UnmapViewOfFile(_ptr);
+        }
+        if (_mappingHandle != nullptr)
+        {
+            CloseHandle(_mappingHandle);
+        }
+        if (_fileHandle != nullptr)
+        {
+            CloseHandle(_fileHandle);
+        }
+#else
+        if (_ptr != nullptr)
+        {
+            munmap(_ptr, _len);
+        }
+        if (_fileDescriptor >= 0)
+        {
+            close(_fileDescriptor);
+        }
+#endif
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    uint8_t * MappedFile::Ptr() const noexcept
+    {
+        return _ptr;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    size_t MappedFile::Len() const noexcept
+    {
+        return _len;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    MappedBlob::MappedBlob(std::shared_ptr<MappedFile> file, size_t const offset, size_t const len)
+        : _file(std::move(file))
+    {
+        MFA_ASSERT(_file != nullptr);
+        MFA_ASSERT(offset + len <= _file->Len());
+        _ptr = _file->Ptr() + offset;
+        _len = len;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    MappedBlob::~MappedBlob()
+    {
+        // Memory belongs to the mapping
+        _ptr = nullptr;
+        _len = 0;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+}
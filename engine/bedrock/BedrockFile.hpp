@@ -3,8 +3,68 @@
 #include <string>
 
 #include "BedrockMemory.hpp"
+#include "BedrockPlatforms.hpp"
 
 namespace MFA::File
 {
     std::shared_ptr<Blob> Read(std::string const & path);
-}
\ No newline at end of file
+
+    // Maps a whole file into memory. Pages are loaded by the os on first access and writes only go to private
+    // copies of the pages, so the file on disk never changes.
+    class MappedFile
+    {
+    public:
+
+        // Returns nullptr when the file does not exist or can not be mapped
+        [[nodiscard]]
+        static std::shared_ptr<MappedFile> Open(std::string const & path);
+
+        ~MappedFile();
+
+        MappedFile(MappedFile const &) noexcept = delete;
+        MappedFile(MappedFile &&) noexcept = delete;
+        MappedFile & operator= (MappedFile const &) noexcept = delete;
+        MappedFile & operator= (MappedFile &&) noexcept = delete;
+
+        [[nodiscard]]
+        uint8_t * Ptr() const noexcept;
+
+        [[nodiscard]]
+        size_t Len() const noexcept;
+
+    private:
+
+        explicit MappedFile() = default;
+
+        uint8_t * _ptr = nullptr;
+        size_t _len = 0;
+#ifdef __PLATFORM_WIN__
+        void * _fileHandle = nullptr;
+        void * _mappingHandle = nullptr;
+#else
+        int _fileDescriptor = -1;
+#endif
+
+    };
+
+    // Blob that points inside a mapped file and keeps the mapping alive. Must be owned by a shared_ptr that is
+    // created with std::make_shared, so the right destructor runs.
+    class MappedBlob : public Blob
+    {
+    public:
+
+        explicit MappedBlob(std::shared_ptr<MappedFile> file, size_t offset, size_t len);
+
+        ~MappedBlob();
+
+        MappedBlob(MappedBlob const &) noexcept = delete;
+        MappedBlob(MappedBlob &&) noexcept = delete;
+        MappedBlob & operator= (MappedBlob const &) noexcept = delete;
+        MappedBlob & operator= (MappedBlob &&) noexcept = delete;
+
+    private:
+
+        std::shared_ptr<MappedFile> _file{};
+
+    };
+}
@@ -122,6 +122,11 @@ namespace MFA
             return Alias(_ptr, _len);
         }
 
+    protected:
+
+        // For blobs that do not own their memory. They have to clear _ptr before this destructor runs.
+        explicit Blob() = default;
+
     };
 
     namespace Memory
@@ -0,0 +1,63 @@
+#include "BedrockStringId.hpp"
+
+#include "BedrockAssert.hpp"
+
+#include <mutex>
+#include <unordered_map>
+
+namespace MFA
+{
+
+    //-------------------------------------------------------------------------------------------------
+
+    struct StringTable
+    {
+        std::mutex lock{};
+        std::unordered_map<StringId::Hash, std::string> strings{};
+    };
+
+    static StringTable & GetStringTable()
+    {
+        static StringTable table{};
+        return table;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    StringId StringId::Intern(std::string_view const text)
+    {
+        auto const stringId = FromString(text);
+
+        auto & table = GetStringTable();
+        std::lock_guard lock{table.lock};
+        auto const [iterator, isInserted] = table.strings.try_emplace(stringId._hash, text);
+        if (isInserted == false && iterator->second != text)
+        {
+            MFA_LOG_ERROR(
+                "StringId collision between %s and %s",
+                iterator->second.c_str(),
+                std::string(text).c_str()
+            );
+            MFA_ASSERT(false);
+        }
+
+        return stringId;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    char const * StringId::GetDebugName() const
+    {
+        auto & table = GetStringTable();
+        std::lock_guard lock{table.lock};
+        auto const findResult = table.strings.find(_hash);
+        if (findResult != table.strings.end())
+        {
+            return findResult->second.c_str();
+        }
+        return "<not interned>";
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace MFA
+{
+
+    // 64 bit FNV-1a hash of a string. Literals are hashed at compile time and comparing two ids never touches
+    // the characters. Strings that go through Intern are stored in a global table so ids can be printed for debugging.
+    class StringId
+    {
+    public:
+
+        using Hash = uint64_t;
+
+        [[nodiscard]]
+        static constexpr Hash HashString(std::string_view const text)
+        {
+            Hash hash = 14695981039346656037ull;
+            for (char const character : text)
+            {
+                hash ^= static_cast<uint8_t>(character);
+                hash *= 1099511628211ull;
+            }
+            return hash;
+        }
+
+        constexpr StringId() = default;
+
+        // Only accepts literals and other constant arrays, so the hash is always computed by the compiler
+        template<size_t Length>
+        consteval StringId(char const (&literal)[Length])
+            : _hash(HashString(std::string_view{literal, Length - 1}))
+        {}
+
+        // Hashes at runtime without registering the string
+        [[nodiscard]]
+        static constexpr StringId FromString(std::string_view const text)
+        {
+            StringId stringId{};
+            stringId._hash = HashString(text);
+            return stringId;
+        }
+
+        // Hashes and stores the string in the debug table. Use it where names are created, for example at import time.
+        [[nodiscard]]
+        static StringId Intern(std::string_view text);
+
+        [[nodiscard]]
+        constexpr Hash GetHash() const noexcept
+        {
+            return _hash;
+        }
+
+        [[nodiscard]]
+        constexpr bool IsValid() const noexcept
+        {
+            return _hash != 0;
+        }
+
+        // Returns the interned string or a placeholder if the string was never interned
+        [[nodiscard]]
+        char const * GetDebugName() const;
+
+        constexpr bool operator == (StringId const & other) const noexcept = default;
+
+        constexpr bool operator < (StringId const & other) const noexcept
+        {
+            return _hash < other._hash;
+        }
+
+    private:
+
+        Hash _hash = 0;
+
+    };
+
+    namespace StringIdLiterals
+    {
+
+        consteval StringId operator""_sid(char const * text, size_t const length)
+        {
+            return StringId::FromString(std::string_view{text, length});
+        }
+
+    }
+
+}
+
+template<>
+struct std::hash<MFA::StringId>
+{
+    size_t operator()(MFA::StringId const & stringId) const noexcept
+    {
+        return static_cast<size_t>(stringId.GetHash());
+    }
+};
@@ -0,0 +1,209 @@
+#include "Archetype.hpp"
+
+#include "BedrockAssert.hpp"
+
+#include <algorithm>
+
+namespace MFA
+{
+
+    //-------------------------------------------------------------------------------------------------
+
+    static size_t AlignUp(size_t const value, size_t const alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    Archetype::Archetype(ComponentMask const & mask)
+        : _mask(mask)
+    {
+        _columns.fill(-1);
+
+        size_t bytesPerEntity = sizeof(Entity);
+        for (ComponentId componentId = 0; componentId < MaxComponents; ++componentId)
+        {
+            if (_mask.test(componentId) == false)
+            {
+                continue;
+            }
+            auto const & info = ComponentRegistry::Get(componentId);
+            _columns[componentId] = static_cast<int>(_componentIds.size());
+            _componentIds.emplace_back(componentId);
+            _componentInfos.emplace_back(info);
+            bytesPerEntity += info.size;
+            _chunkAlignment = std::max(_chunkAlignment, info.alignment);
+        }
+
+        // Padding between the arrays can push the layout over the chunk size so we shrink the capacity until it fits
+        auto const computeLayout = [this](int const capacity)->size_t
+        {
+            _columnOffsets.clear();
+            size_t offset = sizeof(Entity) * capacity;
+            for (auto const & info : _componentInfos)
+            {
+                offset = AlignUp(offset, info.alignment);
+                _columnOffsets.emplace_back(offset);
+                offset += info.size * capacity;
+            }
+            return offset;
+        };
+
+        _chunkCapacity = std::max(static_cast<int>(ChunkSize / bytesPerEntity), 1);
+        _chunkBytes = computeLayout(_chunkCapacity);
+        while (_chunkCapacity > 1 && _chunkBytes > ChunkSize)
+        {
+            --_chunkCapacity;
+            _chunkBytes = computeLayout(_chunkCapacity);
+        }
+        _chunkBytes = AlignUp(_chunkBytes, _chunkAlignment);
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    Archetype::~Archetype()
+    {
+        for (auto & chunk : _chunks)
+        {
+            for (int column = 0; column < static_cast<int>(_componentInfos.size()); ++column)
+            {
+                auto const & info = _componentInfos[column];
+                for (int row = 0; row < chunk.count; ++row)
+                {
+                    info.destruct(chunk.memory + _columnOffsets[column] + info.size * row);
+                }
+            }
+            ::operator delete(chunk.memory, std::align_val_t{_chunkAlignment});
+        }
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    ComponentMask const & Archetype::GetMask() const noexcept
+    {
+        return _mask;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    int Archetype::GetColumn(ComponentId const componentId) const
+    {
+        MFA_ASSERT(componentId < MaxComponents);
+        return _columns[componentId];
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    std::vector<ComponentId> const & Archetype::GetComponentIds() const noexcept
+    {
+        return _componentIds;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    int Archetype::GetChunkCount() const noexcept
+    {
+        return static_cast<int>(_chunks.size());
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    int Archetype::GetChunkCapacity() const noexcept
+    {
+        return _chunkCapacity;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    int Archetype::GetEntityCount() const noexcept
+    {
+        return _entityCount;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    Archetype::Chunk & Archetype::GetChunk(int const chunkIdx)
+    {
+        MFA_ASSERT(chunkIdx >= 0 && chunkIdx < static_cast<int>(_chunks.size()));
+        return _chunks[chunkIdx];
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    Entity * Archetype::GetEntities(Chunk const & chunk) const
+    {
+        return reinterpret_cast<Entity *>(chunk.memory);
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    void * Archetype::GetComponent(Location const & location, int const column) const
+    {
+        MFA_ASSERT(column >= 0 && column < static_cast<int>(_componentInfos.size()));
+        auto const & chunk = _chunks[location.chunk];
+        return chunk.memory + _columnOffsets[column] + _componentInfos[column].size * location.row;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    Archetype::Location Archetype::Allocate(Entity const entity)
+    {
+        // Only the last chunk can have empty rows
+        if (_chunks.empty() || _chunks.back().count == _chunkCapacity)
+        {
+            auto * memory = static_cast<std::byte *>(::operator new(_chunkBytes, std::align_val_t{_chunkAlignment}));
+            _chunks.emplace_back(Chunk{.memory = memory, .count = 0});
+        }
+
+        auto & chunk = _chunks.back();
+        Location const location{.chunk = static_cast<int>(_chunks.size()) - 1, .row = chunk.count};
+        new (GetEntities(chunk) + location.row) Entity(entity);
+        ++chunk.count;
+        ++_entityCount;
+        return location;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    Entity Archetype::Remove(Location const & location)
+    {
+        MFA_ASSERT(location.chunk >= 0 && location.chunk < static_cast<int>(_chunks.size()));
+        auto & chunk = _chunks[location.chunk];
+        MFA_ASSERT(location.row >= 0 && location.row < chunk.count);
+
+        for (int column = 0; column < static_cast<int>(_componentInfos.size()); ++column)
+        {
+            _componentInfos[column].destruct(GetComponent(location, column));
+        }
+
+        auto & lastChunk = _chunks.back();
+        Location const lastLocation{.chunk = static_cast<int>(_chunks.size()) - 1, .row = lastChunk.count - 1};
+
+        Entity movedEntity{};
+        if (lastLocation.chunk != location.chunk || lastLocation.row != location.row)
+        {
+            for (int column = 0; column < static_cast<int>(_componentInfos.size()); ++column)
+            {
+                auto * last = GetComponent(lastLocation, column);
+                _componentInfos[column].moveConstruct(GetComponent(location, column), last);
+                _componentInfos[column].destruct(last);
+            }
+            movedEntity = GetEntities(lastChunk)[lastLocation.row];
+            GetEntities(chunk)[location.row] = movedEntity;
+        }
+
+        --lastChunk.count;
+        --_entityCount;
+        if (lastChunk.count == 0)
+        {
+            ::operator delete(lastChunk.memory, std::align_val_t{_chunkAlignment});
+            _chunks.pop_back();
+        }
+
+        return movedEntity;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "Entity.hpp"
+
+#include <array>
+#include <memory>
+#include <vector>
+
+namespace MFA
+{
+
+    // Storage for every entity that has exactly the same set of components.
+    // Entities are packed into fixed size chunks and each component type has its own array inside the chunk,
+    // so a query touches only the memory of the components that it asks for.
+    class Archetype
+    {
+    public:
+
+        inline static constexpr size_t ChunkSize = 16 * 1024;
+
+        struct Chunk
+        {
+            std::byte * memory = nullptr;
+            int count = 0;
+        };
+
+        struct Location
+        {
+            int chunk = -1;
+            int row = -1;
+        };
+
+        explicit Archetype(ComponentMask const & mask);
+
+        ~Archetype();
+
+        Archetype(Archetype const &) noexcept = delete;
+        Archetype(Archetype &&) noexcept = delete;
+        Archetype & operator = (Archetype const &) noexcept = delete;
+        Archetype & operator = (Archetype &&) noexcept = delete;
+
+        [[nodiscard]]
+        ComponentMask const & GetMask() const noexcept;
+
+        // Returns -1 if the archetype does not have the component
+        [[nodiscard]]
+        int GetColumn(ComponentId componentId) const;
+
+        [[nodiscard]]
+        std::vector<ComponentId> const & GetComponentIds() const noexcept;
+
+        [[nodiscard]]
+        int GetChunkCount() const noexcept;
+
+        [[nodiscard]]
+        int GetChunkCapacity() const noexcept;
+
+        [[nodiscard]]
+        int GetEntityCount() const noexcept;
+
+        [[nodiscard]]
+        Chunk & GetChunk(int chunkIdx);
+
+        [[nodiscard]]
+        Entity * GetEntities(Chunk const & chunk) const;
+
+        [[nodiscard]]
+        void * GetComponent(Location const & location, int column) const;
+
+        template<typename T>
+        [[nodiscard]]
+        T * GetColumnData(Chunk const & chunk, int const column) const
+        {
+            return reinterpret_cast<T *>(chunk.memory + _columnOffsets[column]);
+        }
+
+        // Reserves a row at the end of the archetype. Components of the new row are not constructed.
+        [[nodiscard]]
+        Location Allocate(Entity entity);
+
+        // Destructs the components of the row and moves the last entity into it to keep the chunks dense.
+        // Returns the entity that now lives at the location or an invalid entity if the row was the last one.
+        Entity Remove(Location const & location);
+
+        // Cached archetype transitions for adding and removing a single component
+        std::array<Archetype *, MaxComponents> addEdges{};
+        std::array<Archetype *, MaxComponents> removeEdges{};
+
+    private:
+
+        ComponentMask const _mask;
+        std::vector<ComponentId> _componentIds{};
+        std::vector<ComponentInfo> _componentInfos{};
+        std::vector<size_t> _columnOffsets{};
+        std::array<int, MaxComponents> _columns{};
+
+        size_t _chunkBytes = 0;
+        size_t _chunkAlignment = alignof(Entity);
+        int _chunkCapacity = 0;
+
+        std::vector<Chunk> _chunks{};
+        int _entityCount = 0;
+
+    };
+
+}
@@ -0,0 +1,753 @@
+#include "BVH.hpp"
+
+#include "BedrockAssert.hpp"
+#include "JobSystem.hpp"
+
+#include <algorithm>
+
+namespace MFA
+{
+
+    //-------------------------------------------------------------------------------------------------
+
+    BVH::BVH()
+        : BVH(Params{})
+    {}
+
+    //-------------------------------------------------------------------------------------------------
+
+    BVH::BVH(Params const & params)
+        : _params(params)
+    {}
+
+    //-------------------------------------------------------------------------------------------------
+
+    BVH::~BVH()
+    {
+        // The rebuild task only owns its own snapshot, but we should not leave it running after the tree is gone
+        if (_rebuildFuture.valid())
+        {
+            _rebuildFuture.wait();
+        }
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    BVH::ProxyId BVH::Insert(AABB const & bounds, void * userData)
+    {
+        MFA_ASSERT(bounds.IsValid());
+
+        ProxyId proxyId;
+        if (_freeProxies.empty() == false)
+        {
+            proxyId = _freeProxies.back();
+            _freeProxies.pop_back();
+        }
+        else
+        {
+            proxyId = static_cast<ProxyId>(_proxies.size());
+            _proxies.emplace_back();
+        }
+
+        auto const leaf = AllocateNode();
+        _nodes[leaf].bounds = bounds.Fatten(_params.fatMargin);
+        _nodes[leaf].proxyId = proxyId;
+        _nodes[leaf].height = 0;
+
+        auto & proxy = _proxies[proxyId];
+        proxy.fatBounds = _nodes[leaf].bounds;
+        proxy.userData = userData;
+        proxy.node = leaf;
+        proxy.isAlive = true;
+        proxy.isTouched = false;
+
+        InsertLeaf(leaf);
+        ++_proxyCount;
+        ++_changeCount;
+
+        MarkTouched(proxyId);
+
+        return proxyId;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    void BVH::Remove(ProxyId const proxyId)
+    {
+        MFA_ASSERT(proxyId >= 0 && proxyId < static_cast<ProxyId>(_proxies.size()));
+        auto & proxy = _proxies[proxyId];
+        MFA_ASSERT(proxy.isAlive == true);
+
+        RemoveLeaf(proxy.node);
+        FreeNode(proxy.node);
+
+        proxy.node = -1;
+        proxy.isAlive = false;
+        proxy.userData = nullptr;
+        --_proxyCount;
+        ++_changeCount;
+
+        MarkTouched(proxyId);
+        _freeProxies.emplace_back(proxyId);
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    bool BVH::Update(ProxyId const proxyId, AABB const & bounds)
+    {
+        MFA_ASSERT(proxyId >= 0 && proxyId < static_cast<ProxyId>(_proxies.size()));
+        MFA_ASSERT(bounds.IsValid());
+        auto & proxy = _proxies[proxyId];
+        MFA_ASSERT(proxy.isAlive == true);
+
+        if (proxy.fatBounds.Contains(bounds))
+        {
+            return false;
+        }
+
+        proxy.fatBounds = bounds.Fatten(_params.fatMargin);
+        _nodes[proxy.node].bounds = proxy.fatBounds;
+        Refit(_nodes[proxy.node].parent, true);
+
+        ++_changeCount;
+        MarkTouched(proxyId);
+
+        return true;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    void * BVH::GetUserData(ProxyId const proxyId) const
+    {
+        MFA_ASSERT(proxyId >= 0 && proxyId < static_cast<ProxyId>(_proxies.size()));
+        return _proxies[proxyId].userData;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    void BVH::SetUserData(ProxyId const proxyId, void * userData)
+    {
+        MFA_ASSERT(proxyId >= 0 && proxyId < static_cast<ProxyId>(_proxies.size()));
+        MFA_ASSERT(_proxies[proxyId].isAlive == true);
+        _proxies[proxyId].userData = userData;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    AABB const & BVH::GetFatBounds(ProxyId const proxyId) const
+    {
+        MFA_ASSERT(proxyId >= 0 && proxyId < static_cast<ProxyId>(_proxies.size()));
+        return _proxies[proxyId].fatBounds;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    template<typename OverlapFunction>
+    void BVH::QueryInternal(OverlapFunction const & overlap, QueryCallback const & callback) const
+    {
+        if (_root == -1)
+        {
+            return;
+        }
+
+        std::vector<int> stack{};
+        stack.reserve(64);
+        stack.emplace_back(_root);
+
+        while (stack.empty() == false)
+        {
+            auto const & node = _nodes[stack.back()];
+            stack.pop_back();
+
+            if (overlap(node.bounds) == false)
+            {
+                continue;
+            }
+
+            if (node.IsLeaf())
+            {
+                if (callback(node.proxyId) == false)
+                {
+                    return;
+                }
+            }
+            else
+            {
+                stack.emplace_back(node.child1);
+                stack.emplace_back(node.child2);
+            }
+        }
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    void BVH::Query(AABB const & aabb, QueryCallback const & callback) const
+    {
+        QueryInternal([&aabb](AABB const & bounds)->bool
+        {
+            return aabb.Intersects(bounds);
+        }, callback);
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    void BVH::Query(Sphere const & sphere, QueryCallback const & callback) const
+    {
+        QueryInternal([&sphere](AABB const & bounds)->bool
+        {
+            return sphere.Intersects(bounds);
+        }, callback);
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    void BVH::Query(Frustum const & frustum, QueryCallback const & callback) const
+    {
+        QueryInternal([&frustum](AABB const & bounds)->bool
+        {
+            return frustum.Intersects(bounds);
+        }, callback);
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    void BVH::RayCast(Ray const & ray, float maxDistance, RayCastCallback const & callback) const
+    {
+        if (_root == -1)
+        {
+            return;
+        }
+
+        std::vector<int> stack{};
+        stack.reserve(64);
+        stack.emplace_back(_root);
+
+        while (stack.empty() == false)
+        {
+            auto const & node = _nodes[stack.back()];
+            stack.pop_back();
+
+            float distance = 0.0f;
+            if (ray.Intersects(node.bounds, maxDistance, distance) == false)
+            {
+                continue;
+            }
+
+            if (node.IsLeaf())
+            {
+                maxDistance = callback(node.proxyId, distance);
+                if (maxDistance <= 0.0f)
+                {
+                    return;
+                }
+            }
+            else
+            {
+                stack.emplace_back(node.child1);
+                stack.emplace_back(node.child2);
+            }
+        }
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    void BVH::Rebuild()
+    {
+        if (_isRebuilding)
+        {
+            // A full rebuild makes the pending result useless
+            _rebuildFuture.wait();
+            _rebuildFuture = {};
+            _isRebuilding = false;
+            for (auto const proxyId : _touchedProxies)
+            {
+                _proxies[proxyId].isTouched = false;
+            }
+            _touchedProxies.clear();
+        }
+
+        auto leaves = CollectLeaves();
+        ApplyBuildResult(Build(leaves));
+        _changeCount = 0;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    void BVH::RebuildAsync()
+    {
+        if (_isRebuilding)
+        {
+            return;
+        }
+
+        if (JS::Instance == nullptr)
+        {
+            Rebuild();
+            return;
+        }
+
+        for (auto const proxyId : _touchedProxies)
+        {
+            _proxies[proxyId].isTouched = false;
+        }
+        _touchedProxies.clear();
+        _isRebuilding = true;
+        _changeCount = 0;
+
+        auto leaves = std::make_shared<std::vector<Leaf>>(CollectLeaves());
+        _rebuildFuture = JS::Instance->AssignTask<std::shared_ptr<BuildResult>>([leaves]()->std::shared_ptr<BuildResult>
+        {
+            return std::make_shared<BuildResult>(Build(*leaves));
+        });
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    bool BVH::TryFinishRebuild()
+    {
+        if (_isRebuilding == false)
+        {
+            return false;
+        }
+        MFA_ASSERT(_rebuildFuture.valid());
+        if (_rebuildFuture.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            return false;
+        }
+
+        auto const result = _rebuildFuture.get();
+        _isRebuilding = false;
+
+        ApplyBuildResult(std::move(*result));
+
+        // Proxies that changed after the snapshot are stale in the new tree
+        for (auto const proxyId : _touchedProxies)
+        {
+            auto & proxy = _proxies[proxyId];
+            proxy.isTouched = false;
+            if (proxy.node != -1)
+            {
+                RemoveLeaf(proxy.node);
+                FreeNode(proxy.node);
+                proxy.node = -1;
+            }
+            if (proxy.isAlive)
+            {
+                auto const leaf = AllocateNode();
+                _nodes[leaf].bounds = proxy.fatBounds;
+                _nodes[leaf].proxyId = proxyId;
+                _nodes[leaf].height = 0;
+                proxy.node = leaf;
+                InsertLeaf(leaf);
+            }
+        }
+        _touchedProxies.clear();
+
+        return true;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    bool BVH::IsRebuilding() const noexcept
+    {
+        return _isRebuilding;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    bool BVH::NeedsRebuild() const noexcept
+    {
+        return _proxyCount > 0 && static_cast<float>(_changeCount) > static_cast<float>(_proxyCount) * _params.rebuildRefitRatio;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    int BVH::GetHeight() const noexcept
+    {
+        return _root == -1 ? 0 : _nodes[_root].height;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    int BVH::GetProxyCount() const noexcept
+    {
+        return _proxyCount;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    int BVH::AllocateNode()
+    {
+        if (_freeNodes.empty() == false)
+        {
+            auto const nodeIndex = _freeNodes.back();
+            _freeNodes.pop_back();
+            _nodes[nodeIndex] = Node{};
+            return nodeIndex;
+        }
+        _nodes.emplace_back();
+        return static_cast<int>(_nodes.size()) - 1;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    void BVH::FreeNode(int const nodeIndex)
+    {
+        MFA_ASSERT(nodeIndex >= 0 && nodeIndex < static_cast<int>(_nodes.size()));
+        _nodes[nodeIndex].height = -1;
+        _freeNodes.emplace_back(nodeIndex);
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    // Same sibling selection heuristic as Box2D's dynamic tree: Descend toward the child that increases the total
+    // surface area the least and stop when creating a new parent at the current level is cheaper.
+    void BVH::InsertLeaf(int const leaf)
+    {
+        if (_root == -1)
+        {
+            _root = leaf;
+            _nodes[leaf].parent = -1;
+            return;
+        }
+
+        auto const leafBounds = _nodes[leaf].bounds;
+
+        int index = _root;
+        while (_nodes[index].IsLeaf() == false)
+        {
+            auto const & node = _nodes[index];
+
+            float const area = node.bounds.SurfaceArea();
+            float const combinedArea = AABB::Merge(node.bounds, leafBounds).SurfaceArea();
+
+            float const cost = 2.0f * combinedArea;
+            float const inheritanceCost = 2.0f * (combinedArea - area);
+
+            auto const childCost = [&](int const childIndex)->float
+            {
+                auto const & child = _nodes[childIndex];
+                float const mergedArea = AABB::Merge(child.bounds, leafBounds).SurfaceArea();
+                if (child.IsLeaf())
+                {
+                    return mergedArea + inheritanceCost;
+                }
+                return mergedArea - child.bounds.SurfaceArea() + inheritanceCost;
+            };
+
+            float const cost1 = childCost(node.child1);
+            float const cost2 = childCost(node.child2);
+
+            if (cost < cost1 && cost < cost2)
+            {
+                break;
+            }
+
+            index = cost1 < cost2 ? node.child1 : node.child2;
+        }
+
+        int const sibling = index;
+        int const oldParent = _nodes[sibling].parent;
+        int const newParent = AllocateNode();
+
+        _nodes[newParent].parent = oldParent;
+        _nodes[newParent].bounds = AABB::Merge(leafBounds, _nodes[sibling].bounds);
+        _nodes[newParent].height = _nodes[sibling].height + 1;
+        _nodes[newParent].child1 = sibling;
+        _nodes[newParent].child2 = leaf;
+
+        if (oldParent != -1)
+        {
+            if (_nodes[oldParent].child1 == sibling)
+            {
+                _nodes[oldParent].child1 = newParent;
+            }
+            else
+            {
+                _nodes[oldParent].child2 = newParent;
+            }
+        }
+        else
+        {
+            _root = newParent;
+        }
+
+        _nodes[sibling].parent = newParent;
+        _nodes[leaf].parent = newParent;
+
+        Refit(oldParent, false);
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    void BVH::RemoveLeaf(int const leaf)
+    {
+        if (leaf == _root)
+        {
+            _root = -1;
+            return;
+        }
+
+        int const parent = _nodes[leaf].parent;
+        int const grandParent = _nodes[parent].parent;
+        int const sibling = _nodes[parent].child1 == leaf ? _nodes[parent].child2 : _nodes[parent].child1;
+
+        if (grandParent != -1)
+        {
+            if (_nodes[grandParent].child1 == parent)
+            {
+                _nodes[grandParent].child1 = sibling;
+            }
+            else
+            {
+                _nodes[grandParent].child2 = sibling;
+            }
+            _nodes[sibling].parent = grandParent;
+            FreeNode(parent);
+
+            Refit(grandParent, false);
+        }
+        else
+        {
+            _root = sibling;
+            _nodes[sibling].parent = -1;
+            FreeNode(parent);
+        }
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    void BVH::Refit(int nodeIndex, bool const stopWhenUnchanged)
+    {
+        while (nodeIndex != -1)
+        {
+            auto & node = _nodes[nodeIndex];
+            auto const & child1 = _nodes[node.child1];
+            auto const & child2 = _nodes[node.child2];
+
+            auto const bounds = AABB::Merge(child1.bounds, child2.bounds);
+            auto const height = 1 + std::max(child1.height, child2.height);
+
+            bool const isUnchanged = node.height == height &&
+                node.bounds.min == bounds.min &&
+                node.bounds.max == bounds.max;
+
+            node.bounds = bounds;
+            node.height = height;
+
+            if (stopWhenUnchanged && isUnchanged)
+            {
+                break;
+            }
+
+            nodeIndex = node.parent;
+        }
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    void BVH::MarkTouched(ProxyId const proxyId)
+    {
+        if (_isRebuilding == false)
+        {
+            return;
+        }
+        auto & proxy = _proxies[proxyId];
+        if (proxy.isTouched == false)
+        {
+            proxy.isTouched = true;
+            _touchedProxies.emplace_back(proxyId);
+        }
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    std::vector<BVH::Leaf> BVH::CollectLeaves() const
+    {
+        std::vector<Leaf> leaves{};
+        leaves.reserve(_proxyCount);
+        for (ProxyId proxyId = 0; proxyId < static_cast<ProxyId>(_proxies.size()); ++proxyId)
+        {
+            auto const & proxy = _proxies[proxyId];
+            if (proxy.isAlive)
+            {
+                leaves.emplace_back(Leaf{ .proxyId = proxyId, .bounds = proxy.fatBounds });
+            }
+        }
+        return leaves;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    void BVH::ApplyBuildResult(BuildResult && result)
+    {
+        _nodes = std::move(result.nodes);
+        _root = result.root;
+        _freeNodes.clear();
+
+        for (auto & proxy : _proxies)
+        {
+            proxy.node = -1;
+        }
+
+        for (int nodeIndex = 0; nodeIndex < static_cast<int>(_nodes.size()); ++nodeIndex)
+        {
+            auto const & node = _nodes[nodeIndex];
+            if (node.IsLeaf())
+            {
+                _proxies[node.proxyId].node = nodeIndex;
+            }
+        }
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    BVH::BuildResult BVH::Build(std::vector<Leaf> & leaves)
+    {
+        BuildResult result{};
+        if (leaves.empty() == false)
+        {
+            result.nodes.reserve(leaves.size() * 2 - 1);
+            result.root = BuildRecursive(result.nodes, leaves, 0, static_cast<int>(leaves.size()), -1);
+        }
+        return result;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    // Top down build with binned surface area heuristic
+    int BVH::BuildRecursive(
+        std::vector<Node> & nodes,
+        std::vector<Leaf> & leaves,
+        int const begin,
+        int const end,
+        int const parent
+    )
+    {
+        int const nodeIndex = static_cast<int>(nodes.size());
+        nodes.emplace_back();
+        nodes[nodeIndex].parent = parent;
+
+        if (end - begin == 1)
+        {
+            nodes[nodeIndex].bounds = leaves[begin].bounds;
+            nodes[nodeIndex].proxyId = leaves[begin].proxyId;
+            nodes[nodeIndex].height = 0;
+            return nodeIndex;
+        }
+
+        AABB bounds{};
+        AABB centroidBounds{};
+        for (int i = begin; i < end; ++i)
+        {
+            bounds.Expand(leaves[i].bounds);
+            centroidBounds.Expand(leaves[i].bounds.Center());
+        }
+
+        auto const centroidSize = centroidBounds.max - centroidBounds.min;
+        int axis = 0;
+        if (centroidSize.y > centroidSize[axis])
+        {
+            axis = 1;
+        }
+        if (centroidSize.z > centroidSize[axis])
+        {
+            axis = 2;
+        }
+
+        int middle = (begin + end) / 2;
+
+        if (centroidSize[axis] > 0.0f)
+        {
+            static constexpr int BinCount = 16;
+
+            struct Bin
+            {
+                AABB bounds{};
+                int count = 0;
+            };
+            Bin bins[BinCount]{};
+
+            float const binScale = static_cast<float>(BinCount) / centroidSize[axis];
+            auto const binIndex = [&](Leaf const & leaf)->int
+            {
+                auto const index = static_cast<int>((leaf.bounds.Center()[axis] - centroidBounds.min[axis]) * binScale);
+                return std::clamp(index, 0, BinCount - 1);
+            };
+
+            for (int i = begin; i < end; ++i)
+            {
+                auto & bin = bins[binIndex(leaves[i])];
+                bin.bounds.Expand(leaves[i].bounds);
+                ++bin.count;
+            }
+
+            // Sweep from the right to store the cost of each right side
+            float rightCosts[BinCount]{};
+            {
+                AABB rightBounds{};
+                int rightCount = 0;
+                for (int i = BinCount - 1; i > 0; --i)
+                {
+                    rightBounds.Expand(bins[i].bounds);
+                    rightCount += bins[i].count;
+                    rightCosts[i] = rightCount > 0 ? rightBounds.SurfaceArea() * static_cast<float>(rightCount) : 0.0f;
+                }
+            }
+
+            int bestSplit = -1;
+            float bestCost = std::numeric_limits<float>::max();
+            {
+                AABB leftBounds{};
+                int leftCount = 0;
+                for (int i = 0; i < BinCount - 1; ++i)
+                {
+                    leftBounds.Expand(bins[i].bounds);
+                    leftCount += bins[i].count;
+                    if (leftCount == 0 || leftCount == end - begin)
+                    {
+                        continue;
+                    }
+                    float const cost = leftBounds.SurfaceArea() * static_cast<float>(leftCount) + rightCosts[i + 1];
+                    if (cost < bestCost)
+                    {
+                        bestCost = cost;
+                        bestSplit = i;
+                    }
+                }
+            }
+
+            if (bestSplit >= 0)
+            {
+                auto const * splitPoint = std::partition(
+                    leaves.data() + begin,
+                    leaves.data() + end,
+                    [&](Leaf const & leaf)->bool
+                    {
+                        return binIndex(leaf) <= bestSplit;
+                    }
+                );
+                middle = static_cast<int>(splitPoint - leaves.data());
+            }
+        }
+
+        if (middle == begin || middle == end)
+        {
+            middle = (begin + end) / 2;
+        }
+
+        auto const child1 = BuildRecursive(nodes, leaves, begin, middle, nodeIndex);
+        auto const child2 = BuildRecursive(nodes, leaves, middle, end, nodeIndex);
+
+        auto & node = nodes[nodeIndex];
+        node.bounds = bounds;
+        node.child1 = child1;
+        node.child2 = child2;
+        node.height = 1 + std::max(nodes[child1].height, nodes[child2].height);
+
+        return nodeIndex;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+}
@@ -0,0 +1,184 @@
+#pragma once
+
+#include "BedrockBounds.hpp"
+
+#include <functional>
+#include <future>
+#include <memory>
+#include <vector>
+
+namespace MFA
+{
+
+    // Dynamic bounding volume hierarchy over world space boxes.
+    // Leaves store fat boxes so small movements do not touch the tree. Bigger movements refit the ancestors in place
+    // and the quality that is lost by refitting is recovered by a periodic rebuild that can run on the job system.
+    class BVH
+    {
+    public:
+
+        using ProxyId = int;
+
+        inline static constexpr ProxyId InvalidProxy = -1;
+
+        struct Params
+        {
+            float fatMargin = 0.1f;                 // Extra space around each leaf in world units
+            float rebuildRefitRatio = 0.5f;         // NeedsRebuild returns true after proxyCount * ratio changes
+        };
+
+        // Return false to stop the query
+        using QueryCallback = std::function<bool(ProxyId proxyId)>;
+
+        // Receives the distance of the proxy fat box along the ray. Returns the new max distance, zero stops the query
+        using RayCastCallback = std::function<float(ProxyId proxyId, float distance)>;
+
+        explicit BVH();
+
+        explicit BVH(Params const & params);
+
+        ~BVH();
+
+        BVH(BVH const &) noexcept = delete;
+        BVH(BVH &&) noexcept = delete;
+        BVH & operator = (BVH const &) noexcept = delete;
+        BVH & operator = (BVH &&) noexcept = delete;
+
+        [[nodiscard]]
+        ProxyId Insert(AABB const & bounds, void * userData);
+
+        void Remove(ProxyId proxyId);
+
+        // Returns true if the proxy left its fat box and the tree had to be refitted
+        bool Update(ProxyId proxyId, AABB const & bounds);
+
+        [[nodiscard]]
+        void * GetUserData(ProxyId proxyId) const;
+
+        // For owners that move in memory
+        void SetUserData(ProxyId proxyId, void * userData);
+
+        [[nodiscard]]
+        AABB const & GetFatBounds(ProxyId proxyId) const;
+
+        void Query(AABB const & aabb, QueryCallback const & callback) const;
+
+        void Query(Sphere const & sphere, QueryCallback const & callback) const;
+
+        void Query(Frustum const & frustum, QueryCallback const & callback) const;
+
+        void RayCast(Ray const & ray, float maxDistance, RayCastCallback const & callback) const;
+
+        // Rebuilds the whole tree on the calling thread
+        void Rebuild();
+
+        // Builds a new tree from a snapshot of the leaves on a worker thread. The tree stays usable in the meantime.
+        void RebuildAsync();
+
+        // Has to be called from the thread that owns the tree. Returns true when the rebuilt tree is swapped in.
+        bool TryFinishRebuild();
+
+        [[nodiscard]]
+        bool IsRebuilding() const noexcept;
+
+        // Inserts, removals and refits degrade the tree, so each of them counts toward the next rebuild
+        [[nodiscard]]
+        bool NeedsRebuild() const noexcept;
+
+        [[nodiscard]]
+        int GetHeight() const noexcept;
+
+        [[nodiscard]]
+        int GetProxyCount() const noexcept;
+
+    private:
+
+        struct Node
+        {
+            AABB bounds{};
+            int parent = -1;
+            int child1 = -1;
+            int child2 = -1;
+            int height = 0;
+            ProxyId proxyId = InvalidProxy;
+
+            [[nodiscard]]
+            bool IsLeaf() const noexcept
+            {
+                return child1 == -1;
+            }
+        };
+
+        struct Proxy
+        {
+            AABB fatBounds{};
+            void * userData = nullptr;
+            int node = -1;
+            bool isAlive = false;
+            bool isTouched = false;             // Changed while an async rebuild is in progress
+        };
+
+        struct Leaf
+        {
+            ProxyId proxyId = InvalidProxy;
+            AABB bounds{};
+        };
+
+        struct BuildResult
+        {
+            std::vector<Node> nodes{};
+            int root = -1;
+        };
+
+        template<typename OverlapFunction>
+        void QueryInternal(OverlapFunction const & overlap, QueryCallback const & callback) const;
+
+        [[nodiscard]]
+        int AllocateNode();
+
+        void FreeNode(int nodeIndex);
+
+        void InsertLeaf(int leaf);
+
+        void RemoveLeaf(int leaf);
+
+        // Walks toward the root and updates the bounds and heights
+        void Refit(int nodeIndex, bool stopWhenUnchanged);
+
+        void MarkTouched(ProxyId proxyId);
+
+        [[nodiscard]]
+        std::vector<Leaf> CollectLeaves() const;
+
+        void ApplyBuildResult(BuildResult && result);
+
+        [[nodiscard]]
+        static BuildResult Build(std::vector<Leaf> & leaves);
+
+        static int BuildRecursive(
+            std::vector<Node> & nodes,
+            std::vector<Leaf> & leaves,
+            int begin,
+            int end,
+            int parent
+        );
+
+        Params const _params;
+
+        std::vector<Node> _nodes{};
+        std::vector<int> _freeNodes{};
+        int _root = -1;
+
+        std::vector<Proxy> _proxies{};
+        std::vector<ProxyId> _freeProxies{};
+        int _proxyCount = 0;
+
+        int _changeCount = 0;
+
+        bool _isRebuilding = false;
+        std::vector<ProxyId> _touchedProxies{};
+        std::future<std::shared_ptr<BuildResult>> _rebuildFuture{};
+
+    };
+
+}
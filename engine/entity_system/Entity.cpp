@@ -0,0 +1,60 @@
+#include "Entity.hpp"
+
+#include "BedrockAssert.hpp"
+
+#include <deque>
+#include <mutex>
+
+namespace MFA::ComponentRegistry
+{
+
+    //-------------------------------------------------------------------------------------------------
+
+    // Deque keeps the references that Get returns valid while other threads register new types
+    static std::deque<ComponentInfo> & Infos()
+    {
+        static std::deque<ComponentInfo> infos{};
+        return infos;
+    }
+
+    static std::mutex & Lock()
+    {
+        static std::mutex lock{};
+        return lock;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    ComponentId Register(ComponentInfo const & info)
+    {
+        std::lock_guard lock{Lock()};
+        auto & infos = Infos();
+        if (infos.size() >= MaxComponents)
+        {
+            MFA_CRASH("Too many component types. Increase MaxComponents");
+        }
+        infos.emplace_back(info);
+        return static_cast<ComponentId>(infos.size() - 1);
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    ComponentInfo const & Get(ComponentId const componentId)
+    {
+        std::lock_guard lock{Lock()};
+        auto const & infos = Infos();
+        MFA_ASSERT(componentId < infos.size());
+        return infos[componentId];
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    ComponentId Count()
+    {
+        std::lock_guard lock{Lock()};
+        return static_cast<ComponentId>(Infos().size());
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+
+namespace MFA
+{
+
+    struct Entity
+    {
+        uint32_t index = std::numeric_limits<uint32_t>::max();
+        uint32_t generation = 0;
+
+        [[nodiscard]]
+        bool IsValid() const noexcept
+        {
+            return index != std::numeric_limits<uint32_t>::max();
+        }
+
+        bool operator == (Entity const & other) const noexcept = default;
+    };
+
+    using ComponentId = uint32_t;
+
+    inline static constexpr ComponentId MaxComponents = 64;
+
+    using ComponentMask = std::bitset<MaxComponents>;
+
+    // Type erased operations that the chunk storage needs to move components around
+    struct ComponentInfo
+    {
+        size_t size = 0;
+        size_t alignment = 0;
+        char const * name = nullptr;
+        void (*defaultConstruct)(void * destination) = nullptr;
+        void (*moveConstruct)(void * destination, void * source) = nullptr;
+        void (*destruct)(void * component) = nullptr;
+    };
+
+    namespace ComponentRegistry
+    {
+
+        [[nodiscard]]
+        ComponentId Register(ComponentInfo const & info);
+
+        [[nodiscard]]
+        ComponentInfo const & Get(ComponentId componentId);
+
+        [[nodiscard]]
+        ComponentId Count();
+
+        template<typename T>
+        ComponentInfo CreateInfo()
+        {
+            static_assert(std::is_move_constructible_v<T>);
+            static_assert(std::is_default_constructible_v<T>);
+            return ComponentInfo{
+                .size = sizeof(T),
+                .alignment = alignof(T),
+                .name = typeid(T).name(),
+                .defaultConstruct = [](void * destination)->void
+                {
+                    new (destination) T();
+                },
+                .moveConstruct = [](void * destination, void * source)->void
+                {
+                    new (destination) T(std::move(*static_cast<T *>(source)));
+                },
+                .destruct = [](void * component)->void
+                {
+                    static_cast<T *>(component)->~T();
+                }
+            };
+        }
+
+    }
+
+    namespace ComponentRegistry
+    {
+
+        template<typename T>
+        ComponentId GetId()
+        {
+            static_assert(std::is_same_v<T, std::remove_cvref_t<T>>);
+            static ComponentId const componentId = Register(CreateInfo<T>());
+            return componentId;
+        }
+
+    }
+
+    // Const qualified components share the id of the mutable type. Constness is only used to detect read access.
+    template<typename T>
+    ComponentId GetComponentId()
+    {
+        return ComponentRegistry::GetId<std::remove_cvref_t<T>>();
+    }
+
+    template<typename ... Components>
+    ComponentMask GetComponentMask()
+    {
+        ComponentMask mask{};
+        (mask.set(GetComponentId<Components>()), ...);
+        return mask;
+    }
+
+}
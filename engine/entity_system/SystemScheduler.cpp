@@ -0,0 +1,96 @@
+#include "SystemScheduler.hpp"
+
+#include "BedrockAssert.hpp"
+#include "JobSystem.hpp"
+#include "World.hpp"
+
+#include <future>
+
+namespace MFA
+{
+
+    //-------------------------------------------------------------------------------------------------
+
+    SystemScheduler::SystemScheduler(World & world)
+        : _world(world)
+    {}
+
+    //-------------------------------------------------------------------------------------------------
+
+    SystemScheduler::~SystemScheduler() = default;
+
+    //-------------------------------------------------------------------------------------------------
+
+    void SystemScheduler::AddSystem(std::string name, SystemAccess const & access, UpdateFunction update)
+    {
+        MFA_ASSERT(update != nullptr);
+
+        // A system has to run after every earlier system that it conflicts with
+        int stage = 0;
+        for (auto const & system : _systems)
+        {
+            if (system.access.ConflictsWith(access))
+            {
+                stage = std::max(stage, system.stage + 1);
+            }
+        }
+
+        _systems.emplace_back(System{
+            .name = std::move(name),
+            .access = access,
+            .update = std::move(update),
+            .stage = stage
+        });
+
+        if (static_cast<int>(_stages.size()) <= stage)
+        {
+            _stages.resize(stage + 1);
+        }
+        _stages[stage].emplace_back(static_cast<int>(_systems.size()) - 1);
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    void SystemScheduler::Run()
+    {
+        std::vector<std::future<void>> futures{};
+        for (auto const & stage : _stages)
+        {
+            if (JS::Instance == nullptr || JS::Instance->IsMainThread() == false || stage.size() == 1)
+            {
+                for (auto const systemIdx : stage)
+                {
+                    _systems[systemIdx].update(_world);
+                }
+                continue;
+            }
+
+            futures.clear();
+            for (int i = 1; i < static_cast<int>(stage.size()); ++i)
+            {
+                auto & system = _systems[stage[i]];
+                futures.emplace_back(JS::Instance->AssignTask([&system, this]()->void
+                {
+                    system.update(_world);
+                }));
+            }
+
+            _systems[stage[0]].update(_world);
+
+            for (auto & future : futures)
+            {
+                future.wait();
+            }
+        }
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    int SystemScheduler::GetStageCount() const noexcept
+    {
+        return static_cast<int>(_stages.size());
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+}
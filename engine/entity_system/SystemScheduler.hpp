@@ -0,0 +1,87 @@
+#pragma once
+
+#include "Entity.hpp"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace MFA
+{
+
+    class World;
+
+    struct SystemAccess
+    {
+        ComponentMask reads{};
+        ComponentMask writes{};
+
+        // Const components are read, everything else is written
+        template<typename ... Components>
+        [[nodiscard]]
+        static SystemAccess Of()
+        {
+            SystemAccess access{};
+            ((std::is_const_v<std::remove_reference_t<Components>>
+                ? access.reads.set(GetComponentId<Components>())
+                : access.writes.set(GetComponentId<Components>())), ...);
+            return access;
+        }
+
+        [[nodiscard]]
+        bool ConflictsWith(SystemAccess const & other) const
+        {
+            return (writes & (other.writes | other.reads)).any() || (reads & other.writes).any();
+        }
+    };
+
+    // Each system is put in the first stage after every earlier system that it conflicts with, so a system can share
+    // a stage with earlier systems that were not added right before it. Stages run in order and each stage runs its
+    // systems on the job system in parallel.
+    class SystemScheduler
+    {
+    public:
+
+        using UpdateFunction = std::function<void(World & world)>;
+
+        explicit SystemScheduler(World & world);
+
+        ~SystemScheduler();
+
+        SystemScheduler(SystemScheduler const &) noexcept = delete;
+        SystemScheduler(SystemScheduler &&) noexcept = delete;
+        SystemScheduler & operator = (SystemScheduler const &) noexcept = delete;
+        SystemScheduler & operator = (SystemScheduler &&) noexcept = delete;
+
+        // Systems must not create or destroy entities or add and remove components while running
+        void AddSystem(std::string name, SystemAccess const & access, UpdateFunction update);
+
+        template<typename ... Components>
+        void AddSystem(std::string name, UpdateFunction update)
+        {
+            AddSystem(std::move(name), SystemAccess::Of<Components...>(), std::move(update));
+        }
+
+        void Run();
+
+        [[nodiscard]]
+        int GetStageCount() const noexcept;
+
+    private:
+
+        struct System
+        {
+            std::string name{};
+            SystemAccess access{};
+            UpdateFunction update{};
+            int stage = 0;
+        };
+
+        World & _world;
+
+        std::vector<System> _systems{};
+        std::vector<std::vector<int>> _stages{};
+
+    };
+
+}
@@ -13,14 +13,20 @@ namespace MFA
 
 	void Transform::SetEulerAngles(glm::vec3 const & eulerAngles)
 	{
-		_isDirty |= _rotation.SetEulerAngles(eulerAngles);
+		if (_rotation.SetEulerAngles(eulerAngles))
+		{
+			SetDirty();
+		}
 	}
 
 	//-------------------------------------------------------------------------------------------------
 
 	void Transform::SetQuaternion(glm::quat const & quaternion)
 	{
-		_isDirty |= _rotation.SetQuaternion(quaternion);
+		if (_rotation.SetQuaternion(quaternion))
+		{
+			SetDirty();
+		}
 	}
 
 	//-------------------------------------------------------------------------------------------------
@@ -37,9 +43,17 @@ namespace MFA
 
 	//-------------------------------------------------------------------------------------------------
 
+	uint32_t Transform::GetVersion() const noexcept
+	{
+		return _version;
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
 	void Transform::SetDirty()
 	{
 		_isDirty = true;
+		++_version;
 	}
 
 	//-------------------------------------------------------------------------------------------------
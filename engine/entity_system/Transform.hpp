@@ -19,6 +19,10 @@ namespace MFA
         [[nodiscard]]
         glm::mat4 const& GetMatrix();
 
+        // Increases every time that the transform changes. Useful for caching values that depend on the matrix
+        [[nodiscard]]
+        uint32_t GetVersion() const noexcept;
+
     private:
 
         void SetDirty();
@@ -29,6 +33,7 @@ namespace MFA
         MFA_VARIABLE2(extraTransform, glm::mat4, glm::identity<glm::mat4>(), SetDirty);
     	
         bool _isDirty = true;
+        uint32_t _version = 0;
         glm::mat4 _transform{};
 
     };
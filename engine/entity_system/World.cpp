@@ -0,0 +1,147 @@
+#include "World.hpp"
+
+namespace MFA
+{
+
+    //-------------------------------------------------------------------------------------------------
+
+    World::World() = default;
+
+    //-------------------------------------------------------------------------------------------------
+
+    World::~World()
+    {
+        MFA_ASSERT(_activeQueries == 0);
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    void World::DestroyEntity(Entity const entity)
+    {
+        MFA_ASSERT(_activeQueries == 0);
+        if (IsAlive(entity) == false)
+        {
+            return;
+        }
+
+        auto & record = _records[entity.index];
+        RemoveFromArchetype(record);
+
+        record.archetype = nullptr;
+        record.location = {};
+        ++record.generation;
+        _freeIndices.emplace_back(entity.index);
+        --_entityCount;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    bool World::IsAlive(Entity const entity) const
+    {
+        return entity.index < _records.size() &&
+            _records[entity.index].generation == entity.generation &&
+            _records[entity.index].archetype != nullptr;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    int World::GetEntityCount() const noexcept
+    {
+        return _entityCount;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    int World::GetArchetypeCount() const noexcept
+    {
+        return static_cast<int>(_archetypeList.size());
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    Archetype & World::FindOrCreateArchetype(ComponentMask const & mask)
+    {
+        auto const findResult = _archetypes.find(mask);
+        if (findResult != _archetypes.end())
+        {
+            return *findResult->second;
+        }
+
+        auto archetype = std::make_unique<Archetype>(mask);
+        auto * pointer = archetype.get();
+        _archetypes.emplace(mask, std::move(archetype));
+        _archetypeList.emplace_back(pointer);
+        return *pointer;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    Entity World::AllocateEntity()
+    {
+        ++_entityCount;
+        if (_freeIndices.empty() == false)
+        {
+            auto const index = _freeIndices.back();
+            _freeIndices.pop_back();
+            return Entity{.index = index, .generation = _records[index].generation};
+        }
+        _records.emplace_back();
+        return Entity{.index = static_cast<uint32_t>(_records.size() - 1), .generation = 0};
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    void World::MoveEntity(Entity const entity, Archetype & target)
+    {
+        auto & record = _records[entity.index];
+        auto & source = *record.archetype;
+
+        auto const newLocation = target.Allocate(entity);
+        for (auto const componentId : source.GetComponentIds())
+        {
+            auto const targetColumn = target.GetColumn(componentId);
+            if (targetColumn < 0)
+            {
+                continue;
+            }
+            ComponentRegistry::Get(componentId).moveConstruct(
+                target.GetComponent(newLocation, targetColumn),
+                source.GetComponent(record.location, source.GetColumn(componentId))
+            );
+        }
+
+        // Moved from components are still alive and the source destructs them
+        RemoveFromArchetype(record);
+
+        record.archetype = &target;
+        record.location = newLocation;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    void World::RemoveFromArchetype(EntityRecord const & record)
+    {
+        auto const location = record.location;
+        auto const movedEntity = record.archetype->Remove(location);
+        if (movedEntity.IsValid())
+        {
+            _records[movedEntity.index].location = location;
+        }
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    void * World::GetComponentRaw(Entity const entity, ComponentId const componentId) const
+    {
+        auto const & record = _records[entity.index];
+        auto const column = record.archetype->GetColumn(componentId);
+        if (column < 0)
+        {
+            return nullptr;
+        }
+        return record.archetype->GetComponent(record.location, column);
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+}
@@ -0,0 +1,295 @@
+#pragma once
+
+#include "Archetype.hpp"
+#include "BedrockAssert.hpp"
+#include "JobSystem.hpp"
+
+#include <atomic>
+#include <memory>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace MFA
+{
+
+    // Owns the entities and their components. Components are grouped by archetype so queries walk dense arrays.
+    // Structural changes (create, destroy, add and remove component) are not allowed while a query is running.
+    class World
+    {
+    public:
+
+        explicit World();
+
+        ~World();
+
+        World(World const &) noexcept = delete;
+        World(World &&) noexcept = delete;
+        World & operator = (World const &) noexcept = delete;
+        World & operator = (World &&) noexcept = delete;
+
+        template<typename ... Components>
+        Entity CreateEntity(Components && ... components)
+        {
+            MFA_ASSERT(_activeQueries == 0);
+
+            auto & archetype = FindOrCreateArchetype(GetComponentMask<Components...>());
+            auto const entity = AllocateEntity();
+            auto const location = archetype.Allocate(entity);
+            (ConstructComponent<std::remove_cvref_t<Components>>(
+                archetype, location, std::forward<Components>(components)
+            ), ...);
+
+            auto & record = _records[entity.index];
+            record.archetype = &archetype;
+            record.location = location;
+            return entity;
+        }
+
+        void DestroyEntity(Entity entity);
+
+        [[nodiscard]]
+        bool IsAlive(Entity entity) const;
+
+        template<typename T>
+        T & AddComponent(Entity const entity)
+        {
+            return AddComponent<T>(entity, T());
+        }
+
+        // Replaces the component if the entity already has it
+        template<typename T>
+        T & AddComponent(Entity const entity, T component)
+        {
+            MFA_ASSERT(_activeQueries == 0);
+            MFA_ASSERT(IsAlive(entity));
+
+            auto const componentId = GetComponentId<T>();
+            auto & record = _records[entity.index];
+            if (record.archetype->GetColumn(componentId) >= 0)
+            {
+                auto & existing = *static_cast<T *>(GetComponentRaw(entity, componentId));
+                existing = std::move(component);
+                return existing;
+            }
+
+            auto * target = record.archetype->addEdges[componentId];
+            if (target == nullptr)
+            {
+                auto mask = record.archetype->GetMask();
+                mask.set(componentId);
+                target = &FindOrCreateArchetype(mask);
+                record.archetype->addEdges[componentId] = target;
+            }
+
+            MoveEntity(entity, *target);
+            ConstructComponent<T>(*target, record.location, std::move(component));
+            return *static_cast<T *>(GetComponentRaw(entity, componentId));
+        }
+
+        template<typename T>
+        void RemoveComponent(Entity const entity)
+        {
+            MFA_ASSERT(_activeQueries == 0);
+            MFA_ASSERT(IsAlive(entity));
+
+            auto const componentId = GetComponentId<T>();
+            auto & record = _records[entity.index];
+            if (record.archetype->GetColumn(componentId) < 0)
+            {
+                return;
+            }
+
+            auto * target = record.archetype->removeEdges[componentId];
+            if (target == nullptr)
+            {
+                auto mask = record.archetype->GetMask();
+                mask.reset(componentId);
+                target = &FindOrCreateArchetype(mask);
+                record.archetype->removeEdges[componentId] = target;
+            }
+
+            MoveEntity(entity, *target);
+        }
+
+        template<typename T>
+        [[nodiscard]]
+        bool HasComponent(Entity const entity) const
+        {
+            return IsAlive(entity) && _records[entity.index].archetype->GetColumn(GetComponentId<T>()) >= 0;
+        }
+
+        // Returns nullptr if the entity does not have the component
+        template<typename T>
+        [[nodiscard]]
+        T * GetComponent(Entity const entity)
+        {
+            if (IsAlive(entity) == false)
+            {
+                return nullptr;
+            }
+            return static_cast<T *>(GetComponentRaw(entity, GetComponentId<T>()));
+        }
+
+        // Calls function(Entity, Components & ...) for every entity that has all the components and none of the excluded ones
+        template<typename ... Components, typename Function>
+        void ForEach(Function const & function, ComponentMask const & excluded = {})
+        {
+            QueryScope const scope{_activeQueries};
+
+            auto const mask = GetComponentMask<Components...>();
+            for (auto * archetype : _archetypeList)
+            {
+                if ((archetype->GetMask() & mask) != mask || (archetype->GetMask() & excluded).any())
+                {
+                    continue;
+                }
+                std::array<int, sizeof...(Components)> const columns{archetype->GetColumn(GetComponentId<Components>())...};
+                for (int chunkIdx = 0; chunkIdx < archetype->GetChunkCount(); ++chunkIdx)
+                {
+                    IterateChunk<Components...>(
+                        *archetype,
+                        archetype->GetChunk(chunkIdx),
+                        columns,
+                        function,
+                        std::index_sequence_for<Components...>{}
+                    );
+                }
+            }
+        }
+
+        // Same as ForEach but chunks are distributed between the workers. The function must be thread safe.
+        template<typename ... Components, typename Function>
+        void ParallelForEach(Function const & function, ComponentMask const & excluded = {})
+        {
+            if (JS::Instance == nullptr)
+            {
+                ForEach<Components...>(function, excluded);
+                return;
+            }
+
+            QueryScope const scope{_activeQueries};
+
+            struct ChunkTask
+            {
+                Archetype * archetype = nullptr;
+                int chunkIdx = -1;
+                std::array<int, sizeof...(Components)> columns{};
+            };
+            std::vector<ChunkTask> tasks{};
+
+            auto const mask = GetComponentMask<Components...>();
+            for (auto * archetype : _archetypeList)
+            {
+                if ((archetype->GetMask() & mask) != mask || (archetype->GetMask() & excluded).any())
+                {
+                    continue;
+                }
+                std::array<int, sizeof...(Components)> const columns{archetype->GetColumn(GetComponentId<Components>())...};
+                for (int chunkIdx = 0; chunkIdx < archetype->GetChunkCount(); ++chunkIdx)
+                {
+                    tasks.emplace_back(ChunkTask{.archetype = archetype, .chunkIdx = chunkIdx, .columns = columns});
+                }
+            }
+
+            JS::Instance->ParallelFor(static_cast<int>(tasks.size()), 1, [&tasks, &function](int const begin, int const end)->void
+            {
+                for (int i = begin; i < end; ++i)
+                {
+                    auto const & task = tasks[i];
+                    IterateChunk<Components...>(
+                        *task.archetype,
+                        task.archetype->GetChunk(task.chunkIdx),
+                        task.columns,
+                        function,
+                        std::index_sequence_for<Components...>{}
+                    );
+                }
+            });
+        }
+
+        [[nodiscard]]
+        int GetEntityCount() const noexcept;
+
+        [[nodiscard]]
+        int GetArchetypeCount() const noexcept;
+
+    private:
+
+        struct EntityRecord
+        {
+            Archetype * archetype = nullptr;
+            Archetype::Location location{};
+            uint32_t generation = 0;
+        };
+
+        struct QueryScope
+        {
+            explicit QueryScope(std::atomic<int> & counter)
+                : counter(counter)
+            {
+                ++counter;
+            }
+
+            ~QueryScope()
+            {
+                --counter;
+            }
+
+            std::atomic<int> & counter;
+        };
+
+        template<typename ... Components, typename Function, size_t ... Indices>
+        static void IterateChunk(
+            Archetype const & archetype,
+            Archetype::Chunk const & chunk,
+            std::array<int, sizeof...(Components)> const & columns,
+            Function const & function,
+            std::index_sequence<Indices...>
+        )
+        {
+            auto const * entities = archetype.GetEntities(chunk);
+            std::tuple<Components * ...> const arrays{
+                archetype.GetColumnData<std::remove_const_t<Components>>(chunk, columns[Indices])...
+            };
+            for (int row = 0; row < chunk.count; ++row)
+            {
+                function(entities[row], std::get<Indices>(arrays)[row]...);
+            }
+        }
+
+        template<typename T, typename Argument>
+        void ConstructComponent(Archetype const & archetype, Archetype::Location const & location, Argument && argument)
+        {
+            auto * memory = archetype.GetComponent(location, archetype.GetColumn(GetComponentId<T>()));
+            new (memory) T(std::forward<Argument>(argument));
+        }
+
+        [[nodiscard]]
+        Archetype & FindOrCreateArchetype(ComponentMask const & mask);
+
+        [[nodiscard]]
+        Entity AllocateEntity();
+
+        // Moves the components that both archetypes have. Components that only exist in the target are not constructed.
+        void MoveEntity(Entity entity, Archetype & target);
+
+        // Removes the entity row and fixes the record of the entity that took its place
+        void RemoveFromArchetype(EntityRecord const & record);
+
+        [[nodiscard]]
+        void * GetComponentRaw(Entity entity, ComponentId componentId) const;
+
+        std::vector<EntityRecord> _records{};
+        std::vector<uint32_t> _freeIndices{};
+        int _entityCount = 0;
+
+        std::unordered_map<ComponentMask, std::unique_ptr<Archetype>> _archetypes{};
+        std::vector<Archetype *> _archetypeList{};
+
+        std::atomic<int> _activeQueries = 0;
+
+    };
+
+}
@@ -0,0 +1,1223 @@
+#include "ImportBlockCompression.hpp"
+
+#include "BedrockAssert.hpp"
+#include "JobSystem.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+namespace MFA::Importer
+{
+
+    using Format = AS::Texture::Format;
+
+    namespace
+    {
+
+        constexpr uint32_t BlockSide = 4;
+        constexpr uint32_t TexelCount = BlockSide * BlockSide;
+        constexpr int MinBlocksPerJob = 256;
+
+        // Texels of a block in rgba, channels the source does not have are 0 and alpha is 255
+        using Texels = uint8_t[TexelCount][4];
+        using Values = uint8_t[TexelCount];
+        using Indices = uint8_t[TexelCount];
+
+        struct EncoderSettings
+        {
+            uint32_t powerIterations = 0;
+            uint32_t refinements = 0;
+            bool searchPBits = false;                   // Tries every p-bit pair instead of rounding each endpoint
+            bool separateAlpha = false;                 // BC7 mode 5 for blocks whose alpha varies
+            bool separateAlphaForAll = false;           // BC7 mode 5 for every block
+            bool sixValueMode = false;                  // BC4 with exact 0 and 255
+        };
+
+        //-------------------------------------------------------------------------------------------------
+
+        EncoderSettings GetSettings(CompressionQuality const quality)
+        {
+            switch (quality)
+            {
+            case CompressionQuality::Fast:
+                return EncoderSettings{.powerIterations = 4};
+            case CompressionQuality::Balanced:
+                return EncoderSettings{
+                    .powerIterations = 8,
+                    .refinements = 1,
+                    .searchPBits = true,
+                    .separateAlpha = true
+                };
+            case CompressionQuality::High:
+                return EncoderSettings{
+                    .powerIterations = 8,
+                    .refinements = 4,
+                    .searchPBits = true,
+                    .separateAlpha = true,
+                    .separateAlphaForAll = true,
+                    .sixValueMode = true
+                };
+            }
+            return EncoderSettings{};
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        // Blocks are little endian bit streams, fields are written from the lowest bit
+        class BlockWriter
+        {
+        public:
+
+            void Write(uint32_t const value, uint32_t const bitCount)
+            {
+                MFA_ASSERT(_position + bitCount <= 128);
+                for (uint32_t bit = 0; bit < bitCount; ++bit, ++_position)
+                {
+                    _words[_position >> 6] |= static_cast<uint64_t>((value >> bit) & 1u) << (_position & 63);
+                }
+            }
+
+            void Store(uint8_t * destination) const
+            {
+                MFA_ASSERT(_position == 64 || _position == 128);
+                std::memcpy(destination, _words, _position / 8);
+            }
+
+        private:
+
+            uint64_t _words[2]{};
+            uint32_t _position = 0;
+
+        };
+
+        //-------------------------------------------------------------------------------------------------
+
+        float ClampUnorm8(float const value)
+        {
+            return std::clamp(value, 0.0f, 255.0f);
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        // Endpoints of the line through the texels along their principal axis. The axis comes from power iteration on
+        // the covariance matrix, starting from the column of the largest variance so it is never orthogonal to the
+        // start vector.
+        template<uint32_t Channels>
+        void FitPrincipalAxis(
+            Texels const & texels,
+            uint32_t const iterations,
+            float (&outLow)[4],
+            float (&outHigh)[4]
+        )
+        {
+            float mean[Channels]{};
+            for (auto const & texel : texels)
+            {
+                for (uint32_t c = 0; c < Channels; ++c)
+                {
+                    mean[c] += texel[c];
+                }
+            }
+            for (auto & value : mean)
+            {
+                value /= static_cast<float>(TexelCount);
+            }
+
+            float covariance[Channels][Channels]{};
+            for (auto const & texel : texels)
+            {
+                for (uint32_t a = 0; a < Channels; ++a)
+                {
+                    float const da = texel[a] - mean[a];
+                    for (uint32_t b = a; b < Channels; ++b)
+                    {
+                        covariance[a][b] += da * (texel[b] - mean[b]);
+                    }
+                }
+            }
+            for (uint32_t a = 0; a < Channels; ++a)
+            {
+                for (uint32_t b = 0; b < a; ++b)
+                {
+                    covariance[a][b] = covariance[b][a];
+                }
+            }
+
+            uint32_t largest = 0;
+            for (uint32_t c = 1; c < Channels; ++c)
+            {
+                if (covariance[c][c] > covariance[largest][largest])
+                {
+                    largest = c;
+                }
+            }
+
+            float axis[Channels]{};
+            for (uint32_t c = 0; c < Channels; ++c)
+            {
+                axis[c] = covariance[c][largest];
+            }
+            for (uint32_t iteration = 0; iteration < iterations; ++iteration)
+            {
+                float next[Channels]{};
+                float scale = 0.0f;
+                for (uint32_t a = 0; a < Channels; ++a)
+                {
+                    for (uint32_t b = 0; b < Channels; ++b)
+                    {
+                        next[a] += covariance[a][b] * axis[b];
+                    }
+                    scale = std::max(scale, std::abs(next[a]));
+                }
+                if (scale <= 0.0f)
+                {
+                    break;
+                }
+                for (uint32_t c = 0; c < Channels; ++c)
+                {
+                    axis[c] = next[c] / scale;
+                }
+            }
+
+            float lengthSquared = 0.0f;
+            for (auto const value : axis)
+            {
+                lengthSquared += value * value;
+            }
+
+            float tMin = 0.0f;
+            float tMax = 0.0f;
+            if (lengthSquared > 0.0f)
+            {
+                float const inverseLength = 1.0f / std::sqrt(lengthSquared);
+                for (auto & value : axis)
+                {
+                    value *= inverseLength;
+                }
+
+                tMin = std::numeric_limits<float>::max();
+                tMax = std::numeric_limits<float>::lowest();
+                for (auto const & texel : texels)
+                {
+                    float t = 0.0f;
+                    for (uint32_t c = 0; c < Channels; ++c)
+                    {
+                        t += (texel[c] - mean[c]) * axis[c];
+                    }
+                    tMin = std::min(tMin, t);
+                    tMax = std::max(tMax, t);
+                }
+            }
+
+            for (uint32_t c = 0; c < Channels; ++c)
+            {
+                outLow[c] = ClampUnorm8(mean[c] + tMin * axis[c]);
+                outHigh[c] = ClampUnorm8(mean[c] + tMax * axis[c]);
+            }
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        // Nearest palette entry of every texel, returns the squared error of the block
+        template<uint32_t Channels, uint32_t PaletteSize>
+        uint32_t SelectIndices(
+            Texels const & texels,
+            uint8_t const (&palette)[PaletteSize][4],
+            Indices & outIndices
+        )
+        {
+            uint32_t totalError = 0;
+            for (uint32_t i = 0; i < TexelCount; ++i)
+            {
+                uint32_t bestError = std::numeric_limits<uint32_t>::max();
+                for (uint32_t k = 0; k < PaletteSize; ++k)
+                {
+                    uint32_t error = 0;
+                    for (uint32_t c = 0; c < Channels; ++c)
+                    {
+                        int const difference = static_cast<int>(texels[i][c]) - palette[k][c];
+                        error += static_cast<uint32_t>(difference * difference);
+                    }
+                    if (error < bestError)
+                    {
+                        bestError = error;
+                        outIndices[i] = static_cast<uint8_t>(k);
+                    }
+                }
+                totalError += bestError;
+            }
+            return totalError;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        template<uint32_t PaletteSize>
+        uint32_t SelectScalarIndices(
+            Values const & values,
+            uint8_t const (&palette)[PaletteSize],
+            Indices & outIndices
+        )
+        {
+            uint32_t totalError = 0;
+            for (uint32_t i = 0; i < TexelCount; ++i)
+            {
+                uint32_t bestError = std::numeric_limits<uint32_t>::max();
+                for (uint32_t k = 0; k < PaletteSize; ++k)
+                {
+                    int const difference = static_cast<int>(values[i]) - palette[k];
+                    auto const error = static_cast<uint32_t>(difference * difference);
+                    if (error < bestError)
+                    {
+                        bestError = error;
+                        outIndices[i] = static_cast<uint8_t>(k);
+                    }
+                }
+                totalError += bestError;
+            }
+            return totalError;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        // Least squares endpoints for fixed indices. Weights are the position of each index between the endpoints.
+        // Returns false when the texels do not constrain both endpoints.
+        template<uint32_t Channels, uint32_t PaletteSize>
+        bool SolveEndpoints(
+            Texels const & texels,
+            Indices const & indices,
+            float const (&weights)[PaletteSize],
+            float (&outLow)[4],
+            float (&outHigh)[4]
+        )
+        {
+            float aa = 0.0f;
+            float ab = 0.0f;
+            float bb = 0.0f;
+            float lowSum[Channels]{};
+            float highSum[Channels]{};
+            for (uint32_t i = 0; i < TexelCount; ++i)
+            {
+                float const w = weights[indices[i]];
+                float const u = 1.0f - w;
+                aa += u * u;
+                ab += u * w;
+                bb += w * w;
+                for (uint32_t c = 0; c < Channels; ++c)
+                {
+                    lowSum[c] += u * texels[i][c];
+                    highSum[c] += w * texels[i][c];
+                }
+            }
+
+            float const determinant = aa * bb - ab * ab;
+            if (std::abs(determinant) < 1e-4f)
+            {
+                return false;
+            }
+            float const inverse = 1.0f / determinant;
+            for (uint32_t c = 0; c < Channels; ++c)
+            {
+                outLow[c] = ClampUnorm8((bb * lowSum[c] - ab * highSum[c]) * inverse);
+                outHigh[c] = ClampUnorm8((aa * highSum[c] - ab * lowSum[c]) * inverse);
+            }
+            return true;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        template<uint32_t PaletteSize>
+        bool SolveScalarEndpoints(
+            Values const & values,
+            Indices const & indices,
+            float const (&weights)[PaletteSize],
+            float & outLow,
+            float & outHigh
+        )
+        {
+            Texels texels{};
+            for (uint32_t i = 0; i < TexelCount; ++i)
+            {
+                texels[i][0] = values[i];
+            }
+            float low[4]{};
+            float high[4]{};
+            if (SolveEndpoints<1>(texels, indices, weights, low, high) == false)
+            {
+                return false;
+            }
+            outLow = low[0];
+            outHigh = high[0];
+            return true;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        uint8_t RoundUnorm8(float const value)
+        {
+            return static_cast<uint8_t>(std::lround(ClampUnorm8(value)));
+        }
+
+        //-------------------------------------------------------------------------------------------------
+        // BC1
+        //-------------------------------------------------------------------------------------------------
+
+        // Palette in order of weight, the block stores the endpoints at index 0 and 1 and the two colors between them
+        // at 2 and 3
+        constexpr uint8_t BC1_OrderToIndex[4]{0, 2, 3, 1};
+        constexpr float BC1_Weights[4]{0.0f, 1.0f / 3.0f, 2.0f / 3.0f, 1.0f};
+
+        struct BC1_Candidate
+        {
+            uint16_t color0 = 0;
+            uint16_t color1 = 0;
+            Indices indices{};                          // In order of weight
+            uint32_t error = std::numeric_limits<uint32_t>::max();
+        };
+
+        //-------------------------------------------------------------------------------------------------
+
+        uint16_t QuantizeRGB565(float const (&color)[4])
+        {
+            auto const r = static_cast<uint32_t>(std::lround(ClampUnorm8(color[0]) * 31.0f / 255.0f));
+            auto const g = static_cast<uint32_t>(std::lround(ClampUnorm8(color[1]) * 63.0f / 255.0f));
+            auto const b = static_cast<uint32_t>(std::lround(ClampUnorm8(color[2]) * 31.0f / 255.0f));
+            return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        void ExpandRGB565(uint16_t const color, uint8_t (&outColor)[4])
+        {
+            uint32_t const r = (color >> 11) & 31;
+            uint32_t const g = (color >> 5) & 63;
+            uint32_t const b = color & 31;
+            outColor[0] = static_cast<uint8_t>((r << 3) | (r >> 2));
+            outColor[1] = static_cast<uint8_t>((g << 2) | (g >> 4));
+            outColor[2] = static_cast<uint8_t>((b << 3) | (b >> 2));
+            outColor[3] = 255;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        void EvaluateBC1(
+            Texels const & texels,
+            float const (&low)[4],
+            float const (&high)[4],
+            BC1_Candidate & outCandidate
+        )
+        {
+            outCandidate.color0 = QuantizeRGB565(low);
+            outCandidate.color1 = QuantizeRGB565(high);
+
+            uint8_t palette[4][4]{};
+            ExpandRGB565(outCandidate.color0, palette[0]);
+            ExpandRGB565(outCandidate.color1, palette[3]);
+            for (uint32_t c = 0; c < 3; ++c)
+            {
+                palette[1][c] = static_cast<uint8_t>((2 * palette[0][c] + palette[3][c] + 1) / 3);
+                palette[2][c] = static_cast<uint8_t>((palette[0][c] + 2 * palette[3][c] + 1) / 3);
+            }
+            outCandidate.error = SelectIndices<3>(texels, palette, outCandidate.indices);
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        // Opaque four color blocks only, the three color mode would need color0 <= color1
+        void EncodeBC1(Texels const & texels, EncoderSettings const & settings, uint8_t * destination)
+        {
+            float low[4]{};
+            float high[4]{};
+            FitPrincipalAxis<3>(texels, settings.powerIterations, low, high);
+
+            BC1_Candidate best{};
+            EvaluateBC1(texels, low, high, best);
+            for (uint32_t refinement = 0; refinement < settings.refinements && best.error > 0; ++refinement)
+            {
+                if (SolveEndpoints<3>(texels, best.indices, BC1_Weights, low, high) == false)
+                {
+                    break;
+                }
+                BC1_Candidate candidate{};
+                EvaluateBC1(texels, low, high, candidate);
+                if (candidate.error >= best.error)
+                {
+                    break;
+                }
+                best = candidate;
+            }
+
+            // Swapping the endpoints reverses the palette. Equal endpoints decode as the three color mode, where index
+            // 0 is still the first endpoint.
+            auto color0 = best.color0;
+            auto color1 = best.color1;
+            bool const swapEndpoints = color0 < color1;
+            if (swapEndpoints)
+            {
+                std::swap(color0, color1);
+            }
+
+            BlockWriter writer{};
+            writer.Write(color0, 16);
+            writer.Write(color1, 16);
+            for (auto const order : best.indices)
+            {
+                uint32_t index = 0;
+                if (color0 != color1)
+                {
+                    index = BC1_OrderToIndex[swapEndpoints ? 3 - order : order];
+                }
+                writer.Write(index, 2);
+            }
+            writer.Store(destination);
+        }
+
+        //-------------------------------------------------------------------------------------------------
+        // BC4
+        //-------------------------------------------------------------------------------------------------
+
+        // Weights in index order of the eight value mode
+        constexpr float BC4_Weights[8]{
+            0.0f, 1.0f, 1.0f / 7.0f, 2.0f / 7.0f, 3.0f / 7.0f, 4.0f / 7.0f, 5.0f / 7.0f, 6.0f / 7.0f
+        };
+
+        struct BC4_Candidate
+        {
+            uint8_t value0 = 0;
+            uint8_t value1 = 0;
+            Indices indices{};
+            uint32_t error = std::numeric_limits<uint32_t>::max();
+        };
+
+        //-------------------------------------------------------------------------------------------------
+
+        // value0 > value1 interpolates eight values, otherwise six plus 0 and 255
+        void EvaluateBC4(
+            Values const & values,
+            uint8_t const value0,
+            uint8_t const value1,
+            BC4_Candidate & outCandidate
+        )
+        {
+            uint8_t palette[8]{value0, value1};
+            if (value0 > value1)
+            {
+                for (uint32_t i = 2; i < 8; ++i)
+                {
+                    palette[i] = static_cast<uint8_t>(((8 - i) * value0 + (i - 1) * value1 + 3) / 7);
+                }
+            }
+            else
+            {
+                for (uint32_t i = 2; i < 6; ++i)
+                {
+                    palette[i] = static_cast<uint8_t>(((6 - i) * value0 + (i - 1) * value1 + 2) / 5);
+                }
+                palette[6] = 0;
+                palette[7] = 255;
+            }
+            outCandidate.value0 = value0;
+            outCandidate.value1 = value1;
+            outCandidate.error = SelectScalarIndices(values, palette, outCandidate.indices);
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        void EncodeBC4(Values const & values, EncoderSettings const & settings, uint8_t * destination)
+        {
+            auto const [minIt, maxIt] = std::minmax_element(std::begin(values), std::end(values));
+
+            BC4_Candidate best{};
+            EvaluateBC4(values, *maxIt, *minIt, best);
+            for (uint32_t refinement = 0; refinement < settings.refinements && best.error > 0; ++refinement)
+            {
+                if (best.value0 <= best.value1)
+                {
+                    break;
+                }
+                float low = 0.0f;
+                float high = 0.0f;
+                if (SolveScalarEndpoints(values, best.indices, BC4_Weights, low, high) == false)
+                {
+                    break;
+                }
+                auto const value0 = RoundUnorm8(std::max(low, high));
+                auto const value1 = RoundUnorm8(std::min(low, high));
+                BC4_Candidate candidate{};
+                EvaluateBC4(values, value0, value1, candidate);
+                if (candidate.error >= best.error)
+                {
+                    break;
+                }
+                best = candidate;
+            }
+
+            // The fixed 0 and 255 of the six value mode leave the interpolated values to the rest of the block
+            if (settings.sixValueMode && best.error > 0)
+            {
+                uint8_t innerMin = 255;
+                uint8_t innerMax = 0;
+                for (auto const value : values)
+                {
+                    if (value != 0 && value != 255)
+                    {
+                        innerMin = std::min(innerMin, value);
+                        innerMax = std::max(innerMax, value);
+                    }
+                }
+                if (innerMin > innerMax)
+                {
+                    innerMin = innerMax = 0;
+                }
+                BC4_Candidate candidate{};
+                EvaluateBC4(values, innerMin, innerMax, candidate);
+                if (candidate.error < best.error)
+                {
+                    best = candidate;
+                }
+            }
+
+            BlockWriter writer{};
+            writer.Write(best.value0, 8);
+            writer.Write(best.value1, 8);
+            for (auto const index : best.indices)
+            {
+                writer.Write(index, 3);
+            }
+            writer.Store(destination);
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        void EncodeBC4(
+            Texels const & texels,
+            uint32_t const channel,
+            EncoderSettings const & settings,
+            uint8_t * destination
+        )
+        {
+            Values values{};
+            for (uint32_t i = 0; i < TexelCount; ++i)
+            {
+                values[i] = texels[i][channel];
+            }
+            EncodeBC4(values, settings, destination);
+        }
+
+        //-------------------------------------------------------------------------------------------------
+        // BC7, single subset modes 5 and 6
+        //-------------------------------------------------------------------------------------------------
+
+        constexpr uint32_t BC7_Weights2[4]{0, 21, 43, 64};
+        constexpr uint32_t BC7_Weights4[16]{0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+        constexpr float BC7_UnitWeights2[4]{0.0f, 21.0f / 64.0f, 43.0f / 64.0f, 1.0f};
+        constexpr float BC7_UnitWeights4[16]{
+            0.0f / 64.0f, 4.0f / 64.0f, 9.0f / 64.0f, 13.0f / 64.0f,
+            17.0f / 64.0f, 21.0f / 64.0f, 26.0f / 64.0f, 30.0f / 64.0f,
+            34.0f / 64.0f, 38.0f / 64.0f, 43.0f / 64.0f, 47.0f / 64.0f,
+            51.0f / 64.0f, 55.0f / 64.0f, 60.0f / 64.0f, 64.0f / 64.0f
+        };
+
+        //-------------------------------------------------------------------------------------------------
+
+        uint8_t BC7_Interpolate(uint32_t const endpoint0, uint32_t const endpoint1, uint32_t const weight)
+        {
+            return static_cast<uint8_t>(((64 - weight) * endpoint0 + weight * endpoint1 + 32) >> 6);
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        // Mode 6: rgba endpoints of 7 bits and a p-bit each, 4 bit indices
+        struct Mode6_Candidate
+        {
+            uint8_t endpoints[2][4]{};                  // 7 bits
+            uint8_t pBits[2]{};
+            Indices indices{};
+            uint32_t error = std::numeric_limits<uint32_t>::max();
+        };
+
+        //-------------------------------------------------------------------------------------------------
+
+        // The p-bit is the lowest bit of every channel of the endpoint
+        void QuantizeMode6(
+            float const (&endpoint)[4],
+            uint32_t const pBit,
+            uint8_t (&outQuantized)[4],
+            uint8_t (&outExpanded)[4]
+        )
+        {
+            for (uint32_t c = 0; c < 4; ++c)
+            {
+                auto const halved = (endpoint[c] - static_cast<float>(pBit)) * 0.5f;
+                auto const quantized = std::clamp<long>(std::lround(halved), 0, 127);
+                outQuantized[c] = static_cast<uint8_t>(quantized);
+                outExpanded[c] = static_cast<uint8_t>((quantized << 1) | pBit);
+            }
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        float Mode6_QuantizationError(float const (&endpoint)[4], uint32_t const pBit)
+        {
+            uint8_t quantized[4]{};
+            uint8_t expanded[4]{};
+            QuantizeMode6(endpoint, pBit, quantized, expanded);
+            float error = 0.0f;
+            for (uint32_t c = 0; c < 4; ++c)
+            {
+                float const difference = endpoint[c] - expanded[c];
+                error += difference * difference;
+            }
+            return error;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        void EvaluateMode6(
+            Texels const & texels,
+            float const (&low)[4],
+            float const (&high)[4],
+            uint32_t const pBit0,
+            uint32_t const pBit1,
+            Mode6_Candidate & outCandidate
+        )
+        {
+            uint8_t expanded[2][4]{};
+            QuantizeMode6(low, pBit0, outCandidate.endpoints[0], expanded[0]);
+            QuantizeMode6(high, pBit1, outCandidate.endpoints[1], expanded[1]);
+            outCandidate.pBits[0] = static_cast<uint8_t>(pBit0);
+            outCandidate.pBits[1] = static_cast<uint8_t>(pBit1);
+
+            uint8_t palette[16][4]{};
+            for (uint32_t k = 0; k < 16; ++k)
+            {
+                for (uint32_t c = 0; c < 4; ++c)
+                {
+                    palette[k][c] = BC7_Interpolate(expanded[0][c], expanded[1][c], BC7_Weights4[k]);
+                }
+            }
+            outCandidate.error = SelectIndices<4>(texels, palette, outCandidate.indices);
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        // Opaque blocks keep p-bits of 1 so their alpha stays exactly 255
+        void EvaluateMode6Endpoints(
+            Texels const & texels,
+            float const (&low)[4],
+            float const (&high)[4],
+            bool const opaque,
+            EncoderSettings const & settings,
+            Mode6_Candidate & outCandidate
+        )
+        {
+            if (opaque)
+            {
+                EvaluateMode6(texels, low, high, 1, 1, outCandidate);
+            }
+            else if (settings.searchPBits)
+            {
+                for (uint32_t pBits = 0; pBits < 4; ++pBits)
+                {
+                    Mode6_Candidate candidate{};
+                    EvaluateMode6(texels, low, high, pBits & 1, pBits >> 1, candidate);
+                    if (candidate.error < outCandidate.error)
+                    {
+                        outCandidate = candidate;
+                    }
+                }
+            }
+            else
+            {
+                uint32_t const pBit0 = Mode6_QuantizationError(low, 1) < Mode6_QuantizationError(low, 0) ? 1 : 0;
+                uint32_t const pBit1 = Mode6_QuantizationError(high, 1) < Mode6_QuantizationError(high, 0) ? 1 : 0;
+                EvaluateMode6(texels, low, high, pBit0, pBit1, outCandidate);
+            }
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        Mode6_Candidate EncodeMode6(Texels const & texels, bool const opaque, EncoderSettings const & settings)
+        {
+            float low[4]{};
+            float high[4]{};
+            FitPrincipalAxis<4>(texels, settings.powerIterations, low, high);
+
+            Mode6_Candidate best{};
+            EvaluateMode6Endpoints(texels, low, high, opaque, settings, best);
+            for (uint32_t refinement = 0; refinement < settings.refinements && best.error > 0; ++refinement)
+            {
+                if (SolveEndpoints<4>(texels, best.indices, BC7_UnitWeights4, low, high) == false)
+                {
+                    break;
+                }
+                Mode6_Candidate candidate{};
+                EvaluateMode6Endpoints(texels, low, high, opaque, settings, candidate);
+                if (candidate.error >= best.error)
+                {
+                    break;
+                }
+                best = candidate;
+            }
+            return best;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        // The highest bit of the first index is not stored, so the endpoints are swapped when it would be set
+        void WriteMode6(Mode6_Candidate candidate, uint8_t * destination)
+        {
+            if (candidate.indices[0] >= 8)
+            {
+                std::swap(candidate.endpoints[0], candidate.endpoints[1]);
+                std::swap(candidate.pBits[0], candidate.pBits[1]);
+                for (auto & index : candidate.indices)
+                {
+                    index = static_cast<uint8_t>(15 - index);
+                }
+            }
+
+            BlockWriter writer{};
+            writer.Write(1u << 6, 7);
+            for (uint32_t c = 0; c < 4; ++c)
+            {
+                writer.Write(candidate.endpoints[0][c], 7);
+                writer.Write(candidate.endpoints[1][c], 7);
+            }
+            writer.Write(candidate.pBits[0], 1);
+            writer.Write(candidate.pBits[1], 1);
+            writer.Write(candidate.indices[0], 3);
+            for (uint32_t i = 1; i < TexelCount; ++i)
+            {
+                writer.Write(candidate.indices[i], 4);
+            }
+            writer.Store(destination);
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        // Mode 5: rgb endpoints of 7 bits and alpha endpoints of 8 bits with their own 2 bit indices, no rotation
+        struct Mode5_Candidate
+        {
+            uint8_t colorEndpoints[2][3]{};             // 7 bits
+            uint8_t alphaEndpoints[2]{};
+            Indices colorIndices{};
+            Indices alphaIndices{};
+            uint32_t colorError = std::numeric_limits<uint32_t>::max();
+            uint32_t alphaError = std::numeric_limits<uint32_t>::max();
+        };
+
+        //-------------------------------------------------------------------------------------------------
+
+        void EvaluateMode5Color(
+            Texels const & texels,
+            float const (&low)[4],
+            float const (&high)[4],
+            Mode5_Candidate & outCandidate
+        )
+        {
+            uint8_t expanded[2][3]{};
+            for (uint32_t c = 0; c < 3; ++c)
+            {
+                auto const quantized0 = static_cast<uint32_t>(std::lround(low[c] * 127.0f / 255.0f));
+                auto const quantized1 = static_cast<uint32_t>(std::lround(high[c] * 127.0f / 255.0f));
+                outCandidate.colorEndpoints[0][c] = static_cast<uint8_t>(quantized0);
+                outCandidate.colorEndpoints[1][c] = static_cast<uint8_t>(quantized1);
+                expanded[0][c] = static_cast<uint8_t>((quantized0 << 1) | (quantized0 >> 6));
+                expanded[1][c] = static_cast<uint8_t>((quantized1 << 1) | (quantized1 >> 6));
+            }
+
+            uint8_t palette[4][4]{};
+            for (uint32_t k = 0; k < 4; ++k)
+            {
+                for (uint32_t c = 0; c < 3; ++c)
+                {
+                    palette[k][c] = BC7_Interpolate(expanded[0][c], expanded[1][c], BC7_Weights2[k]);
+                }
+            }
+            outCandidate.colorError = SelectIndices<3>(texels, palette, outCandidate.colorIndices);
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        void EvaluateMode5Alpha(
+            Values const & alpha,
+            uint8_t const alpha0,
+            uint8_t const alpha1,
+            Mode5_Candidate & outCandidate
+        )
+        {
+            outCandidate.alphaEndpoints[0] = alpha0;
+            outCandidate.alphaEndpoints[1] = alpha1;
+            uint8_t palette[4]{};
+            for (uint32_t k = 0; k < 4; ++k)
+            {
+                palette[k] = BC7_Interpolate(alpha0, alpha1, BC7_Weights2[k]);
+            }
+            outCandidate.alphaError = SelectScalarIndices(alpha, palette, outCandidate.alphaIndices);
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        // Color and alpha are independent in this mode, so each keeps its own best refinement
+        Mode5_Candidate EncodeMode5(Texels const & texels, EncoderSettings const & settings)
+        {
+            Mode5_Candidate best{};
+
+            float low[4]{};
+            float high[4]{};
+            FitPrincipalAxis<3>(texels, settings.powerIterations, low, high);
+            EvaluateMode5Color(texels, low, high, best);
+            for (uint32_t refinement = 0; refinement < settings.refinements && best.colorError > 0; ++refinement)
+            {
+                if (SolveEndpoints<3>(texels, best.colorIndices, BC7_UnitWeights2, low, high) == false)
+                {
+                    break;
+                }
+                Mode5_Candidate candidate = best;
+                EvaluateMode5Color(texels, low, high, candidate);
+                if (candidate.colorError >= best.colorError)
+                {
+                    break;
+                }
+                best = candidate;
+            }
+
+            Values alpha{};
+            for (uint32_t i = 0; i < TexelCount; ++i)
+            {
+                alpha[i] = texels[i][3];
+            }
+            auto const [minIt, maxIt] = std::minmax_element(std::begin(alpha), std::end(alpha));
+            EvaluateMode5Alpha(alpha, *minIt, *maxIt, best);
+            for (uint32_t refinement = 0; refinement < settings.refinements && best.alphaError > 0; ++refinement)
+            {
+                float alphaLow = 0.0f;
+                float alphaHigh = 0.0f;
+                if (SolveScalarEndpoints(alpha, best.alphaIndices, BC7_UnitWeights2, alphaLow, alphaHigh) == false)
+                {
+                    break;
+                }
+                Mode5_Candidate candidate = best;
+                EvaluateMode5Alpha(alpha, RoundUnorm8(alphaLow), RoundUnorm8(alphaHigh), candidate);
+                if (candidate.alphaError >= best.alphaError)
+                {
+                    break;
+                }
+                best = candidate;
+            }
+            return best;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        void WriteMode5(Mode5_Candidate candidate, uint8_t * destination)
+        {
+            if (candidate.colorIndices[0] >= 2)
+            {
+                std::swap(candidate.colorEndpoints[0], candidate.colorEndpoints[1]);
+                for (auto & index : candidate.colorIndices)
+                {
+                    index = static_cast<uint8_t>(3 - index);
+                }
+            }
+            if (candidate.alphaIndices[0] >= 2)
+            {
+                std::swap(candidate.alphaEndpoints[0], candidate.alphaEndpoints[1]);
+                for (auto & index : candidate.alphaIndices)
+                {
+                    index = static_cast<uint8_t>(3 - index);
+                }
+            }
+
+            BlockWriter writer{};
+            writer.Write(1u << 5, 6);
+            writer.Write(0, 2);
+            for (uint32_t c = 0; c < 3; ++c)
+            {
+                writer.Write(candidate.colorEndpoints[0][c], 7);
+                writer.Write(candidate.colorEndpoints[1][c], 7);
+            }
+            writer.Write(candidate.alphaEndpoints[0], 8);
+            writer.Write(candidate.alphaEndpoints[1], 8);
+            writer.Write(candidate.colorIndices[0], 1);
+            for (uint32_t i = 1; i < TexelCount; ++i)
+            {
+                writer.Write(candidate.colorIndices[i], 2);
+            }
+            writer.Write(candidate.alphaIndices[0], 1);
+            for (uint32_t i = 1; i < TexelCount; ++i)
+            {
+                writer.Write(candidate.alphaIndices[i], 2);
+            }
+            writer.Store(destination);
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        void EncodeBC7(Texels const & texels, EncoderSettings const & settings, uint8_t * destination)
+        {
+            bool opaque = true;
+            bool alphaVaries = false;
+            for (auto const & texel : texels)
+            {
+                opaque &= texel[3] == 255;
+                alphaVaries |= texel[3] != texels[0][3];
+            }
+
+            auto const mode6 = EncodeMode6(texels, opaque, settings);
+            if (mode6.error > 0 && (settings.separateAlphaForAll || (settings.separateAlpha && alphaVaries)))
+            {
+                auto const mode5 = EncodeMode5(texels, settings);
+                if (mode5.colorError + mode5.alphaError < mode6.error)
+                {
+                    WriteMode5(mode5, destination);
+                    return;
+                }
+            }
+            WriteMode6(mode6, destination);
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        // Edge blocks repeat the last column and row of the image
+        void LoadTexels(
+            uint8_t const * pixels,
+            uint32_t const width,
+            uint32_t const height,
+            uint32_t const components,
+            uint32_t const blockX,
+            uint32_t const blockY,
+            Texels & outTexels
+        )
+        {
+            for (uint32_t y = 0; y < BlockSide; ++y)
+            {
+                uint32_t const sourceY = std::min(blockY * BlockSide + y, height - 1);
+                for (uint32_t x = 0; x < BlockSide; ++x)
+                {
+                    uint32_t const sourceX = std::min(blockX * BlockSide + x, width - 1);
+                    auto const * source = pixels + (static_cast<size_t>(sourceY) * width + sourceX) * components;
+                    auto & texel = outTexels[y * BlockSide + x];
+                    texel[0] = texel[1] = texel[2] = 0;
+                    texel[3] = 255;
+                    for (uint32_t c = 0; c < components; ++c)
+                    {
+                        texel[c] = source[c];
+                    }
+                }
+            }
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        void EncodeBlock(
+            Format const format,
+            Texels const & texels,
+            EncoderSettings const & settings,
+            uint8_t * destination
+        )
+        {
+            switch (format)
+            {
+            case Format::BC1_UNorm_Linear_RGB:
+            case Format::BC1_UNorm_sRGB_RGB:
+                EncodeBC1(texels, settings, destination);
+                break;
+            case Format::BC4_UNorm_Linear_R:
+                EncodeBC4(texels, 0, settings, destination);
+                break;
+            case Format::BC5_UNorm_Linear_RG:
+                EncodeBC4(texels, 0, settings, destination);
+                EncodeBC4(texels, 1, settings, destination + 8);
+                break;
+            case Format::BC7_UNorm_Linear_RGB:
+            case Format::BC7_UNorm_Linear_RGBA:
+            case Format::BC7_UNorm_sRGB_RGB:
+            case Format::BC7_UNorm_sRGB_RGBA:
+                EncodeBC7(texels, settings, destination);
+                break;
+            default:
+                MFA_CRASH("Unsupported block format %d", static_cast<int>(format));
+            }
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        void CompressImage(
+            uint8_t const * pixels,
+            uint32_t const width,
+            uint32_t const height,
+            uint32_t const components,
+            Format const format,
+            EncoderSettings const & settings,
+            uint8_t * destination
+        )
+        {
+            uint32_t const blocksX = (width + BlockSide - 1) / BlockSide;
+            uint32_t const blocksY = (height + BlockSide - 1) / BlockSide;
+            size_t const blockSize = AS::Texture::FormatTable[static_cast<uint8_t>(format)].bits_total * TexelCount / 8;
+
+            auto const encodeBlocks = [&](int const begin, int const end)->void
+            {
+                Texels texels{};
+                for (int block = begin; block < end; ++block)
+                {
+                    auto const blockX = static_cast<uint32_t>(block) % blocksX;
+                    auto const blockY = static_cast<uint32_t>(block) / blocksX;
+                    LoadTexels(pixels, width, height, components, blockX, blockY, texels);
+                    EncodeBlock(format, texels, settings, destination + static_cast<size_t>(block) * blockSize);
+                }
+            };
+
+            auto const blockCount = static_cast<int>(blocksX * blocksY);
+            if (JS::Instance != nullptr)
+            {
+                JS::Instance->ParallelFor(blockCount, MinBlocksPerJob, encodeBlocks);
+            }
+            else
+            {
+                encodeBlocks(0, blockCount);
+            }
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        bool IsOpaque(AS::Texture const & texture)
+        {
+            auto const & formatInfo = AS::Texture::FormatTable[static_cast<uint8_t>(texture.GetFormat())];
+            if (formatInfo.component_count != 4)
+            {
+                return true;
+            }
+            auto const & baseLevel = texture.GetMipmap(0);
+            auto const * pixels = texture.GetBuffer()->Ptr() + baseLevel.offset;
+            for (size_t i = 3; i < baseLevel.size; i += 4)
+            {
+                if (pixels[i] != 255)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    Format BlockCompressedFormat(
+        Format const sourceFormat,
+        TextureUsage const usage,
+        CompressionQuality const quality,
+        bool const opaque
+    )
+    {
+        auto const & formatInfo = AS::Texture::FormatTable[static_cast<uint8_t>(sourceFormat)];
+        if (sourceFormat == Format::INVALID || formatInfo.compression != 0)
+        {
+            return Format::INVALID;
+        }
+
+        bool const sRGB = formatInfo.color_space == 1;
+        switch (formatInfo.component_count)
+        {
+        case 1:
+            // There is no sRGB BC4
+            return sRGB ? Format::INVALID : Format::BC4_UNorm_Linear_R;
+        case 2:
+            return Format::BC5_UNorm_Linear_RG;
+        case 4:
+            break;
+        default:
+            return Format::INVALID;
+        }
+
+        switch (usage)
+        {
+        case TextureUsage::Normal:
+            return sRGB ? Format::INVALID : Format::BC5_UNorm_Linear_RG;
+        case TextureUsage::Mask:
+            return sRGB ? Format::INVALID : Format::BC4_UNorm_Linear_R;
+        case TextureUsage::Color:
+            break;
+        }
+
+        if (opaque && quality == CompressionQuality::Fast)
+        {
+            return sRGB ? Format::BC1_UNorm_sRGB_RGB : Format::BC1_UNorm_Linear_RGB;
+        }
+        if (sRGB)
+        {
+            return opaque ? Format::BC7_UNorm_sRGB_RGB : Format::BC7_UNorm_sRGB_RGBA;
+        }
+        return opaque ? Format::BC7_UNorm_Linear_RGB : Format::BC7_UNorm_Linear_RGBA;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    std::shared_ptr<AS::Texture> CompressTexture(
+        AS::Texture const & texture,
+        TextureUsage const usage,
+        CompressionQuality const quality
+    )
+    {
+        MFA_ASSERT(texture.isValid());
+
+        auto const sourceFormat = texture.GetFormat();
+        auto const format = BlockCompressedFormat(sourceFormat, usage, quality, IsOpaque(texture));
+        if (format == Format::INVALID)
+        {
+            return nullptr;
+        }
+
+        auto const mipCount = texture.GetMipCount();
+        auto const slices = texture.GetSlices();
+        size_t bufferSize = 0;
+        for (uint8_t mipLevel = 0; mipLevel < mipCount; ++mipLevel)
+        {
+            bufferSize += AS::Texture::MipSizeBytes(format, slices, texture.GetMipmap(mipLevel).dimension);
+        }
+
+        auto compressedTexture = std::make_shared<AS::Texture>(format, slices, texture.GetDepth(), bufferSize);
+
+        auto const settings = GetSettings(quality);
+        auto const components = AS::Texture::FormatTable[static_cast<uint8_t>(sourceFormat)].component_count;
+        auto const * sourceBuffer = texture.GetBuffer()->Ptr();
+        for (uint8_t mipLevel = 0; mipLevel < mipCount; ++mipLevel)
+        {
+            auto const & mipmap = texture.GetMipmap(mipLevel);
+            auto const & dimension = mipmap.dimension;
+            auto * destination = compressedTexture->addMipmap(
+                dimension,
+                AS::Texture::MipSizeBytes(format, slices, dimension)
+            );
+
+            // Every slice and depth layer is a separate image of blocks
+            AS::Texture::Dimensions const layerDimension{dimension.width, dimension.height, 1};
+            auto const sourceLayerSize = AS::Texture::MipSizeBytes(sourceFormat, 1, layerDimension);
+            auto const destinationLayerSize = AS::Texture::MipSizeBytes(format, 1, layerDimension);
+            uint32_t const layerCount = static_cast<uint32_t>(slices) * std::max<uint16_t>(dimension.depth, 1);
+            for (uint32_t layer = 0; layer < layerCount; ++layer)
+            {
+                CompressImage(
+                    sourceBuffer + mipmap.offset + layer * sourceLayerSize,
+                    dimension.width,
+                    dimension.height,
+                    components,
+                    format,
+                    settings,
+                    destination + layer * destinationLayerSize
+                );
+            }
+        }
+
+        MFA_ASSERT(compressedTexture->isValid());
+        return compressedTexture;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "AssetTexture.hpp"
+
+#include <cstdint>
+#include <memory>
+
+// Encodes uncompressed textures to BC1, BC4, BC5 or BC7 at import time. The format follows what the texture is used
+// for, so a material keeps the channels it samples at 4 or 8 bits per pixel instead of 32. Every mip and slice is
+// encoded and the blocks are split across the job system.
+namespace MFA::Importer
+{
+
+    enum class TextureUsage : uint8_t
+    {
+        Color,                                  // BC7, or BC1 for opaque textures with the fast preset
+        Normal,                                 // BC5 keeps x and y, z has to be reconstructed by the shader
+        Mask                                    // BC4 keeps the red channel, for occlusion or single channel masks
+    };
+
+    enum class CompressionQuality : uint8_t
+    {
+        Fast,                                   // Endpoints from the principal axis only
+        Balanced,                               // One least squares refinement and the p-bits of both endpoints
+        High                                    // More refinements, BC7 also tries separate alpha for every block
+    };
+
+    // Block format the texture would be encoded to, INVALID when it has no block compressed counterpart.
+    // Opaque is whether every alpha value of a four channel texture is 255.
+    [[nodiscard]]
+    AS::Texture::Format BlockCompressedFormat(
+        AS::Texture::Format sourceFormat,
+        TextureUsage usage,
+        CompressionQuality quality,
+        bool opaque
+    );
+
+    // Returns nullptr when the format has no block compressed counterpart, for example sRGB single channel textures
+    // or textures that are compressed already
+    [[nodiscard]]
+    std::shared_ptr<AS::Texture> CompressTexture(
+        AS::Texture const & texture,
+        TextureUsage usage,
+        CompressionQuality quality
+    );
+
+}
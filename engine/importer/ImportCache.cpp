@@ -0,0 +1,467 @@
+#include "ImportCache.hpp"
+
+#include "BedrockAssert.hpp"
+#include "BedrockFile.hpp"
+#include "BedrockLog.hpp"
+
+#include <bit>
+#include <cinttypes>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+
+namespace MFA::Importer
+{
+
+    namespace
+    {
+
+        constexpr char Magic[8]{'M', 'F', 'A', 'C', 'A', 'C', 'H', 'E'};
+        // Part of every key, increasing it drops the whole cache
+        constexpr uint32_t Version = 1;
+        constexpr char const * ManifestExtension = ".mfacache";
+
+        struct ManifestHeader
+        {
+            char magic[8]{};
+            uint32_t version = 0;
+            uint32_t sourceCount = 0;
+            uint32_t metadataCount = 0;
+            uint32_t padding = 0;
+            uint64_t key = 0;
+        };
+
+        struct SourceStamp
+        {
+            uint64_t size = 0;
+            int64_t modifiedTime = 0;
+            uint64_t contentHash = 0;
+            uint32_t pathLength = 0;
+            uint32_t padding = 0;
+        };
+
+        //-------------------------------------------------------------------------------------------------
+
+        constexpr uint64_t Prime1 = 0x9E3779B185EBCA87ull;
+        constexpr uint64_t Prime2 = 0xC2B2AE3D27D4EB4Full;
+        constexpr uint64_t Prime3 = 0x165667B19E3779F9ull;
+        constexpr uint64_t Prime4 = 0x85EBCA77C2B2AE63ull;
+        constexpr uint64_t Prime5 = 0x27D4EB2F165667C5ull;
+
+        uint64_t Round(uint64_t accumulator, uint64_t const lane)
+        {
+            accumulator += lane * Prime2;
+            accumulator = std::rotl(accumulator, 31);
+            return accumulator * Prime1;
+        }
+
+        uint64_t Merge(uint64_t hash, uint64_t const accumulator)
+        {
+            hash ^= Round(0, accumulator);
+            return hash * Prime1 + Prime4;
+        }
+
+        template<typename T>
+        T ReadUnaligned(uint8_t const * data)
+        {
+            T value;
+            std::memcpy(&value, data, sizeof(T));
+            return value;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        bool ReadStamp(std::string const & path, uint64_t & outSize, int64_t & outModifiedTime)
+        {
+            std::error_code errorCode{};
+            auto const size = std::filesystem::file_size(path, errorCode);
+            if (errorCode)
+            {
+                return false;
+            }
+            auto const modifiedTime = std::filesystem::last_write_time(path, errorCode);
+            if (errorCode)
+            {
+                return false;
+            }
+            outSize = static_cast<uint64_t>(size);
+            outModifiedTime = static_cast<int64_t>(modifiedTime.time_since_epoch().count());
+            return true;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        bool HashFile(std::string const & path, uint64_t & outHash)
+        {
+            std::error_code errorCode{};
+            if (std::filesystem::file_size(path, errorCode) == 0 && !errorCode)
+            {// Empty files can not be mapped
+                outHash = ImportCache::HashContent(nullptr, 0);
+                return true;
+            }
+            auto const file = File::MappedFile::Open(path);
+            if (file == nullptr)
+            {
+                return false;
+            }
+            outHash = ImportCache::HashContent(file->Ptr(), file->Len());
+            return true;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        // Bounds checked reads over the mapped manifest
+        class ManifestReader
+        {
+        public:
+
+            explicit ManifestReader(uint8_t const * data, size_t const size)
+                : _data(data)
+                , _size(size)
+            {}
+
+            template<typename T>
+            bool Read(T & outValue)
+            {
+                if (_size - _offset < sizeof(T))
+                {
+                    return false;
+                }
+                outValue = ReadUnaligned<T>(_data + _offset);
+                _offset += sizeof(T);
+                return true;
+            }
+
+            bool Read(uint32_t const length, std::string & outText)
+            {
+                if (_size - _offset < length)
+                {
+                    return false;
+                }
+                outText.assign(reinterpret_cast<char const *>(_data + _offset), length);
+                _offset += length;
+                return true;
+            }
+
+            [[nodiscard]]
+            size_t Offset() const
+            {
+                return _offset;
+            }
+
+            [[nodiscard]]
+            bool IsAtEnd() const
+            {
+                return _offset == _size;
+            }
+
+        private:
+
+            uint8_t const * _data = nullptr;
+            size_t _size = 0;
+            size_t _offset = 0;
+
+        };
+
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    std::unique_ptr<ImportCache> ImportCache::Instantiate(std::string const & directory)
+    {
+        return std::make_unique<ImportCache>(directory);
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    ImportCache::ImportCache(std::string const & directory)
+        : _directory(directory)
+    {
+        MFA_ASSERT(Instance == nullptr);
+
+        std::error_code errorCode{};
+        std::filesystem::create_directories(_directory, errorCode);
+        if (errorCode)
+        {
+            MFA_LOG_WARN("Failed to create the import cache directory %s", _directory.c_str());
+        }
+
+        Instance = this;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    ImportCache::~ImportCache()
+    {
+        MFA_ASSERT(Instance == this);
+        Instance = nullptr;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    ImportCache::KeyBuilder::KeyBuilder(std::string_view const importer, std::string const & sourcePath)
+    {
+        std::error_code errorCode{};
+        auto const canonicalPath = std::filesystem::weakly_canonical(sourcePath, errorCode);
+        Add(Version);
+        Add(importer);
+        Add(errorCode ? sourcePath : canonicalPath.string());
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    ImportCache::KeyBuilder & ImportCache::KeyBuilder::Add(std::string_view const text)
+    {
+        Add(static_cast<uint64_t>(text.size()));
+        _data.append(text);
+        return *this;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    uint64_t ImportCache::KeyBuilder::Build() const
+    {
+        return HashContent(_data.data(), _data.size());
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    std::string ImportCache::PayloadPath(uint64_t const key, std::string_view const extension) const
+    {
+        char name[17]{};
+        std::snprintf(name, sizeof(name), "%016" PRIx64, key);
+        return (std::filesystem::path(_directory) / name).string() + std::string(extension);
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    std::string ImportCache::ManifestPath(uint64_t const key) const
+    {
+        return PayloadPath(key, ManifestExtension);
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    bool ImportCache::Find(uint64_t const key, std::vector<std::string> * outMetadata) const
+    {
+        auto file = File::MappedFile::Open(ManifestPath(key));
+        if (file == nullptr)
+        {
+            return false;
+        }
+
+        ManifestReader reader{file->Ptr(), file->Len()};
+        ManifestHeader header{};
+        if (
+            reader.Read(header) == false ||
+            std::memcmp(header.magic, Magic, sizeof(Magic)) != 0 ||
+            header.version != Version ||
+            header.key != key
+        )
+        {
+            return false;
+        }
+
+        // Sources that were touched without an edit, stored so the next lookup does not hash them again
+        std::vector<std::pair<size_t, int64_t>> touchedStamps{};
+        for (uint32_t i = 0; i < header.sourceCount; ++i)
+        {
+            SourceStamp stamp{};
+            std::string path{};
+            auto const stampOffset = reader.Offset();
+            if (reader.Read(stamp) == false || reader.Read(stamp.pathLength, path) == false)
+            {
+                return false;
+            }
+
+            uint64_t size = 0;
+            int64_t modifiedTime = 0;
+            if (ReadStamp(path, size, modifiedTime) == false || size != stamp.size)
+            {
+                return false;
+            }
+            if (modifiedTime != stamp.modifiedTime)
+            {
+                uint64_t contentHash = 0;
+                if (HashFile(path, contentHash) == false || contentHash != stamp.contentHash)
+                {
+                    return false;
+                }
+                touchedStamps.emplace_back(stampOffset + offsetof(SourceStamp, modifiedTime), modifiedTime);
+            }
+        }
+
+        std::vector<std::string> metadata(header.metadataCount);
+        for (auto & text : metadata)
+        {
+            uint32_t length = 0;
+            if (reader.Read(length) == false || reader.Read(length, text) == false)
+            {
+                return false;
+            }
+        }
+        if (reader.IsAtEnd() == false)
+        {
+            return false;
+        }
+
+        if (touchedStamps.empty() == false)
+        {
+            std::string manifest(reinterpret_cast<char const *>(file->Ptr()), file->Len());
+            for (auto const & [offset, modifiedTime] : touchedStamps)
+            {
+                std::memcpy(manifest.data() + offset, &modifiedTime, sizeof(modifiedTime));
+            }
+            // Unmapped first, the manifest is replaced by a rename
+            file.reset();
+            WriteFile(ManifestPath(key), [&manifest](std::ofstream & stream)->bool
+            {
+                stream.write(manifest.data(), static_cast<std::streamsize>(manifest.size()));
+                return stream.good();
+            });
+        }
+
+        if (outMetadata != nullptr)
+        {
+            *outMetadata = std::move(metadata);
+        }
+        return true;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    bool ImportCache::Commit(
+        uint64_t const key,
+        std::vector<std::string> const & sources,
+        std::vector<std::string> const & metadata
+    ) const
+    {
+        MFA_ASSERT(sources.empty() == false);
+
+        std::vector<SourceStamp> stamps(sources.size());
+        for (size_t i = 0; i < sources.size(); ++i)
+        {
+            auto & stamp = stamps[i];
+            if (
+                ReadStamp(sources[i], stamp.size, stamp.modifiedTime) == false ||
+                HashFile(sources[i], stamp.contentHash) == false
+            )
+            {
+                MFA_LOG_WARN("Import cache can not read source %s", sources[i].c_str());
+                return false;
+            }
+            stamp.pathLength = static_cast<uint32_t>(sources[i].size());
+        }
+
+        ManifestHeader header{
+            .version = Version,
+            .sourceCount = static_cast<uint32_t>(sources.size()),
+            .metadataCount = static_cast<uint32_t>(metadata.size()),
+            .key = key
+        };
+        std::memcpy(header.magic, Magic, sizeof(Magic));
+
+        return WriteFile(ManifestPath(key), [&](std::ofstream & file)->bool
+        {
+            file.write(reinterpret_cast<char const *>(&header), sizeof(header));
+            for (size_t i = 0; i < sources.size(); ++i)
+            {
+                file.write(reinterpret_cast<char const *>(&stamps[i]), sizeof(SourceStamp));
+                file.write(sources[i].data(), static_cast<std::streamsize>(sources[i].size()));
+            }
+            for (auto const & text : metadata)
+            {
+                auto const length = static_cast<uint32_t>(text.size());
+                file.write(reinterpret_cast<char const *>(&length), sizeof(length));
+                file.write(text.data(), static_cast<std::streamsize>(text.size()));
+            }
+            return file.good();
+        });
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    bool ImportCache::WriteFile(std::string const & path, std::function<bool(std::ofstream &)> const & write)
+    {
+        auto const temporaryPath = path + ".tmp";
+        bool success = false;
+        {
+            std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+            success = file.good() && write(file);
+        }
+
+        std::error_code errorCode{};
+        if (success)
+        {
+            std::filesystem::rename(temporaryPath, path, errorCode);
+            success = !errorCode;
+        }
+        if (success == false)
+        {
+            std::filesystem::remove(temporaryPath, errorCode);
+            MFA_LOG_WARN("Failed to write %s", path.c_str());
+        }
+        return success;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    uint64_t ImportCache::HashContent(void const * data, size_t const size, uint64_t const seed)
+    {
+        auto const * bytes = static_cast<uint8_t const *>(data);
+        auto const * const end = bytes + size;
+
+        uint64_t hash = 0;
+        if (size >= 32)
+        {// Four independent lanes keep the multipliers busy
+            uint64_t lanes[4]{seed + Prime1 + Prime2, seed + Prime2, seed, seed - Prime1};
+            auto const * const lastStripe = end - 32;
+            do
+            {
+                lanes[0] = Round(lanes[0], ReadUnaligned<uint64_t>(bytes));
+                lanes[1] = Round(lanes[1], ReadUnaligned<uint64_t>(bytes + 8));
+                lanes[2] = Round(lanes[2], ReadUnaligned<uint64_t>(bytes + 16));
+                lanes[3] = Round(lanes[3], ReadUnaligned<uint64_t>(bytes + 24));
+                bytes += 32;
+            } while (bytes <= lastStripe);
+
+            hash = std::rotl(lanes[0], 1) + std::rotl(lanes[1], 7) + std::rotl(lanes[2], 12) + std::rotl(lanes[3], 18);
+            for (auto const lane : lanes)
+            {
+                hash = Merge(hash, lane);
+            }
+        }
+        else
+        {
+            hash = seed + Prime5;
+        }
+        hash += static_cast<uint64_t>(size);
+
+        for (; end - bytes >= 8; bytes += 8)
+        {
+            hash ^= Round(0, ReadUnaligned<uint64_t>(bytes));
+            hash = std::rotl(hash, 27) * Prime1 + Prime4;
+        }
+        if (end - bytes >= 4)
+        {
+            hash ^= static_cast<uint64_t>(ReadUnaligned<uint32_t>(bytes)) * Prime1;
+            hash = std::rotl(hash, 23) * Prime2 + Prime3;
+            bytes += 4;
+        }
+        for (; bytes < end; ++bytes)
+        {
+            hash ^= static_cast<uint64_t>(*bytes) * Prime5;
+            hash = std::rotl(hash, 11) * Prime1;
+        }
+
+        hash ^= hash >> 33;
+        hash *= Prime2;
+        hash ^= hash >> 29;
+        hash *= Prime3;
+        hash ^= hash >> 32;
+        return hash;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+}
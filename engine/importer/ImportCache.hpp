@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// Cooked importer results in a directory, so a restart does not import the same sources again.
+// An entry is a manifest plus payload files that share its key. The key is a hash of the importer, the source path and
+// every option that changes the result. The manifest is written after the payloads and lists the size, modification
+// time and content hash of each source file. A lookup maps the manifest and stats the sources, the contents are only
+// hashed again when a time stamp has changed, so saving a file without editing it still hits and stores the new stamp.
+namespace MFA::Importer
+{
+
+    class ImportCache
+    {
+    public:
+
+        inline static ImportCache * Instance = nullptr;
+
+        [[nodiscard]]
+        static std::unique_ptr<ImportCache> Instantiate(std::string const & directory);
+
+        explicit ImportCache(std::string const & directory);
+
+        ~ImportCache();
+
+        ImportCache(ImportCache const &) noexcept = delete;
+        ImportCache(ImportCache &&) noexcept = delete;
+        ImportCache & operator= (ImportCache const &) noexcept = delete;
+        ImportCache & operator= (ImportCache &&) noexcept = delete;
+
+        class KeyBuilder
+        {
+        public:
+
+            explicit KeyBuilder(std::string_view importer, std::string const & sourcePath);
+
+            template<typename T>
+            KeyBuilder & Add(T const & value) requires (std::is_arithmetic_v<T> || std::is_enum_v<T>)
+            {
+                auto const * bytes = reinterpret_cast<char const *>(&value);
+                _data.append(bytes, sizeof(T));
+                return *this;
+            }
+
+            KeyBuilder & Add(std::string_view text);
+
+            [[nodiscard]]
+            uint64_t Build() const;
+
+        private:
+
+            std::string _data{};
+
+        };
+
+        // Where the importer stores a payload of the entry. Extension includes the dot.
+        [[nodiscard]]
+        std::string PayloadPath(uint64_t key, std::string_view extension) const;
+
+        // Returns false when there is no entry or one of its sources has changed.
+        // Metadata are the strings that were committed with the entry.
+        [[nodiscard]]
+        bool Find(uint64_t key, std::vector<std::string> * outMetadata = nullptr) const;
+
+        // Call after every payload is written. Sources are the files the result depends on, the first one is the
+        // path of the key.
+        bool Commit(
+            uint64_t key,
+            std::vector<std::string> const & sources,
+            std::vector<std::string> const & metadata = {}
+        ) const;
+
+        // Writes to a temporary file and renames it, so readers never see a half written file
+        static bool WriteFile(std::string const & path, std::function<bool(std::ofstream &)> const & write);
+
+        // Fast non cryptographic hash, only used to detect changes
+        [[nodiscard]]
+        static uint64_t HashContent(void const * data, size_t size, uint64_t seed = 0);
+
+    private:
+
+        [[nodiscard]]
+        std::string ManifestPath(uint64_t key) const;
+
+        std::string _directory{};
+
+    };
+
+}
@@ -0,0 +1,909 @@
+#include "ImportCookedMesh.hpp"
+
+#include "AssetGLTF_MeshCodec.hpp"
+#include "BedrockAssert.hpp"
+#include "BedrockFile.hpp"
+#include "BedrockLog.hpp"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <type_traits>
+
+namespace MFA::Importer
+{
+
+    namespace
+    {
+
+        using namespace AS::GLTF;
+
+        constexpr char Magic[8]{'M', 'F', 'A', 'M', 'E', 'S', 'H', '\0'};
+        constexpr uint32_t Version = 2;
+        constexpr uint64_t SectionAlignment = 64;
+
+        enum class SectionId : uint32_t
+        {
+            Vertices,
+            Indices,
+            SubMeshes,
+            Primitives,
+            Nodes,
+            NodeChildren,
+            Strings,
+            Skins,
+            SkinJoints,
+            InverseBindMatrices,
+            Animations,
+            Samplers,
+            SamplerKeys,
+            Channels,
+            RootNodes,
+            FlatNodes,
+            LevelOffsets,
+            FlatMeshNodes,
+            NodeToFlatNode,
+            Meshlets,
+            LodErrors,
+            EncodedVertices,                        // Replace Vertices and Indices when the buffers are compressed
+            EncodedIndices,
+            Count
+        };
+
+        struct FileHeader
+        {
+            char magic[8]{};
+            uint32_t version = 0;
+            uint32_t layoutHash = 0;
+            uint64_t fileSize = 0;
+            uint32_t vertexCount = 0;
+            uint32_t indexCount = 0;
+            uint32_t isCentered = 0;
+            uint32_t isOptimized = 0;
+            uint32_t hasPositionMinMax = 0;
+            float positionMin[3]{};
+            float positionMax[3]{};
+            uint32_t sectionCount = 0;
+        };
+
+        struct SectionEntry
+        {
+            SectionId id{};
+            uint32_t elementSize = 0;
+            uint64_t offset = 0;                    // From start of file
+            uint64_t count = 0;
+        };
+
+        // Variable length members are stored as ranges inside the shared sections
+
+        struct CookedSubMesh
+        {
+            uint32_t primitiveStart = 0;
+            uint32_t primitiveCount = 0;
+            uint32_t hasPositionMinMax = 0;
+            float positionMin[3]{};
+            float positionMax[3]{};
+        };
+
+        struct CookedNode
+        {
+            uint32_t nameOffset = 0;                // Inside Strings
+            uint32_t nameLength = 0;
+            int subMeshIndex = -1;
+            uint32_t childrenStart = 0;
+            uint32_t childrenCount = 0;
+            int parent = -1;
+            int skin = -1;
+            glm::vec3 position{};
+            glm::quat rotation{};
+            glm::vec3 scale{};
+            glm::mat4 extraTransform{};
+        };
+
+        struct CookedSkin
+        {
+            uint32_t jointStart = 0;
+            uint32_t jointCount = 0;
+            uint32_t matrixStart = 0;
+            uint32_t matrixCount = 0;
+            int skeletonRootNode = -1;
+        };
+
+        struct CookedAnimation
+        {
+            uint32_t nameOffset = 0;
+            uint32_t nameLength = 0;
+            uint32_t samplerStart = 0;
+            uint32_t samplerCount = 0;
+            uint32_t channelStart = 0;
+            uint32_t channelCount = 0;
+            float startTime = 0.0f;
+            float endTime = 0.0f;
+            float animationDuration = 0.0f;
+        };
+
+        struct CookedSampler
+        {
+            Animation::Interpolation interpolation{};
+            uint32_t keyStart = 0;
+            uint32_t keyCount = 0;
+        };
+
+        //-------------------------------------------------------------------------------------------------
+
+        // Files from a build with different struct layouts must not be read
+        uint32_t ComputeLayoutHash()
+        {
+            uint32_t const sizes[]{
+                sizeof(FileHeader), sizeof(SectionEntry), sizeof(Vertex), sizeof(Index), sizeof(CookedSubMesh),
+                sizeof(Primitive), sizeof(CookedNode), sizeof(CookedSkin), sizeof(glm::mat4), sizeof(CookedAnimation),
+                sizeof(CookedSampler), sizeof(Animation::Sampler::InputAndOutput), sizeof(Animation::Channel),
+                sizeof(MeshData::FlatNode), sizeof(Meshlet), MaxLodCount
+            };
+            uint32_t hash = 2166136261u;
+            for (auto const size : sizes)
+            {
+                hash = (hash ^ size) * 16777619u;
+            }
+            return hash;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        uint64_t AlignOffset(uint64_t const offset)
+        {
+            return (offset + SectionAlignment - 1) / SectionAlignment * SectionAlignment;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        class SectionWriter
+        {
+        public:
+
+            template<typename T>
+            void Add(SectionId const id, T const * data, size_t const count)
+            {
+                static_assert(std::is_trivially_copyable_v<T>);
+                _entries.emplace_back(SectionEntry{
+                    .id = id,
+                    .elementSize = static_cast<uint32_t>(sizeof(T)),
+                    .offset = 0,
+                    .count = count
+                });
+                _payloads.emplace_back(reinterpret_cast<char const *>(data));
+            }
+
+            template<typename T>
+            void Add(SectionId const id, std::vector<T> const & data)
+            {
+                Add(id, data.data(), data.size());
+            }
+
+            bool Write(std::ofstream & file, FileHeader header)
+            {
+                auto offset = AlignOffset(sizeof(FileHeader) + sizeof(SectionEntry) * _entries.size());
+                for (auto & entry : _entries)
+                {
+                    entry.offset = offset;
+                    offset = AlignOffset(offset + entry.elementSize * entry.count);
+                }
+                header.fileSize = offset;
+                header.sectionCount = static_cast<uint32_t>(_entries.size());
+
+                file.write(reinterpret_cast<char const *>(&header), sizeof(header));
+                file.write(reinterpret_cast<char const *>(_entries.data()), sizeof(SectionEntry) * _entries.size());
+                uint64_t position = sizeof(FileHeader) + sizeof(SectionEntry) * _entries.size();
+                for (size_t i = 0; i < _entries.size(); ++i)
+                {
+                    WritePadding(file, _entries[i].offset - position);
+                    auto const size = _entries[i].elementSize * _entries[i].count;
+                    file.write(_payloads[i], static_cast<std::streamsize>(size));
+                    position = _entries[i].offset + size;
+                }
+                WritePadding(file, header.fileSize - position);
+                return file.good();
+            }
+
+        private:
+
+            static void WritePadding(std::ofstream & file, uint64_t const size)
+            {
+                static constexpr char zeros[SectionAlignment]{};
+                file.write(zeros, static_cast<std::streamsize>(size));
+            }
+
+            std::vector<SectionEntry> _entries{};
+            std::vector<char const *> _payloads{};
+
+        };
+
+        //-------------------------------------------------------------------------------------------------
+
+        class SectionReader
+        {
+        public:
+
+            explicit SectionReader(File::MappedFile const & file, std::span<SectionEntry const> const entries)
+                : _file(file)
+            {
+                for (auto const & entry : entries)
+                {
+                    if (static_cast<uint32_t>(entry.id) < static_cast<uint32_t>(SectionId::Count))
+                    {
+                        _entries[static_cast<uint32_t>(entry.id)] = &entry;
+                    }
+                }
+            }
+
+            // Missing sections are empty. Sections with the wrong element size or range make the whole file invalid.
+            template<typename T>
+            std::span<T const> Get(SectionId const id)
+            {
+                auto const * entry = _entries[static_cast<uint32_t>(id)];
+                if (entry == nullptr || entry->count == 0)
+                {
+                    return {};
+                }
+                if (
+                    entry->elementSize != sizeof(T) ||
+                    entry->offset % SectionAlignment != 0 ||
+                    entry->offset > _file.Len() ||
+                    entry->count > (_file.Len() - entry->offset) / sizeof(T)
+                )
+                {
+                    _isValid = false;
+                    return {};
+                }
+                return {reinterpret_cast<T const *>(_file.Ptr() + entry->offset), entry->count};
+            }
+
+            [[nodiscard]]
+            uint64_t GetOffset(SectionId const id) const
+            {
+                return _entries[static_cast<uint32_t>(id)]->offset;
+            }
+
+            [[nodiscard]]
+            bool IsValid() const noexcept
+            {
+                return _isValid;
+            }
+
+        private:
+
+            File::MappedFile const & _file;
+            SectionEntry const * _entries[static_cast<uint32_t>(SectionId::Count)]{};
+            bool _isValid = true;
+
+        };
+
+        //-------------------------------------------------------------------------------------------------
+
+        template<typename T>
+        bool IsRangeValid(std::span<T const> const items, uint32_t const start, uint32_t const count)
+        {
+            return start <= items.size() && count <= items.size() - start;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        template<typename T>
+        std::vector<T> ToVector(std::span<T const> const items)
+        {
+            return std::vector<T>(items.begin(), items.end());
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        bool IsRangeValid(uint64_t const size, uint64_t const start, uint64_t const count)
+        {
+            return start <= size && count <= size - start;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        bool IsIndexValid(int64_t const index, size_t const count)
+        {
+            return index >= 0 && static_cast<uint64_t>(index) < count;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        // -1 stands for none
+        bool IsOptionalIndexValid(int const index, size_t const count)
+        {
+            return index == -1 || IsIndexValid(index, count);
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        // Every index that the renderer and the animation code follow without checking, so a damaged file is
+        // rejected here instead of reading out of bounds later
+        bool IsMeshDataValid(MeshData const & meshData, uint32_t const vertexCount, uint32_t const indexCount)
+        {
+            auto const nodeCount = meshData.nodes.size();
+            auto const flatNodeCount = meshData.flatNodes.size();
+
+            for (auto const & subMesh : meshData.subMeshes)
+            {
+                for (auto const & primitive : subMesh.primitives)
+                {
+                    if (
+                        IsRangeValid(vertexCount, primitive.verticesStartingIndex, primitive.vertexCount) == false ||
+                        IsRangeValid(indexCount, primitive.indicesStartingIndex, primitive.indicesCount) == false ||
+                        IsRangeValid(
+                            meshData.meshlets.size(),
+                            primitive.meshletStartingIndex,
+                            primitive.meshletCount
+                        ) == false ||
+                        primitive.lodCount > MaxLodCount
+                    )
+                    {
+                        return false;
+                    }
+                    for (uint32_t i = 0; i < primitive.lodCount; ++i)
+                    {
+                        auto const & lod = primitive.lods[i];
+                        if (IsRangeValid(indexCount, lod.indicesStartingIndex, lod.indicesCount) == false)
+                        {
+                            return false;
+                        }
+                    }
+                }
+            }
+
+            for (auto const & meshlet : meshData.meshlets)
+            {
+                if (IsRangeValid(indexCount, meshlet.indicesStartingIndex, meshlet.indicesCount) == false)
+                {
+                    return false;
+                }
+            }
+
+            for (auto const & node : meshData.nodes)
+            {
+                if (
+                    IsOptionalIndexValid(node.subMeshIndex, meshData.subMeshes.size()) == false ||
+                    IsOptionalIndexValid(node.parent, nodeCount) == false ||
+                    IsOptionalIndexValid(node.skin, meshData.skins.size()) == false
+                )
+                {
+                    return false;
+                }
+                for (auto const child : node.children)
+                {
+                    if (IsIndexValid(child, nodeCount) == false)
+                    {
+                        return false;
+                    }
+                }
+            }
+
+            for (auto const rootNode : meshData.rootNodes)
+            {
+                if (IsIndexValid(rootNode, nodeCount) == false)
+                {
+                    return false;
+                }
+            }
+
+            for (auto const & skin : meshData.skins)
+            {
+                if (IsOptionalIndexValid(skin.skeletonRootNode, nodeCount) == false)
+                {
+                    return false;
+                }
+                for (auto const joint : skin.joints)
+                {
+                    if (IsIndexValid(joint, nodeCount) == false)
+                    {
+                        return false;
+                    }
+                }
+            }
+
+            for (auto const & animation : meshData.animations)
+            {
+                for (auto const & channel : animation.channels)
+                {
+                    if (
+                        IsIndexValid(channel.nodeIndex, nodeCount) == false ||
+                        IsIndexValid(channel.samplerIndex, animation.samplers.size()) == false
+                    )
+                    {
+                        return false;
+                    }
+                }
+            }
+
+            // The hierarchy is walked level by level and parents have to come before their children
+            if (flatNodeCount != nodeCount || meshData.nodeToFlatNode.size() != nodeCount)
+            {
+                return false;
+            }
+            for (uint32_t flatIdx = 0; flatIdx < static_cast<uint32_t>(flatNodeCount); ++flatIdx)
+            {
+                auto const & flatNode = meshData.flatNodes[flatIdx];
+                if (
+                    IsIndexValid(flatNode.nodeIndex, nodeCount) == false ||
+                    meshData.nodeToFlatNode[flatNode.nodeIndex] != flatIdx ||
+                    flatNode.parent < -1 ||
+                    flatNode.parent >= static_cast<int>(flatIdx) ||
+                    IsOptionalIndexValid(flatNode.subMeshIndex, meshData.subMeshes.size()) == false
+                )
+                {
+                    return false;
+                }
+            }
+            for (auto const flatMeshNode : meshData.flatMeshNodes)
+            {
+                if (IsIndexValid(flatMeshNode, flatNodeCount) == false)
+                {
+                    return false;
+                }
+            }
+            auto const & levelOffsets = meshData.levelOffsets;
+            if (levelOffsets.empty() || levelOffsets.front() != 0 || levelOffsets.back() != flatNodeCount)
+            {
+                return false;
+            }
+            for (size_t i = 1; i < levelOffsets.size(); ++i)
+            {
+                if (levelOffsets[i] < levelOffsets[i - 1])
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    bool SaveCookedMesh(AS::GLTF::Mesh const & mesh, std::string const & path, CookedMeshOptions const & options)
+    {
+        auto const & meshData = *mesh.GetMeshData();
+
+        std::vector<CookedSubMesh> subMeshes{};
+        std::vector<Primitive> primitives{};
+        for (auto const & subMesh : meshData.subMeshes)
+        {
+            CookedSubMesh cookedSubMesh{
+                .primitiveStart = static_cast<uint32_t>(primitives.size()),
+                .primitiveCount = static_cast<uint32_t>(subMesh.primitives.size()),
+                .hasPositionMinMax = subMesh.hasPositionMinMax ? 1u : 0u
+            };
+            Memory::Copy<3>(cookedSubMesh.positionMin, subMesh.positionMin);
+            Memory::Copy<3>(cookedSubMesh.positionMax, subMesh.positionMax);
+            subMeshes.emplace_back(cookedSubMesh);
+            primitives.insert(primitives.end(), subMesh.primitives.begin(), subMesh.primitives.end());
+        }
+
+        std::vector<char> strings{};
+        auto const addString = [&strings](std::string const & value)->uint32_t
+        {
+            auto const offset = static_cast<uint32_t>(strings.size());
+            strings.insert(strings.end(), value.begin(), value.end());
+            return offset;
+        };
+
+        std::vector<CookedNode> nodes{};
+        std::vector<int> nodeChildren{};
+        for (auto const & node : meshData.nodes)
+        {
+            nodes.emplace_back(CookedNode{
+                .nameOffset = addString(node.name),
+                .nameLength = static_cast<uint32_t>(node.name.size()),
+                .subMeshIndex = node.subMeshIndex,
+                .childrenStart = static_cast<uint32_t>(nodeChildren.size()),
+                .childrenCount = static_cast<uint32_t>(node.children.size()),
+                .parent = node.parent,
+                .skin = node.skin,
+                .position = node.transform.Getposition(),
+                .rotation = node.transform.Getrotation().GetQuaternion(),
+                .scale = node.transform.Getscale(),
+                .extraTransform = node.transform.GetextraTransform()
+            });
+            nodeChildren.insert(nodeChildren.end(), node.children.begin(), node.children.end());
+        }
+
+        std::vector<CookedSkin> skins{};
+        std::vector<int> skinJoints{};
+        std::vector<glm::mat4> inverseBindMatrices{};
+        for (auto const & skin : meshData.skins)
+        {
+            skins.emplace_back(CookedSkin{
+                .jointStart = static_cast<uint32_t>(skinJoints.size()),
+                .jointCount = static_cast<uint32_t>(skin.joints.size()),
+                .matrixStart = static_cast<uint32_t>(inverseBindMatrices.size()),
+                .matrixCount = static_cast<uint32_t>(skin.inverseBindMatrices.size()),
+                .skeletonRootNode = skin.skeletonRootNode
+            });
+            skinJoints.insert(skinJoints.end(), skin.joints.begin(), skin.joints.end());
+            inverseBindMatrices.insert(
+                inverseBindMatrices.end(),
+                skin.inverseBindMatrices.begin(),
+                skin.inverseBindMatrices.end()
+            );
+        }
+
+        std::vector<CookedAnimation> animations{};
+        std::vector<CookedSampler> samplers{};
+        std::vector<Animation::Sampler::InputAndOutput> samplerKeys{};
+        std::vector<Animation::Channel> channels{};
+        for (auto const & animation : meshData.animations)
+        {
+            animations.emplace_back(CookedAnimation{
+                .nameOffset = addString(animation.name),
+                .nameLength = static_cast<uint32_t>(animation.name.size()),
+                .samplerStart = static_cast<uint32_t>(samplers.size()),
+                .samplerCount = static_cast<uint32_t>(animation.samplers.size()),
+                .channelStart = static_cast<uint32_t>(channels.size()),
+                .channelCount = static_cast<uint32_t>(animation.channels.size()),
+                .startTime = animation.startTime,
+                .endTime = animation.endTime,
+                .animationDuration = animation.animationDuration
+            });
+            for (auto const & sampler : animation.samplers)
+            {
+                samplers.emplace_back(CookedSampler{
+                    .interpolation = sampler.interpolation,
+                    .keyStart = static_cast<uint32_t>(samplerKeys.size()),
+                    .keyCount = static_cast<uint32_t>(sampler.inputAndOutput.size())
+                });
+                samplerKeys.insert(samplerKeys.end(), sampler.inputAndOutput.begin(), sampler.inputAndOutput.end());
+            }
+            channels.insert(channels.end(), animation.channels.begin(), animation.channels.end());
+        }
+
+        SectionWriter writer{};
+        std::vector<uint8_t> encodedVertices{};
+        std::vector<uint8_t> encodedIndices{};
+        if (options.compressBuffers)
+        {
+            AS::GLTF::MeshCodec::EncodeVertexBuffer(
+                encodedVertices,
+                mesh.GetVertexData()->Ptr(),
+                mesh.GetVertexCount(),
+                sizeof(Vertex)
+            );
+            AS::GLTF::MeshCodec::EncodeIndexBuffer(
+                encodedIndices,
+                mesh.GetIndexData()->As<Index>(),
+                mesh.GetIndexCount()
+            );
+            writer.Add(SectionId::EncodedVertices, encodedVertices);
+            writer.Add(SectionId::EncodedIndices, encodedIndices);
+        }
+        else
+        {
+            writer.Add(SectionId::Vertices, mesh.GetVertexData()->As<Vertex>(), mesh.GetVertexCount());
+            writer.Add(SectionId::Indices, mesh.GetIndexData()->As<Index>(), mesh.GetIndexCount());
+        }
+        writer.Add(SectionId::SubMeshes, subMeshes);
+        writer.Add(SectionId::Primitives, primitives);
+        writer.Add(SectionId::Nodes, nodes);
+        writer.Add(SectionId::NodeChildren, nodeChildren);
+        writer.Add(SectionId::Strings, strings);
+        writer.Add(SectionId::Skins, skins);
+        writer.Add(SectionId::SkinJoints, skinJoints);
+        writer.Add(SectionId::InverseBindMatrices, inverseBindMatrices);
+        writer.Add(SectionId::Animations, animations);
+        writer.Add(SectionId::Samplers, samplers);
+        writer.Add(SectionId::SamplerKeys, samplerKeys);
+        writer.Add(SectionId::Channels, channels);
+        writer.Add(SectionId::RootNodes, meshData.rootNodes);
+        writer.Add(SectionId::FlatNodes, meshData.flatNodes);
+        writer.Add(SectionId::LevelOffsets, meshData.levelOffsets);
+        writer.Add(SectionId::FlatMeshNodes, meshData.flatMeshNodes);
+        writer.Add(SectionId::NodeToFlatNode, meshData.nodeToFlatNode);
+        writer.Add(SectionId::Meshlets, meshData.meshlets);
+        writer.Add(SectionId::LodErrors, meshData.lodErrors);
+
+        FileHeader header{
+            .version = Version,
+            .layoutHash = ComputeLayoutHash(),
+            .vertexCount = mesh.GetVertexCount(),
+            .indexCount = mesh.GetIndexCount(),
+            .isCentered = mesh.IsCentered() ? 1u : 0u,
+            .isOptimized = mesh.IsOptimized() ? 1u : 0u,
+            .hasPositionMinMax = meshData.hasPositionMinMax ? 1u : 0u
+        };
+        std::memcpy(header.magic, Magic, sizeof(Magic));
+        Memory::Copy<3>(header.positionMin, meshData.positionMin);
+        Memory::Copy<3>(header.positionMax, meshData.positionMax);
+
+        auto const temporaryPath = path + ".tmp";
+        bool success = false;
+        {
+            std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+            success = file.good() && writer.Write(file, header);
+        }
+
+        std::error_code errorCode{};
+        if (success)
+        {
+            std::filesystem::rename(temporaryPath, path, errorCode);
+            success = !errorCode;
+        }
+        if (success == false)
+        {
+            std::filesystem::remove(temporaryPath, errorCode);
+            MFA_LOG_WARN("Failed to write cooked mesh %s", path.c_str());
+        }
+        return success;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    std::shared_ptr<AS::GLTF::Mesh> LoadCookedMesh(std::string const & path)
+    {
+        auto const file = File::MappedFile::Open(path);
+        if (file == nullptr)
+        {
+            return nullptr;
+        }
+
+        if (file->Len() < sizeof(FileHeader))
+        {
+            MFA_LOG_WARN("Cooked mesh %s is truncated", path.c_str());
+            return nullptr;
+        }
+        auto const & header = *reinterpret_cast<FileHeader const *>(file->Ptr());
+        if (
+            std::memcmp(header.magic, Magic, sizeof(Magic)) != 0 ||
+            header.version != Version ||
+            header.layoutHash != ComputeLayoutHash()
+        )
+        {
+            MFA_LOG_INFO("Cooked mesh %s was written by an incompatible build", path.c_str());
+            return nullptr;
+        }
+        if (
+            header.fileSize != file->Len() ||
+            header.sectionCount > (file->Len() - sizeof(FileHeader)) / sizeof(SectionEntry)
+        )
+        {
+            MFA_LOG_WARN("Cooked mesh %s is corrupt", path.c_str());
+            return nullptr;
+        }
+
+        SectionReader reader(*file, std::span<SectionEntry const>(
+            reinterpret_cast<SectionEntry const *>(file->Ptr() + sizeof(FileHeader)),
+            header.sectionCount
+        ));
+
+        auto const vertices = reader.Get<Vertex>(SectionId::Vertices);
+        auto const indices = reader.Get<Index>(SectionId::Indices);
+        auto const encodedVertices = reader.Get<uint8_t>(SectionId::EncodedVertices);
+        auto const encodedIndices = reader.Get<uint8_t>(SectionId::EncodedIndices);
+        auto const cookedSubMeshes = reader.Get<CookedSubMesh>(SectionId::SubMeshes);
+        auto const primitives = reader.Get<Primitive>(SectionId::Primitives);
+        auto const cookedNodes = reader.Get<CookedNode>(SectionId::Nodes);
+        auto const nodeChildren = reader.Get<int>(SectionId::NodeChildren);
+        auto const strings = reader.Get<char>(SectionId::Strings);
+        auto const cookedSkins = reader.Get<CookedSkin>(SectionId::Skins);
+        auto const skinJoints = reader.Get<int>(SectionId::SkinJoints);
+        auto const inverseBindMatrices = reader.Get<glm::mat4>(SectionId::InverseBindMatrices);
+        auto const cookedAnimations = reader.Get<CookedAnimation>(SectionId::Animations);
+        auto const cookedSamplers = reader.Get<CookedSampler>(SectionId::Samplers);
+        auto const samplerKeys = reader.Get<Animation::Sampler::InputAndOutput>(SectionId::SamplerKeys);
+        auto const channels = reader.Get<Animation::Channel>(SectionId::Channels);
+
+        auto meshData = std::make_shared<MeshData>();
+        meshData->rootNodes = ToVector(reader.Get<uint32_t>(SectionId::RootNodes));
+        meshData->flatNodes = ToVector(reader.Get<MeshData::FlatNode>(SectionId::FlatNodes));
+        meshData->levelOffsets = ToVector(reader.Get<uint32_t>(SectionId::LevelOffsets));
+        meshData->flatMeshNodes = ToVector(reader.Get<uint32_t>(SectionId::FlatMeshNodes));
+        meshData->nodeToFlatNode = ToVector(reader.Get<uint32_t>(SectionId::NodeToFlatNode));
+        meshData->meshlets = ToVector(reader.Get<Meshlet>(SectionId::Meshlets));
+        meshData->lodErrors = ToVector(reader.Get<float>(SectionId::LodErrors));
+
+        if (
+            reader.IsValid() == false ||
+            header.vertexCount == 0 ||
+            header.indexCount == 0 ||
+            // A raw section is used in place, so it has to hold every element even when an encoded one exists
+            (vertices.empty() ? encodedVertices.empty() : vertices.size() != header.vertexCount) ||
+            (indices.empty() ? encodedIndices.empty() : indices.size() != header.indexCount)
+        )
+        {
+            MFA_LOG_WARN("Cooked mesh %s is corrupt", path.c_str());
+            return nullptr;
+        }
+
+        bool isValid = true;
+
+        meshData->subMeshes.resize(cookedSubMeshes.size());
+        for (size_t i = 0; i < cookedSubMeshes.size(); ++i)
+        {
+            auto const & cookedSubMesh = cookedSubMeshes[i];
+            auto & subMesh = meshData->subMeshes[i];
+            if (IsRangeValid(primitives, cookedSubMesh.primitiveStart, cookedSubMesh.primitiveCount) == false)
+            {
+                isValid = false;
+                break;
+            }
+            subMesh.primitives = ToVector(primitives.subspan(cookedSubMesh.primitiveStart, cookedSubMesh.primitiveCount));
+            subMesh.hasPositionMinMax = cookedSubMesh.hasPositionMinMax != 0;
+            Memory::Copy<3>(subMesh.positionMin, cookedSubMesh.positionMin);
+            Memory::Copy<3>(subMesh.positionMax, cookedSubMesh.positionMax);
+            // Primitives do not move anymore so the pointers stay valid
+            for (auto & primitive : subMesh.primitives)
+            {
+                switch (primitive.alphaMode)
+                {
+                case AlphaMode::Opaque:
+                    subMesh.opaquePrimitives.emplace_back(&primitive);
+                    break;
+                case AlphaMode::Blend:
+                    subMesh.blendPrimitives.emplace_back(&primitive);
+                    break;
+                case AlphaMode::Mask:
+                    subMesh.maskPrimitives.emplace_back(&primitive);
+                    break;
+                default:
+                    break;
+                }
+            }
+        }
+
+        meshData->nodes.resize(cookedNodes.size());
+        for (uint32_t i = 0; i < static_cast<uint32_t>(cookedNodes.size()) && isValid; ++i)
+        {
+            auto const & cookedNode = cookedNodes[i];
+            auto & node = meshData->nodes[i];
+            if (
+                IsRangeValid(strings, cookedNode.nameOffset, cookedNode.nameLength) == false ||
+                IsRangeValid(nodeChildren, cookedNode.childrenStart, cookedNode.childrenCount) == false
+            )
+            {
+                isValid = false;
+                break;
+            }
+            node.name.assign(strings.data() + cookedNode.nameOffset, cookedNode.nameLength);
+            node.subMeshIndex = cookedNode.subMeshIndex;
+            node.children = ToVector(nodeChildren.subspan(cookedNode.childrenStart, cookedNode.childrenCount));
+            node.parent = cookedNode.parent;
+            node.skin = cookedNode.skin;
+            node.transform.Setposition(cookedNode.position);
+            node.transform.SetQuaternion(cookedNode.rotation);
+            node.transform.Setscale(cookedNode.scale);
+            node.transform.SetextraTransform(cookedNode.extraTransform);
+
+            if (node.name.empty() == false)
+            {
+                meshData->nodeNameToIndex.try_emplace(StringId::Intern(node.name), i);
+            }
+        }
+
+        meshData->skins.resize(cookedSkins.size());
+        for (size_t i = 0; i < cookedSkins.size() && isValid; ++i)
+        {
+            auto const & cookedSkin = cookedSkins[i];
+            if (
+                IsRangeValid(skinJoints, cookedSkin.jointStart, cookedSkin.jointCount) == false ||
+                IsRangeValid(inverseBindMatrices, cookedSkin.matrixStart, cookedSkin.matrixCount) == false
+            )
+            {
+                isValid = false;
+                break;
+            }
+            auto & skin = meshData->skins[i];
+            skin.joints = ToVector(skinJoints.subspan(cookedSkin.jointStart, cookedSkin.jointCount));
+            skin.inverseBindMatrices = ToVector(
+                inverseBindMatrices.subspan(cookedSkin.matrixStart, cookedSkin.matrixCount)
+            );
+            skin.skeletonRootNode = cookedSkin.skeletonRootNode;
+        }
+
+        meshData->animations.resize(cookedAnimations.size());
+        for (size_t i = 0; i < cookedAnimations.size() && isValid; ++i)
+        {
+            auto const & cookedAnimation = cookedAnimations[i];
+            if (
+                IsRangeValid(strings, cookedAnimation.nameOffset, cookedAnimation.nameLength) == false ||
+                IsRangeValid(cookedSamplers, cookedAnimation.samplerStart, cookedAnimation.samplerCount) == false ||
+                IsRangeValid(channels, cookedAnimation.channelStart, cookedAnimation.channelCount) == false
+            )
+            {
+                isValid = false;
+                break;
+            }
+            auto & animation = meshData->animations[i];
+            animation.name.assign(strings.data() + cookedAnimation.nameOffset, cookedAnimation.nameLength);
+            animation.channels = ToVector(channels.subspan(cookedAnimation.channelStart, cookedAnimation.channelCount));
+            animation.startTime = cookedAnimation.startTime;
+            animation.endTime = cookedAnimation.endTime;
+            animation.animationDuration = cookedAnimation.animationDuration;
+
+            animation.samplers.resize(cookedAnimation.samplerCount);
+            for (uint32_t j = 0; j < cookedAnimation.samplerCount; ++j)
+            {
+                auto const & cookedSampler = cookedSamplers[cookedAnimation.samplerStart + j];
+                if (IsRangeValid(samplerKeys, cookedSampler.keyStart, cookedSampler.keyCount) == false)
+                {
+                    isValid = false;
+                    break;
+                }
+                animation.samplers[j].interpolation = cookedSampler.interpolation;
+                animation.samplers[j].inputAndOutput = ToVector(
+                    samplerKeys.subspan(cookedSampler.keyStart, cookedSampler.keyCount)
+                );
+            }
+        }
+
+        if (isValid == false || IsMeshDataValid(*meshData, header.vertexCount, header.indexCount) == false)
+        {
+            MFA_LOG_WARN("Cooked mesh %s is corrupt", path.c_str());
+            return nullptr;
+        }
+
+        meshData->hasPositionMinMax = header.hasPositionMinMax != 0;
+        Memory::Copy<3>(meshData->positionMin, header.positionMin);
+        Memory::Copy<3>(meshData->positionMax, header.positionMax);
+
+        // Raw vertex and index buffers are used in place. Writes, for example from CenterMesh, only touch private pages.
+        std::shared_ptr<Blob> vertexData{};
+        std::shared_ptr<Blob> indexData{};
+        if (vertices.empty() == false)
+        {
+            vertexData = std::make_shared<File::MappedBlob>(
+                file,
+                reader.GetOffset(SectionId::Vertices),
+                vertices.size_bytes()
+            );
+        }
+        else
+        {
+            vertexData = Memory::AllocSize(sizeof(Vertex) * header.vertexCount);
+            isValid = AS::GLTF::MeshCodec::DecodeVertexBuffer(
+                vertexData->Ptr(),
+                header.vertexCount,
+                sizeof(Vertex),
+                encodedVertices.data(),
+                encodedVertices.size()
+            );
+        }
+        if (indices.empty() == false)
+        {
+            indexData = std::make_shared<File::MappedBlob>(
+                file,
+                reader.GetOffset(SectionId::Indices),
+                indices.size_bytes()
+            );
+        }
+        else if (isValid)
+        {
+            indexData = Memory::AllocSize(sizeof(Index) * header.indexCount);
+            isValid = AS::GLTF::MeshCodec::DecodeIndexBuffer(
+                indexData->As<Index>(),
+                header.indexCount,
+                encodedIndices.data(),
+                encodedIndices.size()
+            );
+        }
+        if (isValid == false)
+        {
+            MFA_LOG_WARN("Cooked mesh %s has corrupt buffers", path.c_str());
+            return nullptr;
+        }
+
+        return std::make_shared<AS::GLTF::Mesh>(
+            header.vertexCount,
+            header.indexCount,
+            std::move(vertexData),
+            std::move(indexData),
+            std::move(meshData),
+            header.isCentered != 0,
+            header.isOptimized != 0
+        );
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+}
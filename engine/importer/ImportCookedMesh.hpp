@@ -0,0 +1,30 @@
+#pragma once
+
+#include "AssetGLTF_Mesh.hpp"
+
+#include <memory>
+#include <string>
+
+// .mfamesh is a binary image of a finalized mesh. Every section is a flat array that starts at an aligned offset, so
+// loading maps the file, validates the section table and either points the vertex and index buffers straight into
+// the mapping or decodes them with MeshCodec. Nothing is parsed and FinalizeData does not run again.
+// Files are only readable by a build with the same struct layouts, others are rejected and have to be cooked again.
+namespace MFA::Importer
+{
+
+    inline static constexpr char const * CookedMeshExtension = ".mfamesh";
+
+    struct CookedMeshOptions
+    {
+        // Smaller files that need a decode pass on load. Uncompressed buffers are used in place from the mapping.
+        bool compressBuffers = true;
+    };
+
+    // Writes to a temporary file first so a crash never leaves a half written file behind
+    bool SaveCookedMesh(AS::GLTF::Mesh const & mesh, std::string const & path, CookedMeshOptions const & options = {});
+
+    // Returns nullptr when the file is missing, corrupt or was written by an incompatible build
+    [[nodiscard]]
+    std::shared_ptr<AS::GLTF::Mesh> LoadCookedMesh(std::string const & path);
+
+}
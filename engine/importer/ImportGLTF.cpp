@@ -1,15 +1,29 @@
 #include "ImportGLTF.hpp"
 
+#include "AssetGLTF_MeshOptimizer.hpp"
+#include "AssetGLTF_MeshSimplifier.hpp"
 #include "AssetTexture.hpp"
+#include "ImportCache.hpp"
+#include "ImportCookedMesh.hpp"
+#include "ImportGLTF_Document.hpp"
 #include "ImportTexture.hpp"
+#include "ImportTextureContainer.hpp"
 #include "BedrockAssert.hpp"
 #include "BedrockMath.hpp"
+#include "BedrockStringId.hpp"
+#include "JobSystem.hpp"
 
 #include "json.hpp"
 #include "stb_image.h"
 #include "stb_image_write.h"
 #include "tiny_gltf_loader.h"
 
+#include <algorithm>
+#include <cstring>
+#include <future>
+#include <limits>
+#include <unordered_map>
+
 namespace MFA::Importer
 {
 
@@ -18,33 +32,112 @@ namespace MFA::Importer
         std::string const gltfName{};
         uint8_t const index = 0;
         std::string const relativePath{};
+        TextureUsage const usage = TextureUsage::Color;
     };
 
+    // Cooked meshes store the uri and the usage of each texture as metadata
+    static constexpr uint32_t TextureRefsMetadataVersion = 2;
+
+    // Texture index by image uri
+    using TextureLookup = std::unordered_map<StringId, int16_t>;
+
+    //-------------------------------------------------------------------------------------------------
+
+    // Image that the texture is loaded from, -1 when it has none. The dds image of MSFT_texture_dds is preferred since
+    // it is copied without decoding. The image of KHR_texture_basisu is only used when there is no other one.
+    static int GLTF_textureImage(tinygltf::Model const & gltfModel, tinygltf::Texture const & texture)
+    {
+        auto const extensionSource = [&texture](char const * extensionName)->int
+        {
+            auto const findResult = texture.extensions.find(extensionName);
+            if (findResult == texture.extensions.end() || findResult->second.Has("source") == false)
+            {
+                return -1;
+            }
+            return findResult->second.Get("source").GetNumberAsInt();
+        };
+        auto const isValid = [&gltfModel](int const imageIndex)->bool
+        {
+            return imageIndex >= 0 && imageIndex < static_cast<int>(gltfModel.images.size());
+        };
+
+        auto const candidates = {extensionSource("MSFT_texture_dds"), texture.source, extensionSource("KHR_texture_basisu")};
+        for (auto const imageIndex : candidates)
+        {
+            if (isValid(imageIndex))
+            {
+                return imageIndex;
+            }
+        }
+        return -1;
+    }
+
     //-------------------------------------------------------------------------------------------------
 
     static void GLTF_extractTextures(
         std::string const& path,
         tinygltf::Model const& gltfModel,
-        std::vector<TextureRef>& outTextureRefs
+        std::vector<TextureRef>& outTextureRefs,
+        TextureLookup& outTextureLookup
     )
     {
         std::string directoryPath = std::filesystem::path(path).parent_path().string();
 
+        // An image that the materials sample in different ways keeps all of its channels
+        std::unordered_map<std::string, TextureUsage> imageUsages{};
+        auto const addUsage = [&gltfModel, &imageUsages](int const textureIndex, TextureUsage const usage)->void
+        {
+            if (textureIndex < 0 || textureIndex >= static_cast<int>(gltfModel.textures.size()))
+            {
+                return;
+            }
+            auto const imageIndex = GLTF_textureImage(gltfModel, gltfModel.textures[textureIndex]);
+            if (imageIndex < 0)
+            {
+                return;
+            }
+            auto const & image = gltfModel.images[imageIndex];
+            auto const [iterator, isNew] = imageUsages.try_emplace(image.uri, usage);
+            if (isNew == false && iterator->second != usage)
+            {
+                iterator->second = TextureUsage::Color;
+            }
+        };
+        for (auto const & material : gltfModel.materials)
+        {
+            addUsage(material.pbrMetallicRoughness.baseColorTexture.index, TextureUsage::Color);
+            // Roughness and metallic are in green and blue
+            addUsage(material.pbrMetallicRoughness.metallicRoughnessTexture.index, TextureUsage::Color);
+            addUsage(material.normalTexture.index, TextureUsage::Normal);
+            addUsage(material.emissiveTexture.index, TextureUsage::Color);
+            addUsage(material.occlusionTexture.index, TextureUsage::Mask);
+        }
+
         // Extracting textures
         if (false == gltfModel.textures.empty())
         {
             for (auto const& texture : gltfModel.textures)
             {
-                auto const& image = gltfModel.images[texture.source];
+                auto const imageIndex = GLTF_textureImage(gltfModel, texture);
+                if (imageIndex < 0)
+                {
+                    MFA_LOG_WARN("A texture of %s has no image that can be loaded", path.c_str());
+                    continue;
+                }
+                auto const& image = gltfModel.images[imageIndex];
 
                 std::string const imagePath = directoryPath + "/" + image.uri;
 
+                auto const usage = imageUsages.find(image.uri);
                 TextureRef textureRef{
                     .gltfName = image.uri,
                     .index = static_cast<uint8_t>(outTextureRefs.size()),
-                    .relativePath = imagePath
+                    .relativePath = imagePath,
+                    .usage = usage != imageUsages.end() ? usage->second : TextureUsage::Color
                 };
                 outTextureRefs.emplace_back(textureRef);
+                // First texture wins when images are shared, same as a linear search
+                outTextureLookup.try_emplace(StringId::Intern(image.uri), static_cast<int16_t>(textureRef.index));
             }
         }
 
@@ -53,113 +146,178 @@ namespace MFA::Importer
     //-------------------------------------------------------------------------------------------------
 
     static int16_t GLTF_findTextureByName(
-        char const* textureName,
-        std::vector<TextureRef> const& textureRefs
+        std::string const& textureName,
+        TextureLookup const& textureLookup
     )
     {
-        MFA_ASSERT(textureName != nullptr);
-        if (false == textureRefs.empty())
+        auto const findResult = textureLookup.find(StringId::FromString(textureName));
+        if (findResult != textureLookup.end())
         {
-            for (auto const& textureRef : textureRefs)
-            {
-                if (textureRef.gltfName == textureName)
-                {
-                    return textureRef.index;
-                }
-            }
+            return findResult->second;
         }
         return -1;
         //MFA_CRASH("Image not found: %s", gltf_name);
     }
 
-
     //-------------------------------------------------------------------------------------------------
 
-#define extractTextureAndUV_Index(gltfModel, textureInfo, textureRefs, outTextureIndex, outUV_Index)    \
-    if (textureInfo.index >= 0)                                                                             \
+#define extractTextureAndUV_Index(gltfModel, textureInfo, textureLookup, outTextureIndex, outUV_Index)  \
+    if (textureInfo.index >= 0 && textureInfo.index < static_cast<int>(gltfModel.textures.size()))        \
     {                                                                                                       \
-        auto const & emissive_texture = gltfModel.textures[textureInfo.index];                              \
-        auto const & image = gltfModel.images[emissive_texture.source];                                     \
-        outTextureIndex = GLTF_findTextureByName(image.uri.c_str(), textureRefs);                           \
-        if (outTextureIndex >= 0)                                                                           \
+        auto const imageIndex = GLTF_textureImage(gltfModel, gltfModel.textures[textureInfo.index]);        \
+        if (imageIndex >= 0)                                                                                \
         {                                                                                                   \
-            outUV_Index = static_cast<uint16_t>(textureInfo.texCoord);                                      \
+            auto const & image = gltfModel.images[imageIndex];                                              \
+            outTextureIndex = GLTF_findTextureByName(image.uri, textureLookup);                             \
+            if (outTextureIndex >= 0)                                                                       \
+            {                                                                                               \
+                outUV_Index = static_cast<uint16_t>(textureInfo.texCoord);                                  \
+            }                                                                                               \
         }                                                                                                   \
     }
 
     //-------------------------------------------------------------------------------------------------
 
-    static void copyDataIntoVertexMember(
-        float* vertexMember,
-        uint8_t const componentCount,
-        float const* items,
-        uint32_t const dataIndex
+    // Typed window into a gltf buffer. Stride is the distance between elements and is never zero.
+    struct AccessorView
+    {
+        uint8_t const * data = nullptr;
+        uint32_t count = 0;
+        uint32_t stride = 0;
+        int componentType = 0;
+        int componentCount = 0;
+    };
+
+    //-------------------------------------------------------------------------------------------------
+
+    // Validates the whole range up front so later readers can run on worker threads without any checks
+    static bool GLTF_getAccessorView(
+        GLTF_Document const & document,
+        int const accessorIndex,
+        AccessorView & outView
     )
     {
-        Memory::Copy(vertexMember, &items[dataIndex * componentCount], componentCount);
+        if (accessorIndex < 0)
+        {
+            return false;
+        }
+        auto const & gltfModel = document.model;
+        MFA_REQUIRE(static_cast<size_t>(accessorIndex) < gltfModel.accessors.size());
+        auto const & accessor = gltfModel.accessors[accessorIndex];
+        MFA_REQUIRE(accessor.bufferView >= 0 && static_cast<size_t>(accessor.bufferView) < gltfModel.bufferViews.size());
+        auto const & bufferView = gltfModel.bufferViews[accessor.bufferView];
+        MFA_REQUIRE(bufferView.buffer >= 0 && static_cast<size_t>(bufferView.buffer) < document.buffers.size());
+        auto const & buffer = document.buffers[bufferView.buffer];
+
+        auto const componentSize = tinygltf::GetComponentSizeInBytes(static_cast<uint32_t>(accessor.componentType));
+        auto const componentCount = tinygltf::GetNumComponentsInType(static_cast<uint32_t>(accessor.type));
+        auto const stride = accessor.ByteStride(bufferView);
+        MFA_REQUIRE(componentSize > 0 && componentCount > 0 && stride > 0);
+
+        size_t const offset = bufferView.byteOffset + accessor.byteOffset;
+        if (accessor.count > 0)
+        {
+            size_t const lastElementEnd = offset
+                + static_cast<size_t>(stride) * (accessor.count - 1)
+                + static_cast<size_t>(componentSize) * componentCount;
+            MFA_REQUIRE(lastElementEnd <= buffer.size());
+        }
+
+        outView.data = buffer.data() + offset;
+        outView.count = static_cast<uint32_t>(accessor.count);
+        outView.stride = static_cast<uint32_t>(stride);
+        outView.componentType = accessor.componentType;
+        outView.componentCount = componentCount;
+        return true;
     }
 
     //-------------------------------------------------------------------------------------------------
 
-    static bool GLTF_extractPrimitiveDataAndTypeFromBuffer(
-        tinygltf::Model const& gltfModel,
-        tinygltf::Primitive& primitive,
-        char const* fieldKey,
-        int& outType,
-        int& outComponentType,
-        void const*& outData,
-        uint32_t& outDataCount
+    static bool GLTF_getAttributeView(
+        GLTF_Document const & document,
+        tinygltf::Primitive const & primitive,
+        std::string const & fieldKey,
+        AccessorView & outView
+    )
+    {
+        auto const findResult = primitive.attributes.find(fieldKey);
+        if (findResult == primitive.attributes.end())
+        {
+            return false;
+        }
+        return GLTF_getAccessorView(document, findResult->second, outView);
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    // Copies the first sizeof(Member) bytes of each element, so a vec4 tangent fills the vec3 member only
+    template<typename Member>
+    static void GLTF_copyAttribute(
+        AccessorView const & view,
+        uint32_t const begin,
+        uint32_t const end,
+        Vertex * vertices,
+        Member Vertex::* member
     )
     {
-        bool success = false;
-        auto const findAttributeResult = primitive.attributes.find(fieldKey);
-        if (findAttributeResult != primitive.attributes.end())
-        {// Positions
-            success = true;
-            auto const attributeValue = findAttributeResult->second;
-            MFA_REQUIRE(static_cast<size_t>(attributeValue) < gltfModel.accessors.size());
-            auto const& accessor = gltfModel.accessors[attributeValue];
-            outType = accessor.type;
-            outComponentType = accessor.componentType;
-            auto const& bufferView = gltfModel.bufferViews[accessor.bufferView];
-            MFA_REQUIRE(bufferView.buffer < gltfModel.buffers.size());
-            auto const& buffer = gltfModel.buffers[bufferView.buffer];
-            outData = reinterpret_cast<void const*>(
-                &buffer.data[bufferView.byteOffset + accessor.byteOffset]
-                );
-            outDataCount = static_cast<uint32_t>(accessor.count);
+        uint8_t const * source = view.data + static_cast<size_t>(begin) * view.stride;
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            std::memcpy(&(vertices[i].*member), source, sizeof(Member));
+            source += view.stride;
         }
-        return success;
     }
 
     //-------------------------------------------------------------------------------------------------
 
     template<typename ItemType>
-    static bool GLTF_extractPrimitiveDataFromBuffer(
-        tinygltf::Model& gltfModel,
-        tinygltf::Primitive& primitive,
-        char const* fieldKey,
-        int expectedComponentType,
-        ItemType const*& outData,
-        uint32_t& outDataCount
+    static void GLTF_copyIndices(
+        AccessorView const & view,
+        uint32_t const begin,
+        uint32_t const end,
+        uint32_t const vertexBase,
+        Index * indices
+    )
+    {
+        if (view.stride == sizeof(ItemType))
+        {// Tightly packed, the compiler vectorizes the widening
+            auto const * items = reinterpret_cast<ItemType const *>(view.data);
+            for (uint32_t i = begin; i < end; ++i)
+            {
+                indices[i] = static_cast<Index>(items[i]) + vertexBase;
+            }
+        }
+        else
+        {
+            for (uint32_t i = begin; i < end; ++i)
+            {
+                ItemType item;
+                std::memcpy(&item, view.data + static_cast<size_t>(i) * view.stride, sizeof(ItemType));
+                indices[i] = static_cast<Index>(item) + vertexBase;
+            }
+        }
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    template<typename ItemType>
+    static void GLTF_copyJoints(
+        AccessorView const & view,
+        uint32_t const begin,
+        uint32_t const end,
+        Vertex * vertices
     )
     {
-        bool success = false;
-        if (primitive.attributes.find(fieldKey) != primitive.attributes.end())
-        {// Positions
-            success = true;
-            MFA_REQUIRE(static_cast<size_t>(primitive.attributes[fieldKey]) < gltfModel.accessors.size());
-            auto const& accessor = gltfModel.accessors[primitive.attributes[fieldKey]];
-            MFA_ASSERT(accessor.componentType == expectedComponentType);
-            auto const& bufferView = gltfModel.bufferViews[accessor.bufferView];
-            MFA_REQUIRE(static_cast<size_t>(bufferView.buffer) < gltfModel.buffers.size());
-            auto const& buffer = gltfModel.buffers[bufferView.buffer];
-            outData = reinterpret_cast<ItemType const*>(
-                &buffer.data[bufferView.byteOffset + accessor.byteOffset]
-                );
-            outDataCount = static_cast<uint32_t>(accessor.count);
+        int const jointCount = std::min(view.componentCount, 4);
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            ItemType items[4]{};
+            std::memcpy(items, view.data + static_cast<size_t>(i) * view.stride, sizeof(ItemType) * jointCount);
+            for (int j = 0; j < jointCount; ++j)
+            {
+                vertices[i].jointIndices[j] = items[j];
+            }
         }
-        return success;
     }
 
     //-------------------------------------------------------------------------------------------------
@@ -217,29 +375,26 @@ namespace MFA::Importer
     
     //-------------------------------------------------------------------------------------------------
     
+    // Callers read the elements as tightly packed arrays
     template<typename ItemType>
     static void GLTF_extractDataFromBuffer(
-        tinygltf::Model & gltfModel,
+        GLTF_Document const & document,
         int const accessorIndex,
         int const expectedComponentType,
         ItemType const *& outData,
         uint32_t & outDataCount
     )
     {
-        MFA_ASSERT(accessorIndex >= 0);
-        auto const & accessor = gltfModel.accessors[accessorIndex];
-        MFA_ASSERT(accessor.componentType == expectedComponentType);
-        auto const & bufferView = gltfModel.bufferViews[accessor.bufferView];
-        MFA_REQUIRE(bufferView.buffer < gltfModel.buffers.size());
-        auto const & buffer = gltfModel.buffers[bufferView.buffer];
-        outData = reinterpret_cast<ItemType const *>(
-            &buffer.data[bufferView.byteOffset + accessor.byteOffset]
-        );
-        outDataCount = static_cast<uint32_t>(accessor.count);
+        AccessorView view{};
+        auto const result = GLTF_getAccessorView(document, accessorIndex, view);
+        MFA_REQUIRE(result);
+        MFA_ASSERT(view.componentType == expectedComponentType);
+        outData = reinterpret_cast<ItemType const *>(view.data);
+        outDataCount = view.count;
     }
 
     static void GLTF_extractDataAndTypeFromBuffer(
-        tinygltf::Model const & gltfModel,
+        GLTF_Document const & document,
         int accessorIndex,
         int expectedComponentType,
         int & outType,
@@ -247,27 +402,24 @@ namespace MFA::Importer
         uint32_t & outDataCount
     )
     {
-        MFA_ASSERT(accessorIndex >= 0);
-        auto const & accessor = gltfModel.accessors[accessorIndex];
-        outType = accessor.type;
-        MFA_ASSERT(expectedComponentType == accessor.componentType);
-        auto const & bufferView = gltfModel.bufferViews[accessor.bufferView];
-        MFA_REQUIRE(bufferView.buffer < gltfModel.buffers.size());
-        auto const & buffer = gltfModel.buffers[bufferView.buffer];
-        outData = reinterpret_cast<void const *>(
-            &buffer.data[bufferView.byteOffset + accessor.byteOffset]
-        );
-        outDataCount = static_cast<uint32_t>(accessor.count);
+        AccessorView view{};
+        auto const result = GLTF_getAccessorView(document, accessorIndex, view);
+        MFA_REQUIRE(result);
+        MFA_ASSERT(expectedComponentType == view.componentType);
+        outType = document.model.accessors[accessorIndex].type;
+        outData = view.data;
+        outDataCount = view.count;
     }
 
     //-------------------------------------------------------------------------------------------------
 
     static void GLTF_extractSkins(
-        tinygltf::Model & gltfModel,
+        GLTF_Document const & document,
         Mesh * mesh
     )
     {
         MFA_ASSERT(mesh != nullptr);
+        auto const & gltfModel = document.model;
 
         for (auto const & gltfSkin : gltfModel.skins)
         {
@@ -281,7 +433,7 @@ namespace MFA::Importer
             uint32_t inverseBindMatricesCount = 0;
             float const * inverseBindMatricesPtr = nullptr;
             GLTF_extractDataFromBuffer(
-                gltfModel,
+                document,
                 gltfSkin.inverseBindMatrices,
                 TINYGLTF_COMPONENT_TYPE_FLOAT,
                 inverseBindMatricesPtr,
@@ -303,10 +455,11 @@ namespace MFA::Importer
     //-------------------------------------------------------------------------------------------------
 
     static void GLTF_extractAnimations(
-        tinygltf::Model & gltfModel,
+        GLTF_Document const & document,
         Mesh * mesh
     )
     {
+        auto const & gltfModel = document.model;
         using Sampler = Animation::Sampler;
         using Channel = Animation::Channel;
         using Interpolation = Animation::Interpolation;
@@ -364,7 +517,7 @@ namespace MFA::Importer
                     float const * inputData = nullptr;
                     uint32_t inputCount = 0;
                     GLTF_extractDataFromBuffer(
-                        gltfModel,
+                        document,
                         gltfSampler.input,
                         TINYGLTF_COMPONENT_TYPE_FLOAT,
                         inputData,
@@ -393,7 +546,7 @@ namespace MFA::Importer
                     uint32_t outputCount = 0;
                     int outputDataType = 0;
                     GLTF_extractDataAndTypeFromBuffer(
-                        gltfModel,
+                        document,
                         gltfSampler.output,
                         TINYGLTF_COMPONENT_TYPE_FLOAT,
                         outputDataType,
@@ -458,693 +611,620 @@ namespace MFA::Importer
 
     //-------------------------------------------------------------------------------------------------
 
-    static std::shared_ptr<Mesh> GLTF_extractSubMeshes(
-        tinygltf::Model& gltfModel,
-        std::vector<TextureRef> const& textureRefs
+    using TextureFuture = std::future<std::shared_ptr<AS::Texture>>;
+
+    //-------------------------------------------------------------------------------------------------
+
+    static ImportTextureOptions GLTF_textureOptions(TextureUsage const usage, ImportGLTFOptions const & options)
+    {
+        return ImportTextureOptions{
+            .tryToGenerateMipmaps = options.compressTextures,
+            .blockCompress = options.compressTextures,
+            .usage = usage,
+            .compressionQuality = options.textureQuality
+        };
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    static bool GLTF_isImage(std::string const & path)
+    {
+        auto const extension = std::filesystem::path(path).extension().string();
+        return extension == ".png" || extension == ".jpg" || extension == ".jpeg";
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    static std::shared_ptr<AS::Texture> GLTF_decodeTexture(
+        std::string const & path,
+        TextureUsage const usage,
+        ImportGLTFOptions const & options
     )
     {
-        auto const generateUvKeyword = [](int32_t const uvIndex) -> std::string
+        std::shared_ptr<AS::Texture> texture{};
+        if (GLTF_isImage(path))
         {
-            return "TEXCOORD_" + std::to_string(uvIndex);
-        };
-        // Step1: Iterate over all meshes and gather required information for asset buffer
-        uint32_t totalIndicesCount = 0;
-        uint32_t totalVerticesCount = 0;
-        uint32_t indicesVertexStartingIndex = 0;
-        for (auto& mesh : gltfModel.meshes)
+            texture = Importer::UncompressedImage(path, GLTF_textureOptions(usage, options));
+        }
+        else if (IsContainerTexture(path))
+        {// Compressed offline, the levels are copied as stored
+            texture = ContainerTexture(path);
+        }
+        else
         {
-            if (false == mesh.primitives.empty())
+            MFA_LOG_ERROR("Texture format is not supported: %s", path.c_str());
+        }
+        return texture;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    // Placeholder of GLTF_decodeTexture, skips the mipmaps and block compression of the full decode
+    static std::shared_ptr<AS::Texture> GLTF_decodePreview(
+        std::string const & path,
+        TextureUsage const usage,
+        ImportGLTFOptions const & options
+    )
+    {
+        std::shared_ptr<AS::Texture> preview{};
+        if (GLTF_isImage(path))
+        {
+            preview = Importer::PreviewImage(path, options.previewTextureSize, GLTF_textureOptions(usage, options));
+        }
+        else if (IsContainerTexture(path))
+        {
+            auto const texture = ContainerTexture(path);
+            if (texture != nullptr)
             {
-                for (auto& primitive : mesh.primitives)
-                {
-                    {// Indices
-                        MFA_REQUIRE((primitive.indices < gltfModel.accessors.size()));
-                        auto const& accessor = gltfModel.accessors[primitive.indices];
-                        totalIndicesCount += static_cast<uint32_t>(accessor.count);
-                    }
-                    {// Positions
-                        MFA_REQUIRE((primitive.attributes["POSITION"] < gltfModel.accessors.size()));
-                        auto const& accessor = gltfModel.accessors[primitive.attributes["POSITION"]];
-                        totalVerticesCount += static_cast<uint32_t>(accessor.count);
-                    }
-                }
+                preview = PreviewTexture(texture, options.previewTextureSize);
             }
         }
+        return preview;
+    }
 
-        auto mesh = std::make_shared<Mesh>(
-            totalVerticesCount,
-            totalIndicesCount,
-            Memory::AllocSize(sizeof(Vertex) * totalVerticesCount),
-            Memory::AllocSize(sizeof(Index) * totalIndicesCount)
-        );
+    //-------------------------------------------------------------------------------------------------
 
-        // Step2: Fill subMeshes
-        uint32_t primitiveUniqueId = 0;
-        std::vector<Vertex> primitiveVertices{};
-        std::vector<Index> primitiveIndices{};
-        for (auto& gltfMesh : gltfModel.meshes)
+    // Textures that share an image read it once. Returns the first ref of every distinct image, outImageIndices maps
+    // every texture ref to its image.
+    static std::vector<TextureRef> GLTF_mapImages(
+        std::vector<TextureRef> const & textureRefs,
+        std::vector<uint32_t> & outImageIndices
+    )
+    {
+        std::vector<TextureRef> images{};
+        std::unordered_map<std::string, uint32_t> imageLookup{};
+        outImageIndices.reserve(textureRefs.size());
+        for (auto const & textureRef : textureRefs)
         {
-            auto const meshIndex = mesh->InsertSubMesh();
-            if (false == gltfMesh.primitives.empty())
+            auto const [iterator, isNew] = imageLookup.try_emplace(
+                textureRef.relativePath,
+                static_cast<uint32_t>(images.size())
+            );
+            outImageIndices.emplace_back(iterator->second);
+            if (isNew)
             {
-                for (auto& gltfPrimitive : gltfMesh.primitives)
-                {
-                    primitiveIndices.erase(primitiveIndices.begin(), primitiveIndices.end());
-                    primitiveVertices.erase(primitiveVertices.begin(), primitiveVertices.end());
-
-                    int16_t baseColorTextureIndex = -1;
-                    int32_t baseColorUvIndex = -1;
-                    int16_t metallicRoughnessTextureIndex = -1;
-                    int32_t metallicRoughnessUvIndex = -1;
-                    int16_t normalTextureIndex = -1;
-                    int32_t normalUvIndex = -1;
-                    int16_t emissiveTextureIndex = -1;
-                    int32_t emissiveUvIndex = -1;
-                    int16_t occlusionTextureIndex = -1;
-                    int32_t occlusionUV_Index = -1;
-                    float baseColorFactor[4]{1.0f, 1.0f, 1.0f, 1.0f};
-                    float metallicFactor = 0;
-                    float roughnessFactor = 0;
-                    float emissiveFactor[3]{};
-                    bool doubleSided = false;
-                    float alphaCutoff = 0.0f;
-
-                    using AlphaMode = AS::GLTF::AlphaMode;
-                    AlphaMode alphaMode = AlphaMode::Opaque;
-
-                    uint32_t uniqueId = primitiveUniqueId;
-                    primitiveUniqueId++;
-                    if (gltfPrimitive.material >= 0)
-                    {// Material
-                        auto const& material = gltfModel.materials[gltfPrimitive.material];
-
-                        // Base color texture
-                        extractTextureAndUV_Index(
-                            gltfModel,
-                            material.pbrMetallicRoughness.baseColorTexture,
-                            textureRefs,
-                            baseColorTextureIndex,
-                            baseColorUvIndex
-                        );
-
-                        // Metallic-roughness texture
-                        extractTextureAndUV_Index(
-                            gltfModel,
-                            material.pbrMetallicRoughness.metallicRoughnessTexture,
-                            textureRefs,
-                            metallicRoughnessTextureIndex,
-                            metallicRoughnessUvIndex
-                        );
-
-                        // Normal texture
-                        extractTextureAndUV_Index(
-                            gltfModel,
-                            material.normalTexture,
-                            textureRefs,
-                            normalTextureIndex,
-                            normalUvIndex
-                        )
-
-                            // Emissive texture
-                            extractTextureAndUV_Index(
-                                gltfModel,
-                                material.emissiveTexture,
-                                textureRefs,
-                                emissiveTextureIndex,
-                                emissiveUvIndex
-                            )
-
-                            // Occlusion texture
-                            extractTextureAndUV_Index(
-                                gltfModel,
-                                material.occlusionTexture,
-                                textureRefs,
-                                occlusionTextureIndex,
-                                occlusionUV_Index
-                            )
-
-                        {// BaseColorFactor
-                            baseColorFactor[0] = static_cast<float>(material.pbrMetallicRoughness.baseColorFactor[0]);
-                            baseColorFactor[1] = static_cast<float>(material.pbrMetallicRoughness.baseColorFactor[1]);
-                            baseColorFactor[2] = static_cast<float>(material.pbrMetallicRoughness.baseColorFactor[2]);
-                            baseColorFactor[3] = static_cast<float>(material.pbrMetallicRoughness.baseColorFactor[3]);
-                        }
-                        metallicFactor = static_cast<float>(material.pbrMetallicRoughness.metallicFactor);
-                        roughnessFactor = static_cast<float>(material.pbrMetallicRoughness.roughnessFactor);
-                        {// EmissiveFactor
-                            emissiveFactor[0] = static_cast<float>(material.emissiveFactor[0]);
-                            emissiveFactor[1] = static_cast<float>(material.emissiveFactor[1]);
-                            emissiveFactor[2] = static_cast<float>(material.emissiveFactor[2]);
-                        }
+                images.emplace_back(textureRef);
+            }
+        }
+        return images;
+    }
 
-                        alphaCutoff = static_cast<float>(material.alphaCutoff);
-                        alphaMode = [&material]()->AlphaMode
-                        {
-                            if (material.alphaMode == "OPAQUE")
-                            {
-                                return AlphaMode::Opaque;
-                            }
-                            if (material.alphaMode == "BLEND")
-                            {
-                                return AlphaMode::Blend;
-                            }
-                            if (material.alphaMode == "MASK")
-                            {
-                                return AlphaMode::Mask;
-                            }
-                            MFA_LOG_ERROR("Unhandled format detected: %s", material.alphaMode.c_str());
-                            return AlphaMode::Invalid;
-                        }();
-                        doubleSided = material.doubleSided;
-                    }
+    //-------------------------------------------------------------------------------------------------
 
-                    uint32_t primitiveIndicesCount = 0;
-                    {// Indices
-                        MFA_REQUIRE(gltfPrimitive.indices < gltfModel.accessors.size());
-                        auto const& accessor = gltfModel.accessors[gltfPrimitive.indices];
-                        auto const& bufferView = gltfModel.bufferViews[accessor.bufferView];
-                        MFA_REQUIRE(bufferView.buffer < gltfModel.buffers.size());
-                        auto const& buffer = gltfModel.buffers[bufferView.buffer];
-                        primitiveIndicesCount = static_cast<uint32_t>(accessor.count);
+    // Starts one decode per distinct image while the caller extracts the mesh. Decodes run on the background threads
+    // of the job system, on the workers they would hold back the mesh batches that are queued behind them.
+    static void GLTF_startTextureDecodes(
+        std::vector<TextureRef> const & textureRefs,
+        ImportGLTFOptions const & options,
+        std::vector<uint32_t> & outImageIndices,
+        std::vector<TextureFuture> & outDecodes
+    )
+    {
+        // A background thread can not wait for other background tasks, it decodes lazily on the calling thread
+        bool const useJobSystem = JS::Instance != nullptr && JS::IsBackgroundThread() == false;
 
-                        switch (accessor.componentType)
-                        {
-                        case TINYGLTF_PARAMETER_TYPE_UNSIGNED_INT:
-                        {
-                            auto const* gltfIndices = reinterpret_cast<uint32_t const*>(
-                                &buffer.data[bufferView.byteOffset + accessor.byteOffset]
-                                );
-                            for (uint32_t i = 0; i < primitiveIndicesCount; i++)
-                            {
-                                primitiveIndices.emplace_back(gltfIndices[i] + indicesVertexStartingIndex);
-                            }
-                        }
-                        break;
-                        case TINYGLTF_PARAMETER_TYPE_UNSIGNED_SHORT:
-                        {
-                            auto const* gltfIndices = reinterpret_cast<uint16_t const*>(
-                                &buffer.data[bufferView.byteOffset + accessor.byteOffset]
-                                );
-                            for (uint32_t i = 0; i < primitiveIndicesCount; i++)
-                            {
-                                primitiveIndices.emplace_back(gltfIndices[i] + indicesVertexStartingIndex);
-                            }
-                        }
-                        break;
-                        case TINYGLTF_PARAMETER_TYPE_UNSIGNED_BYTE:
-                        {
-                            auto const* gltfIndices = reinterpret_cast<uint8_t const*>(
-                                &buffer.data[bufferView.byteOffset + accessor.byteOffset]
-                                );
-                            for (uint32_t i = 0; i < primitiveIndicesCount; i++)
-                            {
-                                primitiveIndices.emplace_back(gltfIndices[i] + indicesVertexStartingIndex);
-                            }
-                        }
-                        break;
-                        default:
-                            MFA_NOT_IMPLEMENTED_YET("Mohammad Fakhreddin");
-                        }
-                    }
+        for (auto const & image : GLTF_mapImages(textureRefs, outImageIndices))
+        {
+            std::function<std::shared_ptr<AS::Texture>()> decode = [
+                path = image.relativePath,
+                usage = image.usage,
+                options
+            ]()
+            {
+                return GLTF_decodeTexture(path, usage, options);
+            };
+            if (useJobSystem)
+            {
+                outDecodes.emplace_back(JS::Instance->AssignBackgroundTask(decode));
+            }
+            else
+            {
+                outDecodes.emplace_back(std::async(std::launch::deferred, decode));
+            }
+        }
+    }
 
-                    float const* positions = nullptr;
-                    uint32_t primitiveVertexCount = 0;
-                    float positionsMinValue[3]{};
-                    float positionsMaxValue[3]{};
-                    bool hasPositionMinMax = false;
-                    {// Position
-                        auto const result = GLTF_extractPrimitiveDataFromBuffer(
-                            gltfModel,
-                            gltfPrimitive,
-                            "POSITION",
-                            TINYGLTF_COMPONENT_TYPE_FLOAT,
-                            positions,
-                            primitiveVertexCount
-                        );
-                        MFA_ASSERT(result);
-                    }
+    //-------------------------------------------------------------------------------------------------
 
-                    float const* baseColorUVs = nullptr;
-                    float baseColorUV_Min[2]{};
-                    float baseColorUV_Max[2]{};
-                    bool hasBaseColorUvMinMax = false;
-                    if (baseColorUvIndex >= 0)
-                    {// BaseColor
-                        uint32_t baseColorUvsCount = 0;
-                        auto texture_coordinate_key_name = generateUvKeyword(baseColorUvIndex);
-                        auto const result = GLTF_extractPrimitiveDataFromBuffer(
-                            gltfModel,
-                            gltfPrimitive,
-                            texture_coordinate_key_name.c_str(),
-                            TINYGLTF_COMPONENT_TYPE_FLOAT,
-                            baseColorUVs,
-                            baseColorUvsCount
-                        );
-                        MFA_ASSERT(result == true);
-                        MFA_ASSERT(baseColorUvsCount == primitiveVertexCount);
-                    }
+    // Everything the fill pass needs for one primitive, resolved and validated by the first pass
+    struct PrimitiveSource
+    {
+        AccessorView indices{};
+        AccessorView positions{};
+        AccessorView normals{};
+        AccessorView tangents{};
+        AccessorView baseColorUVs{};
+        AccessorView normalUVs{};
+        AccessorView metallicRoughnessUVs{};
+        AccessorView emissionUVs{};
+        AccessorView occlusionUVs{};
+        AccessorView joints{};
+        AccessorView weights{};
+        Vertex * vertices = nullptr;
+        Index * indicesData = nullptr;
+        uint32_t vertexBase = 0;
+    };
 
-                    float const* metallicRoughnessUvs = nullptr;
-                    float metallicRoughnessUVMin[2]{};
-                    float metallicRoughnessUVMax[2]{};
-                    bool hasMetallicRoughnessUvMinMax = false;
-                    if (metallicRoughnessUvIndex >= 0)
-                    {// MetallicRoughness uvs
-                        std::string texture_coordinate_key_name = generateUvKeyword(metallicRoughnessUvIndex);
-                        uint32_t metallicRoughnessUvsCount = 0;
-                        auto const result = GLTF_extractPrimitiveDataFromBuffer(
-                            gltfModel,
-                            gltfPrimitive,
-                            texture_coordinate_key_name.c_str(),
-                            TINYGLTF_COMPONENT_TYPE_FLOAT,
-                            metallicRoughnessUvs,
-                            metallicRoughnessUvsCount
-                        );
-                        MFA_ASSERT(result == true);
-                        MFA_ASSERT(metallicRoughnessUvsCount == primitiveVertexCount);
-                    }
+    //-------------------------------------------------------------------------------------------------
 
-                    float const* emissionUVs = nullptr;
-                    float emissionUV_Min[2]{};
-                    float emissionUV_Max[2]{};
-                    bool hasEmissionUvMinMax = false;
-                    if (emissiveUvIndex >= 0)
-                    {// Emission uvs
-                        std::string textureCoordinateKeyName = generateUvKeyword(emissiveUvIndex);
-                        uint32_t emissionUvCount = 0;
-                        auto const result = GLTF_extractPrimitiveDataFromBuffer(
-                            gltfModel,
-                            gltfPrimitive,
-                            textureCoordinateKeyName.c_str(),
-                            TINYGLTF_COMPONENT_TYPE_FLOAT,
-                            emissionUVs,
-                            emissionUvCount
-                        );
-                        MFA_ASSERT(result == true);
-                        MFA_ASSERT(emissionUvCount == primitiveVertexCount);
-                    }
+    static void GLTF_extractMaterial(
+        tinygltf::Model const & gltfModel,
+        tinygltf::Primitive const & gltfPrimitive,
+        TextureLookup const & textureLookup,
+        Primitive & outPrimitive,
+        int32_t (&outUvIndices)[5]
+    )
+    {
+        using AlphaMode = AS::GLTF::AlphaMode;
+
+        int16_t baseColorTextureIndex = -1;
+        int16_t metallicRoughnessTextureIndex = -1;
+        int16_t normalTextureIndex = -1;
+        int16_t emissiveTextureIndex = -1;
+        int16_t occlusionTextureIndex = -1;
+        auto & [baseColorUvIndex, metallicRoughnessUvIndex, normalUvIndex, emissiveUvIndex, occlusionUV_Index] = outUvIndices;
+        baseColorUvIndex = metallicRoughnessUvIndex = normalUvIndex = emissiveUvIndex = occlusionUV_Index = -1;
+
+        outPrimitive.baseColorFactor[0] = outPrimitive.baseColorFactor[1] = 1.0f;
+        outPrimitive.baseColorFactor[2] = outPrimitive.baseColorFactor[3] = 1.0f;
+        outPrimitive.alphaMode = AlphaMode::Opaque;
+
+        if (gltfPrimitive.material >= 0)
+        {// Material
+            auto const& material = gltfModel.materials[gltfPrimitive.material];
+
+            // Base color texture
+            extractTextureAndUV_Index(
+                gltfModel,
+                material.pbrMetallicRoughness.baseColorTexture,
+                textureLookup,
+                baseColorTextureIndex,
+                baseColorUvIndex
+            );
 
-                    float const* occlusionUVs = nullptr;
-                    float occlusionUV_Min[2]{};
-                    float occlusionUV_Max[2]{};
-                    bool hasOcclusionUV_MinMax = false;
-                    if (occlusionUV_Index >= 0)
-                    {// Occlusion uvs
-                        std::string textureCoordinateKeyName = generateUvKeyword(occlusionUV_Index);
-                        uint32_t occlusionUV_Count = 0;
-                        auto const result = GLTF_extractPrimitiveDataFromBuffer(
-                            gltfModel,
-                            gltfPrimitive,
-                            textureCoordinateKeyName.c_str(),
-                            TINYGLTF_COMPONENT_TYPE_FLOAT,
-                            occlusionUVs,
-                            occlusionUV_Count
-                        );
-                        MFA_ASSERT(result == true);
-                        MFA_ASSERT(occlusionUV_Count == primitiveVertexCount);
-                    }
+            // Metallic-roughness texture
+            extractTextureAndUV_Index(
+                gltfModel,
+                material.pbrMetallicRoughness.metallicRoughnessTexture,
+                textureLookup,
+                metallicRoughnessTextureIndex,
+                metallicRoughnessUvIndex
+            );
 
-                    float const* normalsUVs = nullptr;
-                    float normalsUV_Min[2]{};
-                    float normalsUV_Max[2]{};
-                    bool hasNormalUvMinMax = false;
-                    if (normalUvIndex >= 0)
-                    {// Normal uvs
-                        std::string texture_coordinate_key_name = generateUvKeyword(normalUvIndex);
-                        uint32_t normalUvsCount = 0;
-                        auto const result = GLTF_extractPrimitiveDataFromBuffer(
-                            gltfModel,
-                            gltfPrimitive,
-                            texture_coordinate_key_name.c_str(),
-                            TINYGLTF_COMPONENT_TYPE_FLOAT,
-                            normalsUVs,
-                            normalUvsCount
-                        );
-                        MFA_ASSERT(result == true);
-                        MFA_ASSERT(normalUvsCount == primitiveVertexCount);
-                    }
-                    float const* normalValues = nullptr;
-                    float normalsValuesMin[3]{};
-                    float normalsValuesMax[3]{};
-                    bool hasNormalValueMinMax = false;
-                    {// Normal values
-                        uint32_t normalValuesCount = 0;
-                        auto const result = GLTF_extractPrimitiveDataFromBuffer(
-                            gltfModel,
-                            gltfPrimitive,
-                            "NORMAL",
-                            TINYGLTF_COMPONENT_TYPE_FLOAT,
-                            normalValues,
-                            normalValuesCount
-                        );
-                        MFA_ASSERT(result == false || normalValuesCount == primitiveVertexCount);
-                    }
+            // Normal texture
+            extractTextureAndUV_Index(
+                gltfModel,
+                material.normalTexture,
+                textureLookup,
+                normalTextureIndex,
+                normalUvIndex
+            );
 
-                    float const* tangentValues = nullptr;
-                    float tangentsValuesMin[4]{};
-                    float tangentsValuesMax[4]{};
-                    bool hasTangentsValuesMinMax = false;
-                    {// Tangent values
-                        uint32_t tangentValuesCount = 0;
-                        auto const result = GLTF_extractPrimitiveDataFromBuffer(
-                            gltfModel,
-                            gltfPrimitive,
-                            "TANGENT",
-                            TINYGLTF_COMPONENT_TYPE_FLOAT,
-                            tangentValues,
-                            tangentValuesCount
-                        );
-                        MFA_ASSERT(result == false || tangentValuesCount == primitiveVertexCount);
-                    }
+            // Emissive texture
+            extractTextureAndUV_Index(
+                gltfModel,
+                material.emissiveTexture,
+                textureLookup,
+                emissiveTextureIndex,
+                emissiveUvIndex
+            );
 
+            // Occlusion texture
+            extractTextureAndUV_Index(
+                gltfModel,
+                material.occlusionTexture,
+                textureLookup,
+                occlusionTextureIndex,
+                occlusionUV_Index
+            );
 
-                    uint32_t jointItemCount = 0;
-                    std::vector<uint16_t> jointValues{};
-                    int jointAccessorType = 0;
-                    {// Joints
-                        void const* rawJointValues = nullptr;
-                        int componentType = 0;
-                        uint32_t jointValuesCount = 0;
-                        GLTF_extractPrimitiveDataAndTypeFromBuffer(
-                            gltfModel,
-                            gltfPrimitive,
-                            "JOINTS_0",
-                            jointAccessorType,
-                            componentType,
-                            rawJointValues,
-                            jointValuesCount
-                        );
-                        jointItemCount = jointValuesCount * jointAccessorType;
-                        jointValues.resize(jointItemCount);
-                        switch (componentType)
-                        {
-                        case 0:
-                            break;
-                        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
-                        {
-                            auto const* shortJointValues = static_cast<uint16_t const*>(rawJointValues);
-                            for (uint32_t i = 0; i < jointItemCount; ++i)
-                            {
-                                jointValues[i] = shortJointValues[i];
-                            }
-                        }
-                        break;
-                        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
-                        {
-                            auto const* byteJointValues = static_cast<uint8_t const*>(rawJointValues);
-                            for (uint32_t i = 0; i < jointItemCount; ++i)
-                            {
-                                jointValues[i] = byteJointValues[i];
-                            }
-                        }
-                        break;
-                        default:
-                            MFA_CRASH("Unhandled type");
-                        }
-                        MFA_ASSERT((jointAccessorType > 0 || jointItemCount == 0));
-                    }
-                    std::vector<float> weightValues{};
-                    {// Weights
-                        int componentType = 0;
-                        int accessorType = 0;
-                        uint32_t rawValuesCount = 0;
-                        void const* rawValues = nullptr;
-
-                        GLTF_extractPrimitiveDataAndTypeFromBuffer(
-                            gltfModel,
-                            gltfPrimitive,
-                            "WEIGHTS_0",
-                            accessorType,
-                            componentType,
-                            rawValues,
-                            rawValuesCount
-                        );
-
-                        auto itemCount = rawValuesCount * accessorType;
-
-                        MFA_ASSERT(itemCount == jointItemCount);
-                        MFA_ASSERT(accessorType == jointAccessorType);
-
-                        weightValues.resize(itemCount);
-                        switch (componentType)
-                        {
-                        case 0:
-                            break;
-                        case TINYGLTF_COMPONENT_TYPE_FLOAT:
-                        {
-                            auto const* floatWeightValues = static_cast<float const*>(rawValues);
-                            for (uint32_t i = 0; i < jointItemCount; ++i)
-                            {
-                                weightValues[i] = floatWeightValues[i];
-                            }
-                        }
-                        break;
-                        default:
-                            MFA_CRASH("Unhandled type");
-                        }
-                        MFA_ASSERT((accessorType > 0 || itemCount == 0));
-                    }
-                    // TODO Start from here, Assign weight and joint
-                    float const* colors = nullptr;
-                    float colorsMinValue[3]{ 0 };
-                    float colorsMaxValue[3]{ 1 };
-                    float colorsMinMaxDiff[3]{ 1 };
-                    if (gltfPrimitive.attributes["COLOR"] >= 0)
-                    {
-                        MFA_REQUIRE(gltfPrimitive.attributes["COLOR"] < gltfModel.accessors.size());
-                        auto const& accessor = gltfModel.accessors[gltfPrimitive.attributes["COLOR"]];
-                        //MFA_ASSERT(accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT);
-                        //TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT
-                        if (accessor.minValues.size() == 3 && accessor.maxValues.size() == 3)
-                        {
-                            colorsMinValue[0] = static_cast<float>(accessor.minValues[0]);
-                            colorsMinValue[1] = static_cast<float>(accessor.minValues[1]);
-                            colorsMinValue[2] = static_cast<float>(accessor.minValues[2]);
-                            colorsMaxValue[0] = static_cast<float>(accessor.maxValues[0]);
-                            colorsMaxValue[1] = static_cast<float>(accessor.maxValues[1]);
-                            colorsMaxValue[2] = static_cast<float>(accessor.maxValues[2]);
-                            colorsMinMaxDiff[0] = colorsMaxValue[0] - colorsMinValue[0];
-                            colorsMinMaxDiff[1] = colorsMaxValue[1] - colorsMinValue[1];
-                            colorsMinMaxDiff[2] = colorsMaxValue[2] - colorsMinValue[2];
-                        }
-                        auto const& bufferView = gltfModel.bufferViews[accessor.bufferView];
-                        MFA_REQUIRE(bufferView.buffer < gltfModel.buffers.size());
-                        auto const& buffer = gltfModel.buffers[bufferView.buffer];
-                        colors = reinterpret_cast<const float*>(                           // TODO: Variable not used! Why?
-                            &buffer.data[bufferView.byteOffset + accessor.byteOffset]
-                            );
-                    }
+            {// BaseColorFactor
+                outPrimitive.baseColorFactor[0] = static_cast<float>(material.pbrMetallicRoughness.baseColorFactor[0]);
+                outPrimitive.baseColorFactor[1] = static_cast<float>(material.pbrMetallicRoughness.baseColorFactor[1]);
+                outPrimitive.baseColorFactor[2] = static_cast<float>(material.pbrMetallicRoughness.baseColorFactor[2]);
+                outPrimitive.baseColorFactor[3] = static_cast<float>(material.pbrMetallicRoughness.baseColorFactor[3]);
+            }
+            outPrimitive.metallicFactor = static_cast<float>(material.pbrMetallicRoughness.metallicFactor);
+            outPrimitive.roughnessFactor = static_cast<float>(material.pbrMetallicRoughness.roughnessFactor);
+            {// EmissiveFactor
+                outPrimitive.emissiveFactor[0] = static_cast<float>(material.emissiveFactor[0]);
+                outPrimitive.emissiveFactor[1] = static_cast<float>(material.emissiveFactor[1]);
+                outPrimitive.emissiveFactor[2] = static_cast<float>(material.emissiveFactor[2]);
+            }
 
-                    bool hasPosition = positions != nullptr;
-                    MFA_ASSERT(hasPosition == true);
-                    bool hasBaseColorTexture = baseColorUVs != nullptr;
-                    MFA_ASSERT(baseColorUVs != nullptr == baseColorTextureIndex >= 0);
-                    bool hasNormalValue = normalValues != nullptr;
-                    MFA_ASSERT(hasNormalValue == true);
-                    bool hasNormalTexture = normalsUVs != nullptr;
-                    MFA_ASSERT(normalsUVs != nullptr == normalTextureIndex >= 0);
-                    bool hasCombinedMetallicRoughness = metallicRoughnessUvs != nullptr;
-                    MFA_ASSERT(metallicRoughnessUvs != nullptr == metallicRoughnessTextureIndex >= 0);
-                    bool hasEmissiveTexture = emissionUVs != nullptr;
-                    MFA_ASSERT(emissionUVs != nullptr == emissiveTextureIndex >= 0);
-                    bool hasOcclusionTexture = occlusionUVs != nullptr;
-                    MFA_ASSERT((occlusionUVs != nullptr) == (occlusionTextureIndex >= 0));
-                    bool hasTangentValue = tangentValues != nullptr;
-                    bool hasSkin = jointItemCount > 0;
-                    for (uint32_t i = 0; i < primitiveVertexCount; ++i)
-                    {
-                        primitiveVertices.emplace_back();
-                        auto& vertex = primitiveVertices.back();
+            outPrimitive.alphaCutoff = static_cast<float>(material.alphaCutoff);
+            outPrimitive.alphaMode = [&material]()->AlphaMode
+            {
+                if (material.alphaMode == "OPAQUE")
+                {
+                    return AlphaMode::Opaque;
+                }
+                if (material.alphaMode == "BLEND")
+                {
+                    return AlphaMode::Blend;
+                }
+                if (material.alphaMode == "MASK")
+                {
+                    return AlphaMode::Mask;
+                }
+                MFA_LOG_ERROR("Unhandled format detected: %s", material.alphaMode.c_str());
+                return AlphaMode::Invalid;
+            }();
+            outPrimitive.doubleSided = material.doubleSided;
+        }
 
-                        // Positions
-                        if (hasPosition)
-                        {
-                            copyDataIntoVertexMember(
-                                &vertex.position[0],
-                                3,
-                                positions,
-                                i
-                            );
-                        }
+        outPrimitive.baseColorTextureIndex = baseColorTextureIndex;
+        outPrimitive.metallicRoughnessTextureIndex = metallicRoughnessTextureIndex;
+        outPrimitive.normalTextureIndex = normalTextureIndex;
+        outPrimitive.emissiveTextureIndex = emissiveTextureIndex;
+        outPrimitive.occlusionTextureIndex = occlusionTextureIndex;
+    }
 
-                        // Normal values
-                        if (hasNormalValue)
-                        {
-                            copyDataIntoVertexMember(
-                                &vertex.normal[0],
-                                3,
-                                normalValues,
-                                i
-                            );
-                        }
+    //-------------------------------------------------------------------------------------------------
 
-                        // Normal uvs
-                        if (hasNormalTexture)
-                        {
-                            copyDataIntoVertexMember(
-                                &vertex.normalMapUV[0],
-                                2,
-                                normalsUVs,
-                                i
-                            );
-                        }
+    // Fills vertices [begin, end) of a primitive. Only reads views that the first pass has validated.
+    static void GLTF_fillVertices(PrimitiveSource const & source, uint32_t const begin, uint32_t const end)
+    {
+        auto * vertices = source.vertices;
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            vertices[i] = Vertex{};
+        }
 
-                        if (hasTangentValue)
-                        {// Tangent
-                            copyDataIntoVertexMember(
-                                &vertex.tangent[0],
-                                4,
-                                tangentValues,
-                                i
-                            );
-                        }
+        GLTF_copyAttribute(source.positions, begin, end, vertices, &Vertex::position);
+        GLTF_copyAttribute(source.normals, begin, end, vertices, &Vertex::normal);
+        if (source.tangents.data != nullptr)
+        {// Only xyz is stored, the previous importer wrote w into hasSkin and overwrote it right after
+            GLTF_copyAttribute(source.tangents, begin, end, vertices, &Vertex::tangent);
+        }
+        if (source.baseColorUVs.data != nullptr)
+        {
+            GLTF_copyAttribute(source.baseColorUVs, begin, end, vertices, &Vertex::baseColorUV);
+        }
+        if (source.normalUVs.data != nullptr)
+        {
+            GLTF_copyAttribute(source.normalUVs, begin, end, vertices, &Vertex::normalMapUV);
+        }
+        if (source.metallicRoughnessUVs.data != nullptr)
+        {// Metallic and roughness share the same texture
+            GLTF_copyAttribute(source.metallicRoughnessUVs, begin, end, vertices, &Vertex::roughnessUV);
+            GLTF_copyAttribute(source.metallicRoughnessUVs, begin, end, vertices, &Vertex::metallicUV);
+        }
+        if (source.emissionUVs.data != nullptr)
+        {
+            GLTF_copyAttribute(source.emissionUVs, begin, end, vertices, &Vertex::emissionUV);
+        }
+        if (source.occlusionUVs.data != nullptr)
+        {
+            GLTF_copyAttribute(source.occlusionUVs, begin, end, vertices, &Vertex::occlusionUV);
+        }
 
-                        if (hasEmissiveTexture)
-                        {// Emissive
-                            copyDataIntoVertexMember(
-                                &vertex.emissionUV[0],
-                                2,
-                                emissionUVs,
-                                i
-                            );
-                        }
+        if (source.joints.data != nullptr)
+        {// Joint and weight
+            if (source.joints.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT)
+            {
+                GLTF_copyJoints<uint16_t>(source.joints, begin, end, vertices);
+            }
+            else
+            {
+                GLTF_copyJoints<uint8_t>(source.joints, begin, end, vertices);
+            }
 
-                        if (hasBaseColorTexture)
-                        {// BaseColor
-                            copyDataIntoVertexMember(
-                                &vertex.baseColorUV[0],
-                                2,
-                                baseColorUVs,
-                                i
-                            );
-                        }
+            size_t const weightsSize = sizeof(float) * std::min(source.weights.componentCount, 4);
+            uint8_t const * weights = source.weights.data + static_cast<size_t>(begin) * source.weights.stride;
+            for (uint32_t i = begin; i < end; ++i)
+            {
+                vertices[i].hasSkin = 1;
+                std::memcpy(vertices[i].jointWeights, weights, weightsSize);
+                weights += source.weights.stride;
+            }
+        }
+    }
 
-                        if (hasOcclusionTexture)
-                        {// Occlusion
-                            copyDataIntoVertexMember(
-                                &vertex.occlusionUV[0],
-                                2,
-                                occlusionUVs,
-                                i
-                            );
-                        }
+    //-------------------------------------------------------------------------------------------------
 
-                        if (hasCombinedMetallicRoughness)
-                        {// MetallicRoughness
-                            vertex.roughnessUV[0] = metallicRoughnessUvs[i * 2 + 0];
-                            vertex.roughnessUV[1] = metallicRoughnessUvs[i * 2 + 1];
-                            Memory::Copy(vertex.metallicUV, vertex.roughnessUV);
-                            static_assert(sizeof(vertex.roughnessUV) == sizeof(vertex.metallicUV));
-                            if (hasMetallicRoughnessUvMinMax)
-                            {
-                                MFA_ASSERT(vertex.roughnessUV[0] >= metallicRoughnessUVMin[0]);
-                                MFA_ASSERT(vertex.roughnessUV[0] <= metallicRoughnessUVMax[0]);
-                                MFA_ASSERT(vertex.roughnessUV[1] >= metallicRoughnessUVMin[1]);
-                                MFA_ASSERT(vertex.roughnessUV[1] <= metallicRoughnessUVMax[1]);
-                            }
-                        }
-                        // TODO WTF ? Outside of range error. Why do we need color range anyways ?
-                        // vertex.color[0] = static_cast<uint8_t>((256/(colorsMinMaxDiff[0])) * colors[i * 3 + 0]);
-                        // vertex.color[1] = static_cast<uint8_t>((256/(colorsMinMaxDiff[1])) * colors[i * 3 + 1]);
-                        // vertex.color[2] = static_cast<uint8_t>((256/(colorsMinMaxDiff[2])) * colors[i * 3 + 2]);
+    static void GLTF_fillIndices(PrimitiveSource const & source, uint32_t const begin, uint32_t const end)
+    {
+        switch (source.indices.componentType)
+        {
+        case TINYGLTF_PARAMETER_TYPE_UNSIGNED_INT:
+            GLTF_copyIndices<uint32_t>(source.indices, begin, end, source.vertexBase, source.indicesData);
+            break;
+        case TINYGLTF_PARAMETER_TYPE_UNSIGNED_SHORT:
+            GLTF_copyIndices<uint16_t>(source.indices, begin, end, source.vertexBase, source.indicesData);
+            break;
+        default:
+            GLTF_copyIndices<uint8_t>(source.indices, begin, end, source.vertexBase, source.indicesData);
+            break;
+        }
+    }
+
+    //-------------------------------------------------------------------------------------------------
 
-                        vertex.hasSkin = hasSkin ? 1 : 0;
+    // First pass resolves every primitive and reserves its exact range in the mesh buffers, serially because it can
+    // throw on broken files. Second pass fills the ranges in parallel, large primitives are split into chunks.
+    static std::shared_ptr<Mesh> GLTF_extractSubMeshes(
+        GLTF_Document const & document,
+        TextureLookup const& textureLookup
+    )
+    {
+        auto const & gltfModel = document.model;
 
-                        // Joint and weight
-                        if (hasSkin)
+        auto const generateUvKeyword = [](int32_t const uvIndex) -> std::string
+        {
+            return "TEXCOORD_" + std::to_string(uvIndex);
+        };
+
+        // Step1: Resolve all primitives and gather required information for asset buffer
+        std::vector<PrimitiveSource> sources{};
+        std::vector<Primitive> primitives{};
+        std::vector<uint32_t> primitiveSubMeshes{};
+        uint64_t totalIndicesCount = 0;
+        uint64_t totalVerticesCount = 0;
+        for (size_t meshIndex = 0; meshIndex < gltfModel.meshes.size(); ++meshIndex)
+        {
+            for (auto const & gltfPrimitive : gltfModel.meshes[meshIndex].primitives)
+            {
+                auto & source = sources.emplace_back();
+                auto & primitive = primitives.emplace_back();
+                primitiveSubMeshes.emplace_back(static_cast<uint32_t>(meshIndex));
+
+                primitive.uniqueId = static_cast<uint32_t>(primitives.size() - 1);
+
+                int32_t uvIndices[5]{};
+                GLTF_extractMaterial(gltfModel, gltfPrimitive, textureLookup, primitive, uvIndices);
+                auto const [baseColorUvIndex, metallicRoughnessUvIndex, normalUvIndex, emissiveUvIndex, occlusionUV_Index] = uvIndices;
+
+                {// Indices
+                    auto const result = GLTF_getAccessorView(document, gltfPrimitive.indices, source.indices);
+                    MFA_REQUIRE(result);
+                    MFA_REQUIRE(
+                        source.indices.componentType == TINYGLTF_PARAMETER_TYPE_UNSIGNED_INT ||
+                        source.indices.componentType == TINYGLTF_PARAMETER_TYPE_UNSIGNED_SHORT ||
+                        source.indices.componentType == TINYGLTF_PARAMETER_TYPE_UNSIGNED_BYTE
+                    );
+                }
+
+                {// Position
+                    auto const result = GLTF_getAttributeView(document, gltfPrimitive, "POSITION", source.positions);
+                    MFA_REQUIRE(result);
+                    MFA_REQUIRE(source.positions.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT);
+                    MFA_REQUIRE(source.positions.componentCount == 3);
+                }
+                uint32_t const vertexCount = source.positions.count;
+
+                // Every float attribute is copied as raw floats, so the layout has to be checked here
+                auto const requireFloats = [vertexCount](AccessorView const & view, int const componentCount)->void
+                {
+                    MFA_REQUIRE(view.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT);
+                    MFA_REQUIRE(view.componentCount >= componentCount);
+                    MFA_REQUIRE(view.count == vertexCount);
+                };
+
+                auto const getUvs = [&](int32_t const uvIndex, int const textureIndex, AccessorView & outView)->void
+                {
+                    if (uvIndex >= 0)
+                    {
+                        auto const result = GLTF_getAttributeView(document, gltfPrimitive, generateUvKeyword(uvIndex), outView);
+                        MFA_ASSERT(result == true);
+                        if (result)
                         {
-                            for (int j = 0; j < jointAccessorType; j++)
-                            {
-                                vertex.jointIndices[j] = jointValues[i * jointAccessorType + j];
-                                vertex.jointWeights[j] = weightValues[i * jointAccessorType + j];
-                            }
-                            for (int j = jointAccessorType; j < 4; j++)
-                            {
-                                vertex.jointIndices[j] = 0;
-                                vertex.jointWeights[j] = 0;
-                            }
+                            requireFloats(outView, 2);
                         }
                     }
+                    MFA_ASSERT((outView.data != nullptr) == (textureIndex >= 0));
+                };
+                getUvs(baseColorUvIndex, primitive.baseColorTextureIndex, source.baseColorUVs);
+                getUvs(metallicRoughnessUvIndex, primitive.metallicRoughnessTextureIndex, source.metallicRoughnessUVs);
+                getUvs(emissiveUvIndex, primitive.emissiveTextureIndex, source.emissionUVs);
+                getUvs(occlusionUV_Index, primitive.occlusionTextureIndex, source.occlusionUVs);
+                getUvs(normalUvIndex, primitive.normalTextureIndex, source.normalUVs);
+
+                {// Normal values
+                    auto const result = GLTF_getAttributeView(document, gltfPrimitive, "NORMAL", source.normals);
+                    MFA_REQUIRE(result);
+                    requireFloats(source.normals, 3);
+                }
 
-                    {// Creating new subMesh
-                        Primitive primitive{};
-                        primitive.uniqueId = uniqueId;
-                        primitive.baseColorTextureIndex = baseColorTextureIndex;
-                        primitive.metallicRoughnessTextureIndex = metallicRoughnessTextureIndex;
-                        primitive.normalTextureIndex = normalTextureIndex;
-                        primitive.emissiveTextureIndex = emissiveTextureIndex;
-                        primitive.occlusionTextureIndex = occlusionTextureIndex;
-                        Memory::Copy(primitive.baseColorFactor, baseColorFactor);
-                        primitive.metallicFactor = metallicFactor;
-                        primitive.roughnessFactor = roughnessFactor;
-                        Memory::Copy(primitive.emissiveFactor, emissiveFactor);
-                        //primitive.occlusionStrengthFactor = occlusion
-                        primitive.hasBaseColorTexture = hasBaseColorTexture;
-                        primitive.hasEmissiveTexture = hasEmissiveTexture;
-                        primitive.hasMetallicRoughnessTexture = hasCombinedMetallicRoughness;
-                        primitive.hasNormalBuffer = hasNormalValue;
-                        primitive.hasNormalTexture = hasNormalTexture;
-                        primitive.hasTangentBuffer = hasTangentValue;
-                        primitive.hasSkin = hasSkin;
-                        primitive.hasPositionMinMax = hasPositionMinMax;
-                        Memory::Copy(primitive.positionMin, positionsMinValue);
-                        Memory::Copy(primitive.positionMax, positionsMaxValue);
-
-                        primitive.alphaMode = alphaMode;
-                        primitive.alphaCutoff = alphaCutoff;
-                        primitive.doubleSided = doubleSided;
-
-                        mesh->InsertPrimitive(
-                            meshIndex,
-                            primitive,
-                            static_cast<uint32_t>(primitiveVertices.size()),
-                            primitiveVertices.data(),
-                            static_cast<uint32_t>(primitiveIndices.size()),
-                            primitiveIndices.data()
-                        );
-                    }
-                    indicesVertexStartingIndex += primitiveVertexCount;
+                if (GLTF_getAttributeView(document, gltfPrimitive, "TANGENT", source.tangents))
+                {// Tangent values
+                    requireFloats(source.tangents, 3);
+                }
 
+                if (GLTF_getAttributeView(document, gltfPrimitive, "JOINTS_0", source.joints))
+                {// Joints and weights
+                    MFA_REQUIRE(
+                        source.joints.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT ||
+                        source.joints.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE
+                    );
+                    MFA_REQUIRE(source.joints.count == vertexCount);
+                    auto const result = GLTF_getAttributeView(document, gltfPrimitive, "WEIGHTS_0", source.weights);
+                    MFA_REQUIRE(result);
+                    requireFloats(source.weights, source.joints.componentCount);
+                }
+
+                primitive.hasBaseColorTexture = source.baseColorUVs.data != nullptr;
+                primitive.hasEmissiveTexture = source.emissionUVs.data != nullptr;
+                primitive.hasMetallicRoughnessTexture = source.metallicRoughnessUVs.data != nullptr;
+                primitive.hasNormalBuffer = true;
+                primitive.hasNormalTexture = source.normalUVs.data != nullptr;
+                primitive.hasTangentBuffer = source.tangents.data != nullptr;
+                primitive.hasSkin = source.joints.data != nullptr;
+                primitive.hasPositionMinMax = false;
+
+                totalVerticesCount += vertexCount;
+                totalIndicesCount += source.indices.count;
+            }
+        }
+        MFA_REQUIRE(totalVerticesCount <= std::numeric_limits<uint32_t>::max());
+        MFA_REQUIRE(totalIndicesCount <= std::numeric_limits<uint32_t>::max());
+
+        auto mesh = std::make_shared<Mesh>(
+            static_cast<uint32_t>(totalVerticesCount),
+            static_cast<uint32_t>(totalIndicesCount),
+            Memory::AllocSize(sizeof(Vertex) * totalVerticesCount),
+            Memory::AllocSize(sizeof(Index) * totalIndicesCount)
+        );
+
+        for (size_t i = 0; i < gltfModel.meshes.size(); ++i)
+        {
+            auto const subMeshIndex = mesh->InsertSubMesh();
+            MFA_ASSERT(subMeshIndex == i);
+        }
+
+        // Step2: Reserve the exact ranges, in the same order as before so offsets and ids do not change
+        struct FillTask
+        {
+            uint32_t sourceIndex;
+            uint32_t begin;
+            uint32_t end;
+            bool isVertexTask;
+        };
+        static constexpr uint32_t ChunkSize = 64 * 1024;
+        std::vector<FillTask> tasks{};
+
+        auto * vertexData = mesh->GetVertexData()->As<Vertex>();
+        auto * indexData = mesh->GetIndexData()->As<Index>();
+        for (size_t i = 0; i < sources.size(); ++i)
+        {
+            auto & source = sources[i];
+            auto const & primitive = mesh->ReservePrimitive(
+                primitiveSubMeshes[i],
+                primitives[i],
+                source.positions.count,
+                source.indices.count
+            );
+            source.vertices = vertexData + primitive.verticesStartingIndex;
+            source.indicesData = indexData + primitive.indicesStartingIndex;
+            source.vertexBase = primitive.verticesStartingIndex;
+
+            for (uint32_t begin = 0; begin < source.positions.count; begin += ChunkSize)
+            {
+                auto const end = std::min(begin + ChunkSize, source.positions.count);
+                tasks.emplace_back(FillTask{static_cast<uint32_t>(i), begin, end, true});
+            }
+            for (uint32_t begin = 0; begin < source.indices.count; begin += ChunkSize)
+            {
+                auto const end = std::min(begin + ChunkSize, source.indices.count);
+                tasks.emplace_back(FillTask{static_cast<uint32_t>(i), begin, end, false});
+            }
+        }
+
+        // Step3: Fill the reserved ranges
+        auto const fillRange = [&sources, &tasks](int const begin, int const end)->void
+        {
+            for (int i = begin; i < end; ++i)
+            {
+                auto const & task = tasks[i];
+                auto const & source = sources[task.sourceIndex];
+                if (task.isVertexTask)
+                {
+                    GLTF_fillVertices(source, task.begin, task.end);
+                }
+                else
+                {
+                    GLTF_fillIndices(source, task.begin, task.end);
                 }
             }
+        };
+        if (JS::Instance != nullptr)
+        {
+            JS::Instance->ParallelFor(static_cast<int>(tasks.size()), 1, fillRange);
+        }
+        else
+        {
+            fillRange(0, static_cast<int>(tasks.size()));
         }
+
         return mesh;
     }
 
 	//-------------------------------------------------------------------------------------------------
 
-    std::shared_ptr<MFA::Importer::Model> GLTF_Model(std::string const& path)
+    // Parses the file and builds the final mesh. onTextureRefs runs as soon as the textures are known so that their
+    // decodes can overlap the mesh work.
+    static std::shared_ptr<Mesh> GLTF_loadMesh(
+        std::string const & path,
+        ImportGLTFOptions const & options,
+        std::function<void(std::vector<TextureRef> const &)> const & onTextureRefs
+    )
     {
-        std::shared_ptr<Model> model = nullptr;
+        std::shared_ptr<Mesh> mesh{};
         if (MFA_VERIFY(path.empty() == false))
         {
-            namespace TG = tinygltf;
-            TG::TinyGLTF loader{};
+            // The cooked entry stores the uri and usage of each texture, the decoded images have their own entries
+            auto * cache = ImportCache::Instance;
+            uint64_t cacheKey = 0;
+            if (cache != nullptr)
+            {
+                cacheKey = ImportCache::KeyBuilder("GLTF_Model", path)
+                    .Add(options.optimizeDrawOrder)
+                    .Add(options.buildLods)
+                    .Add(options.buildMeshlets)
+                    .Add(TextureRefsMetadataVersion)
+                    .Build();
+                std::vector<std::string> metadata{};
+                if (cache->Find(cacheKey, &metadata) && metadata.size() % 2 == 0)
+                {
+                    mesh = LoadCookedMesh(cache->PayloadPath(cacheKey, CookedMeshExtension));
+                    if (mesh != nullptr)
+                    {
+                        std::string const directoryPath = std::filesystem::path(path).parent_path().string();
+                        std::vector<TextureRef> textureRefs{};
+                        textureRefs.reserve(metadata.size() / 2);
+                        for (size_t i = 0; i < metadata.size(); i += 2)
+                        {
+                            auto const & imageUri = metadata[i];
+                            auto const & usage = metadata[i + 1];
+                            textureRefs.emplace_back(TextureRef{
+                                .gltfName = imageUri,
+                                .index = static_cast<uint8_t>(textureRefs.size()),
+                                .relativePath = directoryPath + "/" + imageUri,
+                                .usage = usage.empty() ? TextureUsage::Color : static_cast<TextureUsage>(usage[0] - '0')
+                            });
+                        }
+                        onTextureRefs(textureRefs);
+                        return mesh;
+                    }
+                }
+            }
+
             std::string error;
             std::string warning;
-            TG::Model gltfModel{};
+            GLTF_Document document{};
+            auto & gltfModel = document.model;
 
             auto const extension = std::filesystem::path(path).extension().string();
 
             bool success = false;
 
             if (extension == ".gltf")
-            {
-                success = loader.LoadASCIIFromFile(
-                    &gltfModel,
-                    &error,
-                    &warning,
-                    path
-                );
+            {// Json is read by a SAX pass, no DOM is built
+                success = GLTF_Load(path, document, error);
             }
             else if (extension == ".glb")
-            {
-                success = loader.LoadBinaryFromFile(
-                    &gltfModel,
-                    &error,
-                    &warning,
-                    path
-                );
+            {// Binary chunk stays in the mapped file
+                success = GLB_Load(path, document, error);
             }
             else
             {
@@ -1161,8 +1241,8 @@ namespace MFA::Importer
             }
             if (success)
             {
-                std::shared_ptr<Mesh> mesh{};
                 std::vector<TextureRef> textureRefs{};
+                TextureLookup textureLookup{};
 
                 // TODO Camera
                 if (false == gltfModel.meshes.empty())
@@ -1171,52 +1251,328 @@ namespace MFA::Importer
                     GLTF_extractTextures(
                         path,
                         gltfModel,
-                        textureRefs
+                        textureRefs,
+                        textureLookup
                     );
+                    onTextureRefs(textureRefs);
 
                     // SubMeshes
-                    mesh = GLTF_extractSubMeshes(gltfModel, textureRefs);
+                    mesh = GLTF_extractSubMeshes(document, textureLookup);
                     if (mesh == nullptr)
                     {
-                        return model;
+                        return mesh;
                     }
                 }
                 // Nodes
                 GLTF_extractNodes(gltfModel, mesh.get());
                 // Fill skin
-                GLTF_extractSkins(gltfModel, mesh.get());
+                GLTF_extractSkins(document, mesh.get());
                 // Animation
-                GLTF_extractAnimations(gltfModel, mesh.get());
+                GLTF_extractAnimations(document, mesh.get());
                 mesh->FinalizeData();
 
-                std::vector<std::shared_ptr<AS::Texture>> textures{};
-                for (size_t i = 0; i < textureRefs.size(); ++i)
+                if (options.optimizeDrawOrder)
+                {
+                    auto const report = AS::GLTF::MeshOptimizer::Optimize(*mesh);
+                    MFA_LOG_INFO(
+                        "Optimized draw order of %s. ACMR: %f -> %f, ATVR: %f -> %f",
+                        path.c_str(),
+                        report.before.acmr,
+                        report.after.acmr,
+                        report.before.atvr,
+                        report.after.atvr
+                    );
+                }
+
+                if (options.buildLods)
                 {
-                    auto const path = textureRefs[i].relativePath;
-                    auto const extension = std::filesystem::path(path).extension().string();
+                    AS::GLTF::MeshSimplifier::BuildLods(*mesh);
+                }
+
+                if (options.buildMeshlets)
+                {
+                    AS::GLTF::MeshOptimizer::BuildMeshlets(*mesh);
+                }
 
-                    std::shared_ptr<AS::Texture> texture{};
-                    if (extension == ".png" || extension == ".jpg" || extension == ".jpeg")
+                if (
+                    cache != nullptr &&
+                    SaveCookedMesh(*mesh, cache->PayloadPath(cacheKey, CookedMeshExtension))
+                )
+                {
+                    std::string const directoryPath = std::filesystem::path(path).parent_path().string();
+                    std::vector<std::string> sources{path};
+                    for (auto const & buffer : gltfModel.buffers)
                     {
-                        texture = Importer::UncompressedImage(path);
+                        if (buffer.uri.empty() == false && buffer.uri.starts_with("data:") == false)
+                        {
+                            sources.emplace_back(directoryPath + "/" + buffer.uri);
+                        }
                     }
-                    else
+                    std::vector<std::string> metadata{};
+                    metadata.reserve(textureRefs.size() * 2);
+                    for (auto const & textureRef : textureRefs)
                     {
-                        MFA_ASSERT(false);
+                        metadata.emplace_back(textureRef.gltfName);
+                        metadata.emplace_back(1, static_cast<char>('0' + static_cast<int>(textureRef.usage)));
                     }
-
-                    MFA_ASSERT(texture != nullptr);
-                    textures.emplace_back(texture);
+                    cache->Commit(cacheKey, sources, metadata);
                 }
+            }
+        }
+        return mesh;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    std::shared_ptr<MFA::Importer::Model> GLTF_Model(std::string const& path, ImportGLTFOptions const & options)
+    {
+        std::vector<uint32_t> imageIndices{};
+        std::vector<TextureFuture> imageDecodes{};
+
+        auto const mesh = GLTF_loadMesh(path, options, [&](std::vector<TextureRef> const & textureRefs)->void
+        {
+            GLTF_startTextureDecodes(textureRefs, options, imageIndices, imageDecodes);
+        });
+        if (mesh == nullptr)
+        {
+            return nullptr;
+        }
+
+        std::vector<std::shared_ptr<AS::Texture>> images{};
+        images.reserve(imageDecodes.size());
+        for (auto & decode : imageDecodes)
+        {
+            images.emplace_back(decode.get());
+        }
+
+        std::vector<std::shared_ptr<AS::Texture>> textures{};
+        textures.reserve(imageIndices.size());
+        for (auto const imageIndex : imageIndices)
+        {
+            auto const & texture = images[imageIndex];
+            MFA_ASSERT(texture != nullptr);
+            textures.emplace_back(texture);
+        }
 
-                model = std::make_shared<Model>();
-                model->mesh = mesh;
-                model->textures = textures;
+        auto model = std::make_shared<Model>();
+        model->mesh = mesh;
+        model->textures = textures;
+        return model;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    LoadStage AsyncModel::GetStage() const noexcept
+    {
+        return _stage.load(std::memory_order_acquire);
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    std::shared_ptr<Model> AsyncModel::GetModel() const
+    {
+        std::lock_guard lock{_mutex};
+        return _model;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    void AsyncModel::Wait() const
+    {
+        std::unique_lock lock{_mutex};
+        _condition.wait(lock, [this]()->bool
+        {
+            auto const stage = GetStage();
+            return stage == LoadStage::Complete || stage == LoadStage::Failed;
+        });
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    void AsyncModel::Publish(LoadStage const stage, std::shared_ptr<Model> model)
+    {
+        {
+            std::lock_guard lock{_mutex};
+            MFA_ASSERT(stage > _stage.load(std::memory_order_relaxed));
+            if (model != nullptr)
+            {
+                _model = std::move(model);
             }
+            _stage.store(stage, std::memory_order_release);
+        }
+        _condition.notify_all();
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    // Decodes of an async load that are still running. The last preview to finish publishes the previews and the
+    // last full decode publishes the images. Both counts start one above the image count: the loading thread holds
+    // the extra preview until every task is queued and the previews hold the extra image, so the images are never
+    // published before them.
+    struct PendingTextures
+    {
+        std::shared_ptr<AsyncModel> handle{};
+        std::shared_ptr<Mesh> mesh{};
+        std::vector<uint32_t> imageIndices{};
+        std::vector<std::shared_ptr<AS::Texture>> images{};
+        std::vector<std::shared_ptr<AS::Texture>> previews{};
+        std::atomic<size_t> remainingPreviews = 0;
+        std::atomic<size_t> remainingImages = 0;
+    };
+
+    //-------------------------------------------------------------------------------------------------
+
+    static std::shared_ptr<Model> GLTF_createTexturedModel(
+        PendingTextures const & pending,
+        std::vector<std::shared_ptr<AS::Texture>> const & source
+    )
+    {
+        auto model = std::make_shared<Model>();
+        model->mesh = pending.mesh;
+        model->textures.reserve(pending.imageIndices.size());
+        for (auto const imageIndex : pending.imageIndices)
+        {
+            model->textures.emplace_back(source[imageIndex]);
         }
         return model;
     }
 
     //-------------------------------------------------------------------------------------------------
 
-}
\ No newline at end of file
+    static void GLTF_finishImage(PendingTextures & pending)
+    {
+        if (pending.remainingImages.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            pending.handle->Publish(LoadStage::Complete, GLTF_createTexturedModel(pending, pending.images));
+        }
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    static void GLTF_finishPreview(PendingTextures & pending)
+    {
+        if (pending.remainingPreviews.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            pending.handle->Publish(
+                LoadStage::PreviewTexturesReady,
+                GLTF_createTexturedModel(pending, pending.previews)
+            );
+            GLTF_finishImage(pending);
+        }
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    static void GLTF_loadStages(
+        std::shared_ptr<AsyncModel> const & handle,
+        std::string const & path,
+        ImportGLTFOptions const & options
+    )
+    {
+        std::vector<TextureRef> textureRefs{};
+        std::shared_ptr<Mesh> mesh{};
+        try
+        {
+            mesh = GLTF_loadMesh(path, options, [&textureRefs](std::vector<TextureRef> const & refs)->void
+            {
+                for (auto const & textureRef : refs)
+                {
+                    textureRefs.emplace_back(textureRef);
+                }
+            });
+        }
+        catch (std::exception const & exception)
+        {
+            MFA_LOG_ERROR("Failed to load %s: %s", path.c_str(), exception.what());
+        }
+        if (mesh == nullptr)
+        {
+            handle->Publish(LoadStage::Failed, nullptr);
+            return;
+        }
+
+        auto meshModel = std::make_shared<Model>();
+        meshModel->mesh = mesh;
+        meshModel->textures.resize(textureRefs.size());
+        handle->Publish(LoadStage::MeshReady, meshModel);
+
+        auto pending = std::make_shared<PendingTextures>();
+        pending->handle = handle;
+        pending->mesh = mesh;
+        auto const images = GLTF_mapImages(textureRefs, pending->imageIndices);
+        pending->images.resize(images.size());
+        pending->previews.resize(images.size());
+        pending->remainingPreviews = images.size() + 1;
+        pending->remainingImages = images.size() + 1;
+
+        // Each decode is its own background task, so they run in parallel without any of them waiting. The previews
+        // are queued first and only decode the base level, they are on screen long before the full images.
+        auto const run = [](std::function<void()> const & task)->void
+        {
+            if (JS::Instance != nullptr && JS::IsBackgroundThread())
+            {
+                JS::Instance->AssignBackgroundTask(task);
+            }
+            else
+            {
+                task();
+            }
+        };
+        for (size_t i = 0; i < images.size(); ++i)
+        {
+            run([pending, i, path = images[i].relativePath, usage = images[i].usage, options]()->void
+            {
+                try
+                {
+                    pending->previews[i] = GLTF_decodePreview(path, usage, options);
+                }
+                catch (std::exception const & exception)
+                {// Nobody waits for the task, the load has to complete anyway
+                    MFA_LOG_ERROR("Failed to decode the preview of %s: %s", path.c_str(), exception.what());
+                }
+                GLTF_finishPreview(*pending);
+            });
+        }
+        for (size_t i = 0; i < images.size(); ++i)
+        {
+            run([pending, i, path = images[i].relativePath, usage = images[i].usage, options]()->void
+            {
+                try
+                {
+                    pending->images[i] = GLTF_decodeTexture(path, usage, options);
+                }
+                catch (std::exception const & exception)
+                {
+                    MFA_LOG_ERROR("Failed to decode %s: %s", path.c_str(), exception.what());
+                }
+                GLTF_finishImage(*pending);
+            });
+        }
+        // Releases the count of this thread, so an empty image list publishes both stages right away
+        GLTF_finishPreview(*pending);
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    std::shared_ptr<AsyncModel> GLTF_ModelAsync(std::string const & path, ImportGLTFOptions const & options)
+    {
+        auto handle = std::make_shared<AsyncModel>();
+        if (JS::Instance != nullptr && JS::Instance->IsMainThread())
+        {
+            // The handle reports progress, so the future is not needed. The load runs on a background thread, a worker
+            // would hold back every batch that the main thread queues behind it.
+            JS::Instance->AssignBackgroundTask([handle, path, options]()->void
+            {
+                GLTF_loadStages(handle, path, options);
+            });
+        }
+        else
+        {
+            GLTF_loadStages(handle, path, options);
+        }
+        return handle;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+}
@@ -4,8 +4,12 @@
 
 #include "AssetGLTF_Mesh.hpp"
 #include "AssetGLTF_Model.hpp"
+#include "ImportBlockCompression.hpp"
 
+#include <atomic>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <string>
 
 namespace MFA::Importer
@@ -20,5 +24,65 @@ namespace MFA::Importer
     using Node = AS::GLTF::Node;
     using Skin = AS::GLTF::Skin;
 
-    std::shared_ptr<Model> GLTF_Model(std::string const& path);
+    struct ImportGLTFOptions
+    {
+        bool optimizeDrawOrder = true;          // Reorders the triangles and vertices of each primitive for the gpu caches
+        bool buildLods = true;                  // Simplified index lists for distant instances
+        bool buildMeshlets = true;              // Needed for cluster culling
+        uint32_t previewTextureSize = 64;       // Largest side of the placeholder textures of GLTF_ModelAsync
+        bool compressTextures = false;          // BC formats picked from the material slots, generates the mips too
+        CompressionQuality textureQuality = CompressionQuality::Balanced;
+    };
+
+    std::shared_ptr<Model> GLTF_Model(std::string const& path, ImportGLTFOptions const & options = {});
+
+    // Stages of an asynchronous load, they only move forward
+    enum class LoadStage : uint8_t
+    {
+        Loading,
+        MeshReady,                              // Textures are nullptr
+        PreviewTexturesReady,                   // Textures are small placeholders
+        Complete,
+        Failed
+    };
+
+    // Handle of GLTF_ModelAsync. Each stage publishes a new model that shares the mesh with the previous ones,
+    // so a model returned by GetModel never changes while the caller uses it.
+    class AsyncModel
+    {
+    public:
+
+        explicit AsyncModel() = default;
+
+        AsyncModel(AsyncModel const &) noexcept = delete;
+        AsyncModel(AsyncModel &&) noexcept = delete;
+        AsyncModel & operator = (AsyncModel const &) noexcept = delete;
+        AsyncModel & operator = (AsyncModel &&) noexcept = delete;
+
+        [[nodiscard]]
+        LoadStage GetStage() const noexcept;
+
+        // Latest published model, nullptr until the mesh is ready
+        [[nodiscard]]
+        std::shared_ptr<Model> GetModel() const;
+
+        // Blocks until the load is complete or has failed
+        void Wait() const;
+
+        void Publish(LoadStage stage, std::shared_ptr<Model> model);
+
+    private:
+
+        mutable std::mutex _mutex{};
+        mutable std::condition_variable _condition{};
+        std::atomic<LoadStage> _stage = LoadStage::Loading;
+        std::shared_ptr<Model> _model{};
+
+    };
+
+    // Loads the model on the background threads of the job system and returns right away. The mesh is published
+    // first, then preview textures and then the full textures. Without a job system the load runs before the function
+    // returns.
+    [[nodiscard]]
+    std::shared_ptr<AsyncModel> GLTF_ModelAsync(std::string const & path, ImportGLTFOptions const & options = {});
 }
@@ -0,0 +1,794 @@
+#include "ImportGLTF_Document.hpp"
+
+#include "BedrockAssert.hpp"
+
+#include "json.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+
+namespace MFA::Importer
+{
+
+    namespace
+    {
+
+        using Json = nlohmann::json;
+
+        // Containers of the json that the importer reads, everything else is skipped without being stored
+        enum class Scope : uint8_t
+        {
+            Ignore,
+            Root,
+            Accessors,
+            Accessor,
+            BufferViews,
+            BufferView,
+            Buffers,
+            Buffer,
+            Images,
+            Image,
+            Textures,
+            Texture,
+            TextureExtensions,
+            TextureExtension,
+            Materials,
+            Material,
+            PbrMetallicRoughness,
+            TextureInfo,
+            Meshes,
+            Mesh,
+            Primitives,
+            Primitive,
+            Attributes,
+            Nodes,
+            Node,
+            Skins,
+            Skin,
+            Animations,
+            Animation,
+            AnimationSamplers,
+            AnimationSampler,
+            AnimationChannels,
+            AnimationChannel,
+            ChannelTarget,
+            Numbers,
+            Integers
+        };
+
+        // Target is the tinygltf object that the container fills. Texture infos have different types that share
+        // index and texCoord, so a TextureInfo frame points at the index and keeps the texCoord separately.
+        struct Frame
+        {
+            Scope scope = Scope::Ignore;
+            void * target = nullptr;
+            int * texCoord = nullptr;
+        };
+
+        //-------------------------------------------------------------------------------------------------
+
+        int GLTF_typeFromString(std::string const & type)
+        {
+            if (type == "SCALAR") return TINYGLTF_TYPE_SCALAR;
+            if (type == "VEC2") return TINYGLTF_TYPE_VEC2;
+            if (type == "VEC3") return TINYGLTF_TYPE_VEC3;
+            if (type == "VEC4") return TINYGLTF_TYPE_VEC4;
+            if (type == "MAT2") return TINYGLTF_TYPE_MAT2;
+            if (type == "MAT3") return TINYGLTF_TYPE_MAT3;
+            if (type == "MAT4") return TINYGLTF_TYPE_MAT4;
+            return -1;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        class GLTF_SaxHandler final : public Json::json_sax_t
+        {
+        public:
+
+            explicit GLTF_SaxHandler(GLTF_Document & document)
+                : _model(document.model)
+                , _bufferLengths(document.bufferLengths)
+            {}
+
+            bool null() override
+            {
+                return true;
+            }
+
+            bool boolean(bool const value) override
+            {
+                if (_frames.empty())
+                {
+                    return false;
+                }
+                auto const & frame = _frames.back();
+                switch (frame.scope)
+                {
+                case Scope::Accessor:
+                    if (_key == "normalized") Target<tinygltf::Accessor>().normalized = value;
+                    break;
+                case Scope::Material:
+                    if (_key == "doubleSided") Target<tinygltf::Material>().doubleSided = value;
+                    break;
+                default:
+                    break;
+                }
+                return true;
+            }
+
+            bool number_integer(number_integer_t const value) override
+            {
+                return Number(static_cast<double>(value));
+            }
+
+            bool number_unsigned(number_unsigned_t const value) override
+            {
+                return Number(static_cast<double>(value));
+            }
+
+            bool number_float(number_float_t const value, string_t const &) override
+            {
+                return Number(value);
+            }
+
+            bool string(string_t & value) override
+            {
+                if (_frames.empty())
+                {
+                    return false;
+                }
+                auto const & frame = _frames.back();
+                switch (frame.scope)
+                {
+                case Scope::Accessor:
+                    if (_key == "type") Target<tinygltf::Accessor>().type = GLTF_typeFromString(value);
+                    break;
+                case Scope::Buffer:
+                    if (_key == "uri") Target<tinygltf::Buffer>().uri = std::move(value);
+                    break;
+                case Scope::Image:
+                {
+                    auto & image = Target<tinygltf::Image>();
+                    if (_key == "uri") image.uri = std::move(value);
+                    else if (_key == "mimeType") image.mimeType = std::move(value);
+                    else if (_key == "name") image.name = std::move(value);
+                    break;
+                }
+                case Scope::Material:
+                {
+                    auto & material = Target<tinygltf::Material>();
+                    if (_key == "alphaMode") material.alphaMode = std::move(value);
+                    else if (_key == "name") material.name = std::move(value);
+                    break;
+                }
+                case Scope::Mesh:
+                    if (_key == "name") Target<tinygltf::Mesh>().name = std::move(value);
+                    break;
+                case Scope::Node:
+                    if (_key == "name") Target<tinygltf::Node>().name = std::move(value);
+                    break;
+                case Scope::Skin:
+                    if (_key == "name") Target<tinygltf::Skin>().name = std::move(value);
+                    break;
+                case Scope::Animation:
+                    if (_key == "name") Target<tinygltf::Animation>().name = std::move(value);
+                    break;
+                case Scope::AnimationSampler:
+                    if (_key == "interpolation") Target<tinygltf::AnimationSampler>().interpolation = std::move(value);
+                    break;
+                case Scope::ChannelTarget:
+                    if (_key == "path") Target<tinygltf::AnimationChannel>().target_path = std::move(value);
+                    break;
+                default:
+                    break;
+                }
+                return true;
+            }
+
+            bool binary(binary_t &) override
+            {
+                return true;
+            }
+
+            bool start_object(std::size_t) override
+            {
+                if (_frames.empty())
+                {
+                    _frames.emplace_back(Frame{Scope::Root, &_model});
+                    return true;
+                }
+                _frames.emplace_back(ObjectFrame(_frames.back()));
+                return true;
+            }
+
+            bool key(string_t & value) override
+            {
+                _key = std::move(value);
+                return true;
+            }
+
+            bool end_object() override
+            {
+                _frames.pop_back();
+                return true;
+            }
+
+            bool start_array(std::size_t) override
+            {
+                if (_frames.empty())
+                {
+                    return false;
+                }
+                _frames.emplace_back(ArrayFrame(_frames.back()));
+                return true;
+            }
+
+            bool end_array() override
+            {
+                _frames.pop_back();
+                return true;
+            }
+
+            bool parse_error(std::size_t, std::string const &, nlohmann::detail::exception const & exception) override
+            {
+                _error = exception.what();
+                return false;
+            }
+
+            [[nodiscard]]
+            std::string const & Error() const noexcept
+            {
+                return _error;
+            }
+
+        private:
+
+            template<typename T>
+            T & Target() const
+            {
+                return *static_cast<T *>(_frames.back().target);
+            }
+
+            //-------------------------------------------------------------------------------------------------
+
+            bool Number(double const value)
+            {
+                if (_frames.empty())
+                {
+                    return false;
+                }
+                auto const & frame = _frames.back();
+                auto const asInt = static_cast<int>(value);
+                auto const asSize = value > 0.0 ? static_cast<size_t>(value) : 0;
+                switch (frame.scope)
+                {
+                case Scope::Numbers:
+                    static_cast<std::vector<double> *>(frame.target)->emplace_back(value);
+                    break;
+                case Scope::Integers:
+                    static_cast<std::vector<int> *>(frame.target)->emplace_back(asInt);
+                    break;
+                case Scope::Accessor:
+                {
+                    auto & accessor = Target<tinygltf::Accessor>();
+                    if (_key == "bufferView") accessor.bufferView = asInt;
+                    else if (_key == "byteOffset") accessor.byteOffset = asSize;
+                    else if (_key == "componentType") accessor.componentType = asInt;
+                    else if (_key == "count") accessor.count = asSize;
+                    break;
+                }
+                case Scope::BufferView:
+                {
+                    auto & bufferView = Target<tinygltf::BufferView>();
+                    if (_key == "buffer") bufferView.buffer = asInt;
+                    else if (_key == "byteOffset") bufferView.byteOffset = asSize;
+                    else if (_key == "byteLength") bufferView.byteLength = asSize;
+                    else if (_key == "byteStride") bufferView.byteStride = asSize;
+                    else if (_key == "target") bufferView.target = asInt;
+                    break;
+                }
+                case Scope::Buffer:
+                    if (_key == "byteLength") _bufferLengths.back() = asSize;
+                    break;
+                case Scope::Image:
+                    if (_key == "bufferView") Target<tinygltf::Image>().bufferView = asInt;
+                    break;
+                case Scope::Texture:
+                {
+                    auto & texture = Target<tinygltf::Texture>();
+                    if (_key == "source") texture.source = asInt;
+                    else if (_key == "sampler") texture.sampler = asInt;
+                    break;
+                }
+                case Scope::TextureExtension:
+                    // Stored the way tinygltf stores the extension object
+                    if (_key == "source")
+                    {
+                        *static_cast<tinygltf::Value *>(frame.target) = tinygltf::Value(
+                            tinygltf::Value::Object{{"source", tinygltf::Value(asInt)}}
+                        );
+                    }
+                    break;
+                case Scope::Material:
+                    if (_key == "alphaCutoff") Target<tinygltf::Material>().alphaCutoff = value;
+                    break;
+                case Scope::PbrMetallicRoughness:
+                {
+                    auto & pbr = Target<tinygltf::PbrMetallicRoughness>();
+                    if (_key == "metallicFactor") pbr.metallicFactor = value;
+                    else if (_key == "roughnessFactor") pbr.roughnessFactor = value;
+                    break;
+                }
+                case Scope::TextureInfo:
+                    if (_key == "index") *static_cast<int *>(frame.target) = asInt;
+                    else if (_key == "texCoord") *frame.texCoord = asInt;
+                    break;
+                case Scope::Primitive:
+                {
+                    auto & primitive = Target<tinygltf::Primitive>();
+                    if (_key == "indices") primitive.indices = asInt;
+                    else if (_key == "material") primitive.material = asInt;
+                    else if (_key == "mode") primitive.mode = asInt;
+                    break;
+                }
+                case Scope::Attributes:
+                    (*static_cast<std::map<std::string, int> *>(frame.target))[_key] = asInt;
+                    break;
+                case Scope::Node:
+                {
+                    auto & node = Target<tinygltf::Node>();
+                    if (_key == "mesh") node.mesh = asInt;
+                    else if (_key == "skin") node.skin = asInt;
+                    else if (_key == "camera") node.camera = asInt;
+                    break;
+                }
+                case Scope::Skin:
+                {
+                    auto & skin = Target<tinygltf::Skin>();
+                    if (_key == "inverseBindMatrices") skin.inverseBindMatrices = asInt;
+                    else if (_key == "skeleton") skin.skeleton = asInt;
+                    break;
+                }
+                case Scope::AnimationSampler:
+                {
+                    auto & sampler = Target<tinygltf::AnimationSampler>();
+                    if (_key == "input") sampler.input = asInt;
+                    else if (_key == "output") sampler.output = asInt;
+                    break;
+                }
+                case Scope::AnimationChannel:
+                    if (_key == "sampler") Target<tinygltf::AnimationChannel>().sampler = asInt;
+                    break;
+                case Scope::ChannelTarget:
+                    if (_key == "node") Target<tinygltf::AnimationChannel>().target_node = asInt;
+                    break;
+                default:
+                    break;
+                }
+                return true;
+            }
+
+            //-------------------------------------------------------------------------------------------------
+
+            // Object inside an array becomes a new element, other objects are selected by their key
+            Frame ObjectFrame(Frame const & parent)
+            {
+                switch (parent.scope)
+                {
+                case Scope::Accessors:
+                    return {Scope::Accessor, &_model.accessors.emplace_back()};
+                case Scope::BufferViews:
+                    return {Scope::BufferView, &_model.bufferViews.emplace_back()};
+                case Scope::Buffers:
+                    _bufferLengths.emplace_back(0);
+                    return {Scope::Buffer, &_model.buffers.emplace_back()};
+                case Scope::Images:
+                    return {Scope::Image, &_model.images.emplace_back()};
+                case Scope::Textures:
+                    return {Scope::Texture, &_model.textures.emplace_back()};
+                case Scope::Materials:
+                {
+                    auto & material = _model.materials.emplace_back();
+                    material.emissiveFactor = {0.0, 0.0, 0.0};
+                    return {Scope::Material, &material};
+                }
+                case Scope::Meshes:
+                    return {Scope::Mesh, &_model.meshes.emplace_back()};
+                case Scope::Primitives:
+                    return {Scope::Primitive, &static_cast<std::vector<tinygltf::Primitive> *>(parent.target)->emplace_back()};
+                case Scope::Nodes:
+                    return {Scope::Node, &_model.nodes.emplace_back()};
+                case Scope::Skins:
+                    return {Scope::Skin, &_model.skins.emplace_back()};
+                case Scope::Animations:
+                    return {Scope::Animation, &_model.animations.emplace_back()};
+                case Scope::AnimationSamplers:
+                    return {Scope::AnimationSampler, &static_cast<std::vector<tinygltf::AnimationSampler> *>(parent.target)->emplace_back()};
+                case Scope::AnimationChannels:
+                    return {Scope::AnimationChannel, &static_cast<std::vector<tinygltf::AnimationChannel> *>(parent.target)->emplace_back()};
+                case Scope::Material:
+                {
+                    auto & material = *static_cast<tinygltf::Material *>(parent.target);
+                    if (_key == "pbrMetallicRoughness") return {Scope::PbrMetallicRoughness, &material.pbrMetallicRoughness};
+                    if (_key == "normalTexture") return {Scope::TextureInfo, &material.normalTexture.index, &material.normalTexture.texCoord};
+                    if (_key == "occlusionTexture") return {Scope::TextureInfo, &material.occlusionTexture.index, &material.occlusionTexture.texCoord};
+                    if (_key == "emissiveTexture") return {Scope::TextureInfo, &material.emissiveTexture.index, &material.emissiveTexture.texCoord};
+                    break;
+                }
+                case Scope::PbrMetallicRoughness:
+                {
+                    auto & pbr = *static_cast<tinygltf::PbrMetallicRoughness *>(parent.target);
+                    if (_key == "baseColorTexture") return {Scope::TextureInfo, &pbr.baseColorTexture.index, &pbr.baseColorTexture.texCoord};
+                    if (_key == "metallicRoughnessTexture") return {Scope::TextureInfo, &pbr.metallicRoughnessTexture.index, &pbr.metallicRoughnessTexture.texCoord};
+                    break;
+                }
+                case Scope::Texture:
+                    if (_key == "extensions") return {Scope::TextureExtensions, parent.target};
+                    break;
+                case Scope::TextureExtensions:
+                {
+                    // Alternative images that the importer can load, see GLTF_textureImage
+                    auto & extensions = static_cast<tinygltf::Texture *>(parent.target)->extensions;
+                    if (_key == "MSFT_texture_dds" || _key == "KHR_texture_basisu") return {Scope::TextureExtension, &extensions[_key]};
+                    break;
+                }
+                case Scope::Primitive:
+                    if (_key == "attributes") return {Scope::Attributes, &static_cast<tinygltf::Primitive *>(parent.target)->attributes};
+                    break;
+                case Scope::AnimationChannel:
+                    // Target fields are stored on the channel itself
+                    if (_key == "target") return {Scope::ChannelTarget, parent.target};
+                    break;
+                default:
+                    break;
+                }
+                return {};
+            }
+
+            //-------------------------------------------------------------------------------------------------
+
+            Frame ArrayFrame(Frame const & parent)
+            {
+                auto const numbers = [](std::vector<double> & values)->Frame
+                {
+                    values.clear();
+                    return {Scope::Numbers, &values};
+                };
+                auto const integers = [](std::vector<int> & values)->Frame
+                {
+                    values.clear();
+                    return {Scope::Integers, &values};
+                };
+
+                switch (parent.scope)
+                {
+                case Scope::Root:
+                    if (_key == "accessors") return {Scope::Accessors};
+                    if (_key == "bufferViews") return {Scope::BufferViews};
+                    if (_key == "buffers") return {Scope::Buffers};
+                    if (_key == "images") return {Scope::Images};
+                    if (_key == "textures") return {Scope::Textures};
+                    if (_key == "materials") return {Scope::Materials};
+                    if (_key == "meshes") return {Scope::Meshes};
+                    if (_key == "nodes") return {Scope::Nodes};
+                    if (_key == "skins") return {Scope::Skins};
+                    if (_key == "animations") return {Scope::Animations};
+                    break;
+                case Scope::Material:
+                    if (_key == "emissiveFactor") return numbers(static_cast<tinygltf::Material *>(parent.target)->emissiveFactor);
+                    break;
+                case Scope::PbrMetallicRoughness:
+                    if (_key == "baseColorFactor") return numbers(static_cast<tinygltf::PbrMetallicRoughness *>(parent.target)->baseColorFactor);
+                    break;
+                case Scope::Mesh:
+                    if (_key == "primitives") return {Scope::Primitives, &static_cast<tinygltf::Mesh *>(parent.target)->primitives};
+                    break;
+                case Scope::Node:
+                {
+                    auto & node = *static_cast<tinygltf::Node *>(parent.target);
+                    if (_key == "children") return integers(node.children);
+                    if (_key == "translation") return numbers(node.translation);
+                    if (_key == "rotation") return numbers(node.rotation);
+                    if (_key == "scale") return numbers(node.scale);
+                    if (_key == "matrix") return numbers(node.matrix);
+                    break;
+                }
+                case Scope::Skin:
+                    if (_key == "joints") return integers(static_cast<tinygltf::Skin *>(parent.target)->joints);
+                    break;
+                case Scope::Animation:
+                {
+                    auto & animation = *static_cast<tinygltf::Animation *>(parent.target);
+                    if (_key == "samplers") return {Scope::AnimationSamplers, &animation.samplers};
+                    if (_key == "channels") return {Scope::AnimationChannels, &animation.channels};
+                    break;
+                }
+                default:
+                    break;
+                }
+                return {};
+            }
+
+            tinygltf::Model & _model;
+            std::vector<size_t> & _bufferLengths;
+            std::vector<Frame> _frames{};
+            std::string _key{};
+            std::string _error{};
+
+        };
+
+        //-------------------------------------------------------------------------------------------------
+
+        // The same fixed size checks that tinygltf does, the extraction indexes these arrays directly
+        bool GLTF_validateModel(tinygltf::Model const & model, std::string & outError)
+        {
+            for (auto const & material : model.materials)
+            {
+                if (material.pbrMetallicRoughness.baseColorFactor.size() != 4 || material.emissiveFactor.size() != 3)
+                {
+                    outError = "Material " + material.name + " has an invalid color factor";
+                    return false;
+                }
+            }
+            for (auto const & image : model.images)
+            {
+                if (image.bufferView >= static_cast<int>(model.bufferViews.size()))
+                {
+                    outError = "Image " + image.name + " has an invalid bufferView";
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        bool GLTF_parseJson(char const * json, size_t const size, GLTF_Document & outDocument, std::string & outError)
+        {
+            GLTF_SaxHandler handler{outDocument};
+            if (Json::sax_parse(json, json + size, &handler) == false)
+            {
+                outError = handler.Error().empty() ? "Invalid gltf json" : handler.Error();
+                return false;
+            }
+            return GLTF_validateModel(outDocument.model, outError);
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        std::string GLTF_decodeUri(std::string const & uri)
+        {
+            std::string result{};
+            result.reserve(uri.size());
+            for (size_t i = 0; i < uri.size(); ++i)
+            {
+                if (uri[i] == '%' && i + 2 < uri.size() && std::isxdigit(uri[i + 1]) && std::isxdigit(uri[i + 2]))
+                {
+                    result.push_back(static_cast<char>(std::stoi(uri.substr(i + 1, 2), nullptr, 16)));
+                    i += 2;
+                }
+                else
+                {
+                    result.push_back(uri[i]);
+                }
+            }
+            return result;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        bool GLTF_decodeBase64(std::string_view const text, std::vector<uint8_t> & outData)
+        {
+            auto const decodeCharacter = [](char const character)->int
+            {
+                if (character >= 'A' && character <= 'Z') return character - 'A';
+                if (character >= 'a' && character <= 'z') return character - 'a' + 26;
+                if (character >= '0' && character <= '9') return character - '0' + 52;
+                if (character == '+') return 62;
+                if (character == '/') return 63;
+                return -1;
+            };
+
+            outData.clear();
+            outData.reserve(text.size() / 4 * 3);
+            uint32_t bits = 0;
+            int bitCount = 0;
+            for (auto const character : text)
+            {
+                if (character == '=')
+                {
+                    break;
+                }
+                auto const value = decodeCharacter(character);
+                if (value < 0)
+                {
+                    return false;
+                }
+                bits = (bits << 6) | static_cast<uint32_t>(value);
+                bitCount += 6;
+                if (bitCount >= 8)
+                {
+                    bitCount -= 8;
+                    outData.emplace_back(static_cast<uint8_t>(bits >> bitCount));
+                }
+            }
+            return true;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        // Resolves a buffer that has an uri, either an embedded base64 data uri or a file next to the gltf file
+        bool GLTF_loadUriBuffer(
+            std::string const & directory,
+            std::string const & uri,
+            GLTF_Document & document,
+            std::span<uint8_t const> & outData,
+            std::string & outError
+        )
+        {
+            if (uri.starts_with("data:"))
+            {
+                static constexpr std::string_view Base64Marker = ";base64,";
+                auto const markerPosition = uri.find(Base64Marker);
+                auto & decoded = document.decodedBuffers.emplace_back();
+                if (
+                    markerPosition == std::string::npos ||
+                    GLTF_decodeBase64(std::string_view(uri).substr(markerPosition + Base64Marker.size()), decoded) == false
+                )
+                {
+                    outError = "Failed to decode data uri";
+                    return false;
+                }
+                outData = decoded;
+                return true;
+            }
+
+            auto const path = (std::filesystem::path(directory) / GLTF_decodeUri(uri)).string();
+            auto file = File::MappedFile::Open(path);
+            if (file == nullptr)
+            {
+                outError = "Failed to open buffer " + path;
+                return false;
+            }
+            outData = std::span<uint8_t const>(file->Ptr(), file->Len());
+            document.mappedFiles.emplace_back(std::move(file));
+            return true;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        // Points each buffer of the parsed model at its memory. Only a glb has a binary chunk for buffers without uri.
+        bool GLTF_resolveBuffers(
+            std::string const & path,
+            std::span<uint8_t const> const binaryChunk,
+            GLTF_Document & document,
+            std::string & outError
+        )
+        {
+            auto const directory = std::filesystem::path(path).parent_path().string();
+            auto const & buffers = document.model.buffers;
+            document.buffers.resize(buffers.size());
+            for (size_t i = 0; i < buffers.size(); ++i)
+            {
+                std::span<uint8_t const> bufferData{};
+                if (buffers[i].uri.empty())
+                {
+                    bufferData = binaryChunk;
+                }
+                else if (GLTF_loadUriBuffer(directory, buffers[i].uri, document, bufferData, outError) == false)
+                {
+                    return false;
+                }
+
+                // The binary chunk can have up to 3 bytes of padding after the buffer
+                auto const length = document.bufferLengths[i];
+                if (length > bufferData.size())
+                {
+                    outError = "Buffer " + std::to_string(i) + " is smaller than its byteLength";
+                    return false;
+                }
+                document.buffers[i] = bufferData.first(length);
+            }
+            return true;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        uint32_t ReadUint32(uint8_t const * data)
+        {
+            uint32_t value = 0;
+            std::memcpy(&value, data, sizeof(value));
+            return value;
+        }
+
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    bool GLB_Load(std::string const & path, GLTF_Document & outDocument, std::string & outError)
+    {
+        static constexpr uint32_t Magic = 0x46546C67;           // glTF
+        static constexpr uint32_t JsonChunkType = 0x4E4F534A;   // JSON
+        static constexpr uint32_t BinaryChunkType = 0x004E4942; // BIN
+        static constexpr size_t HeaderSize = 12;
+        static constexpr size_t ChunkHeaderSize = 8;
+
+        auto file = File::MappedFile::Open(path);
+        if (file == nullptr)
+        {
+            outError = "Failed to open " + path;
+            return false;
+        }
+
+        auto const * data = file->Ptr();
+        auto const fileSize = file->Len();
+        if (fileSize < HeaderSize + ChunkHeaderSize || ReadUint32(data) != Magic || ReadUint32(data + 4) != 2)
+        {
+            outError = "Invalid glb header";
+            return false;
+        }
+        size_t const totalLength = std::min<size_t>(ReadUint32(data + 8), fileSize);
+
+        std::span<uint8_t const> jsonChunk{};
+        std::span<uint8_t const> binaryChunk{};
+        size_t offset = HeaderSize;
+        while (offset + ChunkHeaderSize <= totalLength)
+        {
+            size_t const chunkLength = ReadUint32(data + offset);
+            auto const chunkType = ReadUint32(data + offset + 4);
+            offset += ChunkHeaderSize;
+            if (chunkLength > totalLength - offset)
+            {
+                outError = "Invalid glb chunk length";
+                return false;
+            }
+            std::span<uint8_t const> const chunk{data + offset, chunkLength};
+            if (chunkType == JsonChunkType && jsonChunk.empty())
+            {
+                jsonChunk = chunk;
+            }
+            else if (chunkType == BinaryChunkType && binaryChunk.empty())
+            {
+                binaryChunk = chunk;
+            }
+            // Chunks are 4 byte aligned
+            offset += (chunkLength + 3) & ~size_t{3};
+        }
+        if (jsonChunk.empty())
+        {
+            outError = "Glb has no json chunk";
+            return false;
+        }
+
+        outDocument.mappedFiles.emplace_back(std::move(file));
+        if (GLTF_parseJson(reinterpret_cast<char const *>(jsonChunk.data()), jsonChunk.size(), outDocument, outError) == false)
+        {
+            return false;
+        }
+
+        return GLTF_resolveBuffers(path, binaryChunk, outDocument, outError);
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    bool GLTF_Load(std::string const & path, GLTF_Document & outDocument, std::string & outError)
+    {
+        // The json mapping is only needed while parsing, the model keeps its own copies of the strings
+        auto const file = File::MappedFile::Open(path);
+        if (file == nullptr)
+        {
+            outError = "Failed to open " + path;
+            return false;
+        }
+        if (GLTF_parseJson(reinterpret_cast<char const *>(file->Ptr()), file->Len(), outDocument, outError) == false)
+        {
+            return false;
+        }
+        return GLTF_resolveBuffers(path, {}, outDocument, outError);
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "BedrockFile.hpp"
+
+#include "tiny_gltf_loader.h"
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+// Parsed .gltf/.glb json plus the memory of each buffer. The json is read by a SAX pass that only fills the parts of
+// tinygltf::Model the importer uses, the buffers of the model stay empty. Buffer memory is owned by the document and
+// is either a mapped file or a decoded data uri, so a .glb binary chunk is read in place from the page cache.
+namespace MFA::Importer
+{
+
+    struct GLTF_Document
+    {
+        tinygltf::Model model{};
+        // One span per model buffer, exactly byteLength long
+        std::vector<std::span<uint8_t const>> buffers{};
+        // Declared byteLength of each buffer
+        std::vector<size_t> bufferLengths{};
+
+        std::vector<std::shared_ptr<File::MappedFile>> mappedFiles{};
+        std::vector<std::vector<uint8_t>> decodedBuffers{};
+    };
+
+    // Maps the file and parses its json chunk. Buffers without an uri are the binary chunk, external ones are mapped.
+    [[nodiscard]]
+    bool GLB_Load(std::string const & path, GLTF_Document & outDocument, std::string & outError);
+
+    // Maps the file and parses it in place. External buffers are mapped and data uris are decoded, a buffer without
+    // uri is an error since only a glb can provide it.
+    [[nodiscard]]
+    bool GLTF_Load(std::string const & path, GLTF_Document & outDocument, std::string & outError);
+
+}
@@ -0,0 +1,358 @@
+#include "ImportMipChain.hpp"
+
+#include "BedrockAssert.hpp"
+#include "BedrockCpu.hpp"
+#include "JobSystem.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MFA_MIP_CHAIN_SSE2
+#include <immintrin.h>
+#endif
+
+namespace MFA::Importer
+{
+
+    namespace
+    {
+
+        constexpr uint32_t MinPixelsPerJob = 16384;
+        // Linear values are 16 bit, the table back to sRGB is indexed with the top 14 bits
+        constexpr uint32_t LinearLutShift = 2;
+
+        struct SrgbTables
+        {
+            std::array<uint16_t, 256> toLinear{};
+            std::array<uint8_t, (65536 >> LinearLutShift)> toSrgb{};
+        };
+
+        //-------------------------------------------------------------------------------------------------
+
+        SrgbTables const & GetSrgbTables()
+        {
+            static SrgbTables const tables = []()->SrgbTables
+            {
+                SrgbTables result{};
+                for (uint32_t i = 0; i < result.toLinear.size(); ++i)
+                {
+                    auto const srgb = static_cast<double>(i) / 255.0;
+                    auto const linear = srgb <= 0.04045 ? srgb / 12.92 : std::pow((srgb + 0.055) / 1.055, 2.4);
+                    result.toLinear[i] = static_cast<uint16_t>(std::lround(linear * 65535.0));
+                }
+                for (uint32_t i = 0; i < result.toSrgb.size(); ++i)
+                {
+                    // Center of the 16 bit values that share this entry
+                    auto const linear = (static_cast<double>(i << LinearLutShift) + ((1 << LinearLutShift) - 1) * 0.5) / 65535.0;
+                    auto const srgb = linear <= 0.0031308 ? linear * 12.92 : 1.055 * std::pow(linear, 1.0 / 2.4) - 0.055;
+                    result.toSrgb[i] = static_cast<uint8_t>(std::clamp<long>(std::lround(srgb * 255.0), 0, 255));
+                }
+                return result;
+            }();
+            return tables;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        // column0 and column1 are byte offsets of the two source pixels inside the rows
+        void BoxPixelLinear(
+            uint8_t const * row0,
+            uint8_t const * row1,
+            size_t const column0,
+            size_t const column1,
+            uint32_t const components,
+            uint8_t * output
+        )
+        {
+            for (uint32_t c = 0; c < components; ++c)
+            {
+                output[c] = static_cast<uint8_t>(
+                    (row0[column0 + c] + row0[column1 + c] + row1[column0 + c] + row1[column1 + c] + 2) >> 2
+                );
+            }
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        template<uint32_t Components>
+        void BoxPixelSrgb(
+            uint8_t const * row0,
+            uint8_t const * row1,
+            size_t const column0,
+            size_t const column1,
+            SrgbTables const & tables,
+            uint8_t * output
+        )
+        {
+            // Alpha stays linear
+            constexpr uint32_t SrgbComponents = Components == 4 ? 3 : Components;
+            auto const & toLinear = tables.toLinear;
+            for (uint32_t c = 0; c < SrgbComponents; ++c)
+            {
+                uint32_t const sum = toLinear[row0[column0 + c]] + toLinear[row0[column1 + c]] +
+                    toLinear[row1[column0 + c]] + toLinear[row1[column1 + c]];
+                output[c] = tables.toSrgb[((sum + 2) >> 2) >> LinearLutShift];
+            }
+            for (uint32_t c = SrgbComponents; c < Components; ++c)
+            {
+                output[c] = static_cast<uint8_t>(
+                    (row0[column0 + c] + row0[column1 + c] + row1[column0 + c] + row1[column1 + c] + 2) >> 2
+                );
+            }
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        template<uint32_t Components>
+        void BoxRowSrgb(
+            uint8_t const * row0,
+            uint8_t const * row1,
+            uint32_t const width,
+            uint32_t const outputWidth,
+            SrgbTables const & tables,
+            uint8_t * output
+        )
+        {
+            for (uint32_t x = 0; x < outputWidth; ++x)
+            {
+                BoxPixelSrgb<Components>(
+                    row0,
+                    row1,
+                    static_cast<size_t>(x) * 2 * Components,
+                    static_cast<size_t>(std::min(x * 2 + 1, width - 1)) * Components,
+                    tables,
+                    output + x * Components
+                );
+            }
+        }
+
+        using SrgbRowKernel = void (*)(
+            uint8_t const * row0,
+            uint8_t const * row1,
+            uint32_t width,
+            uint32_t outputWidth,
+            SrgbTables const & tables,
+            uint8_t * output
+        );
+
+        constexpr SrgbRowKernel SrgbRowKernels[4]{&BoxRowSrgb<1>, &BoxRowSrgb<2>, &BoxRowSrgb<3>, &BoxRowSrgb<4>};
+
+        //-------------------------------------------------------------------------------------------------
+
+        // Returns how many of the pairCount outputs were written, the caller finishes the rest
+        using RowKernel = uint32_t (*)(uint8_t const * row0, uint8_t const * row1, uint32_t pairCount, uint8_t * output);
+
+#ifdef MFA_MIP_CHAIN_SSE2
+
+        // 16 bytes of two rows to 8 unrounded sums of 2x2 pixels, in output order
+        template<uint32_t Components>
+        __m128i PairSums(__m128i const row0, __m128i const row1)
+        {
+            auto const zero = _mm_setzero_si128();
+            auto const low = _mm_add_epi16(_mm_unpacklo_epi8(row0, zero), _mm_unpacklo_epi8(row1, zero));
+            auto const high = _mm_add_epi16(_mm_unpackhi_epi8(row0, zero), _mm_unpackhi_epi8(row1, zero));
+            if constexpr (Components == 1)
+            {
+                auto const one = _mm_set1_epi16(1);
+                return _mm_packs_epi32(_mm_madd_epi16(low, one), _mm_madd_epi16(high, one));
+            }
+            else if constexpr (Components == 2)
+            {
+                auto const lowPs = _mm_castsi128_ps(low);
+                auto const highPs = _mm_castsi128_ps(high);
+                return _mm_add_epi16(
+                    _mm_castps_si128(_mm_shuffle_ps(lowPs, highPs, _MM_SHUFFLE(2, 0, 2, 0))),
+                    _mm_castps_si128(_mm_shuffle_ps(lowPs, highPs, _MM_SHUFFLE(3, 1, 3, 1)))
+                );
+            }
+            else
+            {
+                static_assert(Components == 4);
+                return _mm_add_epi16(_mm_unpacklo_epi64(low, high), _mm_unpackhi_epi64(low, high));
+            }
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        template<uint32_t Components>
+        uint32_t BoxRowSSE2(uint8_t const * row0, uint8_t const * row1, uint32_t const pairCount, uint8_t * output)
+        {
+            constexpr uint32_t OutputsPerStep = 16 / Components;
+            auto const rounding = _mm_set1_epi16(2);
+            uint32_t x = 0;
+            for (; x + OutputsPerStep <= pairCount; x += OutputsPerStep)
+            {
+                auto const * source0 = reinterpret_cast<__m128i const *>(row0 + x * 2 * Components);
+                auto const * source1 = reinterpret_cast<__m128i const *>(row1 + x * 2 * Components);
+                auto const first = PairSums<Components>(_mm_loadu_si128(source0), _mm_loadu_si128(source1));
+                auto const second = PairSums<Components>(_mm_loadu_si128(source0 + 1), _mm_loadu_si128(source1 + 1));
+                _mm_storeu_si128(
+                    reinterpret_cast<__m128i *>(output + x * Components),
+                    _mm_packus_epi16(
+                        _mm_srli_epi16(_mm_add_epi16(first, rounding), 2),
+                        _mm_srli_epi16(_mm_add_epi16(second, rounding), 2)
+                    )
+                );
+            }
+            return x;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        // Same as PairSums for 32 bytes, the first 16 bytes end up in the low lane
+        template<uint32_t Components>
+        MFA_TARGET_AVX2
+        __m256i PairSumsAVX2(__m256i const row0, __m256i const row1)
+        {
+            auto const zero = _mm256_setzero_si256();
+            auto const low = _mm256_add_epi16(_mm256_unpacklo_epi8(row0, zero), _mm256_unpacklo_epi8(row1, zero));
+            auto const high = _mm256_add_epi16(_mm256_unpackhi_epi8(row0, zero), _mm256_unpackhi_epi8(row1, zero));
+            if constexpr (Components == 1)
+            {
+                auto const one = _mm256_set1_epi16(1);
+                return _mm256_packs_epi32(_mm256_madd_epi16(low, one), _mm256_madd_epi16(high, one));
+            }
+            else if constexpr (Components == 2)
+            {
+                auto const lowPs = _mm256_castsi256_ps(low);
+                auto const highPs = _mm256_castsi256_ps(high);
+                return _mm256_add_epi16(
+                    _mm256_castps_si256(_mm256_shuffle_ps(lowPs, highPs, _MM_SHUFFLE(2, 0, 2, 0))),
+                    _mm256_castps_si256(_mm256_shuffle_ps(lowPs, highPs, _MM_SHUFFLE(3, 1, 3, 1)))
+                );
+            }
+            else
+            {
+                static_assert(Components == 4);
+                return _mm256_add_epi16(_mm256_unpacklo_epi64(low, high), _mm256_unpackhi_epi64(low, high));
+            }
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        template<uint32_t Components>
+        MFA_TARGET_AVX2
+        uint32_t BoxRowAVX2(uint8_t const * row0, uint8_t const * row1, uint32_t const pairCount, uint8_t * output)
+        {
+            constexpr uint32_t OutputsPerStep = 32 / Components;
+            auto const rounding = _mm256_set1_epi16(2);
+            uint32_t x = 0;
+            for (; x + OutputsPerStep <= pairCount; x += OutputsPerStep)
+            {
+                auto const * source0 = reinterpret_cast<__m256i const *>(row0 + x * 2 * Components);
+                auto const * source1 = reinterpret_cast<__m256i const *>(row1 + x * 2 * Components);
+                auto const first = PairSumsAVX2<Components>(_mm256_loadu_si256(source0), _mm256_loadu_si256(source1));
+                auto const second = PairSumsAVX2<Components>(
+                    _mm256_loadu_si256(source0 + 1),
+                    _mm256_loadu_si256(source1 + 1)
+                );
+                // Pack interleaves the lanes of both halves, the permute restores the order
+                auto const packed = _mm256_packus_epi16(
+                    _mm256_srli_epi16(_mm256_add_epi16(first, rounding), 2),
+                    _mm256_srli_epi16(_mm256_add_epi16(second, rounding), 2)
+                );
+                _mm256_storeu_si256(
+                    reinterpret_cast<__m256i *>(output + x * Components),
+                    _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0))
+                );
+            }
+            return x;
+        }
+
+#endif
+
+        //-------------------------------------------------------------------------------------------------
+
+        RowKernel SelectRowKernel([[maybe_unused]] uint32_t const components)
+        {
+#ifdef MFA_MIP_CHAIN_SSE2
+            bool const avx2 = Cpu::GetFeatures().avx2;
+            switch (components)
+            {
+            case 1:
+                return avx2 ? &BoxRowAVX2<1> : &BoxRowSSE2<1>;
+            case 2:
+                return avx2 ? &BoxRowAVX2<2> : &BoxRowSSE2<2>;
+            case 4:
+                return avx2 ? &BoxRowAVX2<4> : &BoxRowSSE2<4>;
+            default:
+                break;
+            }
+#endif
+            return nullptr;
+        }
+
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    void DownsampleMip(
+        uint8_t const * source,
+        uint32_t const width,
+        uint32_t const height,
+        uint32_t const components,
+        bool const sRGB,
+        uint8_t * destination
+    )
+    {
+        MFA_ASSERT(source != nullptr && destination != nullptr);
+        MFA_ASSERT(width > 0 && height > 0);
+        MFA_ASSERT(components > 0 && components <= 4);
+
+        uint32_t const outputWidth = (width + 1) / 2;
+        uint32_t const outputHeight = (height + 1) / 2;
+        size_t const sourceStride = static_cast<size_t>(width) * components;
+        size_t const outputStride = static_cast<size_t>(outputWidth) * components;
+        // Outputs whose two source columns both exist
+        uint32_t const pairCount = width / 2;
+
+        SrgbTables const * srgbTables = sRGB ? &GetSrgbTables() : nullptr;
+        RowKernel const rowKernel = sRGB ? nullptr : SelectRowKernel(components);
+
+        auto const downsampleRows = [&](int const begin, int const end)->void
+        {
+            for (auto y = static_cast<uint32_t>(begin); y < static_cast<uint32_t>(end); ++y)
+            {
+                auto const * row0 = source + static_cast<size_t>(y) * 2 * sourceStride;
+                auto const * row1 = source + std::min(y * 2 + 1, height - 1) * sourceStride;
+                auto * output = destination + y * outputStride;
+
+                if (srgbTables != nullptr)
+                {
+                    SrgbRowKernels[components - 1](row0, row1, width, outputWidth, *srgbTables, output);
+                    continue;
+                }
+
+                uint32_t x = rowKernel != nullptr ? rowKernel(row0, row1, pairCount, output) : 0;
+                for (; x < outputWidth; ++x)
+                {
+                    BoxPixelLinear(
+                        row0,
+                        row1,
+                        static_cast<size_t>(x) * 2 * components,
+                        static_cast<size_t>(std::min(x * 2 + 1, width - 1)) * components,
+                        components,
+                        output + x * components
+                    );
+                }
+            }
+        };
+
+        auto const rowCount = static_cast<int>(outputHeight);
+        auto const minRowsPerJob = static_cast<int>(std::max<uint32_t>(MinPixelsPerJob / outputWidth, 1));
+        if (JS::Instance != nullptr)
+        {
+            JS::Instance->ParallelFor(rowCount, minRowsPerJob, downsampleRows);
+        }
+        else
+        {
+            downsampleRows(0, rowCount);
+        }
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+}
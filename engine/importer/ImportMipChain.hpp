@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+
+// Each mip level is box filtered from the previous one instead of resampling the full image for every level, so a
+// whole chain costs about one third of a pass over the base level. Rows are split across the job system, linear
+// formats use SSE2 or AVX2 kernels and sRGB formats are averaged in linear space through lookup tables.
+namespace MFA::Importer
+{
+
+    // Writes ceil(width / 2) x ceil(height / 2) pixels like AS::Texture::MipDimensions, the last column and row of
+    // an odd sized level are filtered with themselves. With sRGB a fourth component is treated as linear alpha.
+    void DownsampleMip(
+        uint8_t const * source,
+        uint32_t width,
+        uint32_t height,
+        uint32_t components,
+        bool sRGB,
+        uint8_t * destination
+    );
+
+}
@@ -1,87 +1,638 @@
 #include "ImportObj.hpp"
 
-#include <fstream>
-#include <string>
-
+#include "AssetGLTF_MeshOptimizer.hpp"
+#include "AssetGLTF_MeshSimplifier.hpp"
+#include "ImportCache.hpp"
+#include "ImportCookedMesh.hpp"
+#include "BedrockAssert.hpp"
+#include "BedrockFile.hpp"
 #include "BedrockLog.hpp"
-#include "tiny_gltf_loader/tiny_gltf_loader.h"
-#include "tiny_obj_loader/tiny_obj_loader.h"
+#include "BedrockMemory.hpp"
+#include "JobSystem.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <vector>
 
 namespace MFA::Importer
 {
-    bool LoadObj(std::string const& path, ObjModel& outModel)
+
+    using Mesh = AS::GLTF::Mesh;
+    using Vertex = AS::GLTF::Vertex;
+    using Index = AS::GLTF::Index;
+    using Primitive = AS::GLTF::Primitive;
+
+    namespace
     {
 
-        /*std::ifstream infile(path);
-        if (infile.good() ) {
-            return false;
-        }*/
+        namespace ObjAttribute
+        {
+            constexpr int Position = 0;
+            constexpr int Uv = 1;
+            constexpr int Normal = 2;
+            constexpr int Count = 3;
+        }
+
+        // Obj indices are one based and negative ones count back from the last element read so far. Chunks do not
+        // know how many elements the previous chunks have, so relative indices are fixed after every chunk is parsed.
+        struct ObjCorner
+        {
+            int32_t indices[ObjAttribute::Count]{-1, -1, -1};   // -1 when the face has no such index
+            uint8_t relativeMask = 0;                           // Bit i is set while indices[i] is chunk relative
+
+            [[nodiscard]]
+            bool operator==(ObjCorner const & other) const
+            {
+                return std::memcmp(indices, other.indices, sizeof(indices)) == 0;
+            }
+        };
+
+        struct ObjChunk
+        {
+            std::vector<glm::vec3> positions{};
+            std::vector<glm::vec2> uvs{};
+            std::vector<glm::vec3> normals{};
+            std::vector<ObjCorner> corners{};                   // Three per triangle
+            uint32_t bases[ObjAttribute::Count]{};              // Elements in the previous chunks
+            bool isValid = true;
+        };
+
+        //-------------------------------------------------------------------------------------------------
 
-        if (path.empty()) { // Fail if model file could not be found:
-            return false;
+        bool IsBlank(char const character)
+        {
+            return character == ' ' || character == '\t' || character == '\r';
         }
 
-        std::ifstream ifs(path);
-        std::string content(
-            (std::istreambuf_iterator<char>(ifs)),
-            (std::istreambuf_iterator<char>())
-        );
+        //-------------------------------------------------------------------------------------------------
+
+        char const * SkipBlanks(char const * cursor, char const * const end)
+        {
+            while (cursor < end && IsBlank(*cursor))
+            {
+                ++cursor;
+            }
+            return cursor;
+        }
+
+        //-------------------------------------------------------------------------------------------------
 
-        tinyobj::attrib_t attributes;
-        std::vector<tinyobj::shape_t> shapes;
-        std::vector<tinyobj::material_t> materials;
-        std::string warning;
-        std::string error;
-        std::istringstream sourceStream(content);
-        if (!tinyobj::LoadObj(&attributes, &shapes, &materials, &warning, &error, &sourceStream)) {
-            return false;
+        char const * SkipLine(char const * cursor, char const * const end)
+        {
+            auto const * newLine = static_cast<char const *>(std::memchr(cursor, '\n', end - cursor));
+            return newLine != nullptr ? newLine + 1 : end;
         }
 
-        outModel.vertices.clear();
-        outModel.indices.clear();
+        //-------------------------------------------------------------------------------------------------
 
-        for (const auto & shape : shapes) 
+        bool ParseFloat(char const *& cursor, char const * const end, float & outValue)
         {
-            std::map<std::tuple<int, int, int>, uint32_t> uniqueVertices;
+            auto const * begin = SkipBlanks(cursor, end);
+            if (begin < end && *begin == '+')
+            {// from_chars does not accept the sign
+                ++begin;
+            }
+            auto const [next, error] = std::from_chars(begin, end, outValue);
+            if (error == std::errc::result_out_of_range)
+            {// Denormals
+                outValue = 0.0f;
+            }
+            else if (error != std::errc{})
+            {
+                return false;
+            }
+            cursor = next;
+            return true;
+        }
 
-            bool hasVertices = attributes.vertices.empty() == false;
-            bool hasTexCoords = attributes.texcoords.empty() == false;
-            bool hasNormals = attributes.normals.empty() == false;
+        //-------------------------------------------------------------------------------------------------
 
-            outModel.hasTexCoords = hasTexCoords;
-            outModel.hasNormals = hasNormals;
+        template<int Count>
+        bool ParseFloats(char const *& cursor, char const * const end, float * outValues)
+        {
+            for (int i = 0; i < Count; ++i)
+            {
+                if (ParseFloat(cursor, end, outValues[i]) == false)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
 
-            for (const auto& indices : shape.mesh.indices) {
-                glm::vec3 pos = hasVertices ? glm::vec3(
-                    attributes.vertices[3 * indices.vertex_index],
-                    attributes.vertices[3 * indices.vertex_index + 1],
-                    attributes.vertices[3 * indices.vertex_index + 2]
-                ) : glm::vec3{};
-                glm::vec2 uv = hasTexCoords ? glm::vec2(
-                    attributes.texcoords[2 * indices.texcoord_index],
-                    1.0f - attributes.texcoords[2 * indices.texcoord_index + 1]
-                ) : glm::vec2{};
-                glm::vec3 normal = hasNormals ? glm::vec3(
-                    attributes.normals[3 * indices.normal_index],
-                    attributes.normals[3 * indices.normal_index + 1],
-                    attributes.normals[3 * indices.normal_index + 2]
-                ) : glm::vec3{};
+        //-------------------------------------------------------------------------------------------------
 
-                std::tuple<int, int, int> tuple = std::tuple<int, int, int>
-                    (indices.vertex_index, indices.normal_index, indices.texcoord_index);
+        // Parses "v", "v/vt", "v//vn" or "v/vt/vn". Counts are the elements this chunk has read so far.
+        bool ParseCorner(
+            char const *& cursor,
+            char const * const end,
+            uint32_t const (&counts)[ObjAttribute::Count],
+            ObjCorner & outCorner
+        )
+        {
+            for (int i = 0; i < ObjAttribute::Count; ++i)
+            {
+                if (i > 0)
+                {
+                    if (cursor >= end || *cursor != '/')
+                    {
+                        return true;
+                    }
+                    ++cursor;
+                    if (i == ObjAttribute::Uv && cursor < end && *cursor == '/')
+                    {
+                        continue;
+                    }
+                }
 
-                if (uniqueVertices.find(tuple) == uniqueVertices.end()) {
-                    uniqueVertices.insert({ tuple, static_cast<uint32_t>(outModel.vertices.size()) });
+                int32_t value = 0;
+                auto const [next, error] = std::from_chars(cursor, end, value);
+                if (error != std::errc{} || value == 0)
+                {
+                    return false;
+                }
+                cursor = next;
 
-                    outModel.vertices.emplace_back();
-                    auto & vertex = outModel.vertices.back();
-                    vertex.position = pos;
-                    vertex.uv = uv;
-                    vertex.normal = normal;
+                if (value > 0)
+                {
+                    outCorner.indices[i] = value - 1;
+                }
+                else
+                {
+                    outCorner.indices[i] = static_cast<int32_t>(counts[i]) + value;
+                    outCorner.relativeMask |= static_cast<uint8_t>(1 << i);
                 }
-                outModel.indices.push_back(uniqueVertices[tuple]);
             }
+            return true;
         }
-        return true;
+
+        //-------------------------------------------------------------------------------------------------
+
+        // Chunks start at the beginning of a line. Statements other than v, vt, vn and f are skipped.
+        void ParseChunk(char const * cursor, char const * const end, ObjChunk & chunk)
+        {
+            std::vector<ObjCorner> polygon{};
+            while (cursor < end && chunk.isValid)
+            {
+                cursor = SkipBlanks(cursor, end);
+                if (end - cursor >= 2 && cursor[0] == 'v')
+                {
+                    if (IsBlank(cursor[1]))
+                    {// Extra w or color components are ignored
+                        cursor += 1;
+                        auto & position = chunk.positions.emplace_back();
+                        chunk.isValid = ParseFloats<3>(cursor, end, &position.x);
+                    }
+                    else if (end - cursor >= 3 && cursor[1] == 't' && IsBlank(cursor[2]))
+                    {
+                        cursor += 2;
+                        glm::vec2 uv{};
+                        chunk.isValid = ParseFloat(cursor, end, uv.x);
+                        // V is optional
+                        ParseFloat(cursor, end, uv.y);
+                        // Obj origin is the bottom left corner
+                        uv.y = 1.0f - uv.y;
+                        chunk.uvs.emplace_back(uv);
+                    }
+                    else if (end - cursor >= 3 && cursor[1] == 'n' && IsBlank(cursor[2]))
+                    {
+                        cursor += 2;
+                        auto & normal = chunk.normals.emplace_back();
+                        chunk.isValid = ParseFloats<3>(cursor, end, &normal.x);
+                    }
+                }
+                else if (end - cursor >= 2 && cursor[0] == 'f' && IsBlank(cursor[1]))
+                {
+                    cursor += 1;
+                    uint32_t const counts[ObjAttribute::Count]{
+                        static_cast<uint32_t>(chunk.positions.size()),
+                        static_cast<uint32_t>(chunk.uvs.size()),
+                        static_cast<uint32_t>(chunk.normals.size())
+                    };
+
+                    polygon.clear();
+                    while (true)
+                    {
+                        cursor = SkipBlanks(cursor, end);
+                        if (cursor >= end || *cursor == '\n' || *cursor == '#')
+                        {
+                            break;
+                        }
+                        if (ParseCorner(cursor, end, counts, polygon.emplace_back()) == false)
+                        {
+                            chunk.isValid = false;
+                            break;
+                        }
+                    }
+
+                    // Fan triangulation, lines and points are dropped
+                    for (size_t i = 2; i < polygon.size(); ++i)
+                    {
+                        chunk.corners.emplace_back(polygon[0]);
+                        chunk.corners.emplace_back(polygon[i - 1]);
+                        chunk.corners.emplace_back(polygon[i]);
+                    }
+                }
+                cursor = SkipLine(cursor, end);
+            }
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        // Adds the bases of the chunk to the relative indices and checks that every index is in range
+        bool ResolveCorners(ObjChunk & chunk, uint32_t const (&totals)[ObjAttribute::Count])
+        {
+            for (auto & corner : chunk.corners)
+            {
+                for (int i = 0; i < ObjAttribute::Count; ++i)
+                {
+                    auto & index = corner.indices[i];
+                    if ((corner.relativeMask & (1 << i)) != 0)
+                    {
+                        index += static_cast<int32_t>(chunk.bases[i]);
+                        if (index < 0)
+                        {
+                            return false;
+                        }
+                    }
+                    if (index >= static_cast<int32_t>(totals[i]))
+                    {
+                        return false;
+                    }
+                }
+                corner.relativeMask = 0;
+                if (corner.indices[ObjAttribute::Position] < 0)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        // Open addressing table from corners to welded vertices with linear probing. Capacity is a power of two and
+        // at least twice the number of corners, so probes stay short and the table never fills up.
+        class CornerWelder
+        {
+        public:
+
+            explicit CornerWelder(size_t const cornerCount)
+            {
+                auto const capacity = std::bit_ceil(std::max<size_t>(cornerCount * 2, 16));
+                _slots.assign(capacity, EmptySlot);
+                _mask = capacity - 1;
+                _uniqueCorners.reserve(cornerCount / 4);
+            }
+
+            // Returns the vertex index of the corner, new corners get the next index
+            uint32_t Insert(ObjCorner const & corner)
+            {
+                auto slot = Hash(corner) & _mask;
+                while (true)
+                {
+                    auto const vertexIndex = _slots[slot];
+                    if (vertexIndex == EmptySlot)
+                    {
+                        auto const newIndex = static_cast<uint32_t>(_uniqueCorners.size());
+                        _slots[slot] = newIndex;
+                        _uniqueCorners.emplace_back(corner);
+                        return newIndex;
+                    }
+                    if (_uniqueCorners[vertexIndex] == corner)
+                    {
+                        return vertexIndex;
+                    }
+                    slot = (slot + 1) & _mask;
+                }
+            }
+
+            [[nodiscard]]
+            std::vector<ObjCorner> const & UniqueCorners() const noexcept
+            {
+                return _uniqueCorners;
+            }
+
+        private:
+
+            static constexpr uint32_t EmptySlot = std::numeric_limits<uint32_t>::max();
+
+            [[nodiscard]]
+            static uint64_t Hash(ObjCorner const & corner)
+            {
+                uint64_t hash = static_cast<uint32_t>(corner.indices[0]) * 0x9E3779B185EBCA87ull;
+                hash ^= static_cast<uint32_t>(corner.indices[1]) * 0xC2B2AE3D27D4EB4Full;
+                hash ^= static_cast<uint32_t>(corner.indices[2]) * 0x165667B19E3779F9ull;
+                return hash ^ (hash >> 29);
+            }
+
+            std::vector<uint32_t> _slots{};
+            size_t _mask = 0;
+            std::vector<ObjCorner> _uniqueCorners{};
+
+        };
+
+        //-------------------------------------------------------------------------------------------------
+
+        void RunParallel(int const count, int const minBatchSize, std::function<void(int, int)> const & task)
+        {
+            if (JS::Instance != nullptr)
+            {
+                JS::Instance->ParallelFor(count, minBatchSize, task);
+            }
+            else
+            {
+                task(0, count);
+            }
+        }
+
     }
+
+    //-------------------------------------------------------------------------------------------------
+
+    // Chunks are parsed in parallel, then corners are resolved and welded into one primitive
+    static std::shared_ptr<Mesh> OBJ_extractMesh(std::string const & path)
+    {
+        auto const file = File::MappedFile::Open(path);
+        if (file == nullptr)
+        {
+            MFA_LOG_ERROR("Failed to open obj file %s", path.c_str());
+            return nullptr;
+        }
+
+        auto const * begin = reinterpret_cast<char const *>(file->Ptr());
+        auto const * end = begin + file->Len();
+
+        static constexpr size_t ChunkSize = 1024 * 1024;
+        std::vector<char const *> boundaries{begin};
+        while (boundaries.back() != end)
+        {
+            auto const * next = boundaries.back();
+            next = static_cast<size_t>(end - next) > ChunkSize ? SkipLine(next + ChunkSize, end) : end;
+            boundaries.emplace_back(next);
+        }
+
+        auto const chunkCount = static_cast<int>(boundaries.size() - 1);
+        std::vector<ObjChunk> chunks(chunkCount);
+        RunParallel(chunkCount, 1, [&chunks, &boundaries](int const begin, int const end)->void
+        {
+            for (int i = begin; i < end; ++i)
+            {
+                ParseChunk(boundaries[i], boundaries[i + 1], chunks[i]);
+            }
+        });
+
+        uint64_t totals[ObjAttribute::Count]{};
+        uint64_t totalCorners = 0;
+        for (auto & chunk : chunks)
+        {
+            if (chunk.isValid == false)
+            {
+                MFA_LOG_ERROR("Failed to parse obj file %s", path.c_str());
+                return nullptr;
+            }
+            chunk.bases[ObjAttribute::Position] = static_cast<uint32_t>(totals[ObjAttribute::Position]);
+            chunk.bases[ObjAttribute::Uv] = static_cast<uint32_t>(totals[ObjAttribute::Uv]);
+            chunk.bases[ObjAttribute::Normal] = static_cast<uint32_t>(totals[ObjAttribute::Normal]);
+            totals[ObjAttribute::Position] += chunk.positions.size();
+            totals[ObjAttribute::Uv] += chunk.uvs.size();
+            totals[ObjAttribute::Normal] += chunk.normals.size();
+            totalCorners += chunk.corners.size();
+        }
+        if (totalCorners == 0)
+        {
+            MFA_LOG_ERROR("Obj file %s has no faces", path.c_str());
+            return nullptr;
+        }
+        if (
+            totalCorners > std::numeric_limits<uint32_t>::max() ||
+            totals[ObjAttribute::Position] > std::numeric_limits<int32_t>::max() ||
+            totals[ObjAttribute::Uv] > std::numeric_limits<int32_t>::max() ||
+            totals[ObjAttribute::Normal] > std::numeric_limits<int32_t>::max()
+        )
+        {
+            MFA_LOG_ERROR("Obj file %s is too large", path.c_str());
+            return nullptr;
+        }
+
+        uint32_t const counts[ObjAttribute::Count]{
+            static_cast<uint32_t>(totals[ObjAttribute::Position]),
+            static_cast<uint32_t>(totals[ObjAttribute::Uv]),
+            static_cast<uint32_t>(totals[ObjAttribute::Normal])
+        };
+        std::vector<uint8_t> chunkResults(chunkCount);
+        RunParallel(chunkCount, 1, [&](int const begin, int const end)->void
+        {
+            for (int i = begin; i < end; ++i)
+            {
+                chunkResults[i] = ResolveCorners(chunks[i], counts) ? 1 : 0;
+            }
+        });
+        if (std::find(chunkResults.begin(), chunkResults.end(), 0) != chunkResults.end())
+        {
+            MFA_LOG_ERROR("Obj file %s has a face index out of range", path.c_str());
+            return nullptr;
+        }
+
+        std::vector<glm::vec3> positions{};
+        std::vector<glm::vec2> uvs{};
+        std::vector<glm::vec3> normals{};
+        positions.reserve(counts[ObjAttribute::Position]);
+        uvs.reserve(counts[ObjAttribute::Uv]);
+        normals.reserve(counts[ObjAttribute::Normal]);
+        for (auto & chunk : chunks)
+        {
+            positions.insert(positions.end(), chunk.positions.begin(), chunk.positions.end());
+            uvs.insert(uvs.end(), chunk.uvs.begin(), chunk.uvs.end());
+            normals.insert(normals.end(), chunk.normals.begin(), chunk.normals.end());
+        }
+
+        // Welding is serial so the vertex order only depends on the file
+        auto const indexCount = static_cast<uint32_t>(totalCorners);
+        std::vector<Index> indices(indexCount);
+        CornerWelder welder{totalCorners};
+        {
+            uint32_t nextIndex = 0;
+            for (auto const & chunk : chunks)
+            {
+                for (auto const & corner : chunk.corners)
+                {
+                    indices[nextIndex++] = welder.Insert(corner);
+                }
+            }
+        }
+        auto const & uniqueCorners = welder.UniqueCorners();
+        auto const vertexCount = static_cast<uint32_t>(uniqueCorners.size());
+
+        auto mesh = std::make_shared<Mesh>(
+            vertexCount,
+            indexCount,
+            Memory::AllocSize(sizeof(Vertex) * vertexCount),
+            Memory::AllocSize(sizeof(Index) * indexCount)
+        );
+
+        auto const subMeshIndex = mesh->InsertSubMesh();
+        MFA_ASSERT(subMeshIndex == 0);
+
+        bool const hasUvs = uvs.empty() == false;
+        Primitive primitive{};
+        primitive.uniqueId = 0;
+        primitive.baseColorTextureIndex = -1;
+        primitive.metallicRoughnessTextureIndex = -1;
+        primitive.normalTextureIndex = -1;
+        primitive.emissiveTextureIndex = -1;
+        primitive.occlusionTextureIndex = -1;
+        primitive.baseColorFactor[0] = primitive.baseColorFactor[1] = 1.0f;
+        primitive.baseColorFactor[2] = primitive.baseColorFactor[3] = 1.0f;
+        primitive.alphaMode = AS::GLTF::AlphaMode::Opaque;
+        primitive.hasNormalBuffer = true;
+        primitive.hasPositionMinMax = false;
+
+        auto const & reservedPrimitive = mesh->ReservePrimitive(subMeshIndex, primitive, vertexCount, indexCount);
+        auto * vertices = mesh->GetVertexData()->As<Vertex>() + reservedPrimitive.verticesStartingIndex;
+        auto * meshIndices = mesh->GetIndexData()->As<Index>() + reservedPrimitive.indicesStartingIndex;
+        auto const vertexBase = reservedPrimitive.verticesStartingIndex;
+
+        bool hasMissingNormals = false;
+        for (auto const & corner : uniqueCorners)
+        {
+            hasMissingNormals |= corner.indices[ObjAttribute::Normal] < 0;
+        }
+
+        RunParallel(static_cast<int>(vertexCount), 16 * 1024, [&](int const begin, int const end)->void
+        {
+            for (int i = begin; i < end; ++i)
+            {
+                auto const & corner = uniqueCorners[i];
+                auto & vertex = vertices[i];
+                vertex = Vertex{};
+                vertex.position = positions[corner.indices[ObjAttribute::Position]];
+                if (hasUvs && corner.indices[ObjAttribute::Uv] >= 0)
+                {
+                    vertex.baseColorUV = uvs[corner.indices[ObjAttribute::Uv]];
+                }
+                if (corner.indices[ObjAttribute::Normal] >= 0)
+                {
+                    vertex.normal = normals[corner.indices[ObjAttribute::Normal]];
+                }
+            }
+        });
+        for (uint32_t i = 0; i < indexCount; ++i)
+        {
+            meshIndices[i] = vertexBase + indices[i];
+        }
+
+        if (hasMissingNormals)
+        {// Area weighted face normals for the corners that have none
+            for (uint32_t i = 0; i + 2 < indexCount; i += 3)
+            {
+                auto const i0 = indices[i];
+                auto const i1 = indices[i + 1];
+                auto const i2 = indices[i + 2];
+                auto const faceNormal = glm::cross(
+                    vertices[i1].position - vertices[i0].position,
+                    vertices[i2].position - vertices[i0].position
+                );
+                for (auto const index : {i0, i1, i2})
+                {
+                    if (uniqueCorners[index].indices[ObjAttribute::Normal] < 0)
+                    {
+                        vertices[index].normal += faceNormal;
+                    }
+                }
+            }
+            for (uint32_t i = 0; i < vertexCount; ++i)
+            {
+                if (uniqueCorners[i].indices[ObjAttribute::Normal] < 0)
+                {
+                    auto const length = glm::length(vertices[i].normal);
+                    vertices[i].normal = length > 0.0f ? vertices[i].normal / length : glm::vec3{0.0f, 1.0f, 0.0f};
+                }
+            }
+        }
+
+        auto & node = mesh->InsertNode();
+        node.name = std::filesystem::path(path).stem().string();
+        node.subMeshIndex = static_cast<int>(subMeshIndex);
+
+        return mesh;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    std::shared_ptr<AS::GLTF::Model> OBJ_Model(std::string const & path, ImportObjOptions const & options)
+    {
+        if (path.empty())
+        {
+            return nullptr;
+        }
+
+        auto * cache = ImportCache::Instance;
+        uint64_t cacheKey = 0;
+        if (cache != nullptr)
+        {
+            cacheKey = ImportCache::KeyBuilder("OBJ_Model", path)
+                .Add(options.optimizeDrawOrder)
+                .Add(options.buildLods)
+                .Add(options.buildMeshlets)
+                .Build();
+            if (cache->Find(cacheKey))
+            {
+                auto cookedMesh = LoadCookedMesh(cache->PayloadPath(cacheKey, CookedMeshExtension));
+                if (cookedMesh != nullptr)
+                {
+                    auto model = std::make_shared<AS::GLTF::Model>();
+                    model->mesh = std::move(cookedMesh);
+                    return model;
+                }
+            }
+        }
+
+        auto const mesh = OBJ_extractMesh(path);
+        if (mesh == nullptr)
+        {
+            return nullptr;
+        }
+        mesh->FinalizeData();
+
+        if (options.optimizeDrawOrder)
+        {
+            auto const report = AS::GLTF::MeshOptimizer::Optimize(*mesh);
+            MFA_LOG_INFO(
+                "Optimized draw order of %s. ACMR: %f -> %f, ATVR: %f -> %f",
+                path.c_str(),
+                report.before.acmr,
+                report.after.acmr,
+                report.before.atvr,
+                report.after.atvr
+            );
+        }
+
+        if (options.buildLods)
+        {
+            AS::GLTF::MeshSimplifier::BuildLods(*mesh);
+        }
+
+        if (options.buildMeshlets)
+        {
+            AS::GLTF::MeshOptimizer::BuildMeshlets(*mesh);
+        }
+
+        if (
+            cache != nullptr &&
+            SaveCookedMesh(*mesh, cache->PayloadPath(cacheKey, CookedMeshExtension))
+        )
+        {
+            cache->Commit(cacheKey, {path});
+        }
+
+        auto model = std::make_shared<AS::GLTF::Model>();
+        model->mesh = mesh;
+        return model;
+    }
+
 }
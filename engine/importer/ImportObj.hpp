@@ -1,27 +1,23 @@
 #pragma once
 
+#include "AssetGLTF_Model.hpp"
+
+#include <memory>
 #include <string>
-#include <vec2.hpp>
-#include <vec3.hpp>
-#include <vector>
 
 namespace MFA::Importer
 {
 
-    struct Vertex
+    struct ImportObjOptions
     {
-        glm::vec3 position{};
-        glm::vec3 normal{};
-        glm::vec2 uv{};
+        bool optimizeDrawOrder = true;          // Reorders the triangles and vertices for the gpu caches
+        bool buildLods = true;                  // Simplified index lists for distant instances
+        bool buildMeshlets = true;              // Needed for cluster culling
     };
 
-    struct ObjModel
-    {
-        std::vector<Vertex> vertices{};
-        std::vector<int> indices{};
-        bool hasNormals = true;
-        bool hasTexCoords = true;
-    };
+    // Single node, single primitive model without textures. Groups and materials are ignored, faces are triangulated
+    // as fans and normals are generated when the file has none. Returns nullptr when the file can not be parsed.
+    [[nodiscard]]
+    std::shared_ptr<AS::GLTF::Model> OBJ_Model(std::string const & path, ImportObjOptions const & options = {});
 
-    bool LoadObj(std::string const & path, ObjModel & outModel);
 }
@@ -0,0 +1,546 @@
+#include "ImportPixelFormat.hpp"
+
+#include "BedrockAssert.hpp"
+#include "BedrockCpu.hpp"
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MFA_PIXEL_FORMAT_SIMD
+#include <immintrin.h>
+#endif
+
+namespace MFA::Importer::PixelFormat
+{
+
+    namespace
+    {
+
+        // Every simd kernel converts a prefix of the pixels and returns its length, the scalar code does the rest
+        using Kernel = size_t (*)(uint8_t const * source, size_t count, uint8_t * destination);
+
+        struct Kernels
+        {
+            Kernel grayToRGBA = nullptr;
+            Kernel grayAlphaToRGBA = nullptr;
+            Kernel rgbToRGBA = nullptr;
+            Kernel bgrToRGBA = nullptr;
+            Kernel bgraToRGBA = nullptr;
+            Kernel premultiplyAlpha = nullptr;
+            Kernel convert16To8 = nullptr;
+        };
+
+        //-------------------------------------------------------------------------------------------------
+
+        size_t NoKernel(uint8_t const *, size_t, uint8_t *)
+        {
+            return 0;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        // Exact round(color * alpha / 255)
+        uint8_t MultiplyUnorm(uint32_t const color, uint32_t const alpha)
+        {
+            auto const product = color * alpha + 128;
+            return static_cast<uint8_t>((product + (product >> 8)) >> 8);
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        // Exact round(value / 257), written so the simd kernels can stay in 16 bit lanes
+        uint8_t RoundTo8(uint32_t const value)
+        {
+            return static_cast<uint8_t>((((value * 65281u) >> 16) + 128) >> 8);
+        }
+
+#ifdef MFA_PIXEL_FORMAT_SIMD
+
+        //-------------------------------------------------------------------------------------------------
+
+        // Three byte pixels to four byte pixels with an opaque alpha. The mask picks the channel order.
+        MFA_TARGET_SSSE3
+        size_t ThreeToFourSSSE3(uint8_t const * source, size_t const count, uint8_t * destination, __m128i const mask)
+        {
+            auto const alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+            size_t i = 0;
+            // Each step reads 16 bytes for 12 bytes of pixels
+            for (; (i + 4) * 3 + 4 <= count * 3; i += 4)
+            {
+                auto const pixels = _mm_loadu_si128(reinterpret_cast<__m128i const *>(source + i * 3));
+                _mm_storeu_si128(
+                    reinterpret_cast<__m128i *>(destination + i * 4),
+                    _mm_or_si128(_mm_shuffle_epi8(pixels, mask), alpha)
+                );
+            }
+            return i;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        MFA_TARGET_SSSE3
+        size_t RGBToRGBA_SSSE3(uint8_t const * source, size_t const count, uint8_t * destination)
+        {
+            auto const mask = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+            return ThreeToFourSSSE3(source, count, destination, mask);
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        MFA_TARGET_SSSE3
+        size_t BGRToRGBA_SSSE3(uint8_t const * source, size_t const count, uint8_t * destination)
+        {
+            auto const mask = _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+            return ThreeToFourSSSE3(source, count, destination, mask);
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        MFA_TARGET_SSSE3
+        size_t GrayToRGBA_SSSE3(uint8_t const * source, size_t const count, uint8_t * destination)
+        {
+            auto const alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+            auto const mask0 = _mm_setr_epi8(0, 0, 0, -1, 1, 1, 1, -1, 2, 2, 2, -1, 3, 3, 3, -1);
+            auto const step = _mm_set1_epi8(4);
+            size_t i = 0;
+            for (; i + 16 <= count; i += 16)
+            {
+                auto const gray = _mm_loadu_si128(reinterpret_cast<__m128i const *>(source + i));
+                auto * output = reinterpret_cast<__m128i *>(destination + i * 4);
+                auto mask = mask0;
+                for (int part = 0; part < 4; ++part)
+                {
+                    _mm_storeu_si128(output + part, _mm_or_si128(_mm_shuffle_epi8(gray, mask), alpha));
+                    mask = _mm_add_epi8(mask, step);
+                }
+            }
+            return i;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        MFA_TARGET_SSSE3
+        size_t GrayAlphaToRGBA_SSSE3(uint8_t const * source, size_t const count, uint8_t * destination)
+        {
+            auto const lowMask = _mm_setr_epi8(0, 0, 0, 1, 2, 2, 2, 3, 4, 4, 4, 5, 6, 6, 6, 7);
+            auto const highMask = _mm_setr_epi8(8, 8, 8, 9, 10, 10, 10, 11, 12, 12, 12, 13, 14, 14, 14, 15);
+            size_t i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                auto const pixels = _mm_loadu_si128(reinterpret_cast<__m128i const *>(source + i * 2));
+                auto * output = reinterpret_cast<__m128i *>(destination + i * 4);
+                _mm_storeu_si128(output, _mm_shuffle_epi8(pixels, lowMask));
+                _mm_storeu_si128(output + 1, _mm_shuffle_epi8(pixels, highMask));
+            }
+            return i;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        MFA_TARGET_SSSE3
+        size_t BGRAToRGBA_SSSE3(uint8_t const * source, size_t const count, uint8_t * destination)
+        {
+            auto const mask = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                auto const pixels = _mm_loadu_si128(reinterpret_cast<__m128i const *>(source + i * 4));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(destination + i * 4), _mm_shuffle_epi8(pixels, mask));
+            }
+            return i;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        // Two pixels widened to 16 bit, color times alpha and alpha times 255
+        MFA_TARGET_SSSE3
+        __m128i PremultiplyWide(__m128i const pixels)
+        {
+            auto const colorMask = _mm_setr_epi16(-1, -1, -1, 0, -1, -1, -1, 0);
+            auto const opaque = _mm_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255);
+            auto const rounding = _mm_set1_epi16(128);
+            auto const alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+            auto const factor = _mm_or_si128(_mm_and_si128(alpha, colorMask), opaque);
+            auto const product = _mm_add_epi16(_mm_mullo_epi16(pixels, factor), rounding);
+            return _mm_srli_epi16(_mm_add_epi16(product, _mm_srli_epi16(product, 8)), 8);
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        MFA_TARGET_SSSE3
+        size_t PremultiplyAlphaSSSE3(uint8_t const * source, size_t const count, uint8_t * destination)
+        {
+            auto const zero = _mm_setzero_si128();
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                auto const pixels = _mm_loadu_si128(reinterpret_cast<__m128i const *>(source + i * 4));
+                auto const low = PremultiplyWide(_mm_unpacklo_epi8(pixels, zero));
+                auto const high = PremultiplyWide(_mm_unpackhi_epi8(pixels, zero));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(destination + i * 4), _mm_packus_epi16(low, high));
+            }
+            return i;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        // Works in place, the 16 bytes that a step writes were already read by that step or an earlier one
+        MFA_TARGET_SSSE3
+        size_t Convert16To8_SSSE3(uint8_t const * source, size_t const count, uint8_t * destination)
+        {
+            auto const scale = _mm_set1_epi16(static_cast<short>(65281));
+            auto const rounding = _mm_set1_epi16(128);
+            size_t i = 0;
+            for (; i + 16 <= count; i += 16)
+            {
+                auto const * values = reinterpret_cast<__m128i const *>(source + i * 2);
+                auto const low = _mm_loadu_si128(values);
+                auto const high = _mm_loadu_si128(values + 1);
+                auto const roundedLow = _mm_srli_epi16(_mm_add_epi16(_mm_mulhi_epu16(low, scale), rounding), 8);
+                auto const roundedHigh = _mm_srli_epi16(_mm_add_epi16(_mm_mulhi_epu16(high, scale), rounding), 8);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(destination + i), _mm_packus_epi16(roundedLow, roundedHigh));
+            }
+            return i;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        MFA_TARGET_AVX2
+        size_t ThreeToFourAVX2(uint8_t const * source, size_t const count, uint8_t * destination, __m256i const mask)
+        {
+            auto const alpha = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+            // Moves the second group of four pixels to the upper lane
+            auto const spread = _mm256_setr_epi32(0, 1, 2, 2, 3, 4, 5, 5);
+            size_t i = 0;
+            // Each step reads 32 bytes for 24 bytes of pixels
+            for (; (i + 8) * 3 + 8 <= count * 3; i += 8)
+            {
+                auto const pixels = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(source + i * 3));
+                auto const lanes = _mm256_permutevar8x32_epi32(pixels, spread);
+                _mm256_storeu_si256(
+                    reinterpret_cast<__m256i *>(destination + i * 4),
+                    _mm256_or_si256(_mm256_shuffle_epi8(lanes, mask), alpha)
+                );
+            }
+            return i;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        MFA_TARGET_AVX2
+        size_t RGBToRGBA_AVX2(uint8_t const * source, size_t const count, uint8_t * destination)
+        {
+            auto const mask = _mm256_setr_epi8(
+                0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+                0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1
+            );
+            return ThreeToFourAVX2(source, count, destination, mask);
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        MFA_TARGET_AVX2
+        size_t BGRToRGBA_AVX2(uint8_t const * source, size_t const count, uint8_t * destination)
+        {
+            auto const mask = _mm256_setr_epi8(
+                2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1,
+                2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1
+            );
+            return ThreeToFourAVX2(source, count, destination, mask);
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        MFA_TARGET_AVX2
+        size_t GrayToRGBA_AVX2(uint8_t const * source, size_t const count, uint8_t * destination)
+        {
+            auto const alpha = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+            auto const mask = _mm256_setr_epi8(
+                0, 0, 0, -1, 1, 1, 1, -1, 2, 2, 2, -1, 3, 3, 3, -1,
+                4, 4, 4, -1, 5, 5, 5, -1, 6, 6, 6, -1, 7, 7, 7, -1
+            );
+            auto const step = _mm256_set1_epi8(8);
+            size_t i = 0;
+            for (; i + 16 <= count; i += 16)
+            {
+                auto const gray = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<__m128i const *>(source + i)));
+                auto * output = reinterpret_cast<__m256i *>(destination + i * 4);
+                _mm256_storeu_si256(output, _mm256_or_si256(_mm256_shuffle_epi8(gray, mask), alpha));
+                _mm256_storeu_si256(
+                    output + 1,
+                    _mm256_or_si256(_mm256_shuffle_epi8(gray, _mm256_add_epi8(mask, step)), alpha)
+                );
+            }
+            return i;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        MFA_TARGET_AVX2
+        size_t GrayAlphaToRGBA_AVX2(uint8_t const * source, size_t const count, uint8_t * destination)
+        {
+            auto const mask = _mm256_setr_epi8(
+                0, 0, 0, 1, 2, 2, 2, 3, 4, 4, 4, 5, 6, 6, 6, 7,
+                8, 8, 8, 9, 10, 10, 10, 11, 12, 12, 12, 13, 14, 14, 14, 15
+            );
+            size_t i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                auto const pixels = _mm256_broadcastsi128_si256(
+                    _mm_loadu_si128(reinterpret_cast<__m128i const *>(source + i * 2))
+                );
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(destination + i * 4), _mm256_shuffle_epi8(pixels, mask));
+            }
+            return i;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        MFA_TARGET_AVX2
+        size_t BGRAToRGBA_AVX2(uint8_t const * source, size_t const count, uint8_t * destination)
+        {
+            auto const mask = _mm256_setr_epi8(
+                2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+                2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15
+            );
+            size_t i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                auto const pixels = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(source + i * 4));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(destination + i * 4), _mm256_shuffle_epi8(pixels, mask));
+            }
+            return i;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        MFA_TARGET_AVX2
+        __m256i PremultiplyWideAVX2(__m256i const pixels)
+        {
+            auto const colorMask = _mm256_setr_epi16(-1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1, 0);
+            auto const opaque = _mm256_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255);
+            auto const rounding = _mm256_set1_epi16(128);
+            auto const alpha = _mm256_shufflehi_epi16(
+                _mm256_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3)),
+                _MM_SHUFFLE(3, 3, 3, 3)
+            );
+            auto const factor = _mm256_or_si256(_mm256_and_si256(alpha, colorMask), opaque);
+            auto const product = _mm256_add_epi16(_mm256_mullo_epi16(pixels, factor), rounding);
+            return _mm256_srli_epi16(_mm256_add_epi16(product, _mm256_srli_epi16(product, 8)), 8);
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        MFA_TARGET_AVX2
+        size_t PremultiplyAlphaAVX2(uint8_t const * source, size_t const count, uint8_t * destination)
+        {
+            auto const zero = _mm256_setzero_si256();
+            size_t i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                auto const pixels = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(source + i * 4));
+                // Unpack and pack both work inside the lanes so the pixel order is kept
+                auto const low = PremultiplyWideAVX2(_mm256_unpacklo_epi8(pixels, zero));
+                auto const high = PremultiplyWideAVX2(_mm256_unpackhi_epi8(pixels, zero));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(destination + i * 4), _mm256_packus_epi16(low, high));
+            }
+            return i;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        MFA_TARGET_AVX2
+        size_t Convert16To8_AVX2(uint8_t const * source, size_t const count, uint8_t * destination)
+        {
+            auto const scale = _mm256_set1_epi16(static_cast<short>(65281));
+            auto const rounding = _mm256_set1_epi16(128);
+            size_t i = 0;
+            for (; i + 32 <= count; i += 32)
+            {
+                auto const * values = reinterpret_cast<__m256i const *>(source + i * 2);
+                auto const low = _mm256_loadu_si256(values);
+                auto const high = _mm256_loadu_si256(values + 1);
+                auto const roundedLow = _mm256_srli_epi16(_mm256_add_epi16(_mm256_mulhi_epu16(low, scale), rounding), 8);
+                auto const roundedHigh = _mm256_srli_epi16(_mm256_add_epi16(_mm256_mulhi_epu16(high, scale), rounding), 8);
+                _mm256_storeu_si256(
+                    reinterpret_cast<__m256i *>(destination + i),
+                    _mm256_permute4x64_epi64(_mm256_packus_epi16(roundedLow, roundedHigh), _MM_SHUFFLE(3, 1, 2, 0))
+                );
+            }
+            return i;
+        }
+
+#endif
+
+        //-------------------------------------------------------------------------------------------------
+
+        Kernels SelectKernels()
+        {
+            Kernels kernels{
+                .grayToRGBA = &NoKernel,
+                .grayAlphaToRGBA = &NoKernel,
+                .rgbToRGBA = &NoKernel,
+                .bgrToRGBA = &NoKernel,
+                .bgraToRGBA = &NoKernel,
+                .premultiplyAlpha = &NoKernel,
+                .convert16To8 = &NoKernel,
+            };
+#ifdef MFA_PIXEL_FORMAT_SIMD
+            auto const & features = Cpu::GetFeatures();
+            if (features.avx2)
+            {
+                kernels = Kernels{
+                    .grayToRGBA = &GrayToRGBA_AVX2,
+                    .grayAlphaToRGBA = &GrayAlphaToRGBA_AVX2,
+                    .rgbToRGBA = &RGBToRGBA_AVX2,
+                    .bgrToRGBA = &BGRToRGBA_AVX2,
+                    .bgraToRGBA = &BGRAToRGBA_AVX2,
+                    .premultiplyAlpha = &PremultiplyAlphaAVX2,
+                    .convert16To8 = &Convert16To8_AVX2,
+                };
+            }
+            else if (features.ssse3)
+            {
+                kernels = Kernels{
+                    .grayToRGBA = &GrayToRGBA_SSSE3,
+                    .grayAlphaToRGBA = &GrayAlphaToRGBA_SSSE3,
+                    .rgbToRGBA = &RGBToRGBA_SSSE3,
+                    .bgrToRGBA = &BGRToRGBA_SSSE3,
+                    .bgraToRGBA = &BGRAToRGBA_SSSE3,
+                    .premultiplyAlpha = &PremultiplyAlphaSSSE3,
+                    .convert16To8 = &Convert16To8_SSSE3,
+                };
+            }
+#endif
+            return kernels;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        Kernels const & GetKernels()
+        {
+            static Kernels const kernels = SelectKernels();
+            return kernels;
+        }
+
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    void ExpandToRGBA(uint8_t const * source, uint32_t const components, size_t const pixelCount, uint8_t * destination)
+    {
+        switch (components)
+        {
+        case 1:
+            GrayToRGBA(source, pixelCount, destination);
+            break;
+        case 2:
+            GrayAlphaToRGBA(source, pixelCount, destination);
+            break;
+        case 3:
+            RGBToRGBA(source, pixelCount, destination);
+            break;
+        case 4:
+            if (source != destination)
+            {
+                std::memcpy(destination, source, pixelCount * 4);
+            }
+            break;
+        default:
+            MFA_ASSERT(false);
+        }
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    void GrayToRGBA(uint8_t const * source, size_t const pixelCount, uint8_t * destination)
+    {
+        for (size_t i = GetKernels().grayToRGBA(source, pixelCount, destination); i < pixelCount; ++i)
+        {
+            destination[i * 4 + 0] = source[i];
+            destination[i * 4 + 1] = source[i];
+            destination[i * 4 + 2] = source[i];
+            destination[i * 4 + 3] = 255;
+        }
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    void GrayAlphaToRGBA(uint8_t const * source, size_t const pixelCount, uint8_t * destination)
+    {
+        for (size_t i = GetKernels().grayAlphaToRGBA(source, pixelCount, destination); i < pixelCount; ++i)
+        {
+            destination[i * 4 + 0] = source[i * 2];
+            destination[i * 4 + 1] = source[i * 2];
+            destination[i * 4 + 2] = source[i * 2];
+            destination[i * 4 + 3] = source[i * 2 + 1];
+        }
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    void RGBToRGBA(uint8_t const * source, size_t const pixelCount, uint8_t * destination)
+    {
+        for (size_t i = GetKernels().rgbToRGBA(source, pixelCount, destination); i < pixelCount; ++i)
+        {
+            destination[i * 4 + 0] = source[i * 3 + 0];
+            destination[i * 4 + 1] = source[i * 3 + 1];
+            destination[i * 4 + 2] = source[i * 3 + 2];
+            destination[i * 4 + 3] = 255;
+        }
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    void BGRToRGBA(uint8_t const * source, size_t const pixelCount, uint8_t * destination)
+    {
+        for (size_t i = GetKernels().bgrToRGBA(source, pixelCount, destination); i < pixelCount; ++i)
+        {
+            destination[i * 4 + 0] = source[i * 3 + 2];
+            destination[i * 4 + 1] = source[i * 3 + 1];
+            destination[i * 4 + 2] = source[i * 3 + 0];
+            destination[i * 4 + 3] = 255;
+        }
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    void BGRAToRGBA(uint8_t const * source, size_t const pixelCount, uint8_t * destination)
+    {
+        for (size_t i = GetKernels().bgraToRGBA(source, pixelCount, destination); i < pixelCount; ++i)
+        {
+            auto const blue = source[i * 4 + 0];
+            destination[i * 4 + 0] = source[i * 4 + 2];
+            destination[i * 4 + 1] = source[i * 4 + 1];
+            destination[i * 4 + 2] = blue;
+            destination[i * 4 + 3] = source[i * 4 + 3];
+        }
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    void PremultiplyAlpha(uint8_t * rgba, size_t const pixelCount)
+    {
+        for (size_t i = GetKernels().premultiplyAlpha(rgba, pixelCount, rgba); i < pixelCount; ++i)
+        {
+            auto * pixel = rgba + i * 4;
+            pixel[0] = MultiplyUnorm(pixel[0], pixel[3]);
+            pixel[1] = MultiplyUnorm(pixel[1], pixel[3]);
+            pixel[2] = MultiplyUnorm(pixel[2], pixel[3]);
+        }
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    void Convert16To8(uint16_t const * source, size_t const valueCount, uint8_t * destination)
+    {
+        auto const * sourceBytes = reinterpret_cast<uint8_t const *>(source);
+        for (size_t i = GetKernels().convert16To8(sourceBytes, valueCount, destination); i < valueCount; ++i)
+        {
+            destination[i] = RoundTo8(source[i]);
+        }
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+}
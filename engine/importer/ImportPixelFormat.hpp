@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Conversions from decoded image layouts to the 8 bit layouts of AS::Texture. The kernels are picked once from the
+// cpu features (AVX2, SSSE3 or scalar) and write straight into the destination, so a decoded image can be expanded
+// into the texture buffer without an intermediate copy. Counts are in pixels unless noted otherwise.
+namespace MFA::Importer::PixelFormat
+{
+
+    // 1: gray, 2: gray and alpha, 3: rgb, 4: rgba. Missing alpha becomes 255.
+    void ExpandToRGBA(uint8_t const * source, uint32_t components, size_t pixelCount, uint8_t * destination);
+
+    void GrayToRGBA(uint8_t const * source, size_t pixelCount, uint8_t * destination);
+
+    void GrayAlphaToRGBA(uint8_t const * source, size_t pixelCount, uint8_t * destination);
+
+    void RGBToRGBA(uint8_t const * source, size_t pixelCount, uint8_t * destination);
+
+    void BGRToRGBA(uint8_t const * source, size_t pixelCount, uint8_t * destination);
+
+    // Source and destination can be the same buffer
+    void BGRAToRGBA(uint8_t const * source, size_t pixelCount, uint8_t * destination);
+
+    // Multiplies the color of each pixel by its alpha with rounding, in place
+    void PremultiplyAlpha(uint8_t * rgba, size_t pixelCount);
+
+    // Rounds each value to the nearest 8 bit value. Counts values, destination can be the source.
+    void Convert16To8(uint16_t const * source, size_t valueCount, uint8_t * destination);
+
+}
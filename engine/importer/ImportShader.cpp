@@ -1,9 +1,14 @@
 #include "ImportShader.hpp"
 
+#include "ImportCache.hpp"
 #include "BedrockAssert.hpp"
 #include "BedrockLog.hpp"
 #include "BedrockFile.hpp"
 
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
 namespace MFA::Importer
 {
 
@@ -51,22 +56,168 @@ namespace MFA::Importer
 
 	//-------------------------------------------------------------------------------------------------
 
+	// Reads the make rule that glslc writes with -MD. Returns every prerequisite, the input first and then the
+	// included files. Spaces in paths are escaped with a backslash and long rules continue on the next line.
+	static bool ReadDependencies(std::string const & path, std::vector<std::string> & outDependencies)
+	{
+		std::ifstream file(path, std::ios::binary);
+		if (file.good() == false)
+		{
+			return false;
+		}
+		std::string const rule{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+
+		// Drive letters are followed by a slash, so the first colon and space ends the target
+		auto const separator = rule.find(": ");
+		if (separator == std::string::npos)
+		{
+			return false;
+		}
+
+		std::string dependency{};
+		for (size_t i = separator + 2; i < rule.size(); ++i)
+		{
+			char const character = rule[i];
+			char const next = i + 1 < rule.size() ? rule[i + 1] : '\0';
+			if (character == '\\' && (next == ' ' || next == '\n' || next == '\r'))
+			{
+				if (next == ' ')
+				{
+					dependency += ' ';
+				}
+				++i;
+				continue;
+			}
+			if (character == ' ' || character == '\t' || character == '\n' || character == '\r')
+			{
+				if (dependency.empty() == false)
+				{
+					outDependencies.emplace_back(std::move(dependency));
+					dependency.clear();
+				}
+				continue;
+			}
+			dependency += character;
+		}
+		if (dependency.empty() == false)
+		{
+			outDependencies.emplace_back(std::move(dependency));
+		}
+		return outDependencies.empty() == false;
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
     bool CompileShaderToSPV(
         std::string const & inputPath,
         std::string const & outputPath,
         std::string const & stage
     )
 	{
+		// Included files are sources of the entry as well, glslc lists them in a dependency file
+		auto * cache = ImportCache::Instance;
+		uint64_t cacheKey = 0;
+		std::error_code errorCode{};
+		if (cache != nullptr)
+		{
+			cacheKey = ImportCache::KeyBuilder("CompileShaderToSPV", inputPath)
+				.Add(stage)
+				.Build();
+			if (cache->Find(cacheKey))
+			{
+				std::filesystem::copy_file(
+					cache->PayloadPath(cacheKey, ".spv"),
+					outputPath,
+					std::filesystem::copy_options::overwrite_existing,
+					errorCode
+				);
+				if (!errorCode)
+				{
+					return true;
+				}
+			}
+		}
+
+		auto const dependencyPath = outputPath + ".d";
 		std::string command = "";
 		MFA_STRING(
 			command,
-			"glslc -g -fshader-stage=%s \"%s\" -o \"%s\" -std=450core",
+			"glslc -g -fshader-stage=%s \"%s\" -o \"%s\" -std=450core -MD -MF \"%s\"",
 			stage.c_str(),
 			inputPath.c_str(),
-			outputPath.c_str()
+			outputPath.c_str(),
+			dependencyPath.c_str()
 		);
 		auto const result = std::system(command.c_str());
-		return result == 0;
+
+		std::vector<std::string> dependencies{};
+		bool const hasDependencies = ReadDependencies(dependencyPath, dependencies);
+		std::filesystem::remove(dependencyPath, errorCode);
+
+		if (result != 0)
+		{
+			return false;
+		}
+
+		// Without the list of included files an entry could outlive an edit, so the result is not cached
+		if (cache != nullptr && hasDependencies)
+		{
+			std::vector<std::string> sources{inputPath};
+			for (auto const & dependency : dependencies)
+			{
+				if (std::filesystem::equivalent(dependency, inputPath, errorCode) == false)
+				{
+					sources.emplace_back(dependency);
+				}
+			}
+
+			std::filesystem::copy_file(
+				outputPath,
+				cache->PayloadPath(cacheKey, ".spv"),
+				std::filesystem::copy_options::overwrite_existing,
+				errorCode
+			);
+			if (!errorCode)
+			{
+				cache->Commit(cacheKey, sources);
+			}
+		}
+		else if (cache != nullptr)
+		{
+			MFA_LOG_WARN("No dependency file for %s, the shader is not cached", inputPath.c_str());
+		}
+		return true;
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	std::shared_ptr<AS::Shader> ShaderFromHLSL(
+		std::string const & inputPath,
+		std::string const & outputPath,
+		VkShaderStageFlagBits const stage,
+		std::string const & entryPoint
+	)
+	{
+		std::string stageName{};
+		switch (stage)
+		{
+		case VK_SHADER_STAGE_VERTEX_BIT:
+			stageName = "vert";
+			break;
+		case VK_SHADER_STAGE_FRAGMENT_BIT:
+			stageName = "frag";
+			break;
+		case VK_SHADER_STAGE_COMPUTE_BIT:
+			stageName = "comp";
+			break;
+		default: MFA_NOT_IMPLEMENTED_YET("Mohammad Fakhreddin");
+		}
+
+		if (CompileShaderToSPV(inputPath, outputPath, stageName) == false)
+		{
+			MFA_LOG_WARN("Failed to compile %s, the existing module is used instead", inputPath.c_str());
+		}
+		return ShaderFromSPV(outputPath, stage, entryPoint);
 	}
 
 	//-------------------------------------------------------------------------------------------------
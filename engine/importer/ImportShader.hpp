@@ -27,4 +27,14 @@ namespace MFA::Importer
         std::string const & stage
     );
 
+    // Compiles the source to outputPath and imports the result. When the compiler fails, for example because glslc
+    // is not installed, the module that is already at outputPath is imported instead. Returns nullptr when there is
+    // neither a fresh nor an existing module.
+    std::shared_ptr<AS::Shader> ShaderFromHLSL(
+        std::string const & inputPath,
+        std::string const & outputPath,
+        VkShaderStageFlagBits stage,
+        std::string const & entryPoint
+    );
+
 }
@@ -1,5 +1,8 @@
 #include "ImportTexture.hpp"
 
+#include "ImportCache.hpp"
+#include "ImportMipChain.hpp"
+#include "ImportPixelFormat.hpp"
 #include "BedrockAssert.hpp"
 #include "BedrockFile.hpp"
 #include "BedrockMemory.hpp"
@@ -9,142 +12,223 @@
 #include "stb_image.h"
 #include "stb_image_resize.h"
 
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
 namespace MFA::Importer
 {
 
     using Format = AS::Texture::Format;
 
-    struct Data
+    // Allocates the texture with room for the whole mip chain, lets the caller fill the base level in place and then
+    // filters the remaining levels from it. The finished chain is block compressed when the options ask for it.
+    static std::shared_ptr<AS::Texture> CreateUncompressedTexture(
+        int32_t const width,
+        int32_t const height,
+        Format const format,
+        uint32_t const components,
+        uint16_t const depth,
+        uint16_t const slices,
+        ImportTextureOptions const & options,
+        std::function<void(uint8_t * baseLevel, size_t baseLevelSize)> const & writeBaseLevel
+    )
     {
-        int32_t width = 0;
-        int32_t height = 0;
-        int32_t stbi_components = 0;
-        std::shared_ptr<Blob> stbi_pixels;
-        Format format = Format::INVALID;
-        std::shared_ptr<Blob> pixels;
-        uint32_t components = 0;
-        [[nodiscard]]
-        bool valid() const
-        {
-            return stbi_pixels != nullptr &&
-                stbi_pixels->IsValid() == true &&
-                width > 0 &&
-                height > 0 &&
-                stbi_components > 0;
-        }
-    };
+        AS::Texture::Dimensions const originalImageDimension{
+            static_cast<uint32_t>(width),
+            static_cast<uint32_t>(height),
+            depth
+        };
 
-    enum class LoadResult
-    {
-        Invalid,
-        Success,
-        FileNotExists
-        // Format not supported
-    };
+        // Volume textures would need the depth filtered too
+        uint8_t const mipCount = options.tryToGenerateMipmaps && depth == 1
+            ? AS::Texture::ComputeMipCount(originalImageDimension)
+            : 1;
 
-    static LoadResult LoadUncompressed(Data& outImageData, std::string const& path, bool prefer_srgb)
-    {
-        LoadResult ret = LoadResult::Invalid;
+        auto const bufferSize = AS::Texture::CalculateUncompressedTextureRequiredDataSize(
+            format,
+            slices,
+            originalImageDimension,
+            mipCount
+        );
 
-        auto const rawFile = File::Read(path);
+        std::shared_ptr<AS::Texture> texture = std::make_shared<AS::Texture>(
+            format,
+            slices,
+            depth,
+            bufferSize
+        );
 
-        if (rawFile == nullptr)
+        auto const baseLevelSize = AS::Texture::MipSizeBytes(format, slices, originalImageDimension);
+        auto * baseLevel = texture->addMipmap(originalImageDimension, baseLevelSize);
+        writeBaseLevel(baseLevel, baseLevelSize);
+        if (options.premultiplyAlpha && components == 4)
         {
-            return ret;
+            PixelFormat::PremultiplyAlpha(baseLevel, baseLevelSize / 4);
         }
 
-        auto* readData = stbi_load_from_memory(
-            rawFile->Ptr(),
-            static_cast<int>(rawFile->Len()),
-            &outImageData.width,
-            &outImageData.height,
-            &outImageData.stbi_components,
-            0
-        );
-
-        if (readData != nullptr)
+        // Every level is filtered from the previous one straight into the texture buffer, slices are filtered separately
+        auto const & formatInfo = AS::Texture::FormatTable[static_cast<uint8_t>(format)];
+        bool const useSRGB = formatInfo.color_space == 1;
+        auto previousMipDims = originalImageDimension;
+        uint8_t const * previousMipPixels = baseLevel;
+        for (uint8_t mipLevel = 1; mipLevel < mipCount; mipLevel++)
         {
-            MFA_ASSERT(outImageData.width > 0);
-            MFA_ASSERT(outImageData.height > 0);
-            MFA_ASSERT(outImageData.stbi_components > 0);
-
-            outImageData.stbi_pixels = std::make_shared<Blob>(
-                readData,
-                static_cast<size_t>(outImageData.width) *
-                outImageData.height *
-                outImageData.stbi_components *
-                sizeof(uint8_t)
+            auto const currentMipDims = AS::Texture::MipDimensions(
+                mipLevel,
+                mipCount,
+                originalImageDimension
+            );
+            auto const currentMipSizeBytes = AS::Texture::MipSizeBytes(
+                format,
+                slices,
+                currentMipDims
+            );
+            auto * mipMapPixels = texture->addMipmap(currentMipDims, currentMipSizeBytes);
 
+            auto const previousSliceSize = AS::Texture::MipSizeBytes(format, 1, previousMipDims);
+            auto const currentSliceSize = AS::Texture::MipSizeBytes(format, 1, currentMipDims);
+            for (uint16_t slice = 0; slice < slices; ++slice)
+            {
+                DownsampleMip(
+                    previousMipPixels + slice * previousSliceSize,
+                    previousMipDims.width,
+                    previousMipDims.height,
+                    components,
+                    useSRGB,
+                    mipMapPixels + slice * currentSliceSize
                 );
+            }
 
-            outImageData.components = outImageData.stbi_components;
-            if (prefer_srgb)
+            previousMipDims = currentMipDims;
+            previousMipPixels = mipMapPixels;
+        }
+
+        MFA_ASSERT(texture->isValid());
+
+        if (options.blockCompress)
+        {
+            auto compressedTexture = CompressTexture(*texture, options.usage, options.compressionQuality);
+            if (compressedTexture != nullptr)
             {
-                switch (outImageData.stbi_components)
-                {
-                case 1:
-                    outImageData.format = Format::UNCOMPRESSED_UNORM_R8_SRGB;
-                    break;
-                case 2:
-                case 3:
-                case 4:
-                    outImageData.format = Format::UNCOMPRESSED_UNORM_R8G8B8A8_SRGB;
-                    outImageData.components = 4;
-                    break;
-                default: MFA_NOT_IMPLEMENTED_YET("Mohammad Fakhreddin");
-                }
+                texture = std::move(compressedTexture);
             }
-            else
+        }
+
+        return texture;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    // Decodes with stb_image and expands the pixels directly into the texture. 16 bit images are rounded to 8 bit.
+    static std::shared_ptr<AS::Texture> LoadUncompressed(
+        std::string const & path,
+        bool const prefer_srgb,
+        ImportTextureOptions const & options
+    )
+    {
+        auto const rawFile = File::MappedFile::Open(path);
+        if (rawFile == nullptr)
+        {
+            return nullptr;
+        }
+
+        int width = 0;
+        int height = 0;
+        int stbiComponents = 0;
+        uint8_t * stbiPixels = nullptr;
+        auto const * fileData = rawFile->Ptr();
+        auto const fileSize = static_cast<int>(rawFile->Len());
+        if (stbi_is_16_bit_from_memory(fileData, fileSize) != 0)
+        {
+            auto * wideValues = stbi_load_16_from_memory(fileData, fileSize, &width, &height, &stbiComponents, 0);
+            if (wideValues != nullptr)
             {
-                switch (outImageData.stbi_components)
-                {
-                case 1:
-                    outImageData.format = Format::UNCOMPRESSED_UNORM_R8_LINEAR;
-                    break;
-                case 2:
-                    outImageData.format = Format::UNCOMPRESSED_UNORM_R8G8_LINEAR;
-                    break;
-                case 3:
-                case 4:
-                    outImageData.format = Format::UNCOMPRESSED_UNORM_R8G8B8A8_LINEAR;
-                    outImageData.components = 4;
-                    break;
-                default: MFA_LOG_WARN("Unhandled component count: %d", outImageData.stbi_components);
-                }
+                auto const valueCount = static_cast<size_t>(width) * height * stbiComponents;
+                stbiPixels = reinterpret_cast<uint8_t *>(wideValues);
+                PixelFormat::Convert16To8(wideValues, valueCount, stbiPixels);
             }
-            MFA_ASSERT(outImageData.components >= static_cast<uint32_t>(outImageData.stbi_components));
-            if (static_cast<int>(outImageData.components) == outImageData.stbi_components)
+        }
+        else
+        {
+            stbiPixels = stbi_load_from_memory(fileData, fileSize, &width, &height, &stbiComponents, 0);
+        }
+
+        if (stbiPixels == nullptr)
+        {
+            MFA_LOG_WARN("Failed to decode image %s: %s", path.c_str(), stbi_failure_reason());
+            return nullptr;
+        }
+
+        MFA_ASSERT(width > 0);
+        MFA_ASSERT(height > 0);
+        MFA_ASSERT(stbiComponents > 0);
+
+        Format format = Format::INVALID;
+        auto components = static_cast<uint32_t>(stbiComponents);
+        if (prefer_srgb)
+        {
+            switch (stbiComponents)
             {
-                outImageData.pixels = outImageData.stbi_pixels;
+            case 1:
+                format = Format::UNCOMPRESSED_UNORM_R8_SRGB;
+                break;
+            case 2:
+            case 3:
+            case 4:
+                format = Format::UNCOMPRESSED_UNORM_R8G8B8A8_SRGB;
+                components = 4;
+                break;
+            default: MFA_NOT_IMPLEMENTED_YET("Mohammad Fakhreddin");
             }
-            else
+        }
+        else
+        {
+            switch (stbiComponents)
             {
-                auto const size = static_cast<size_t>(outImageData.width) *
-                    outImageData.height *
-                    outImageData.components *
-                    sizeof(uint8_t);
-
-                outImageData.pixels = Memory::AllocSize(size);
+            case 1:
+                format = Format::UNCOMPRESSED_UNORM_R8_LINEAR;
+                break;
+            case 2:
+                format = Format::UNCOMPRESSED_UNORM_R8G8_LINEAR;
+                break;
+            case 3:
+            case 4:
+                format = Format::UNCOMPRESSED_UNORM_R8G8B8A8_LINEAR;
+                components = 4;
+                break;
+            default: MFA_LOG_WARN("Unhandled component count: %d", stbiComponents);
+            }
+        }
 
-                auto* pixels_array = outImageData.pixels->As<uint8_t>();
-                auto const* stbi_pixels_array = outImageData.stbi_pixels->As<uint8_t>();
-                for (int pixel_index = 0; pixel_index < outImageData.width * outImageData.height; pixel_index++)
+        std::shared_ptr<AS::Texture> texture{};
+        if (format != Format::INVALID)
+        {
+            MFA_ASSERT(components >= static_cast<uint32_t>(stbiComponents));
+            auto const pixelCount = static_cast<size_t>(width) * height;
+            texture = CreateUncompressedTexture(
+                width,
+                height,
+                format,
+                components,
+                1,
+                1,
+                options,
+                [&](uint8_t * baseLevel, size_t const baseLevelSize)->void
                 {
-                    for (uint32_t component_index = 0; component_index < outImageData.components; component_index++)
+                    if (static_cast<int>(components) == stbiComponents)
+                    {
+                        std::memcpy(baseLevel, stbiPixels, baseLevelSize);
+                    }
+                    else
                     {
-                        pixels_array[pixel_index * outImageData.components + component_index] = static_cast<int64_t>(component_index) < outImageData.stbi_components
-                            ? stbi_pixels_array[pixel_index * outImageData.stbi_components + component_index]
-                            : 255u;
+                        PixelFormat::ExpandToRGBA(stbiPixels, stbiComponents, pixelCount, baseLevel);
                     }
                 }
-            }
-            ret = LoadResult::Success;
-        }
-        else
-        {
-            ret = LoadResult::FileNotExists;
+            );
         }
-        return ret;
+        stbi_image_free(stbiPixels);
+        return texture;
     }
 
     //-------------------------------------------------------------------------------------------------
@@ -203,39 +287,148 @@ namespace MFA::Importer
 
     //-------------------------------------------------------------------------------------------------
 
+    static constexpr char const * CookedTextureExtension = ".mfatex";
+
+    // .mfatex is a header, the mip table and the texture buffer exactly as AS::Texture holds it
+    struct CookedTextureHeader
+    {
+        char magic[8]{};
+        uint32_t version = 0;
+        Format format = Format::INVALID;
+        uint8_t mipCount = 0;
+        uint16_t slices = 0;
+        uint16_t depth = 0;
+        uint16_t padding = 0;
+        uint64_t bufferSize = 0;
+    };
+
+    static constexpr char CookedTextureMagic[8]{'M', 'F', 'A', 'T', 'E', 'X', 'T', 'R'};
+    static constexpr uint32_t CookedTextureVersion = 3;
+
+    //-------------------------------------------------------------------------------------------------
+
+    static bool SaveCookedTexture(AS::Texture const & texture, std::string const & path)
+    {
+        auto const buffer = texture.GetBuffer();
+        MFA_ASSERT(buffer != nullptr);
+
+        CookedTextureHeader header{
+            .version = CookedTextureVersion,
+            .format = texture.GetFormat(),
+            .mipCount = texture.GetMipCount(),
+            .slices = texture.GetSlices(),
+            .depth = texture.GetDepth(),
+            .bufferSize = buffer->Len()
+        };
+        std::memcpy(header.magic, CookedTextureMagic, sizeof(CookedTextureMagic));
+
+        return ImportCache::WriteFile(path, [&](std::ofstream & file)->bool
+        {
+            file.write(reinterpret_cast<char const *>(&header), sizeof(header));
+            file.write(
+                reinterpret_cast<char const *>(texture.GetMipmaps()),
+                static_cast<std::streamsize>(sizeof(AS::Texture::MipmapInfo) * header.mipCount)
+            );
+            file.write(reinterpret_cast<char const *>(buffer->Ptr()), static_cast<std::streamsize>(buffer->Len()));
+            return file.good();
+        });
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    static std::shared_ptr<AS::Texture> LoadCookedTexture(std::string const & path)
+    {
+        auto const file = File::MappedFile::Open(path);
+        if (file == nullptr || file->Len() < sizeof(CookedTextureHeader))
+        {
+            return nullptr;
+        }
+
+        CookedTextureHeader header{};
+        std::memcpy(&header, file->Ptr(), sizeof(header));
+        auto const mipTableSize = sizeof(AS::Texture::MipmapInfo) * header.mipCount;
+        if (
+            std::memcmp(header.magic, CookedTextureMagic, sizeof(CookedTextureMagic)) != 0 ||
+            header.version != CookedTextureVersion ||
+            header.mipCount == 0 ||
+            file->Len() != sizeof(header) + mipTableSize + header.bufferSize
+        )
+        {
+            return nullptr;
+        }
+
+        std::vector<AS::Texture::MipmapInfo> mipmaps(header.mipCount);
+        std::memcpy(mipmaps.data(), file->Ptr() + sizeof(header), mipTableSize);
+        auto * buffer = file->Ptr() + sizeof(header) + mipTableSize;
+
+        auto texture = std::make_shared<AS::Texture>(
+            header.format,
+            header.slices,
+            header.depth,
+            header.bufferSize
+        );
+        uint64_t expectedOffset = 0;
+        for (auto const & mipmap : mipmaps)
+        {
+            if (mipmap.offset != expectedOffset || mipmap.offset + mipmap.size > header.bufferSize)
+            {
+                return nullptr;
+            }
+            texture->addMipmap(mipmap.dimension, buffer + mipmap.offset, mipmap.size);
+            expectedOffset += mipmap.size;
+        }
+        if (texture->isValid() == false)
+        {
+            return nullptr;
+        }
+        return texture;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    static uint64_t UncompressedImageKey(std::string const & path, ImportTextureOptions const & options)
+    {
+        return ImportCache::KeyBuilder("UncompressedImage", path)
+            .Add(options.tryToGenerateMipmaps)
+            .Add(options.premultiplyAlpha)
+            .Add(options.blockCompress)
+            .Add(options.usage)
+            .Add(options.compressionQuality)
+            .Build();
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
     std::shared_ptr<AS::Texture> UncompressedImage(
         std::string const& path, 
         ImportTextureOptions const& options
     )
     {
-        std::shared_ptr<AS::Texture> texture{};
-        Data imageData{};
-        auto const loadImageResult = LoadUncompressed(
-            imageData,
-            path,
-            false
-        );
-        if (loadImageResult == LoadResult::Success)
+        auto * cache = ImportCache::Instance;
+        uint64_t cacheKey = 0;
+        if (cache != nullptr)
         {
-            MFA_ASSERT(imageData.valid());
-            auto const image_width = imageData.width;
-            auto const image_height = imageData.height;
-            auto const pixels = imageData.pixels;
-            auto const components = imageData.components;
-            auto const format = imageData.format;
-            int const depth = 1; // TODO We need to support depth
-            int const slices = 1;
-
-            texture = InMemoryTexture(
-                *pixels,
-                image_width,
-                image_height,
-                format,
-                components,
-                depth,
-                slices,
-                options
-            );
+            cacheKey = UncompressedImageKey(path, options);
+            if (cache->Find(cacheKey))
+            {
+                auto cookedTexture = LoadCookedTexture(cache->PayloadPath(cacheKey, CookedTextureExtension));
+                if (cookedTexture != nullptr)
+                {
+                    return cookedTexture;
+                }
+            }
+        }
+
+        auto texture = LoadUncompressed(path, false, options);
+        if (texture != nullptr)
+        {
+            if (
+                cache != nullptr &&
+                SaveCookedTexture(*texture, cache->PayloadPath(cacheKey, CookedTextureExtension))
+            )
+            {
+                cache->Commit(cacheKey, {path});
+            }
         }
         // TODO: Handle errors
         return texture;
@@ -265,6 +458,124 @@ namespace MFA::Importer
 
     //-------------------------------------------------------------------------------------------------
 
+    std::shared_ptr<AS::Texture> PreviewTexture(
+        std::shared_ptr<AS::Texture> const & texture,
+        uint32_t const maxDimension
+    )
+    {
+        MFA_ASSERT(texture != nullptr);
+        MFA_ASSERT(maxDimension > 0);
+
+        auto const & formatInfo = AS::Texture::FormatTable[static_cast<uint8_t>(texture->GetFormat())];
+        if (texture->GetSlices() != 1 || texture->GetMipCount() == 0)
+        {
+            return nullptr;
+        }
+
+        // Mip zero is the largest one
+        uint8_t mipLevel = 0;
+        while (
+            mipLevel + 1 < texture->GetMipCount() &&
+            std::max(texture->GetMipmap(mipLevel).dimension.width, texture->GetMipmap(mipLevel).dimension.height) > maxDimension
+        )
+        {
+            ++mipLevel;
+        }
+        auto const & mipmap = texture->GetMipmap(mipLevel);
+        auto const & dimension = mipmap.dimension;
+
+        uint32_t const largestSide = std::max(dimension.width, dimension.height);
+        if (mipLevel == 0 && largestSide <= maxDimension)
+        {
+            return texture;
+        }
+
+        Alias const mipPixels{texture->GetBuffer()->Ptr() + mipmap.offset, static_cast<size_t>(mipmap.size)};
+        if (formatInfo.compression != 0)
+        {// Blocks cannot be resized, only a level that fits is copied
+            if (largestSide > maxDimension)
+            {
+                return nullptr;
+            }
+            auto preview = std::make_shared<AS::Texture>(texture->GetFormat(), 1, dimension.depth, mipPixels.Len());
+            preview->addMipmap(dimension, mipPixels.Ptr(), mipPixels.Len());
+            return preview;
+        }
+        if (largestSide <= maxDimension)
+        {
+            return InMemoryTexture(
+                mipPixels,
+                static_cast<int32_t>(dimension.width),
+                static_cast<int32_t>(dimension.height),
+                texture->GetFormat(),
+                formatInfo.component_count,
+                dimension.depth
+            );
+        }
+
+        auto const scale = static_cast<float>(maxDimension) / static_cast<float>(largestSide);
+        auto const width = std::max(static_cast<int32_t>(static_cast<float>(dimension.width) * scale), 1);
+        auto const height = std::max(static_cast<int32_t>(static_cast<float>(dimension.height) * scale), 1);
+
+        std::shared_ptr<Blob> pixels = Memory::AllocSize(
+            static_cast<size_t>(width) * height * formatInfo.component_count
+        );
+        ResizeInputParams const inputParams{
+            .inputImagePixels = mipPixels,
+            .inputImageWidth = static_cast<int32_t>(dimension.width),
+            .inputImageHeight = static_cast<int32_t>(dimension.height),
+            .componentsCount = formatInfo.component_count,
+            .outputImagePixels = pixels,
+            .outputWidth = width,
+            .outputHeight = height,
+            .useSRGB = formatInfo.color_space == 1,
+        };
+        if (ResizeUncompressed(inputParams) == false)
+        {
+            return nullptr;
+        }
+
+        return InMemoryTexture(
+            *pixels,
+            width,
+            height,
+            texture->GetFormat(),
+            formatInfo.component_count,
+            dimension.depth
+        );
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    std::shared_ptr<AS::Texture> PreviewImage(
+        std::string const & path,
+        uint32_t const maxDimension,
+        ImportTextureOptions const & options
+    )
+    {
+        std::shared_ptr<AS::Texture> texture{};
+        auto * cache = ImportCache::Instance;
+        if (cache != nullptr)
+        {
+            auto const cacheKey = UncompressedImageKey(path, options);
+            if (cache->Find(cacheKey))
+            {
+                texture = LoadCookedTexture(cache->PayloadPath(cacheKey, CookedTextureExtension));
+            }
+        }
+        if (texture == nullptr)
+        {// Mipmaps and block compression are the slow part of the import, the base level is enough to downscale
+            texture = LoadUncompressed(path, false, ImportTextureOptions{.usage = options.usage});
+        }
+        if (texture == nullptr)
+        {
+            return nullptr;
+        }
+        return PreviewTexture(texture, maxDimension);
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
     std::shared_ptr<AS::Texture> InMemoryTexture(
         BaseBlob const & data,
         int32_t width,
@@ -276,68 +587,19 @@ namespace MFA::Importer
         ImportTextureOptions const& options
     )
     {
-        AS::Texture::Dimensions const originalImageDimension{
-            static_cast<uint32_t>(width),
-            static_cast<uint32_t>(height),
-            depth
-        };
-
-        uint8_t const mipCount = options.tryToGenerateMipmaps
-            ? AS::Texture::ComputeMipCount(originalImageDimension)
-            : 1;
-
-        auto const bufferSize = AS::Texture::CalculateUncompressedTextureRequiredDataSize(
-            format,
-            slices,
-            originalImageDimension,
-            mipCount
-        );
-
-        std::shared_ptr<AS::Texture> texture = std::make_shared<AS::Texture>(
+        return CreateUncompressedTexture(
+            width,
+            height,
             format,
-            slices,
+            components,
             depth,
-            bufferSize
+            slices,
+            options,
+            [&data](uint8_t * baseLevel, size_t const baseLevelSize)->void
+            {
+                MFA_ASSERT(data.Len() >= baseLevelSize);
+                std::memcpy(baseLevel, data.Ptr(), baseLevelSize);
+            }
         );
-
-        // Generating mipmaps (TODO : Code needs debugging)
-        texture->addMipmap(originalImageDimension, std::make_shared<Blob>(data));
-
-        for (uint8_t mipLevel = 1; mipLevel < mipCount; mipLevel++)
-        {
-            auto const currentMipDims = AS::Texture::MipDimensions(
-                mipLevel,
-                mipCount,
-                originalImageDimension
-            );
-            auto const currentMipSizeBytes = AS::Texture::MipSizeBytes(
-                format,
-                slices,
-                currentMipDims
-            );
-            std::shared_ptr<Blob> mipMapPixels = Memory::AllocSize(currentMipSizeBytes);
-
-            // Resize
-            ResizeInputParams inputParams{
-                .inputImagePixels = data,
-                .inputImageWidth = static_cast<int>(originalImageDimension.width),
-                .inputImageHeight = static_cast<int>(originalImageDimension.height),
-                .componentsCount = components,
-                .outputImagePixels = mipMapPixels,
-                .outputWidth = static_cast<int>(currentMipDims.width),
-                .outputHeight = static_cast<int>(currentMipDims.height),
-            };
-            auto const resizeResult = ResizeUncompressed(inputParams);
-            MFA_ASSERT(resizeResult == true);
-
-            texture->addMipmap(
-                currentMipDims,
-                mipMapPixels
-            );
-        }
-
-        MFA_ASSERT(texture->isValid());
-
-        return texture;
     }
 }
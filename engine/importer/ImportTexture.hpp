@@ -3,13 +3,17 @@
 #include <string>
 
 #include "AssetTexture.hpp"
+#include "ImportBlockCompression.hpp"
 
 namespace MFA::Importer
 {
     struct ImportTextureOptions
     {
         bool tryToGenerateMipmaps = false;      // Generates mipmaps for uncompressed texture
-        // TODO Usage flags
+        bool premultiplyAlpha = false;          // Multiplies the stored color by alpha, for rgba textures
+        bool blockCompress = false;             // Encodes every mip to the BC format of the usage
+        TextureUsage usage = TextureUsage::Color;
+        CompressionQuality compressionQuality = CompressionQuality::Balanced;
     };
 
     [[nodiscard]]
@@ -21,6 +25,24 @@ namespace MFA::Importer
     [[nodiscard]]
     std::shared_ptr<AS::Texture> ErrorTexture();
 
+    // Single mip copy of the largest mip that fits in maxDimension, used as a placeholder while the full texture loads.
+    // Returns the source when it is already small enough. Compressed formats are not resized, so they return nullptr
+    // when no mip fits.
+    [[nodiscard]]
+    std::shared_ptr<AS::Texture> PreviewTexture(
+        std::shared_ptr<AS::Texture> const & texture,
+        uint32_t maxDimension
+    );
+
+    // PreviewTexture of the image at path without its mipmaps and block compression, so it is ready long before
+    // UncompressedImage with the same options. Reads the cooked texture instead when the cache already has it.
+    [[nodiscard]]
+    std::shared_ptr<AS::Texture> PreviewImage(
+        std::string const & path,
+        uint32_t maxDimension,
+        ImportTextureOptions const & options = {}
+    );
+
     [[nodiscard]]
     std::shared_ptr<AS::Texture> InMemoryTexture(
         BaseBlob const & data,
@@ -0,0 +1,662 @@
+#include "ImportTextureContainer.hpp"
+
+#include "ImportPixelFormat.hpp"
+#include "BedrockAssert.hpp"
+#include "BedrockFile.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+namespace MFA::Importer
+{
+
+    using Format = AS::Texture::Format;
+
+    namespace
+    {
+
+        // How the stored pixels differ from the rgba layout of the format
+        enum class Swizzle : uint8_t
+        {
+            None,
+            BGRA,
+            BGR,                                    // 24 bit, expanded to rgba
+            RGB                                     // 24 bit, expanded to rgba
+        };
+
+        struct ContainerLayout
+        {
+            Format format = Format::INVALID;
+            Swizzle swizzle = Swizzle::None;
+            bool forceOpaque = false;               // 32 bit layouts whose fourth byte is padding
+            uint32_t width = 0;
+            uint32_t height = 0;
+            uint32_t depth = 1;
+            uint16_t slices = 1;
+            uint8_t mipCount = 1;
+        };
+
+        //-------------------------------------------------------------------------------------------------
+
+        template<typename T>
+        T ReadValue(uint8_t const * data, size_t const offset)
+        {
+            T value{};
+            std::memcpy(&value, data + offset, sizeof(T));
+            return value;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        // Containers store the mip chain that Vulkan expects, each side is halved and rounded down
+        AS::Texture::Dimensions LevelDimensions(ContainerLayout const & layout, uint8_t const mipLevel)
+        {
+            return AS::Texture::Dimensions{
+                .width = std::max(layout.width >> mipLevel, 1u),
+                .height = std::max(layout.height >> mipLevel, 1u),
+                .depth = static_cast<uint16_t>(std::max(layout.depth >> mipLevel, 1u)),
+            };
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        // Bytes of one slice of a level in the file
+        size_t StoredSliceSize(ContainerLayout const & layout, AS::Texture::Dimensions const & dimensions)
+        {
+            auto const size = AS::Texture::MipSizeBytes(layout.format, 1, dimensions);
+            if (layout.swizzle == Swizzle::BGR || layout.swizzle == Swizzle::RGB)
+            {
+                return size / 4 * 3;
+            }
+            return size;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        bool IsValidLayout(ContainerLayout const & layout, std::string const & path)
+        {
+            if (layout.format == Format::INVALID)
+            {
+                return false;
+            }
+            if (layout.width == 0 || layout.height == 0 || layout.depth == 0 || layout.slices == 0)
+            {
+                MFA_LOG_WARN("Texture %s has an empty extent", path.c_str());
+                return false;
+            }
+            if (layout.depth > 1 && layout.slices > 1)
+            {
+                MFA_LOG_WARN("Texture %s is a volume array, which is not supported", path.c_str());
+                return false;
+            }
+            auto const maxMipCount = AS::Texture::ComputeMipCount(AS::Texture::Dimensions{
+                .width = layout.width,
+                .height = layout.height,
+                .depth = static_cast<uint16_t>(std::min<uint32_t>(layout.depth, UINT16_MAX))
+            });
+            if (layout.mipCount == 0 || layout.mipCount > maxMipCount)
+            {
+                MFA_LOG_WARN("Texture %s has %d mips", path.c_str(), static_cast<int>(layout.mipCount));
+                return false;
+            }
+            return true;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        // Copies every slice of every level from the file. sliceOffsets holds the file offset of each slice of each
+        // level, level major.
+        std::shared_ptr<AS::Texture> BuildTexture(
+            ContainerLayout const & layout,
+            uint8_t const * fileData,
+            size_t const fileSize,
+            std::vector<size_t> const & sliceOffsets,
+            std::string const & path
+        )
+        {
+            MFA_ASSERT(sliceOffsets.size() == static_cast<size_t>(layout.mipCount) * layout.slices);
+
+            size_t bufferSize = 0;
+            for (uint8_t mipLevel = 0; mipLevel < layout.mipCount; ++mipLevel)
+            {
+                auto const dimensions = LevelDimensions(layout, mipLevel);
+                bufferSize += AS::Texture::MipSizeBytes(layout.format, layout.slices, dimensions);
+            }
+
+            auto texture = std::make_shared<AS::Texture>(
+                layout.format,
+                layout.slices,
+                static_cast<uint16_t>(layout.depth),
+                bufferSize
+            );
+
+            for (uint8_t mipLevel = 0; mipLevel < layout.mipCount; ++mipLevel)
+            {
+                auto const dimensions = LevelDimensions(layout, mipLevel);
+                auto const sliceSize = AS::Texture::MipSizeBytes(layout.format, 1, dimensions);
+                auto const storedSliceSize = StoredSliceSize(layout, dimensions);
+                auto * level = texture->addMipmap(dimensions, sliceSize * layout.slices);
+
+                for (uint16_t slice = 0; slice < layout.slices; ++slice)
+                {
+                    auto const offset = sliceOffsets[static_cast<size_t>(mipLevel) * layout.slices + slice];
+                    if (offset > fileSize || fileSize - offset < storedSliceSize)
+                    {
+                        MFA_LOG_WARN("Texture %s is truncated", path.c_str());
+                        return nullptr;
+                    }
+
+                    auto const * source = fileData + offset;
+                    auto * destination = level + slice * sliceSize;
+                    auto const pixelCount = sliceSize / 4;
+                    switch (layout.swizzle)
+                    {
+                    case Swizzle::None:
+                        std::memcpy(destination, source, sliceSize);
+                        break;
+                    case Swizzle::BGRA:
+                        PixelFormat::BGRAToRGBA(source, pixelCount, destination);
+                        break;
+                    case Swizzle::BGR:
+                        PixelFormat::BGRToRGBA(source, pixelCount, destination);
+                        break;
+                    case Swizzle::RGB:
+                        PixelFormat::RGBToRGBA(source, pixelCount, destination);
+                        break;
+                    }
+                    if (layout.forceOpaque)
+                    {
+                        for (size_t i = 3; i < sliceSize; i += 4)
+                        {
+                            destination[i] = 255;
+                        }
+                    }
+                }
+            }
+
+            if (texture->isValid() == false)
+            {
+                return nullptr;
+            }
+            return texture;
+        }
+
+        //-------------------------------------------------------------------------------------------------
+        // DDS
+        //-------------------------------------------------------------------------------------------------
+
+        constexpr uint32_t DDS_Magic = 0x20534444;                  // "DDS "
+        constexpr size_t DDS_HeaderSize = 124;
+        constexpr size_t DDS_PixelFormatOffset = 4 + 72;
+        constexpr size_t DDS_DX10_HeaderSize = 20;
+
+        constexpr uint32_t DDPF_AlphaPixels = 0x1;
+        constexpr uint32_t DDPF_FourCC = 0x4;
+        constexpr uint32_t DDPF_RGB = 0x40;
+        constexpr uint32_t DDPF_Luminance = 0x20000;
+
+        constexpr uint32_t DDSCaps2_Cubemap = 0x200;
+        constexpr uint32_t DDSCaps2_AllFaces = 0xFC00;
+        constexpr uint32_t DDSCaps2_Volume = 0x200000;
+
+        constexpr uint32_t DDS_ResourceDimensionTexture3D = 4;
+        constexpr uint32_t DDS_ResourceMiscTextureCube = 0x4;
+        constexpr uint32_t DDS_AlphaModeOpaque = 3;
+
+        //-------------------------------------------------------------------------------------------------
+
+        constexpr uint32_t FourCC(char const a, char const b, char const c, char const d)
+        {
+            return static_cast<uint32_t>(static_cast<uint8_t>(a)) |
+                (static_cast<uint32_t>(static_cast<uint8_t>(b)) << 8) |
+                (static_cast<uint32_t>(static_cast<uint8_t>(c)) << 16) |
+                (static_cast<uint32_t>(static_cast<uint8_t>(d)) << 24);
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        // Fills format and swizzle from a DXGI_FORMAT value
+        void DDS_MapDxgiFormat(uint32_t const dxgiFormat, bool const opaque, ContainerLayout & layout)
+        {
+            switch (dxgiFormat)
+            {
+            case 28:                                                // R8G8B8A8_UNORM
+                layout.format = Format::UNCOMPRESSED_UNORM_R8G8B8A8_LINEAR;
+                break;
+            case 29:                                                // R8G8B8A8_UNORM_SRGB
+                layout.format = Format::UNCOMPRESSED_UNORM_R8G8B8A8_SRGB;
+                break;
+            case 87:                                                // B8G8R8A8_UNORM
+                layout.format = Format::UNCOMPRESSED_UNORM_R8G8B8A8_LINEAR;
+                layout.swizzle = Swizzle::BGRA;
+                break;
+            case 91:                                                // B8G8R8A8_UNORM_SRGB
+                layout.format = Format::UNCOMPRESSED_UNORM_R8G8B8A8_SRGB;
+                layout.swizzle = Swizzle::BGRA;
+                break;
+            case 49:                                                // R8G8_UNORM
+                layout.format = Format::UNCOMPRESSED_UNORM_R8G8_LINEAR;
+                break;
+            case 61:                                                // R8_UNORM
+                layout.format = Format::UNCOMPRESSED_UNORM_R8_LINEAR;
+                break;
+            case 70:                                                // BC1_TYPELESS
+            case 71:                                                // BC1_UNORM
+                layout.format = opaque ? Format::BC1_UNorm_Linear_RGB : Format::BC1_UNorm_Linear_RGBA;
+                break;
+            case 72:                                                // BC1_UNORM_SRGB
+                layout.format = opaque ? Format::BC1_UNorm_sRGB_RGB : Format::BC1_UNorm_sRGB_RGBA;
+                break;
+            case 79:                                                // BC4_TYPELESS
+            case 80:                                                // BC4_UNORM
+                layout.format = Format::BC4_UNorm_Linear_R;
+                break;
+            case 81:                                                // BC4_SNORM
+                layout.format = Format::BC4_SNorm_Linear_R;
+                break;
+            case 82:                                                // BC5_TYPELESS
+            case 83:                                                // BC5_UNORM
+                layout.format = Format::BC5_UNorm_Linear_RG;
+                break;
+            case 84:                                                // BC5_SNORM
+                layout.format = Format::BC5_SNorm_Linear_RG;
+                break;
+            case 95:                                                // BC6H_UF16
+                layout.format = Format::BC6H_UFloat_Linear_RGB;
+                break;
+            case 96:                                                // BC6H_SF16
+                layout.format = Format::BC6H_SFloat_Linear_RGB;
+                break;
+            case 97:                                                // BC7_TYPELESS
+            case 98:                                                // BC7_UNORM
+                layout.format = opaque ? Format::BC7_UNorm_Linear_RGB : Format::BC7_UNorm_Linear_RGBA;
+                break;
+            case 99:                                                // BC7_UNORM_SRGB
+                layout.format = opaque ? Format::BC7_UNorm_sRGB_RGB : Format::BC7_UNorm_sRGB_RGBA;
+                break;
+            default:
+                break;
+            }
+        }
+
+        //-------------------------------------------------------------------------------------------------
+
+        // Headers without the DX10 extension describe the format with a four character code or bit masks
+        void DDS_MapLegacyFormat(uint8_t const * pixelFormat, ContainerLayout & layout)
+        {
+            auto const flags = ReadValue<uint32_t>(pixelFormat, 4);
+            auto const fourCC = ReadValue<uint32_t>(pixelFormat, 8);
+            auto const bitCount = ReadValue<uint32_t>(pixelFormat, 12);
+            auto const redMask = ReadValue<uint32_t>(pixelFormat, 16);
+            auto const greenMask = ReadValue<uint32_t>(pixelFormat, 20);
+            auto const blueMask = ReadValue<uint32_t>(pixelFormat, 24);
+            auto const alphaMask = ReadValue<uint32_t>(pixelFormat, 28);
+
+            if ((flags & DDPF_FourCC) != 0)
+            {
+                // DXT1 does not tell whether its blocks use punch through alpha, D3D samples it with alpha
+                if (fourCC == FourCC('D', 'X', 'T', '1'))
+                {
+                    layout.format = Format::BC1_UNorm_Linear_RGBA;
+                }
+                else if (fourCC == FourCC('A', 'T', 'I', '1') || fourCC == FourCC('B', 'C', '4', 'U'))
+                {
+                    layout.format = Format::BC4_UNorm_Linear_R;
+                }
+                else if (fourCC == FourCC('B', 'C', '4', 'S'))
+                {
+                    layout.format = Format::BC4_SNorm_Linear_R;
+                }
+                else if (fourCC == FourCC('A', 'T', 'I', '2') || fourCC == FourCC('B', 'C', '5', 'U'))
+                {
+                    layout.format = Format::BC5_UNorm_Linear_RG;
+                }
+                else if (fourCC == FourCC('B', 'C', '5', 'S'))
+                {
+                    layout.format = Format::BC5_SNorm_Linear_RG;
+                }
+                return;
+            }
+
+            bool const hasAlpha = (flags & DDPF_AlphaPixels) != 0 && alphaMask != 0;
+            if ((flags & DDPF_RGB) != 0 && bitCount == 32)
+            {
+                if (redMask == 0x000000FF && greenMask == 0x0000FF00 && blueMask == 0x00FF0000)
+                {
+                    layout.format = Format::UNCOMPRESSED_UNORM_R8G8B8A8_LINEAR;
+                }
+                else if (redMask == 0x00FF0000 && greenMask == 0x0000FF00 && blueMask == 0x000000FF)
+                {
+                    layout.format = Format::UNCOMPRESSED_UNORM_R8G8B8A8_LINEAR;
+                    layout.swizzle = Swizzle::BGRA;
+                }
+                layout.forceOpaque = hasAlpha == false;
+            }
+            else if ((flags & DDPF_RGB) != 0 && bitCount == 24)
+            {
+                if (redMask == 0x00FF0000 && greenMask == 0x0000FF00 && blueMask == 0x000000FF)
+                {
+                    layout.format = Format::UNCOMPRESSED_UNORM_R8G8B8A8_LINEAR;
+                    layout.swizzle = Swizzle::BGR;
+                }
+                else if (redMask == 0x000000FF && greenMask == 0x0000FF00 && blueMask == 0x00FF0000)
+                {
+                    layout.format = Format::UNCOMPRESSED_UNORM_R8G8B8A8_LINEAR;
+                    layout.swizzle = Swizzle::RGB;
+                }
+            }
+            else if ((flags & DDPF_Luminance) != 0 && bitCount == 8)
+            {
+                layout.format = Format::UNCOMPRESSED_UNORM_R8_LINEAR;
+            }
+        }
+
+        //-------------------------------------------------------------------------------------------------
+        // KTX2
+        //-------------------------------------------------------------------------------------------------
+
+        constexpr uint8_t KTX2_Identifier[12]{0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+        constexpr size_t KTX2_HeaderSize = 80;
+        constexpr size_t KTX2_LevelIndexEntrySize = 24;
+
+        //-------------------------------------------------------------------------------------------------
+
+        // Fills format and swizzle from a VkFormat value, the importer does not depend on the vulkan headers
+        void KTX2_MapVkFormat(uint32_t const vkFormat, ContainerLayout & layout)
+        {
+            switch (vkFormat)
+            {
+            case 9:                                                 // R8_UNORM
+                layout.format = Format::UNCOMPRESSED_UNORM_R8_LINEAR;
+                break;
+            case 15:                                                // R8_SRGB
+                layout.format = Format::UNCOMPRESSED_UNORM_R8_SRGB;
+                break;
+            case 16:                                                // R8G8_UNORM
+                layout.format = Format::UNCOMPRESSED_UNORM_R8G8_LINEAR;
+                break;
+            case 37:                                                // R8G8B8A8_UNORM
+                layout.format = Format::UNCOMPRESSED_UNORM_R8G8B8A8_LINEAR;
+                break;
+            case 43:                                                // R8G8B8A8_SRGB
+                layout.format = Format::UNCOMPRESSED_UNORM_R8G8B8A8_SRGB;
+                break;
+            case 44:                                                // B8G8R8A8_UNORM
+                layout.format = Format::UNCOMPRESSED_UNORM_R8G8B8A8_LINEAR;
+                layout.swizzle = Swizzle::BGRA;
+                break;
+            case 50:                                                // B8G8R8A8_SRGB
+                layout.format = Format::UNCOMPRESSED_UNORM_R8G8B8A8_SRGB;
+                layout.swizzle = Swizzle::BGRA;
+                break;
+            case 131:                                               // BC1_RGB_UNORM_BLOCK
+                layout.format = Format::BC1_UNorm_Linear_RGB;
+                break;
+            case 132:                                               // BC1_RGB_SRGB_BLOCK
+                layout.format = Format::BC1_UNorm_sRGB_RGB;
+                break;
+            case 133:                                               // BC1_RGBA_UNORM_BLOCK
+                layout.format = Format::BC1_UNorm_Linear_RGBA;
+                break;
+            case 134:                                               // BC1_RGBA_SRGB_BLOCK
+                layout.format = Format::BC1_UNorm_sRGB_RGBA;
+                break;
+            case 139:                                               // BC4_UNORM_BLOCK
+                layout.format = Format::BC4_UNorm_Linear_R;
+                break;
+            case 140:                                               // BC4_SNORM_BLOCK
+                layout.format = Format::BC4_SNorm_Linear_R;
+                break;
+            case 141:                                               // BC5_UNORM_BLOCK
+                layout.format = Format::BC5_UNorm_Linear_RG;
+                break;
+            case 142:                                               // BC5_SNORM_BLOCK
+                layout.format = Format::BC5_SNorm_Linear_RG;
+                break;
+            case 143:                                               // BC6H_UFLOAT_BLOCK
+                layout.format = Format::BC6H_UFloat_Linear_RGB;
+                break;
+            case 144:                                               // BC6H_SFLOAT_BLOCK
+                layout.format = Format::BC6H_SFloat_Linear_RGB;
+                break;
+            case 145:                                               // BC7_UNORM_BLOCK
+                layout.format = Format::BC7_UNorm_Linear_RGBA;
+                break;
+            case 146:                                               // BC7_SRGB_BLOCK
+                layout.format = Format::BC7_UNorm_sRGB_RGBA;
+                break;
+            default:
+                break;
+            }
+        }
+
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    bool IsContainerTexture(std::string const & path)
+    {
+        auto const extension = std::filesystem::path(path).extension().string();
+        return extension == ".dds" || extension == ".ktx2";
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    std::shared_ptr<AS::Texture> ContainerTexture(std::string const & path)
+    {
+        auto const extension = std::filesystem::path(path).extension().string();
+        if (extension == ".dds")
+        {
+            return DDS_Texture(path);
+        }
+        if (extension == ".ktx2")
+        {
+            return KTX2_Texture(path);
+        }
+        MFA_LOG_WARN("Texture container is not supported: %s", path.c_str());
+        return nullptr;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    // Magic, header and an optional DX10 header. Data is stored slice by slice, each with its whole mip chain.
+    std::shared_ptr<AS::Texture> DDS_Texture(std::string const & path)
+    {
+        auto const file = File::MappedFile::Open(path);
+        if (file == nullptr)
+        {
+            MFA_LOG_WARN("Failed to open %s", path.c_str());
+            return nullptr;
+        }
+
+        auto const * data = file->Ptr();
+        auto const fileSize = file->Len();
+        if (
+            fileSize < 4 + DDS_HeaderSize ||
+            ReadValue<uint32_t>(data, 0) != DDS_Magic ||
+            ReadValue<uint32_t>(data, 4) != DDS_HeaderSize
+        )
+        {
+            MFA_LOG_WARN("%s is not a dds file", path.c_str());
+            return nullptr;
+        }
+
+        ContainerLayout layout{};
+        layout.height = ReadValue<uint32_t>(data, 12);
+        layout.width = ReadValue<uint32_t>(data, 16);
+        auto const depth = ReadValue<uint32_t>(data, 24);
+        layout.mipCount = static_cast<uint8_t>(std::clamp<uint32_t>(ReadValue<uint32_t>(data, 28), 1, UINT8_MAX));
+        auto const caps2 = ReadValue<uint32_t>(data, 4 + 108);
+
+        auto const * pixelFormat = data + DDS_PixelFormatOffset;
+        size_t dataOffset = 4 + DDS_HeaderSize;
+        uint32_t faceCount = 1;
+        uint32_t arraySize = 1;
+        bool isVolume = (caps2 & DDSCaps2_Volume) != 0;
+
+        if (ReadValue<uint32_t>(pixelFormat, 8) == FourCC('D', 'X', '1', '0'))
+        {
+            if (fileSize < dataOffset + DDS_DX10_HeaderSize)
+            {
+                MFA_LOG_WARN("Texture %s is truncated", path.c_str());
+                return nullptr;
+            }
+            auto const * extension = data + dataOffset;
+            auto const dxgiFormat = ReadValue<uint32_t>(extension, 0);
+            auto const resourceDimension = ReadValue<uint32_t>(extension, 4);
+            auto const miscFlag = ReadValue<uint32_t>(extension, 8);
+            arraySize = std::max(ReadValue<uint32_t>(extension, 12), 1u);
+            auto const alphaMode = ReadValue<uint32_t>(extension, 16) & 0x7;
+            dataOffset += DDS_DX10_HeaderSize;
+
+            isVolume = resourceDimension == DDS_ResourceDimensionTexture3D;
+            faceCount = (miscFlag & DDS_ResourceMiscTextureCube) != 0 ? 6 : 1;
+            DDS_MapDxgiFormat(dxgiFormat, alphaMode == DDS_AlphaModeOpaque, layout);
+            if (layout.format == Format::INVALID)
+            {
+                MFA_LOG_WARN("Dxgi format %u of %s is not supported", dxgiFormat, path.c_str());
+                return nullptr;
+            }
+        }
+        else
+        {
+            if ((caps2 & DDSCaps2_Cubemap) != 0)
+            {
+                // Faces can be left out of a legacy cubemap, which a slice array can not express
+                if ((caps2 & DDSCaps2_AllFaces) != DDSCaps2_AllFaces)
+                {
+                    MFA_LOG_WARN("Cubemap %s does not have every face", path.c_str());
+                    return nullptr;
+                }
+                faceCount = 6;
+            }
+            DDS_MapLegacyFormat(pixelFormat, layout);
+            if (layout.format == Format::INVALID)
+            {
+                MFA_LOG_WARN("Pixel format of %s is not supported", path.c_str());
+                return nullptr;
+            }
+        }
+
+        layout.depth = isVolume ? std::max(depth, 1u) : 1;
+        auto const sliceCount = arraySize * faceCount;
+        if (sliceCount > UINT16_MAX)
+        {
+            MFA_LOG_WARN("Texture %s has too many slices", path.c_str());
+            return nullptr;
+        }
+        layout.slices = static_cast<uint16_t>(sliceCount);
+        if (IsValidLayout(layout, path) == false)
+        {
+            return nullptr;
+        }
+
+        // Each slice holds its full mip chain, AS::Texture keeps the slices of a level together
+        std::vector<size_t> sliceOffsets(static_cast<size_t>(layout.mipCount) * layout.slices);
+        size_t offset = dataOffset;
+        for (uint16_t slice = 0; slice < layout.slices; ++slice)
+        {
+            for (uint8_t mipLevel = 0; mipLevel < layout.mipCount; ++mipLevel)
+            {
+                sliceOffsets[static_cast<size_t>(mipLevel) * layout.slices + slice] = offset;
+                offset += StoredSliceSize(layout, LevelDimensions(layout, mipLevel));
+            }
+        }
+
+        return BuildTexture(layout, data, fileSize, sliceOffsets, path);
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+    // Identifier, header, index and a level index. Every level is one range of the file that holds its layers, faces
+    // and depth slices in that order, which is the slice order of AS::Texture.
+    std::shared_ptr<AS::Texture> KTX2_Texture(std::string const & path)
+    {
+        auto const file = File::MappedFile::Open(path);
+        if (file == nullptr)
+        {
+            MFA_LOG_WARN("Failed to open %s", path.c_str());
+            return nullptr;
+        }
+
+        auto const * data = file->Ptr();
+        auto const fileSize = file->Len();
+        if (fileSize < KTX2_HeaderSize || std::memcmp(data, KTX2_Identifier, sizeof(KTX2_Identifier)) != 0)
+        {
+            MFA_LOG_WARN("%s is not a ktx2 file", path.c_str());
+            return nullptr;
+        }
+
+        auto const vkFormat = ReadValue<uint32_t>(data, 12);
+        auto const pixelWidth = ReadValue<uint32_t>(data, 20);
+        auto const pixelHeight = ReadValue<uint32_t>(data, 24);
+        auto const pixelDepth = ReadValue<uint32_t>(data, 28);
+        auto const layerCount = std::max(ReadValue<uint32_t>(data, 32), 1u);
+        auto const faceCount = std::max(ReadValue<uint32_t>(data, 36), 1u);
+        // Zero asks the loader to generate the chain, only the base level is stored then
+        auto const levelCount = std::max(ReadValue<uint32_t>(data, 40), 1u);
+        auto const supercompressionScheme = ReadValue<uint32_t>(data, 44);
+
+        if (supercompressionScheme != 0)
+        {
+            MFA_LOG_WARN("Supercompressed ktx2 file %s is not supported", path.c_str());
+            return nullptr;
+        }
+
+        ContainerLayout layout{};
+        KTX2_MapVkFormat(vkFormat, layout);
+        if (layout.format == Format::INVALID)
+        {
+            MFA_LOG_WARN("Vulkan format %u of %s is not supported", vkFormat, path.c_str());
+            return nullptr;
+        }
+        if (levelCount > UINT8_MAX || layerCount * faceCount > UINT16_MAX)
+        {
+            MFA_LOG_WARN("Texture %s has too many levels or slices", path.c_str());
+            return nullptr;
+        }
+        layout.width = pixelWidth;
+        layout.height = std::max(pixelHeight, 1u);
+        layout.depth = std::max(pixelDepth, 1u);
+        layout.slices = static_cast<uint16_t>(layerCount * faceCount);
+        layout.mipCount = static_cast<uint8_t>(levelCount);
+        if (IsValidLayout(layout, path) == false)
+        {
+            return nullptr;
+        }
+
+        if (fileSize < KTX2_HeaderSize + levelCount * KTX2_LevelIndexEntrySize)
+        {
+            MFA_LOG_WARN("Texture %s is truncated", path.c_str());
+            return nullptr;
+        }
+
+        std::vector<size_t> sliceOffsets(static_cast<size_t>(layout.mipCount) * layout.slices);
+        for (uint8_t mipLevel = 0; mipLevel < layout.mipCount; ++mipLevel)
+        {
+            auto const entryOffset = KTX2_HeaderSize + mipLevel * KTX2_LevelIndexEntrySize;
+            auto const byteOffset = ReadValue<uint64_t>(data, entryOffset);
+            auto const byteLength = ReadValue<uint64_t>(data, entryOffset + 8);
+
+            auto const storedSliceSize = StoredSliceSize(layout, LevelDimensions(layout, mipLevel));
+            if (byteLength != storedSliceSize * layout.slices)
+            {
+                MFA_LOG_WARN("Level %d of %s has an unexpected size", static_cast<int>(mipLevel), path.c_str());
+                return nullptr;
+            }
+            for (uint16_t slice = 0; slice < layout.slices; ++slice)
+            {
+                auto const sliceIndex = static_cast<size_t>(mipLevel) * layout.slices + slice;
+                sliceOffsets[sliceIndex] = byteOffset + slice * storedSliceSize;
+            }
+        }
+
+        return BuildTexture(layout, data, fileSize, sliceOffsets, path);
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
+}
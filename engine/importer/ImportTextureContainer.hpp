@@ -0,0 +1,29 @@
+#pragma once
+
+#include "AssetTexture.hpp"
+
+#include <memory>
+#include <string>
+
+// Loads .dds and .ktx2 files that were compressed offline. Their levels are copied from the mapped file into
+// AS::Texture without a decode, only bgr layouts are swizzled to rgba. Array layers and cube faces become slices and
+// the mip chain is kept as stored. BC6H is the only float format that is accepted. Supercompressed ktx2 files and the
+// formats without an AS::Texture counterpart (BC2, BC3, uncompressed float and 16 bit formats) are rejected.
+namespace MFA::Importer
+{
+
+    // True for the extensions ContainerTexture can load
+    [[nodiscard]]
+    bool IsContainerTexture(std::string const & path);
+
+    // Picks the loader from the extension. Returns nullptr and logs a warning when the file can not be used.
+    [[nodiscard]]
+    std::shared_ptr<AS::Texture> ContainerTexture(std::string const & path);
+
+    [[nodiscard]]
+    std::shared_ptr<AS::Texture> DDS_Texture(std::string const & path);
+
+    [[nodiscard]]
+    std::shared_ptr<AS::Texture> KTX2_Texture(std::string const & path);
+
+}
@@ -2,6 +2,8 @@
 
 #include "ThreadPool.hpp"
 
+#include <algorithm>
+#include <deque>
 #include <future>
 #include <omp.h>
 
@@ -30,6 +32,17 @@ namespace MFA
         ~JobSystem()
         {
             MFA_ASSERT(Instance != nullptr);
+            {
+                std::lock_guard lock{mBackgroundMutex};
+                mBackgroundIsAlive = false;
+                // Tasks that have not started are dropped, their futures report a broken promise
+                mBackgroundTasks.clear();
+            }
+            mBackgroundCondition.notify_all();
+            for (auto & thread : mBackgroundThreads)
+            {
+                thread.join();
+            }
             Instance = nullptr;
         }
 
@@ -67,6 +80,93 @@ namespace MFA
             return params->promise.get_future();
         }
 
+        // Splits [0, count) into batches and runs them on the workers while the calling thread handles the first batch.
+        // Blocks until every batch is done. Only the main thread can assign tasks so other threads run the loop inline.
+        void ParallelFor(int const count, int const minBatchSize, std::function<void(int begin, int end)> const & task)
+        {
+            if (count <= 0)
+            {
+                return;
+            }
+
+            int const threadCount = threadPool.NumberOfAvailableThreads();
+            int const batchLimit = std::max(minBatchSize, 1);
+            if (threadCount < 2 || count <= batchLimit || threadPool.IsMainThread() == false)
+            {
+                task(0, count);
+                return;
+            }
+
+            int const batchCount = std::min(threadCount + 1, (count + batchLimit - 1) / batchLimit);
+            int const batchSize = (count + batchCount - 1) / batchCount;
+
+            std::vector<std::future<void>> futures{};
+            futures.reserve(batchCount);
+            for (int begin = batchSize; begin < count; begin += batchSize)
+            {
+                int const end = std::min(begin + batchSize, count);
+                futures.emplace_back(AssignTask([&task, begin, end]()->void
+                {
+                    task(begin, end);
+                }));
+            }
+
+            task(0, std::min(batchSize, count));
+
+            for (auto & future : futures)
+            {
+                future.wait();
+            }
+        }
+
+        // Runs long tasks such as asset loads and texture decodes on a few dedicated threads, so they never sit in the
+        // worker queues in front of the batches of the main thread. Any thread can assign background tasks, but a
+        // background task must not wait for another one since every background thread could be waiting then.
+        // Background threads are not the main thread, so their ParallelFor calls run inline.
+        std::future<void> AssignBackgroundTask(std::function<void()> task)
+        {
+            auto promise = std::make_shared<std::promise<void>>();
+            auto future = promise->get_future();
+            PushBackgroundTask([task = std::move(task), promise]()->void
+            {
+                try
+                {
+                    task();
+                    promise->set_value();
+                }
+                catch (...)
+                {
+                    promise->set_exception(std::current_exception());
+                }
+            });
+            return future;
+        }
+
+        template<typename T>
+        std::future<T> AssignBackgroundTask(std::function<T()> task)
+        {
+            auto promise = std::make_shared<std::promise<T>>();
+            auto future = promise->get_future();
+            PushBackgroundTask([task = std::move(task), promise]()->void
+            {
+                try
+                {
+                    promise->set_value(task());
+                }
+                catch (...)
+                {
+                    promise->set_exception(std::current_exception());
+                }
+            });
+            return future;
+        }
+
+        [[nodiscard]]
+        static bool IsBackgroundThread() noexcept
+        {
+            return tIsBackgroundThread;
+        }
+
         [[nodiscard]]
         auto NumberOfAvailableThreads() const
         {
@@ -83,8 +183,58 @@ namespace MFA
 
     private:
 
+        void PushBackgroundTask(std::function<void()> task)
+        {
+            {
+                std::lock_guard lock{mBackgroundMutex};
+                mBackgroundTasks.emplace_back(std::move(task));
+                if (mBackgroundThreads.empty())
+                {// Started on first use, most runs never load anything in the background
+                    auto const threadCount = std::max(2u, std::thread::hardware_concurrency() / 4);
+                    for (uint32_t i = 0; i < threadCount; ++i)
+                    {
+                        mBackgroundThreads.emplace_back([this]()->void
+                        {
+                            BackgroundLoop();
+                        });
+                    }
+                }
+            }
+            mBackgroundCondition.notify_one();
+        }
+
+        void BackgroundLoop()
+        {
+            tIsBackgroundThread = true;
+            std::unique_lock lock{mBackgroundMutex};
+            while (true)
+            {
+                mBackgroundCondition.wait(lock, [this]()->bool
+                {
+                    return mBackgroundTasks.empty() == false || mBackgroundIsAlive == false;
+                });
+                if (mBackgroundIsAlive == false)
+                {
+                    return;
+                }
+                auto task = std::move(mBackgroundTasks.front());
+                mBackgroundTasks.pop_front();
+                lock.unlock();
+                task();
+                lock.lock();
+            }
+        }
+
         ThreadPool threadPool{};
 
+        inline static thread_local bool tIsBackgroundThread = false;
+
+        std::vector<std::thread> mBackgroundThreads{};
+        std::mutex mBackgroundMutex{};
+        std::condition_variable mBackgroundCondition{};
+        std::deque<std::function<void()>> mBackgroundTasks{};
+        bool mBackgroundIsAlive = true;
+
     };
 }
 
@@ -393,6 +393,7 @@ namespace MFA
 
 	    recordState.frameIndex = _currentFrame;
 	    recordState.isValid = true;
+	    ++_frameNumber;
 	    ++_currentFrame;
         if (_currentFrame >= _maxFramePerFlight)
         {
@@ -539,6 +540,13 @@ namespace MFA
 
     //-------------------------------------------------------------------------------------------------
 
+    uint64_t LogicalDevice::GetFrameNumber() const noexcept
+    {
+	    return _frameNumber;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
     uint32_t LogicalDevice::GetGraphicQueueFamily() const noexcept
     {
 	    return _graphicQueueFamily;
@@ -83,6 +83,12 @@ namespace MFA
         [[nodiscard]]
         uint32_t GetMaxFramePerFlight() const noexcept;
 
+        // Number of record states acquired so far. Acquiring one waits for the frame that was acquired
+        // GetMaxFramePerFlight frames earlier, so the frames before GetFrameNumber() - GetMaxFramePerFlight()
+        // are done.
+        [[nodiscard]]
+        uint64_t GetFrameNumber() const noexcept;
+
         [[nodiscard]]
         uint32_t GetGraphicQueueFamily() const noexcept;
 
@@ -222,6 +228,7 @@ namespace MFA
         uint32_t _swapChainImageCount {};
         uint32_t _maxFramePerFlight {};
         uint32_t _currentFrame{};
+        uint64_t _frameNumber{};
 
         uint32_t _graphicQueueFamily {};
         uint32_t _computeQueueFamily {};
@@ -98,7 +98,8 @@ namespace MFA::RenderBackend
         VkCommandBuffer commandBuffer,
         VkBuffer buffer,
         VkImage image,
-        AS::Texture const& cpuTexture
+        AS::Texture const& cpuTexture,
+        uint8_t firstMipLevel
     );
 
     //-------------------------------------------------------------------------------------------------
@@ -1975,6 +1976,19 @@ namespace MFA::RenderBackend
 
     //-------------------------------------------------------------------------------------------------
 
+    bool IsFenceSignaled(VkDevice device, VkFence fence)
+    {
+        auto const result = vkGetFenceStatus(device, fence);
+        if (result == VK_NOT_READY)
+        {
+            return false;
+        }
+        VK_Check(result);
+        return true;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+
     void BeginCommandBuffer(
         VkCommandBuffer commandBuffer,
         VkCommandBufferBeginInfo const & beginInfo
@@ -3026,7 +3040,8 @@ namespace MFA::RenderBackend
         VkCommandBuffer commandBuffer,
         VkBuffer buffer,
         VkImage image,
-        AS::Texture const& cpuTexture
+        AS::Texture const& cpuTexture,
+        uint8_t const firstMipLevel
     )
     {
         MFA_ASSERT(device != nullptr);
@@ -3034,12 +3049,15 @@ namespace MFA::RenderBackend
         MFA_ASSERT(buffer != VK_NULL_HANDLE);
         MFA_ASSERT(image != VK_NULL_HANDLE);
         MFA_ASSERT(cpuTexture.isValid());
+        MFA_ASSERT(firstMipLevel < cpuTexture.GetMipCount());
         MFA_ASSERT(
             cpuTexture.GetMipmap(cpuTexture.GetMipCount() - 1).offset +
             cpuTexture.GetMipmap(cpuTexture.GetMipCount() - 1).size == cpuTexture.GetBuffer()->Len()
         );
 
-        auto const mipCount = cpuTexture.GetMipCount();
+        // The buffer starts at the first uploaded level
+        auto const bufferStart = cpuTexture.GetMipmap(firstMipLevel).offset;
+        auto const mipCount = cpuTexture.GetMipCount() - firstMipLevel;
         auto const slices = cpuTexture.GetSlices();
         auto const regionCount = mipCount * slices;
         auto const regionsBlob = Memory::AllocSize(regionCount * sizeof(VkBufferImageCopy));
@@ -3048,15 +3066,18 @@ namespace MFA::RenderBackend
         {
             for (uint8_t mipLevel = 0; mipLevel < mipCount; mipLevel++)
             {
-                auto const& mipInfo = cpuTexture.GetMipmap(mipLevel);
-                auto& region = regionsArray[mipLevel];
+                auto const cpuMipLevel = static_cast<uint8_t>(firstMipLevel + mipLevel);
+                auto const& mipInfo = cpuTexture.GetMipmap(cpuMipLevel);
+                auto& region = regionsArray[sliceIndex * mipCount + mipLevel];
                 region.imageExtent.width = mipInfo.dimension.width;
                 region.imageExtent.height = mipInfo.dimension.height;
                 region.imageExtent.depth = mipInfo.dimension.depth;
                 region.imageOffset.x = 0;
                 region.imageOffset.y = 0;
                 region.imageOffset.z = 0;
-                region.bufferOffset = static_cast<uint32_t>(cpuTexture.mipOffsetInBytes(mipLevel, sliceIndex));
+                region.bufferOffset = static_cast<uint32_t>(
+                    cpuTexture.mipOffsetInBytes(cpuMipLevel, sliceIndex) - bufferStart
+                );
                 region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
                 region.imageSubresource.mipLevel = mipLevel;
                 region.imageSubresource.baseArrayLayer = sliceIndex;
@@ -3111,6 +3132,14 @@ namespace MFA::RenderBackend
         case Format::BC7_UNorm_sRGB_RGB:
         case Format::BC7_UNorm_sRGB_RGBA:
             return VkFormat::VK_FORMAT_BC7_SRGB_BLOCK;
+        case Format::BC1_UNorm_Linear_RGB:
+            return VkFormat::VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+        case Format::BC1_UNorm_sRGB_RGB:
+            return VkFormat::VK_FORMAT_BC1_RGB_SRGB_BLOCK;
+        case Format::BC1_UNorm_Linear_RGBA:
+            return VkFormat::VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+        case Format::BC1_UNorm_sRGB_RGBA:
+            return VkFormat::VK_FORMAT_BC1_RGBA_SRGB_BLOCK;
         default:
             MFA_LOG_WARN("Format not found");
         }
@@ -3123,33 +3152,40 @@ namespace MFA::RenderBackend
         AS::Texture const& cpuTexture,
         VkDevice device,
         VkPhysicalDevice physicalDevice,
-        VkCommandBuffer commandBuffer
+        VkCommandBuffer commandBuffer,
+        uint8_t const firstMipLevel
     )
     {
         MFA_ASSERT(device != nullptr);
         MFA_ASSERT(physicalDevice != nullptr);
         MFA_ASSERT(commandBuffer != VK_NULL_HANDLE);
         MFA_ASSERT(cpuTexture.isValid());
+        MFA_ASSERT(firstMipLevel < cpuTexture.GetMipCount());
 
-        if (cpuTexture.isValid())
+        if (cpuTexture.isValid() && firstMipLevel < cpuTexture.GetMipCount())
         {
             auto const format = cpuTexture.GetFormat();
-            auto const mipCount = cpuTexture.GetMipCount();
+            auto const mipCount = static_cast<uint8_t>(cpuTexture.GetMipCount() - firstMipLevel);
             auto const sliceCount = cpuTexture.GetSlices();
-            auto const& largestMipmapInfo = cpuTexture.GetMipmap(0);
+            auto const& largestMipmapInfo = cpuTexture.GetMipmap(firstMipLevel);
             auto const buffer = cpuTexture.GetBuffer();
             MFA_ASSERT(buffer != nullptr && buffer->IsValid() == true);
+            // Levels are stored from the largest to the smallest, so the uploaded ones are the tail of the buffer
+            auto const uploadedData = Alias(
+                buffer->Ptr() + largestMipmapInfo.offset,
+                buffer->Len() - largestMipmapInfo.offset
+            );
             // Create upload buffer
             auto const uploadBufferGroup = CreateBuffer(    // TODO: We can cache this buffer
                 device,
                 physicalDevice,
-                buffer->Len(),
+                uploadedData.Len(),
                 VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
             );
 
             // Map texture data to buffer
-            CopyDataToHostVisibleBuffer(device, uploadBufferGroup->memory, *buffer);
+            CopyDataToHostVisibleBuffer(device, uploadBufferGroup->memory, uploadedData);
 
             auto const vulkan_format = ConvertCpuTextureFormatToGpu(format);
 
@@ -3183,7 +3219,8 @@ namespace MFA::RenderBackend
                 commandBuffer,
                 uploadBufferGroup->buffer,
                 imageGroup->image,
-                cpuTexture
+                cpuTexture,
+                firstMipLevel
             );
 
             TransferImageLayout(
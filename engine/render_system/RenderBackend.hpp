@@ -355,6 +355,10 @@ namespace MFA::RenderBackend
 
     void WaitForFence(VkDevice device, std::vector<VkFence> const & fences);
 
+    // Does not wait, true once the work that signals the fence has finished
+    [[nodiscard]]
+    bool IsFenceSignaled(VkDevice device, VkFence fence);
+
     void BeginCommandBuffer(
         VkCommandBuffer commandBuffer,
         VkCommandBufferBeginInfo const & beginInfo
@@ -663,12 +667,14 @@ namespace MFA::RenderBackend
     void DestroySampler(VkDevice device, RT::SamplerGroup const& sampler);
 
     using CreateTextureResult = std::tuple<std::shared_ptr<RT::GpuTexture>, std::shared_ptr<RT::BufferAndMemory>>;
+    // Levels before firstMipLevel are not uploaded, the image starts at that level and only holds the smaller ones
     [[nodiscard]]
     CreateTextureResult CreateTexture(
         AS::Texture const& cpuTexture,
         VkDevice device,
         VkPhysicalDevice physicalDevice,
-        VkCommandBuffer commandBuffer
+        VkCommandBuffer commandBuffer,
+        uint8_t firstMipLevel = 0
     );
 
     void DestroyTexture(VkDevice device, RT::GpuTexture& gpuTexture);
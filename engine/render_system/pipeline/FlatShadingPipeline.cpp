@@ -37,6 +37,21 @@ namespace MFA
 
 	//-------------------------------------------------------------------------------------------------
 
+	VertexLayout const & FlatShadingPipeline::GetVertexLayout()
+	{
+		static VertexLayout const vertexLayout = []()->VertexLayout
+		{
+			VertexLayout layout{};
+			layout.Add(VertexLayout::Attribute::Position, VertexLayout::Encoding::Unorm16x4);
+			layout.Add(VertexLayout::Attribute::BaseColorUV, VertexLayout::Encoding::Float16x2);
+			layout.Add(VertexLayout::Attribute::Normal, VertexLayout::Encoding::Octahedral16x2);
+			return layout;
+		}();
+		return vertexLayout;
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
 	FlatShadingPipeline::~FlatShadingPipeline()
 	{
 		mPipeline = nullptr;
@@ -89,14 +104,32 @@ namespace MFA
 		RT::GpuTexture const & texture
 	) const
 	{
+		auto const maxFramesPerFlight = LogicalDevice::Instance->GetMaxFramePerFlight();
 		auto perGeometryDescriptorSet = RB::CreateDescriptorSet(
 			LogicalDevice::Instance->GetVkDevice(),
 			mDescriptorPool->descriptorPool,
 			mPerGeometryDescriptorLayout->descriptorSetLayout,
-			1
+			maxFramesPerFlight
 		);
 
-		auto const& descriptorSet = perGeometryDescriptorSet.descriptorSets[0];
+		for (uint32_t frameIndex = 0; frameIndex < maxFramesPerFlight; ++frameIndex)
+		{
+			UpdatePerGeometryDescriptorSetGroup(perGeometryDescriptorSet, frameIndex, material, texture);
+		}
+
+		return perGeometryDescriptorSet;
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	void FlatShadingPipeline::UpdatePerGeometryDescriptorSetGroup(
+		RT::DescriptorSetGroup const & descriptorSetGroup,
+		uint32_t const frameIndex,
+		RT::BufferAndMemory const & material,
+		RT::GpuTexture const & texture
+	) const
+	{
+		auto const& descriptorSet = descriptorSetGroup.descriptorSets[frameIndex];
 		MFA_ASSERT(descriptorSet != VK_NULL_HANDLE);
 
 		DescriptorSetSchema descriptorSetSchema{ descriptorSet };
@@ -119,8 +152,6 @@ namespace MFA
 		descriptorSetSchema.AddImage(&texturesSamplerInfo, 1);
 
 		descriptorSetSchema.UpdateDescriptorSets();
-
-		return perGeometryDescriptorSet;
 	}
 
 	//-------------------------------------------------------------------------------------------------
@@ -189,38 +220,32 @@ namespace MFA
 	void FlatShadingPipeline::CreatePipeline()
 	{
 		// Vertex shader
-		{
-			bool success = Importer::CompileShaderToSPV(
-				Path::Instance->Get("engine/shaders/flat_shading_pipeline/FlatShadingPipeline.vert.hlsl"),
-				Path::Instance->Get("engine/shaders/flat_shading_pipeline/FlatShadingPipeline.vert.spv"),
-				"vert"
-			);
-			MFA_ASSERT(success == true);
-		}
-		auto cpuVertexShader = Importer::ShaderFromSPV(
+		auto cpuVertexShader = Importer::ShaderFromHLSL(
+			Path::Instance->Get("engine/shaders/flat_shading_pipeline/FlatShadingPipeline.vert.hlsl"),
 			Path::Instance->Get("engine/shaders/flat_shading_pipeline/FlatShadingPipeline.vert.spv"),
 			VK_SHADER_STAGE_VERTEX_BIT,
 			"main"
 		);
+		if (cpuVertexShader == nullptr)
+		{
+			MFA_CRASH("Failed to load shader");
+		}
 		auto gpuVertexShader = RB::CreateShader(
 			LogicalDevice::Instance->GetVkDevice(),
 			cpuVertexShader
 		);
 
 		// Fragment shader
-		{
-			bool success = Importer::CompileShaderToSPV(
-				Path::Instance->Get("engine/shaders/flat_shading_pipeline/FlatShadingPipeline.frag.hlsl"),
-				Path::Instance->Get("engine/shaders/flat_shading_pipeline/FlatShadingPipeline.frag.spv"),
-				"frag"
-			);
-			MFA_ASSERT(success == true);
-		}
-		auto cpuFragmentShader = Importer::ShaderFromSPV(
+		auto cpuFragmentShader = Importer::ShaderFromHLSL(
+			Path::Instance->Get("engine/shaders/flat_shading_pipeline/FlatShadingPipeline.frag.hlsl"),
 			Path::Instance->Get("engine/shaders/flat_shading_pipeline/FlatShadingPipeline.frag.spv"),
 			VK_SHADER_STAGE_FRAGMENT_BIT,
 			"main"
 		);
+		if (cpuFragmentShader == nullptr)
+		{
+			MFA_CRASH("Failed to load shader");
+		}
 		auto gpuFragmentShader = RB::CreateShader(
 			LogicalDevice::Instance->GetVkDevice(),
 			cpuFragmentShader
@@ -228,35 +253,9 @@ namespace MFA
 
 		std::vector<RT::GpuShader const*> shaders{ gpuVertexShader.get(), gpuFragmentShader.get() };
 
-		VkVertexInputBindingDescription const bindingDescription{
-			.binding = 0,
-			.stride = sizeof(Vertex),
-			.inputRate = VK_VERTEX_INPUT_RATE_VERTEX,
-		};
-
-		std::vector<VkVertexInputAttributeDescription> inputAttributeDescriptions{};
-		// Position
-		inputAttributeDescriptions.emplace_back(VkVertexInputAttributeDescription{
-			.location = static_cast<uint32_t>(inputAttributeDescriptions.size()),
-			.binding = 0,
-			.format = VK_FORMAT_R32G32B32_SFLOAT,
-			.offset = offsetof(Vertex, position),
-		});
-		// UV
-		inputAttributeDescriptions.emplace_back(VkVertexInputAttributeDescription{
-			.location = static_cast<uint32_t>(inputAttributeDescriptions.size()),
-			.binding = 0,
-			.format = VK_FORMAT_R32G32_SFLOAT,
-			.offset = offsetof(Vertex, baseColorUV),
-		});
-		// Normal
-		inputAttributeDescriptions.emplace_back(VkVertexInputAttributeDescription{
-			.location = static_cast<uint32_t>(inputAttributeDescriptions.size()),
-			.binding = 0,
-			.format = VK_FORMAT_R32G32B32_SFLOAT,
-			.offset = offsetof(Vertex, normal),
-		});
-
+		auto const & vertexLayout = GetVertexLayout();
+		auto const bindingDescriptions = vertexLayout.GetBindingDescriptions();
+		auto inputAttributeDescriptions = vertexLayout.GetAttributeDescriptions();
 
 		RB::CreateGraphicPipelineOptions pipelineOptions{};
 		pipelineOptions.useStaticViewportAndScissor = false;
@@ -295,8 +294,8 @@ namespace MFA
 			LogicalDevice::Instance->GetVkDevice(),
 			static_cast<uint8_t>(shaders.size()),
 			shaders.data(),
-			1,
-			&bindingDescription,
+			static_cast<uint32_t>(bindingDescriptions.size()),
+			bindingDescriptions.data(),
 			static_cast<uint8_t>(inputAttributeDescriptions.size()),
 			inputAttributeDescriptions.data(),
 			surfaceCapabilities.currentExtent,
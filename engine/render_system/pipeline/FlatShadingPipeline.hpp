@@ -1,6 +1,7 @@
 #pragma once
 
 #include "render_pass/DisplayRenderPass.hpp"
+#include "utils/VertexLayout.hpp"
 
 #include <memory>
 #include <glm/glm.hpp>
@@ -11,12 +12,9 @@ namespace MFA
     {
     public:
 
-        struct Vertex
-        {
-            glm::vec3 position{};
-            glm::vec2 baseColorUV{};
-            glm::vec3 normal{};
-        };
+        // Position, base color uv and normal in 16 bytes
+        [[nodiscard]]
+        static VertexLayout const & GetVertexLayout();
 
         struct ViewProjection
         {
@@ -26,6 +24,8 @@ namespace MFA
         struct PushConstants
         {
             glm::mat4 model;
+            glm::vec4 positionMin;                  // Decodes the quantized positions
+            glm::vec4 positionExtent;
         };
 
         struct Material
@@ -39,7 +39,7 @@ namespace MFA
 
         struct Params
         {
-            int maxSets = 1000;
+            int maxSets = 1000;             // Every geometry takes one set per frame in flight
             VkCullModeFlags cullModeFlags = VK_CULL_MODE_BACK_BIT;
             VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
             VkPolygonMode polygonMode = VK_POLYGON_MODE_FILL;
@@ -66,12 +66,21 @@ namespace MFA
 
         void SetPushConstants(RT::CommandRecordState& recordState, PushConstants pushConstants) const;
 
+        // One set per frame in flight, bind it with the frame index of the record state
         [[nodiscard]]
         RT::DescriptorSetGroup CreatePerGeometryDescriptorSetGroup(
             RT::BufferAndMemory const& material,
             RT::GpuTexture const& texture
         ) const;
 
+        // Rewrites the set of the frame, the frame must not be in use by a command buffer that is still executing
+        void UpdatePerGeometryDescriptorSetGroup(
+            RT::DescriptorSetGroup const& descriptorSetGroup,
+            uint32_t frameIndex,
+            RT::BufferAndMemory const& material,
+            RT::GpuTexture const& texture
+        ) const;
+
     private:
 
         void CreatePerPipelineDescriptorSetLayout();
@@ -111,38 +111,32 @@ RT::DescriptorSetGroup TextOverlayPipeline::CreateDescriptorSet(RT::GpuTexture c
 void TextOverlayPipeline::CreatePipeline()
 {
 	// Vertex shader
-	{
-		bool success = Importer::CompileShaderToSPV(
-			Path::Instance->Get("engine/shaders/text_overlay_pipeline/TextOverlay.vert.hlsl"),
-			Path::Instance->Get("engine/shaders/text_overlay_pipeline/TextOverlay.vert.spv"),
-			"vert"
-		);
-		MFA_ASSERT(success == true);
-	}
-	auto cpuVertexShader = Importer::ShaderFromSPV(
+	auto cpuVertexShader = Importer::ShaderFromHLSL(
+		Path::Instance->Get("engine/shaders/text_overlay_pipeline/TextOverlay.vert.hlsl"),
 		Path::Instance->Get("engine/shaders/text_overlay_pipeline/TextOverlay.vert.spv"),
 		VK_SHADER_STAGE_VERTEX_BIT,
 		"main"
 	);
+	if (cpuVertexShader == nullptr)
+	{
+		MFA_CRASH("Failed to load shader");
+	}
 	auto gpuVertexShader = RB::CreateShader(
 		LogicalDevice::Instance->GetVkDevice(),
 		cpuVertexShader
 	);
 
 	// Fragment shader
-	{
-		bool success = Importer::CompileShaderToSPV(
-			Path::Instance->Get("engine/shaders/text_overlay_pipeline/TextOverlay.frag.hlsl"),
-			Path::Instance->Get("engine/shaders/text_overlay_pipeline/TextOverlay.frag.spv"),
-			"frag"
-		);
-		MFA_ASSERT(success == true);
-	}
-	auto cpuFragmentShader = Importer::ShaderFromSPV(
+	auto cpuFragmentShader = Importer::ShaderFromHLSL(
+		Path::Instance->Get("engine/shaders/text_overlay_pipeline/TextOverlay.frag.hlsl"),
 		Path::Instance->Get("engine/shaders/text_overlay_pipeline/TextOverlay.frag.spv"),
 		VK_SHADER_STAGE_FRAGMENT_BIT,
 		"main"
 	);
+	if (cpuFragmentShader == nullptr)
+	{
+		MFA_CRASH("Failed to load shader");
+	}
 	auto gpuFragmentShader = RB::CreateShader(
 		LogicalDevice::Instance->GetVkDevice(),
 		cpuFragmentShader
@@ -0,0 +1,243 @@
+#include "MeshComponents.hpp"
+
+#include "MeshRenderer.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace MFA::MeshSystems
+{
+
+	//-------------------------------------------------------------------------------------------------
+
+	Entity CreateMeshEntity(World & world, MeshRenderer & renderer, Transform const & transform)
+	{
+		return world.CreateEntity(
+			Transform(transform),
+			MeshComponent{.renderer = &renderer},
+			BoundsComponent{.localBounds = renderer.GetLocalBounds()}
+		);
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	Transform & OverrideNode(World & world, Entity const entity, int const nodeIndex)
+	{
+		auto const * meshComponent = world.GetComponent<MeshComponent>(entity);
+		MFA_ASSERT(meshComponent != nullptr && meshComponent->renderer != nullptr);
+		auto const & meshData = meshComponent->renderer->GetMeshData();
+		MFA_ASSERT(nodeIndex >= 0 && nodeIndex < static_cast<int>(meshData->nodes.size()));
+
+		auto * overrides = world.GetComponent<NodeOverridesComponent>(entity);
+		if (overrides == nullptr)
+		{
+			NodeOverridesComponent component{};
+			component.nodeCache = NodeTransformCache(meshData);
+			overrides = &world.AddComponent(entity, std::move(component));
+		}
+
+		auto const findResult = std::lower_bound(overrides->nodes.begin(), overrides->nodes.end(), static_cast<uint32_t>(nodeIndex));
+		auto const slot = findResult - overrides->nodes.begin();
+		if (findResult == overrides->nodes.end() || *findResult != static_cast<uint32_t>(nodeIndex))
+		{
+			overrides->nodes.insert(findResult, static_cast<uint32_t>(nodeIndex));
+			overrides->transforms.insert(overrides->transforms.begin() + slot, meshData->nodes[nodeIndex].transform);
+			overrides->nodeCache.SetOverrides(overrides->nodes);
+		}
+		return overrides->transforms[slot];
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	void ResetNode(World & world, Entity const entity, int const nodeIndex)
+	{
+		auto * overrides = world.GetComponent<NodeOverridesComponent>(entity);
+		if (overrides == nullptr)
+		{
+			return;
+		}
+
+		auto const findResult = std::lower_bound(overrides->nodes.begin(), overrides->nodes.end(), static_cast<uint32_t>(nodeIndex));
+		if (findResult == overrides->nodes.end() || *findResult != static_cast<uint32_t>(nodeIndex))
+		{
+			return;
+		}
+
+		auto const slot = findResult - overrides->nodes.begin();
+		overrides->nodes.erase(findResult);
+		overrides->transforms.erase(overrides->transforms.begin() + slot);
+
+		if (overrides->nodes.empty())
+		{
+			world.RemoveComponent<NodeOverridesComponent>(entity);
+		}
+		else
+		{
+			overrides->nodeCache.SetOverrides(overrides->nodes);
+		}
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	SystemAccess UpdateBoundsAccess()
+	{
+		return SystemAccess::Of<Transform, BoundsComponent>();
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	void UpdateBounds(World & world)
+	{
+		world.ParallelForEach<Transform, BoundsComponent>([](Entity, Transform & transform, BoundsComponent & bounds)->void
+		{
+			auto const version = transform.GetVersion();
+			if (bounds.isValid && bounds.transformVersion == version)
+			{
+				return;
+			}
+			bounds.worldBounds = bounds.localBounds.IsValid()
+				? bounds.localBounds.Transform(transform.GetMatrix())
+				: AABB::FromCenterAndExtents(transform.Getposition(), glm::vec3{});
+			bounds.transformVersion = version;
+			bounds.isValid = true;
+		});
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	SystemAccess UpdateNodeCachesAccess()
+	{
+		return SystemAccess::Of<MeshComponent, NodeOverridesComponent>();
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	void UpdateNodeCaches(World & world)
+	{
+		std::unordered_set<MeshRenderer *> renderers{};
+		world.ForEach<MeshComponent const, NodeOverridesComponent const>([&renderers](
+			Entity,
+			MeshComponent const & mesh,
+			NodeOverridesComponent const &
+		)->void
+		{
+			renderers.emplace(mesh.renderer);
+		});
+		for (auto * renderer : renderers)
+		{
+			renderer->UpdateRestPose();
+		}
+
+		world.ParallelForEach<MeshComponent const, NodeOverridesComponent>([](
+			Entity,
+			MeshComponent const & mesh,
+			NodeOverridesComponent & overrides
+		)->void
+		{
+			overrides.nodeCache.Update(mesh.renderer->GetRestPose(), overrides.transforms);
+		});
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	void SyncBVH(World & world, BVH & bvh)
+	{
+		world.ForEach<BoundsComponent>([&bvh](Entity const entity, BoundsComponent & bounds)->void
+		{
+			MFA_ASSERT(bounds.isValid);
+			if (bounds.proxyId == BVH::InvalidProxy)
+			{
+				bounds.proxyId = bvh.Insert(bounds.worldBounds, reinterpret_cast<void *>(static_cast<uintptr_t>(entity.index)));
+				bounds.proxyTransformVersion = bounds.transformVersion;
+				return;
+			}
+			if (bounds.proxyTransformVersion != bounds.transformVersion)
+			{
+				bvh.Update(bounds.proxyId, bounds.worldBounds);
+				bounds.proxyTransformVersion = bounds.transformVersion;
+			}
+		});
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	void RemoveFromBVH(World & world, Entity const entity, BVH & bvh)
+	{
+		auto * bounds = world.GetComponent<BoundsComponent>(entity);
+		if (bounds != nullptr && bounds->proxyId != BVH::InvalidProxy)
+		{
+			bvh.Remove(bounds->proxyId);
+			bounds->proxyId = BVH::InvalidProxy;
+		}
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	void CullWithBVH(World & world, BVH const & bvh, Frustum const & frustum)
+	{
+		// The tree skips every subtree outside of the frustum, so only the visible proxies are visited
+		std::vector<bool> isProxyVisible{};
+		bvh.Query(frustum, [&isProxyVisible](BVH::ProxyId const proxyId)->bool
+		{
+			if (static_cast<size_t>(proxyId) >= isProxyVisible.size())
+			{
+				isProxyVisible.resize(proxyId + 1, false);
+			}
+			isProxyVisible[proxyId] = true;
+			return true;
+		});
+
+		world.ParallelForEach<BoundsComponent>([&isProxyVisible](Entity, BoundsComponent & bounds)->void
+		{
+			bounds.isVisible = bounds.proxyId == BVH::InvalidProxy || (
+				static_cast<size_t>(bounds.proxyId) < isProxyVisible.size() && isProxyVisible[bounds.proxyId]
+			);
+		});
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	void Render(World & world, RT::CommandRecordState & recordState)
+	{
+		std::unordered_map<MeshRenderer *, std::vector<MeshRenderer::DrawItem>> groups{};
+
+		world.ForEach<Transform, MeshComponent const, BoundsComponent const>(
+			[&groups](Entity, Transform & transform, MeshComponent const & mesh, BoundsComponent const & bounds)->void
+			{
+				if (bounds.isVisible == false)
+				{
+					return;
+				}
+				groups[mesh.renderer].emplace_back(MeshRenderer::DrawItem{.model = transform.GetMatrix()});
+			},
+			GetComponentMask<NodeOverridesComponent>()
+		);
+
+		world.ForEach<Transform, MeshComponent const, BoundsComponent const, NodeOverridesComponent const>([&groups](
+			Entity,
+			Transform & transform,
+			MeshComponent const & mesh,
+			BoundsComponent const & bounds,
+			NodeOverridesComponent const & overrides
+		)->void
+		{
+			if (bounds.isVisible == false)
+			{
+				return;
+			}
+			groups[mesh.renderer].emplace_back(MeshRenderer::DrawItem{
+				.model = transform.GetMatrix(),
+				.nodeCache = &overrides.nodeCache
+			});
+		});
+
+		for (auto & [renderer, items] : groups)
+		{
+			renderer->Render(recordState, items);
+		}
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "BedrockBounds.hpp"
+#include "BVH.hpp"
+#include "NodeTransformCache.hpp"
+#include "RenderTypes.hpp"
+#include "SystemScheduler.hpp"
+#include "Transform.hpp"
+#include "World.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace MFA
+{
+
+    class MeshRenderer;
+
+    // Components that describe a mesh instance inside a World. An entity needs Transform, MeshComponent and
+    // BoundsComponent to be drawn, CreateMeshEntity adds all three.
+
+    struct MeshComponent
+    {
+        MeshRenderer * renderer = nullptr;
+    };
+
+    // Optional. Entities without it are drawn with the rest pose that is shared between all instances of the renderer.
+    // Only the overridden nodes are stored, sorted by node index.
+    struct NodeOverridesComponent
+    {
+        std::vector<uint32_t> nodes{};
+        std::vector<Transform> transforms{};
+        NodeTransformCache nodeCache{};
+    };
+
+    struct BoundsComponent
+    {
+        AABB localBounds{};
+        AABB worldBounds{};
+        uint32_t transformVersion = 0;
+        bool isValid = false;
+        BVH::ProxyId proxyId = BVH::InvalidProxy;
+        uint32_t proxyTransformVersion = 0;
+        bool isVisible = true;                  // Result of the last CullWithBVH
+    };
+
+    namespace MeshSystems
+    {
+
+        Entity CreateMeshEntity(World & world, MeshRenderer & renderer, Transform const & transform);
+
+        // Local transform of the node for this entity only. The first call copies the rest pose transform.
+        // The reference is invalidated by structural changes and by overriding another node of the entity.
+        Transform & OverrideNode(World & world, Entity entity, int nodeIndex);
+
+        // Returns the node to the shared rest pose. The overrides component is removed with the last override.
+        void ResetNode(World & world, Entity entity, int nodeIndex);
+
+        // Writes Transform because GetMatrix updates the cached matrix
+        [[nodiscard]]
+        SystemAccess UpdateBoundsAccess();
+
+        void UpdateBounds(World & world);
+
+        // Writes MeshComponent because the rest pose of its renderer is updated
+        [[nodiscard]]
+        SystemAccess UpdateNodeCachesAccess();
+
+        // Updates the rest pose of the renderers that have overridden entities first, then the entity caches in parallel
+        void UpdateNodeCaches(World & world);
+
+        // Has to run on the thread that owns the BVH
+        void SyncBVH(World & world, BVH & bvh);
+
+        // Removes the proxy of the entity from the BVH. Call it before destroying the entity.
+        void RemoveFromBVH(World & world, Entity entity, BVH & bvh);
+
+        // Marks the entities whose proxy overlaps the frustum as visible and the rest as hidden. Has to run after
+        // SyncBVH, entities without a proxy stay visible.
+        void CullWithBVH(World & world, BVH const & bvh, Frustum const & frustum);
+
+        // Groups the visible entities by renderer and draws each group with a single pipeline bind
+        void Render(World & world, RT::CommandRecordState & recordState);
+
+    }
+
+}
@@ -1,7 +1,11 @@
 #include "MeshRenderer.hpp"
 
 #include "LogicalDevice.hpp"
-#include "MeshInstance.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
 
 namespace MFA
 {
@@ -13,11 +17,14 @@ namespace MFA
 		std::shared_ptr<AS::GLTF::Model> const& model,
 		std::shared_ptr<RT::GpuTexture> errorTexture,
 		bool hasOverrideColor,
-		glm::vec4 overrideColor
+		glm::vec4 overrideColor,
+		std::shared_ptr<TextureStreamer> textureStreamer
 	)
 		: _pipeline(std::move(pipeline))
 		, _meshData(model->mesh->GetMeshData())
+		, _restPose(_meshData)
 		, _errorTexture(std::move(errorTexture))
+		, _textureStreamer(std::move(textureStreamer))
 		, _hasOverrideColor(hasOverrideColor)
 		, _overrideColor(overrideColor)
 	{
@@ -49,6 +56,10 @@ namespace MFA
 
 		_indexCount = model->mesh->GetIndexCount();
 		_indices = model->mesh->GetIndexData();
+
+		ComputeLocalBounds();
+
+		ComputeTextureDensities();
 		
 		RB::EndAndSubmitSingleTimeCommand(
 			device->GetVkDevice(),
@@ -60,115 +71,139 @@ namespace MFA
 
 	//-------------------------------------------------------------------------------------------------
 
+	MeshRenderer::~MeshRenderer()
+	{
+		auto const * device = LogicalDevice::Instance;
+		for (auto & upload : _pendingUploads)
+		{
+			RB::WaitForFence(device->GetVkDevice(), {upload.fence});
+			FreeUpload(upload);
+		}
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
 	void MeshRenderer::Render(RT::CommandRecordState& recordState, std::vector<glm::mat4> const& models)
 	{
-		_pipeline->BindPipeline(recordState);
+		ReleaseFinishedWork();
 
-		RB::BindIndexBuffer(
-			recordState,
-			*_indicesBuffer,
-			0,
-			VK_INDEX_TYPE_UINT32
-		);
+		UpdateDescriptorSets(recordState.frameIndex);
+
+		BindBuffers(recordState);
+
+		UpdateRestPose();
 
-		RB::BindVertexBuffer(
-			recordState,
-			*_verticesBuffer,
-			0,
-			0
-		);
 		for (auto const& model : models)
 		{
-			auto const & rootNodes = _meshData->rootNodes;
-			auto & nodes = _meshData->nodes;
-			for (auto & rootNode : rootNodes)
-			{
-				auto & node = nodes[rootNode];
-				DrawNode(
-					recordState, 
-					node, 
-					model
-				);
-			}
+			DrawNodes(recordState, _restPose, model);
 		}
 	}
 
 	//-------------------------------------------------------------------------------------------------
 
-	void MeshRenderer::Render(RT::CommandRecordState& recordState, std::vector<MeshInstance*> const& instances) const
+	void MeshRenderer::Render(RT::CommandRecordState& recordState, std::vector<DrawItem> const& items)
 	{
-		_pipeline->BindPipeline(recordState);
+		ReleaseFinishedWork();
 
-		RB::BindIndexBuffer(
-			recordState,
-			*_indicesBuffer,
-			0,
-			VK_INDEX_TYPE_UINT32
-		);
+		UpdateDescriptorSets(recordState.frameIndex);
 
-		RB::BindVertexBuffer(
-			recordState,
-			*_verticesBuffer,
-			0,
-			0
-		);
-		for (auto & instance : instances)
+		BindBuffers(recordState);
+
+		auto const & restPose = UpdateRestPose();
+
+		for (auto const & item : items)
 		{
-			auto const& rootNodes = _meshData->rootNodes;
-			auto & nodes = instance->GetNodes();
-			for (auto& rootNode : rootNodes)
-			{
-				auto& node = nodes[rootNode];
-				DrawNode(
-					recordState,
-					node,
-					instance->GetTransform().GetMatrix()
-				);
-			}
+			DrawNodes(
+				recordState,
+				item.nodeCache != nullptr ? *item.nodeCache : restPose,
+				item.model
+			);
 		}
 	}
 
 	//-------------------------------------------------------------------------------------------------
 
+	void MeshRenderer::SetCullingView(std::optional<CullingView> const & cullingView)
+	{
+		_cullingView = cullingView;
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	void MeshRenderer::SetLodView(std::optional<LodView> const & lodView)
+	{
+		_lodView = lodView;
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	NodeTransformCache const & MeshRenderer::UpdateRestPose()
+	{
+		_restPose.Update(_meshData->nodes);
+		return _restPose;
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	NodeTransformCache const & MeshRenderer::GetRestPose() const noexcept
+	{
+		return _restPose;
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
 	std::shared_ptr<RT::BufferGroup> MeshRenderer::GenerateVertexBuffer(VkCommandBuffer cb, AS::GLTF::Model const& model)
 	{
 		auto& mesh = model.mesh;
 
-		auto* gltfVertices = mesh->GetVertexData()->As<AS::GLTF::Vertex>();
-		auto gltfVertexCount = mesh->GetVertexCount();
+		auto const* gltfVertices = mesh->GetVertexData()->As<AS::GLTF::Vertex>();
+		auto const gltfVertexCount = mesh->GetVertexCount();
+
+		auto const & vertexLayout = FlatShadingPipeline::GetVertexLayout();
+		auto const bufferSize = vertexLayout.GetBufferSize(gltfVertexCount);
 
-		std::vector<FlatShadingPipeline::Vertex> cpuVertices(gltfVertexCount);
+		_vertexQuantization = VertexLayout::ComputeQuantization(gltfVertices, gltfVertexCount);
 
-		for (int i = 0; i < static_cast<int>(gltfVertexCount); ++i)
+		_vertexStreamOffsets.clear();
+		for (uint32_t binding = 0; binding < vertexLayout.GetStreamCount(); ++binding)
 		{
-			auto const& gltfVertex = gltfVertices[i];
-			cpuVertices[i] = FlatShadingPipeline::Vertex
-			{
-				.position = gltfVertex.position,
-				.baseColorUV = gltfVertex.baseColorUV,
-				.normal = gltfVertex.normal
-			};
+			_vertexStreamOffsets.emplace_back(vertexLayout.GetStreamOffset(binding, gltfVertexCount));
 		}
 
-		auto alias = Alias(cpuVertices.data(), cpuVertices.size());
-
 		auto* device = LogicalDevice::Instance;
 
 		auto const stageBuffer = RB::CreateStageBuffer(
 			device->GetVkDevice(),
 			device->GetPhysicalDevice(),
-			alias.Len(),
+			bufferSize,
 			1
 		);
 
+		// Vertices are encoded straight into the stage buffer
+		void * stageMemory = nullptr;
+		RB::MapHostVisibleMemory(
+			device->GetVkDevice(),
+			stageBuffer->buffers[0]->memory,
+			0,
+			bufferSize,
+			&stageMemory
+		);
+		vertexLayout.Write(
+			gltfVertices,
+			gltfVertexCount,
+			_vertexQuantization,
+			static_cast<uint8_t *>(stageMemory)
+		);
+		RB::UnMapHostVisibleMemory(device->GetVkDevice(), stageBuffer->buffers[0]->memory);
+
 		_verticesBuffer = RB::CreateVertexBuffer(
 			device->GetVkDevice(),
 			device->GetPhysicalDevice(),
-			cb,
-			*stageBuffer->buffers[0],
-			alias
+			bufferSize
 		);
 
+		RB::UpdateLocalBuffer(cb, *_verticesBuffer, *stageBuffer->buffers[0]);
+
 		return stageBuffer;
 	}
 
@@ -179,27 +214,80 @@ namespace MFA
 		AS::GLTF::Model const& model
 	)
 	{
-		auto& mesh = model.mesh;
+		auto const& mesh = *model.mesh;
+
+		auto const* gltfIndices = mesh.GetIndexData()->As<AS::GLTF::Index>();
+		auto const gltfIndexCount = mesh.GetIndexCount();
 
-		auto const gltfIndices = mesh->GetIndexData();
+		// Indices are rebased to the first vertex of their primitive and the draw adds it back through vertexOffset,
+		// so 16 bits are enough when no primitive has more than 65536 vertices
+		bool use16Bit = true;
+		for (auto const& subMesh : _meshData->subMeshes)
+		{
+			for (auto const& primitive : subMesh.primitives)
+			{
+				use16Bit &= primitive.vertexCount <= std::numeric_limits<uint16_t>::max() + 1u;
+			}
+		}
+		_indexType = use16Bit ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+		auto const bufferSize = (use16Bit ? sizeof(uint16_t) : sizeof(uint32_t)) * gltfIndexCount;
 
 		auto* device = LogicalDevice::Instance;
 
 		auto const indexStageBuffer = RB::CreateStageBuffer(
 			device->GetVkDevice(),
 			device->GetPhysicalDevice(),
-			gltfIndices->Len(),
+			bufferSize,
 			1
 		);
 
+		void* stageMemory = nullptr;
+		RB::MapHostVisibleMemory(
+			device->GetVkDevice(),
+			indexStageBuffer->buffers[0]->memory,
+			0,
+			bufferSize,
+			&stageMemory
+		);
+		if (use16Bit)
+		{
+			auto* destination = static_cast<uint16_t*>(stageMemory);
+			auto const rebase = [&](uint32_t const firstIndex, uint32_t const indexCount, uint32_t const firstVertex)->void
+			{
+				for (auto i = firstIndex; i < firstIndex + indexCount; ++i)
+				{
+					MFA_ASSERT(gltfIndices[i] - firstVertex <= std::numeric_limits<uint16_t>::max());
+					destination[i] = static_cast<uint16_t>(gltfIndices[i] - firstVertex);
+				}
+			};
+			// Every index belongs to a primitive or to one of its levels of detail
+			for (auto const& subMesh : _meshData->subMeshes)
+			{
+				for (auto const& primitive : subMesh.primitives)
+				{
+					rebase(primitive.indicesStartingIndex, primitive.indicesCount, primitive.verticesStartingIndex);
+					for (uint32_t i = 0; i < primitive.lodCount; ++i)
+					{
+						auto const& lod = primitive.lods[i];
+						rebase(lod.indicesStartingIndex, lod.indicesCount, primitive.verticesStartingIndex);
+					}
+				}
+			}
+		}
+		else
+		{
+			std::memcpy(stageMemory, gltfIndices, bufferSize);
+		}
+		RB::UnMapHostVisibleMemory(device->GetVkDevice(), indexStageBuffer->buffers[0]->memory);
+
 		_indicesBuffer = RB::CreateIndexBuffer(
 			device->GetVkDevice(),
 			device->GetPhysicalDevice(),
-			cb,
-			*indexStageBuffer->buffers[0],
-			*gltfIndices
+			bufferSize
 		);
 
+		RB::UpdateLocalBuffer(cb, *_indicesBuffer, *indexStageBuffer->buffers[0]);
+
 		return indexStageBuffer;
 	}
 
@@ -211,11 +299,37 @@ namespace MFA
 		std::vector<std::shared_ptr<RT::BufferAndMemory>> stagingBuffers{};
 
 		_textures.clear();
+		_cpuTextures = model.textures;
 
 		auto* device = LogicalDevice::Instance;
 
-		for (auto& cpuTexture : model.textures)
+		for (size_t i = 0; i < model.textures.size(); ++i)
 		{
+			auto const & cpuTexture = model.textures[i];
+
+			// Asynchronous loads publish the mesh before its textures
+			if (cpuTexture == nullptr)
+			{
+				_textures.emplace_back(nullptr);
+				continue;
+			}
+
+			// The importer shares one texture between materials that use the same image, upload it once
+			auto const previous = std::find(model.textures.begin(), model.textures.begin() + i, cpuTexture);
+			if (previous != model.textures.begin() + i)
+			{
+				_textures.emplace_back(_textures[previous - model.textures.begin()]);
+				continue;
+			}
+
+			// The streamer uploads the smallest levels on its next update
+			if (_textureStreamer != nullptr)
+			{
+				_textureStreamer->Register(cpuTexture);
+				_textures.emplace_back(_textureStreamer->GetGpuTexture(*cpuTexture));
+				continue;
+			}
+
 			auto [gpuTexture, stageBuffer] = RB::CreateTexture(
 				*cpuTexture,
 				device->GetVkDevice(),
@@ -294,6 +408,10 @@ namespace MFA
 		int nextMaterialIdx = 0;
 
 		_descriptorSets.clear();
+		_outdatedTextures.assign(
+			LogicalDevice::Instance->GetMaxFramePerFlight(),
+			std::vector<bool>(_textures.size(), false)
+		);
 
 		for (auto const& subMesh : _meshData->subMeshes)
 		{
@@ -302,17 +420,10 @@ namespace MFA
 
 			for (auto const& primitive : subMesh.primitives)
 			{
-				auto const* gpuTexture = _errorTexture.get();
-
-				if (primitive.hasBaseColorTexture == true)
-				{
-					gpuTexture = _textures[primitive.baseColorTextureIndex].get();
-				}
-
 				descriptorSets.emplace_back(
 					_pipeline->CreatePerGeometryDescriptorSetGroup(
 						*_materials[nextMaterialIdx]->buffers[0],
-						*gpuTexture
+						GetBaseColorTexture(primitive)
 					)
 				);
 
@@ -323,10 +434,263 @@ namespace MFA
 
 	//-------------------------------------------------------------------------------------------------
 
+	RT::GpuTexture const & MeshRenderer::GetBaseColorTexture(AS::GLTF::Primitive const & primitive) const
+	{
+		if (primitive.hasBaseColorTexture == true && _textures[primitive.baseColorTextureIndex] != nullptr)
+		{
+			return *_textures[primitive.baseColorTextureIndex];
+		}
+		return *_errorTexture;
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	bool MeshRenderer::UpdateTextures(AS::GLTF::Model const & model, uint32_t const maxUploads)
+	{
+		MFA_ASSERT(model.mesh->GetMeshData() == _meshData);
+		MFA_ASSERT(model.textures.size() == _cpuTextures.size());
+
+		auto * device = LogicalDevice::Instance;
+
+		ReleaseFinishedWork();
+
+		PendingUpload upload{};
+		std::vector<bool> isTextureUpdated(model.textures.size(), false);
+		bool hasUpdates = false;
+		bool isUpToDate = true;
+
+		for (size_t i = 0; i < model.textures.size(); ++i)
+		{
+			auto const & cpuTexture = model.textures[i];
+			if (cpuTexture == _cpuTextures[i])
+			{
+				continue;
+			}
+
+			std::shared_ptr<RT::GpuTexture> gpuTexture{};
+			auto const previous = std::find(model.textures.begin(), model.textures.begin() + i, cpuTexture);
+			if (previous != model.textures.begin() + i && _cpuTextures[previous - model.textures.begin()] == cpuTexture)
+			{
+				gpuTexture = _textures[previous - model.textures.begin()];
+			}
+			else if (cpuTexture != nullptr && _textureStreamer != nullptr)
+			{
+				_textureStreamer->Register(cpuTexture);
+				gpuTexture = _textureStreamer->GetGpuTexture(*cpuTexture);
+			}
+			else if (cpuTexture != nullptr)
+			{
+				if (upload.stagingBuffers.size() >= maxUploads)
+				{
+					isUpToDate = false;
+					continue;
+				}
+				if (upload.commandBuffer == VK_NULL_HANDLE)
+				{
+					upload.commandBuffer = RB::BeginSingleTimeCommand(
+						device->GetVkDevice(),
+						device->GetGraphicCommandPool()
+					);
+				}
+				auto [texture, stageBuffer] = RB::CreateTexture(
+					*cpuTexture,
+					device->GetVkDevice(),
+					device->GetPhysicalDevice(),
+					upload.commandBuffer
+				);
+				gpuTexture = texture;
+				upload.stagingBuffers.emplace_back(stageBuffer);
+			}
+
+			if (_textures[i] != nullptr)
+			{// Frames that are acquired from now on use the replacement, the ones before it may still sample this one
+				_retiredTextures.emplace_back(RetiredTexture{
+					.gpuTexture = std::move(_textures[i]),
+					.releaseFrame = device->GetFrameNumber() + device->GetMaxFramePerFlight()
+				});
+			}
+			_textures[i] = gpuTexture;
+			_cpuTextures[i] = cpuTexture;
+			isTextureUpdated[i] = true;
+			hasUpdates = true;
+		}
+
+		if (hasUpdates == false)
+		{
+			return isUpToDate;
+		}
+
+		// Frames that are submitted later to the same queue sample the new images after the copies are done, the
+		// staging buffers are released once the fence is signaled
+		if (upload.commandBuffer != VK_NULL_HANDLE)
+		{
+			upload.fence = RB::CreateFence(device->GetVkDevice(), 1)[0];
+			RB::ResetFences(device->GetVkDevice(), {upload.fence});
+
+			RB::EndCommandBuffer(upload.commandBuffer);
+			VkSubmitInfo const submitInfo{
+				.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+				.commandBufferCount = 1,
+				.pCommandBuffers = &upload.commandBuffer,
+			};
+			RB::SubmitQueues(device->GetGraphicQueue(), 1, &submitInfo, upload.fence);
+
+			_pendingUploads.emplace_back(std::move(upload));
+		}
+
+		MarkTexturesOutdated(isTextureUpdated);
+
+		return isUpToDate;
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	void MeshRenderer::UpdateStreamedTextures()
+	{
+		if (_textureStreamer == nullptr)
+		{
+			return;
+		}
+
+		// The streamer keeps the previous textures alive until the frames in flight are done with them
+		std::vector<bool> isTextureUpdated(_textures.size(), false);
+		bool isAnyTextureUpdated = false;
+
+		for (size_t i = 0; i < _textures.size(); ++i)
+		{
+			if (_cpuTextures[i] == nullptr)
+			{
+				continue;
+			}
+			auto gpuTexture = _textureStreamer->GetGpuTexture(*_cpuTextures[i]);
+			if (gpuTexture == _textures[i])
+			{
+				continue;
+			}
+			_textures[i] = std::move(gpuTexture);
+			isTextureUpdated[i] = true;
+			isAnyTextureUpdated = true;
+		}
+
+		if (isAnyTextureUpdated)
+		{
+			MarkTexturesOutdated(isTextureUpdated);
+		}
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	void MeshRenderer::MarkTexturesOutdated(std::vector<bool> const & isTextureUpdated)
+	{
+		for (auto & outdatedTextures : _outdatedTextures)
+		{
+			for (size_t i = 0; i < isTextureUpdated.size(); ++i)
+			{
+				if (isTextureUpdated[i])
+				{
+					outdatedTextures[i] = true;
+				}
+			}
+		}
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	void MeshRenderer::UpdateDescriptorSets(uint32_t const frameIndex)
+	{
+		auto & outdatedTextures = _outdatedTextures[frameIndex];
+		if (std::find(outdatedTextures.begin(), outdatedTextures.end(), true) == outdatedTextures.end())
+		{
+			return;
+		}
+
+		int nextMaterialIdx = 0;
+		for (size_t subMeshIdx = 0; subMeshIdx < _meshData->subMeshes.size(); ++subMeshIdx)
+		{
+			auto const & subMesh = _meshData->subMeshes[subMeshIdx];
+			for (size_t primitiveIdx = 0; primitiveIdx < subMesh.primitives.size(); ++primitiveIdx)
+			{
+				auto const & primitive = subMesh.primitives[primitiveIdx];
+				if (primitive.hasBaseColorTexture == true && outdatedTextures[primitive.baseColorTextureIndex])
+				{
+					_pipeline->UpdatePerGeometryDescriptorSetGroup(
+						_descriptorSets[subMeshIdx][primitiveIdx],
+						frameIndex,
+						*_materials[nextMaterialIdx]->buffers[0],
+						GetBaseColorTexture(primitive)
+					);
+				}
+				++nextMaterialIdx;
+			}
+		}
+
+		std::fill(outdatedTextures.begin(), outdatedTextures.end(), false);
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	void MeshRenderer::ReleaseFinishedWork()
+	{
+		auto const * device = LogicalDevice::Instance;
+
+		std::erase_if(_pendingUploads, [this, device](PendingUpload & upload)->bool
+		{
+			if (RB::IsFenceSignaled(device->GetVkDevice(), upload.fence) == false)
+			{
+				return false;
+			}
+			FreeUpload(upload);
+			return true;
+		});
+
+		auto const frameNumber = device->GetFrameNumber();
+		std::erase_if(_retiredTextures, [frameNumber](RetiredTexture const & retiredTexture)->bool
+		{
+			return frameNumber >= retiredTexture.releaseFrame;
+		});
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	void MeshRenderer::FreeUpload(PendingUpload & upload)
+	{
+		auto const * device = LogicalDevice::Instance;
+		RB::DestroyCommandBuffers(device->GetVkDevice(), device->GetGraphicCommandPool(), 1, &upload.commandBuffer);
+		RB::DestroyFence(device->GetVkDevice(), {upload.fence});
+		upload.stagingBuffers.clear();
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	void MeshRenderer::BindBuffers(RT::CommandRecordState& recordState) const
+	{
+		_pipeline->BindPipeline(recordState);
+
+		RB::BindIndexBuffer(
+			recordState,
+			*_indicesBuffer,
+			0,
+			_indexType
+		);
+
+		for (uint32_t binding = 0; binding < static_cast<uint32_t>(_vertexStreamOffsets.size()); ++binding)
+		{
+			RB::BindVertexBuffer(
+				recordState,
+				*_verticesBuffer,
+				binding,
+				_vertexStreamOffsets[binding]
+			);
+		}
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
 	void MeshRenderer::DrawSubMesh(
 		RT::CommandRecordState& recordState,
 		int const subMeshIdx,
-		glm::mat4 const& transform
+		glm::mat4 const& transform,
+		float const pixelsPerUnit
 	) const
 	{
 		auto const& subMesh = _meshData->subMeshes[subMeshIdx];
@@ -335,7 +699,9 @@ namespace MFA
 		_pipeline->SetPushConstants(
 			recordState,
 			FlatShadingPipeline::PushConstants{
-				.model = transform
+				.model = transform,
+				.positionMin = _vertexQuantization.positionMin,
+				.positionExtent = _vertexQuantization.positionExtent
 			}
 		);
 
@@ -345,35 +711,253 @@ namespace MFA
 			RB::AutoBindDescriptorSet(
 				recordState,
 				RB::UpdateFrequency::PerGeometry,
-				descriptorSets[i].descriptorSets[0]
+				descriptorSets[i]
 			);
 
-			RB::DrawIndexed(
-				recordState,
-				primitive.indicesCount,
-				1,
-				primitive.indicesStartingIndex
+			// 16 bit indices are relative to the first vertex of the primitive
+			auto const vertexOffset = _indexType == VK_INDEX_TYPE_UINT16 ? primitive.verticesStartingIndex : 0;
+
+			// Meshlets only cover the original triangles so simplified levels are drawn in full
+			auto const lodLevel = SelectLodLevel(primitive, pixelsPerUnit);
+			if (lodLevel > 0)
+			{
+				auto const & lod = primitive.lods[lodLevel - 1];
+				RB::DrawIndexed(
+					recordState,
+					lod.indicesCount,
+					1,
+					lod.indicesStartingIndex,
+					vertexOffset
+				);
+				continue;
+			}
+
+			if (_cullingView.has_value() == false || primitive.meshletCount == 0)
+			{
+				RB::DrawIndexed(
+					recordState,
+					primitive.indicesCount,
+					1,
+					primitive.indicesStartingIndex,
+					vertexOffset
+				);
+				continue;
+			}
+
+			_visibleRanges.clear();
+			MeshletCulling::Cull(
+				*_meshData,
+				primitive,
+				MeshletCulling::ToMeshSpace(_cullingView->viewProjection, _cullingView->cameraPosition, transform),
+				_visibleRanges
 			);
+			for (auto const & range : _visibleRanges)
+			{
+				RB::DrawIndexed(
+					recordState,
+					range.indexCount,
+					1,
+					range.firstIndex,
+					vertexOffset
+				);
+			}
+		}
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	void MeshRenderer::ComputeLocalBounds()
+	{
+		auto const * vertices = _vertices->As<AS::GLTF::Vertex>();
+
+		std::vector<AABB> subMeshBounds(_meshData->subMeshes.size());
+		for (int i = 0; i < static_cast<int>(subMeshBounds.size()); ++i)
+		{
+			for (auto const & primitive : _meshData->subMeshes[i].primitives)
+			{
+				auto const end = primitive.verticesStartingIndex + primitive.vertexCount;
+				for (auto j = primitive.verticesStartingIndex; j < end; ++j)
+				{
+					subMeshBounds[i].Expand(vertices[j].position);
+				}
+			}
+		}
+
+		UpdateRestPose();
+
+		_localBounds = AABB{};
+		for (auto const flatNodeIdx : _meshData->flatMeshNodes)
+		{
+			auto const & bounds = subMeshBounds[_meshData->flatNodes[flatNodeIdx].subMeshIndex];
+			if (bounds.IsValid())
+			{
+				_localBounds.Expand(bounds.Transform(_restPose.GetMatrix(flatNodeIdx)));
+			}
+		}
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	void MeshRenderer::ComputeTextureDensities()
+	{
+		auto const * vertices = _vertices->As<AS::GLTF::Vertex>();
+		auto const * indices = _indices->As<AS::GLTF::Index>();
+
+		_textureDensities.assign(_cpuTextures.size(), 0.0f);
+		for (auto const & subMesh : _meshData->subMeshes)
+		{
+			for (auto const & primitive : subMesh.primitives)
+			{
+				if (primitive.hasBaseColorTexture == false)
+				{
+					continue;
+				}
+
+				double meshArea = 0.0;
+				double uvArea = 0.0;
+				auto const end = primitive.indicesStartingIndex + primitive.indicesCount;
+				for (auto i = primitive.indicesStartingIndex; i + 2 < end; i += 3)
+				{
+					auto const & v0 = vertices[indices[i]];
+					auto const & v1 = vertices[indices[i + 1]];
+					auto const & v2 = vertices[indices[i + 2]];
+					meshArea += glm::length(glm::cross(v1.position - v0.position, v2.position - v0.position));
+					auto const uv1 = v1.baseColorUV - v0.baseColorUV;
+					auto const uv2 = v2.baseColorUV - v0.baseColorUV;
+					uvArea += std::abs(uv1.x * uv2.y - uv1.y * uv2.x);
+				}
+				if (meshArea <= 0.0 || uvArea <= 0.0)
+				{
+					continue;
+				}
+
+				// Average over the primitive, the areas are squared lengths
+				auto & density = _textureDensities[primitive.baseColorTextureIndex];
+				density = std::max(density, static_cast<float>(std::sqrt(uvArea / meshArea)));
+			}
+		}
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	uint32_t MeshRenderer::SelectLodLevel(AS::GLTF::Primitive const & primitive, float const pixelsPerUnit) const
+	{
+		if (_lodView.has_value() == false || pixelsPerUnit <= 0.0f)
+		{
+			return 0;
+		}
+
+		uint32_t lodLevel = 0;
+		for (uint32_t i = 0; i < primitive.lodCount; ++i)
+		{
+			if (primitive.lods[i].error * pixelsPerUnit > _lodView->maxPixelError)
+			{
+				break;
+			}
+			lodLevel = i + 1;
+		}
+		return lodLevel;
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	float MeshRenderer::ComputePixelsPerUnit(glm::mat4 const & model, float const nodeScale) const
+	{
+		MFA_ASSERT(_lodView.has_value());
+
+		// Bounds are in model space, vertices are scaled by their node as well
+		float const modelScale = MaxAxisScale(model);
+		auto const center = glm::vec3(model * glm::vec4(_localBounds.Center(), 1.0f));
+		float const radius = glm::length(_localBounds.Extents()) * modelScale;
+		// Closest point of the bounding sphere, so no part of the mesh is closer to the camera than the estimate
+		float const distance = std::max(glm::distance(center, _lodView->cameraPosition) - radius, 1e-3f);
+		return _lodView->pixelsPerUnit * modelScale * nodeScale / distance;
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	float MeshRenderer::MaxAxisScale(glm::mat4 const & transform)
+	{
+		return std::max({
+			glm::length(glm::vec3(transform[0])),
+			glm::length(glm::vec3(transform[1])),
+			glm::length(glm::vec3(transform[2]))
+		});
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	void MeshRenderer::RequestTextureMipLevels(float const pixelsPerUnit) const
+	{
+		for (size_t i = 0; i < _cpuTextures.size(); ++i)
+		{
+			auto const & cpuTexture = _cpuTextures[i];
+			if (cpuTexture == nullptr || _textureDensities[i] <= 0.0f)
+			{
+				continue;
+			}
+
+			uint8_t mipLevel = 0;
+			if (pixelsPerUnit > 0.0f)
+			{
+				// Each level halves the texels per pixel, the finest level that still has one texel per pixel is enough
+				auto const & dimension = cpuTexture->GetMipmap(0).dimension;
+				float const texelsPerUnit = _textureDensities[i] * static_cast<float>(
+					std::max(dimension.width, dimension.height)
+				);
+				float const texelsPerPixel = texelsPerUnit / pixelsPerUnit;
+				if (texelsPerPixel > 1.0f)
+				{
+					mipLevel = static_cast<uint8_t>(std::min(
+						std::floor(std::log2(texelsPerPixel)),
+						static_cast<float>(cpuTexture->GetMipCount() - 1)
+					));
+				}
+			}
+			_textureStreamer->RequestMipLevel(*cpuTexture, mipLevel);
 		}
 	}
 
 	//-------------------------------------------------------------------------------------------------
 
-	void MeshRenderer::DrawNode(
-		RT::CommandRecordState& recordState, 
-		Asset::GLTF::Node & node,
-		glm::mat4 const& parentTransform
+	void MeshRenderer::DrawNodes(
+		RT::CommandRecordState& recordState,
+		NodeTransformCache const & nodeCache,
+		glm::mat4 const& model
 	) const
 	{
-		auto const transform = parentTransform * node.transform.GetMatrix();
-		if (node.hasSubMesh())
+		auto const & flatNodes = _meshData->flatNodes;
+
+		// Errors and texture densities are in vertex units, the largest node scale keeps both conservative
+		float nodeScale = 0.0f;
+		if (_lodView.has_value())
+		{
+			for (auto const flatNodeIdx : _meshData->flatMeshNodes)
+			{
+				nodeScale = std::max(nodeScale, MaxAxisScale(nodeCache.GetMatrix(flatNodeIdx)));
+			}
+		}
+
+		// Without a view the screen size is unknown, so everything is drawn and requested at full detail
+		float pixelsPerUnit = 0.0f;
+		if (_lodView.has_value() && _localBounds.IsValid())
 		{
-			DrawSubMesh(recordState, node.subMeshIndex, transform);
+			pixelsPerUnit = ComputePixelsPerUnit(model, nodeScale);
 		}
 
-		for (auto const child : node.children)
+		if (_textureStreamer != nullptr)
 		{
-			DrawNode(recordState, _meshData->nodes[child], transform);
+			RequestTextureMipLevels(pixelsPerUnit);
+		}
+
+		for (auto const flatNodeIdx : _meshData->flatMeshNodes)
+		{
+			DrawSubMesh(
+				recordState,
+				flatNodes[flatNodeIdx].subMeshIndex,
+				model * nodeCache.GetMatrix(flatNodeIdx),
+				pixelsPerUnit
+			);
 		}
 	}
 
@@ -399,21 +983,27 @@ namespace MFA
 		std::vector<std::vector<std::tuple<int, int>>> result{};
 
 		auto const indices = _indices->As<AS::GLTF::Index>();
-		
-		int faceCount = static_cast<int>(_indexCount) / 3;
 
 		result.resize(_vertexCount);
 
 		// TODO: This chunk of code is very useful. We need a helper function from it
-		for (int i = 0; i < faceCount; ++i)
+		// Only the original triangles of each primitive, the simplified levels are appended after them
+		for (auto const & subMesh : _meshData->subMeshes)
 		{
-			auto const idx0 = indices[3 * i];
-			auto const idx1 = indices[3 * i + 1];
-			auto const idx2 = indices[3 * i + 2];
+			for (auto const & primitive : subMesh.primitives)
+			{
+				auto const end = primitive.indicesStartingIndex + primitive.indicesCount;
+				for (auto i = primitive.indicesStartingIndex; i + 2 < end; i += 3)
+				{
+					auto const idx0 = indices[i];
+					auto const idx1 = indices[i + 1];
+					auto const idx2 = indices[i + 2];
 
-			result[idx0].emplace_back(std::tuple<int, int>{idx1, idx2});
-			result[idx1].emplace_back(std::tuple<int, int>{idx2, idx0});
-			result[idx2].emplace_back(std::tuple<int, int>{idx0, idx1});
+					result[idx0].emplace_back(std::tuple<int, int>{idx1, idx2});
+					result[idx1].emplace_back(std::tuple<int, int>{idx2, idx0});
+					result[idx2].emplace_back(std::tuple<int, int>{idx0, idx1});
+				}
+			}
 		}
 
 		return result;
@@ -428,4 +1018,18 @@ namespace MFA
 
 	//-------------------------------------------------------------------------------------------------
 
+	std::shared_ptr<AS::GLTF::MeshData> const & MeshRenderer::GetMeshData() const noexcept
+	{
+		return _meshData;
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	AABB const & MeshRenderer::GetLocalBounds() const noexcept
+	{
+		return _localBounds;
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
 }
@@ -4,14 +4,19 @@
 #include "RenderBackend.hpp"
 #include "RenderTypes.hpp"
 #include "ImportGLTF.hpp"
+#include "BedrockBounds.hpp"
+#include "NodeTransformCache.hpp"
+#include "VertexLayout.hpp"
+#include "MeshletCulling.hpp"
+#include "TextureStreamer.hpp"
 
+#include <limits>
 #include <memory>
+#include <optional>
 
 namespace MFA
 {
 
-    class MeshInstance;
-
     class MeshRenderer
     {
     public:
@@ -21,12 +26,71 @@ namespace MFA
             std::shared_ptr<AS::GLTF::Model> const& model,
             std::shared_ptr<RT::GpuTexture> errorTexture,
             bool hasOverrideColor = false,
-            glm::vec4 overrideColor = {}
+            glm::vec4 overrideColor = {},
+            std::shared_ptr<TextureStreamer> textureStreamer = nullptr      // Textures are uploaded in full without it
         );
 
+        ~MeshRenderer();
+
+        MeshRenderer(MeshRenderer const&) noexcept = delete;
+        MeshRenderer(MeshRenderer&&) noexcept = delete;
+        MeshRenderer& operator= (MeshRenderer const& rhs) noexcept = delete;
+        MeshRenderer& operator= (MeshRenderer&& rhs) noexcept = delete;
+
         void Render(RT::CommandRecordState& recordState, std::vector<glm::mat4> const& models);
 
-        void Render(RT::CommandRecordState& recordState, std::vector<MeshInstance*> const& instances) const;
+        struct DrawItem
+        {
+            glm::mat4 model{};
+            NodeTransformCache const * nodeCache = nullptr;        // Rest pose is used when there is no cache
+        };
+
+        // Rest pose node matrices that are shared between every instance without node overrides.
+        // Instance caches read from it so it has to be updated before them.
+        NodeTransformCache const & UpdateRestPose();
+
+        [[nodiscard]]
+        NodeTransformCache const & GetRestPose() const noexcept;
+
+        void Render(RT::CommandRecordState& recordState, std::vector<DrawItem> const& items);
+
+        struct CullingView
+        {
+            glm::mat4 viewProjection{};
+            glm::vec3 cameraPosition{};
+        };
+
+        // While a view is set, meshlets that are outside of it or face away from the camera are not drawn.
+        // Primitives without meshlets are always drawn in full.
+        void SetCullingView(std::optional<CullingView> const & cullingView);
+
+        struct LodView
+        {
+            glm::vec3 cameraPosition{};
+            float pixelsPerUnit = 1.0f;             // At distance one: projection[1][1] * viewportHeight * 0.5
+            float maxPixelError = 1.0f;
+        };
+
+        // While a view is set, each instance draws the coarsest level of detail whose error stays under
+        // maxPixelError on screen. Without a view the full primitives are drawn.
+        // Streamed textures are requested at the mip level that the view samples, or in full without a view.
+        void SetLodView(std::optional<LodView> const & lodView);
+
+        // Uploads the textures of the model that differ from the ones in use, for example when a GLTF_ModelAsync load
+        // publishes a new stage. At most maxUploads textures are uploaded per call so a stage can be spread over frames.
+        // Streamed textures are only registered and do not count towards maxUploads.
+        // Has to be called outside of command recording. Frames that are submitted later sample the new textures
+        // after their copies, the replaced ones are released once the frames in flight are done with them.
+        // Returns true when every texture is up to date.
+        bool UpdateTextures(
+            AS::GLTF::Model const & model,
+            uint32_t maxUploads = std::numeric_limits<uint32_t>::max()
+        );
+
+        // Switches to the textures that the streamer has replaced since the last call. It has to follow
+        // TextureStreamer::Update before the next frame is recorded, the streamer releases the previous textures once
+        // the frames in flight are done with them.
+        void UpdateStreamedTextures();
         
         [[nodiscard]]
         std::vector<glm::vec3> GetVertices(glm::mat4 const& model) const noexcept;
@@ -35,8 +99,29 @@ namespace MFA
 
         std::vector<Asset::GLTF::Node> const & GetNodes() const noexcept;
 
+        [[nodiscard]]
+        std::shared_ptr<AS::GLTF::MeshData> const & GetMeshData() const noexcept;
+
+        // Bounds of the mesh in its rest pose and in model space
+        [[nodiscard]]
+        AABB const & GetLocalBounds() const noexcept;
+
     private:
 
+        // Replaced texture that a frame acquired before the replacement can still sample
+        struct RetiredTexture
+        {
+            std::shared_ptr<RT::GpuTexture> gpuTexture{};
+            uint64_t releaseFrame = 0;                  // Released once the device reaches this frame number
+        };
+
+        struct PendingUpload
+        {
+            VkFence fence = VK_NULL_HANDLE;
+            VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+            std::vector<std::shared_ptr<RT::BufferAndMemory>> stagingBuffers{};
+        };
+
         std::shared_ptr<RT::BufferGroup> GenerateVertexBuffer(VkCommandBuffer cb, AS::GLTF::Model const& model);
 
         std::shared_ptr<RT::BufferGroup> GenerateIndexBuffer(VkCommandBuffer cb, AS::GLTF::Model const& model);
@@ -46,30 +131,78 @@ namespace MFA
         std::vector<std::shared_ptr<RT::BufferGroup>> CreateMaterials(VkCommandBuffer cb);
 
         void CreateDescriptorSets();
+
+        // The descriptor sets of every frame in flight that sample an updated texture are rewritten before their
+        // frame is recorded next, the frames that are still executing keep reading the previous ones
+        void MarkTexturesOutdated(std::vector<bool> const & isTextureUpdated);
+
+        void UpdateDescriptorSets(uint32_t frameIndex);
+
+        // Frees the uploads that the gpu has finished and the retired textures that no frame can sample anymore
+        void ReleaseFinishedWork();
+
+        void FreeUpload(PendingUpload & upload);
+
+        [[nodiscard]]
+        RT::GpuTexture const & GetBaseColorTexture(AS::GLTF::Primitive const & primitive) const;
         
+        void BindBuffers(RT::CommandRecordState& recordState) const;
+
+        // Zero pixels per unit draws every primitive at full detail
         void DrawSubMesh(
             RT::CommandRecordState& recordState,
             int subMeshIdx,
-            glm::mat4 const & transform
+            glm::mat4 const & transform,
+            float pixelsPerUnit
         ) const;
 
-        void DrawNode(
+        // Coarsest level of the primitive whose own error stays under the pixel budget, zero is the original
+        [[nodiscard]]
+        uint32_t SelectLodLevel(AS::GLTF::Primitive const & primitive, float pixelsPerUnit) const;
+
+        // Screen pixels per vertex unit at the closest point of the bounds. Requires the lod view.
+        // Node scale is the largest scale of the mesh nodes in the current pose
+        [[nodiscard]]
+        float ComputePixelsPerUnit(glm::mat4 const & model, float nodeScale) const;
+
+        // Length of the longest basis vector
+        [[nodiscard]]
+        static float MaxAxisScale(glm::mat4 const & transform);
+
+        // Zero pixels per unit requests every texture in full
+        void RequestTextureMipLevels(float pixelsPerUnit) const;
+
+        void ComputeLocalBounds();
+
+        void ComputeTextureDensities();
+
+        void DrawNodes(
             RT::CommandRecordState& recordState,
-            Asset::GLTF::Node & node, 
-            glm::mat4 const& parentTransform
+            NodeTransformCache const & nodeCache,
+            glm::mat4 const& model
         ) const;
 
         std::shared_ptr<FlatShadingPipeline> _pipeline{};
 
         std::shared_ptr<AS::GLTF::MeshData> _meshData{};
+        NodeTransformCache _restPose{};
 
         std::shared_ptr<RT::GpuTexture> _errorTexture{};
 
         std::shared_ptr<RT::BufferAndMemory> _verticesBuffer{};
+        std::vector<VkDeviceSize> _vertexStreamOffsets{};         // One per binding of the pipeline vertex layout
+        VertexLayout::Quantization _vertexQuantization{};
         std::shared_ptr<RT::BufferAndMemory> _indicesBuffer{};
-        std::vector<std::shared_ptr<RT::GpuTexture>> _textures{};
+        VkIndexType _indexType = VK_INDEX_TYPE_UINT32;
+        std::vector<std::shared_ptr<RT::GpuTexture>> _textures{};             // nullptr until the texture is loaded
+        std::vector<std::shared_ptr<AS::Texture>> _cpuTextures{};             // Source of each uploaded texture
+        std::shared_ptr<TextureStreamer> _textureStreamer{};
+        std::vector<float> _textureDensities{};     // Largest uv units per mesh unit of a primitive, zero when unused
         std::vector<std::shared_ptr<RT::BufferGroup>> _materials{};
         std::vector<std::vector<RT::DescriptorSetGroup>> _descriptorSets;
+        std::vector<std::vector<bool>> _outdatedTextures{};   // Per frame in flight, textures its sets don't sample yet
+        std::vector<RetiredTexture> _retiredTextures{};
+        std::vector<PendingUpload> _pendingUploads{};
         
         int _vertexCount{};
         std::shared_ptr<Blob> _vertices{};
@@ -77,6 +210,13 @@ namespace MFA
         int _indexCount{};
         std::shared_ptr<Blob> _indices{};
 
+        AABB _localBounds{};
+
+        std::optional<CullingView> _cullingView{};
+        mutable std::vector<MeshletCulling::IndexRange> _visibleRanges{};
+
+        std::optional<LodView> _lodView{};
+
         bool _hasOverrideColor{};
         glm::vec4 _overrideColor{};
     };
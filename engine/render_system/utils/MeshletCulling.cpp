@@ -0,0 +1,79 @@
+#include "MeshletCulling.hpp"
+
+#include "BedrockAssert.hpp"
+
+#include <glm/geometric.hpp>
+
+namespace MFA::MeshletCulling
+{
+
+	//-------------------------------------------------------------------------------------------------
+
+	View ToMeshSpace(glm::mat4 const & viewProjection, glm::vec3 const & cameraPosition, glm::mat4 const & model)
+	{
+		return View{
+			.frustum = Frustum::FromViewProjection(viewProjection * model),
+			.cameraPosition = glm::inverse(model) * glm::vec4{cameraPosition, 1.0f}
+		};
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	bool IsVisible(AS::GLTF::Meshlet const & meshlet, View const & view)
+	{
+		if (view.frustum.Intersects(Sphere{ .center = meshlet.center, .radius = meshlet.radius }) == false)
+		{
+			return false;
+		}
+
+		// Every triangle faces away when the whole bounding sphere is inside the back side of the normal cone
+		if (meshlet.coneCutoff < 1.0f)
+		{
+			auto const toCenter = meshlet.center - view.cameraPosition;
+			if (glm::dot(toCenter, meshlet.coneAxis) >= meshlet.coneCutoff * glm::length(toCenter) + meshlet.radius)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	void Cull(
+		AS::GLTF::MeshData const & meshData,
+		AS::GLTF::Primitive const & primitive,
+		View const & view,
+		std::vector<IndexRange> & outRanges
+	)
+	{
+		MFA_ASSERT(primitive.meshletStartingIndex + primitive.meshletCount <= meshData.meshlets.size());
+
+		auto const begin = primitive.meshletStartingIndex;
+		auto const end = begin + primitive.meshletCount;
+		for (auto i = begin; i < end; ++i)
+		{
+			auto const & meshlet = meshData.meshlets[i];
+			if (IsVisible(meshlet, view) == false)
+			{
+				continue;
+			}
+			if (outRanges.empty() == false)
+			{
+				auto & lastRange = outRanges.back();
+				if (lastRange.firstIndex + lastRange.indexCount == meshlet.indicesStartingIndex)
+				{
+					lastRange.indexCount += meshlet.indicesCount;
+					continue;
+				}
+			}
+			outRanges.emplace_back(IndexRange{
+				.firstIndex = meshlet.indicesStartingIndex,
+				.indexCount = meshlet.indicesCount
+			});
+		}
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "AssetGLTF_Mesh.hpp"
+#include "BedrockBounds.hpp"
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace MFA::MeshletCulling
+{
+
+    struct IndexRange
+    {
+        uint32_t firstIndex = 0;
+        uint32_t indexCount = 0;
+    };
+
+    // Camera data moved into the space of the mesh, so the meshlets are tested without transforming them
+    struct View
+    {
+        Frustum frustum{};
+        glm::vec3 cameraPosition{};
+    };
+
+    [[nodiscard]]
+    View ToMeshSpace(glm::mat4 const & viewProjection, glm::vec3 const & cameraPosition, glm::mat4 const & model);
+
+    [[nodiscard]]
+    bool IsVisible(AS::GLTF::Meshlet const & meshlet, View const & view);
+
+    // Appends the index ranges of the visible meshlets of the primitive. Neighbouring ranges are merged.
+    void Cull(
+        AS::GLTF::MeshData const & meshData,
+        AS::GLTF::Primitive const & primitive,
+        View const & view,
+        std::vector<IndexRange> & outRanges
+    );
+
+}
@@ -0,0 +1,176 @@
+#include "NodeTransformCache.hpp"
+
+#include "BedrockAssert.hpp"
+#include "JobSystem.hpp"
+
+namespace MFA
+{
+
+	//-------------------------------------------------------------------------------------------------
+
+	NodeTransformCache::NodeTransformCache() = default;
+
+	//-------------------------------------------------------------------------------------------------
+
+	NodeTransformCache::NodeTransformCache(std::shared_ptr<AS::GLTF::MeshData> meshData)
+		: _meshData(std::move(meshData))
+	{
+		MFA_ASSERT(_meshData != nullptr);
+		auto const nodeCount = _meshData->flatNodes.size();
+		_matrices.resize(nodeCount, glm::identity<glm::mat4>());
+		_versions.resize(nodeCount, 0);
+		_isChanged.resize(nodeCount, 0);
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	bool NodeTransformCache::Update(std::vector<AS::GLTF::Node> & nodes)
+	{
+		MFA_ASSERT(_meshData != nullptr);
+		MFA_ASSERT(nodes.size() == _meshData->flatNodes.size());
+		MFA_ASSERT(_overrideSlots.empty());
+
+		_localMatrices.resize(_matrices.size());
+
+		auto const & flatNodes = _meshData->flatNodes;
+		return UpdateLevels(
+			[&nodes, &flatNodes](int const flatIdx)->uint32_t
+			{
+				return nodes[flatNodes[flatIdx].nodeIndex].transform.GetVersion();
+			},
+			[this, &nodes, &flatNodes](int const flatIdx, bool const isLocalChanged)->glm::mat4 const &
+			{
+				if (isLocalChanged)
+				{
+					_localMatrices[flatIdx] = nodes[flatNodes[flatIdx].nodeIndex].transform.GetMatrix();
+				}
+				return _localMatrices[flatIdx];
+			}
+		);
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	bool NodeTransformCache::Update(NodeTransformCache const & restPose, std::vector<Transform> & overrideTransforms)
+	{
+		MFA_ASSERT(_meshData != nullptr);
+		MFA_ASSERT(restPose._meshData == _meshData);
+		MFA_ASSERT(restPose._localMatrices.size() == _matrices.size());
+
+		auto const findSlot = [this](int const flatIdx)->int
+		{
+			return _overrideSlots.empty() ? -1 : _overrideSlots[flatIdx];
+		};
+
+		return UpdateLevels(
+			[&findSlot, &restPose, &overrideTransforms](int const flatIdx)->uint32_t
+			{
+				auto const slot = findSlot(flatIdx);
+				return slot < 0 ? restPose._versions[flatIdx] : overrideTransforms[slot].GetVersion();
+			},
+			[&findSlot, &restPose, &overrideTransforms](int const flatIdx, bool)->glm::mat4 const &
+			{
+				auto const slot = findSlot(flatIdx);
+				return slot < 0 ? restPose._localMatrices[flatIdx] : overrideTransforms[slot].GetMatrix();
+			}
+		);
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	void NodeTransformCache::SetOverrides(std::vector<uint32_t> const & overrideNodes)
+	{
+		MFA_ASSERT(_meshData != nullptr);
+		_overrideSlots.assign(_matrices.size(), -1);
+		for (int slot = 0; slot < static_cast<int>(overrideNodes.size()); ++slot)
+		{
+			_overrideSlots[_meshData->nodeToFlatNode[overrideNodes[slot]]] = slot;
+		}
+		// Versions of the overrides and the rest pose are not comparable
+		_isDirty = true;
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	glm::mat4 const & NodeTransformCache::GetMatrix(uint32_t const flatNodeIdx) const
+	{
+		return _matrices[flatNodeIdx];
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	std::vector<glm::mat4> const & NodeTransformCache::GetMatrices() const noexcept
+	{
+		return _matrices;
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	void NodeTransformCache::SetDirty()
+	{
+		_isDirty = true;
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	template<typename VersionFunction, typename LocalFunction>
+	bool NodeTransformCache::UpdateLevels(VersionFunction const & getVersion, LocalFunction const & getLocal)
+	{
+		// Small hierarchies are cheaper to update on a single thread
+		static constexpr int MinBatchSize = 64;
+
+		auto const & flatNodes = _meshData->flatNodes;
+		auto const updateRange = [&](int const begin, int const end)->void
+		{
+			for (int i = begin; i < end; ++i)
+			{
+				auto const parent = flatNodes[i].parent;
+				auto const version = getVersion(i);
+
+				bool const isLocalChanged = _isDirty || _versions[i] != version;
+				bool const isParentChanged = parent >= 0 && _isChanged[parent] != 0;
+
+				_isChanged[i] = isLocalChanged || isParentChanged ? 1 : 0;
+				if (_isChanged[i] == 0)
+				{
+					continue;
+				}
+
+				_versions[i] = version;
+				auto const & localMatrix = getLocal(i, isLocalChanged);
+				_matrices[i] = parent >= 0 ? _matrices[parent] * localMatrix : localMatrix;
+			}
+		};
+
+		auto const & levelOffsets = _meshData->levelOffsets;
+		for (int level = 0; level + 1 < static_cast<int>(levelOffsets.size()); ++level)
+		{
+			auto const levelBegin = static_cast<int>(levelOffsets[level]);
+			auto const levelEnd = static_cast<int>(levelOffsets[level + 1]);
+			// Parents are all in the previous levels so nodes inside a level are independent
+			if (JS::Instance != nullptr)
+			{
+				JS::Instance->ParallelFor(levelEnd - levelBegin, MinBatchSize, [&](int const begin, int const end)->void
+				{
+					updateRange(levelBegin + begin, levelBegin + end);
+				});
+			}
+			else
+			{
+				updateRange(levelBegin, levelEnd);
+			}
+		}
+
+		_isDirty = false;
+
+		bool anyChanged = false;
+		for (auto const isChanged : _isChanged)
+		{
+			anyChanged |= isChanged != 0;
+		}
+		return anyChanged;
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "AssetGLTF_Mesh.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace MFA
+{
+
+    // Keeps the model space matrix of every node in flattened order.
+    // Only the nodes whose transform has changed since the last update and their subtrees are recomputed.
+    class NodeTransformCache
+    {
+    public:
+
+        explicit NodeTransformCache();
+
+        explicit NodeTransformCache(std::shared_ptr<AS::GLTF::MeshData> meshData);
+
+        // Rest pose. Nodes must have the same layout as meshData->nodes. Returns true if any matrix has changed.
+        bool Update(std::vector<AS::GLTF::Node> & nodes);
+
+        // Instance pose. Overridden nodes use their own transform and every other node reads its local matrix
+        // from the rest pose cache, so the shared nodes are never touched. The rest pose has to be updated first.
+        bool Update(NodeTransformCache const & restPose, std::vector<Transform> & overrideTransforms);
+
+        // Node indices of the overrides in the same order as the transforms passed to Update
+        void SetOverrides(std::vector<uint32_t> const & overrideNodes);
+
+        [[nodiscard]]
+        glm::mat4 const & GetMatrix(uint32_t flatNodeIdx) const;
+
+        [[nodiscard]]
+        std::vector<glm::mat4> const & GetMatrices() const noexcept;
+
+        void SetDirty();
+
+    private:
+
+        // Recomputes the nodes whose local version has changed and every node below them, level by level
+        template<typename VersionFunction, typename LocalFunction>
+        bool UpdateLevels(VersionFunction const & getVersion, LocalFunction const & getLocal);
+
+        std::shared_ptr<AS::GLTF::MeshData> _meshData{};
+
+        std::vector<glm::mat4> _matrices{};
+        std::vector<glm::mat4> _localMatrices{};    // Only filled for the rest pose
+        std::vector<uint32_t> _versions{};
+        std::vector<uint8_t> _isChanged{};          // Changed in current update. Children read it from their parent
+        std::vector<int> _overrideSlots{};          // Per flat node, -1 when the node is not overridden
+
+        bool _isDirty = true;
+
+    };
+
+}
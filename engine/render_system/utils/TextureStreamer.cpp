@@ -0,0 +1,398 @@
+#include "TextureStreamer.hpp"
+
+#include "BedrockAssert.hpp"
+#include "LogicalDevice.hpp"
+#include "RenderBackend.hpp"
+
+#include <algorithm>
+#include <queue>
+#include <tuple>
+
+namespace MFA
+{
+
+	//-------------------------------------------------------------------------------------------------
+
+	TextureStreamer::TextureStreamer(Options const & options)
+		: _options(options)
+	{}
+
+	//-------------------------------------------------------------------------------------------------
+
+	TextureStreamer::~TextureStreamer()
+	{
+		auto const * device = LogicalDevice::Instance;
+		for (auto & upload : _pendingUploads)
+		{
+			RB::WaitForFence(device->GetVkDevice(), {upload.fence});
+			FreeUpload(upload);
+		}
+		_pendingUploads.clear();
+		if (_freeFences.empty() == false)
+		{
+			RB::DestroyFence(device->GetVkDevice(), _freeFences);
+		}
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	void TextureStreamer::Register(std::shared_ptr<AS::Texture> const & texture)
+	{
+		MFA_ASSERT(texture != nullptr && texture->isValid());
+
+		auto & entry = _entries[texture.get()];
+		// A texture that was released can leave an entry behind at the same address
+		if (entry.texture.lock() == texture)
+		{
+			return;
+		}
+		Retire(entry);
+		entry = Entry{};
+		entry.texture = texture;
+
+		auto const mipCount = texture->GetMipCount();
+		uint8_t initialMipLevel = 0;
+		while (initialMipLevel + 1 < mipCount)
+		{
+			auto const & dimension = texture->GetMipmap(initialMipLevel).dimension;
+			if (std::max(dimension.width, dimension.height) <= _options.initialMaxDimension)
+			{
+				break;
+			}
+			++initialMipLevel;
+		}
+		entry.initialMipLevel = initialMipLevel;
+		entry.neededMipLevel = initialMipLevel;
+		entry.lastRequestedUpdate = _updateIndex;
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	void TextureStreamer::RequestMipLevel(AS::Texture const & texture, uint8_t const mipLevel)
+	{
+		auto const findResult = _entries.find(&texture);
+		if (findResult == _entries.end())
+		{
+			return;
+		}
+		auto & entry = findResult->second;
+		entry.requestedMipLevel = std::min(entry.requestedMipLevel, mipLevel);
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	bool TextureStreamer::Update()
+	{
+		ReleaseFinishedWork();
+
+		std::vector<LiveEntry> liveEntries{};
+		liveEntries.reserve(_entries.size());
+		for (auto itr = _entries.begin(); itr != _entries.end();)
+		{
+			auto texture = itr->second.texture.lock();
+			if (texture == nullptr)
+			{
+				Retire(itr->second);
+				itr = _entries.erase(itr);
+				continue;
+			}
+			liveEntries.emplace_back(LiveEntry{.entry = &itr->second, .texture = std::move(texture)});
+			++itr;
+		}
+
+		size_t targetBytes = 0;
+		for (auto & liveEntry : liveEntries)
+		{
+			auto & entry = *liveEntry.entry;
+			if (entry.requestedMipLevel != NoRequest)
+			{
+				entry.neededMipLevel = std::min(entry.requestedMipLevel, entry.initialMipLevel);
+				entry.lastRequestedUpdate = _updateIndex;
+			}
+			entry.requestedMipLevel = NoRequest;
+
+			bool const isStale = _updateIndex - entry.lastRequestedUpdate > _options.evictAfterUpdates;
+			if (isStale)
+			{
+				entry.neededMipLevel = entry.initialMipLevel;
+			}
+			// New textures upload their smallest levels first and the finer ones follow in later updates
+			if (entry.gpuTexture == nullptr || isStale)
+			{
+				entry.targetMipLevel = entry.initialMipLevel;
+			}
+			else
+			{
+				// Levels finer than needed stay until the budget runs out, so a texture at the edge of a level
+				// does not switch back and forth every frame
+				entry.targetMipLevel = std::min(entry.neededMipLevel, entry.residentMipLevel);
+			}
+			targetBytes += ResidentBytes(*liveEntry.texture, entry.targetMipLevel);
+		}
+
+		FitTargetsInBudget(liveEntries, targetBytes);
+
+		// The image that a change replaces stays alive until the frames in flight are done with it, so the new image
+		// comes on top of everything that is allocated now. Textures that lose levels are always changed since that is
+		// how the budget is restored, the ones that gain levels have to fit next to the resident and retired images.
+		size_t allocatedBytes = _residentBytes + _retiredBytes;
+		std::vector<LiveEntry *> upgrades{};
+		std::vector<LiveEntry *> changes{};
+		for (auto & liveEntry : liveEntries)
+		{
+			auto const & entry = *liveEntry.entry;
+			if (entry.gpuTexture != nullptr && entry.targetMipLevel < entry.residentMipLevel)
+			{
+				upgrades.emplace_back(&liveEntry);
+			}
+			else if (entry.gpuTexture == nullptr || entry.targetMipLevel != entry.residentMipLevel)
+			{
+				changes.emplace_back(&liveEntry);
+				allocatedBytes += ResidentBytes(*liveEntry.texture, entry.targetMipLevel);
+			}
+		}
+		// Most recently requested first, then the ones that are missing the most levels
+		std::sort(upgrades.begin(), upgrades.end(), [](LiveEntry const * lhs, LiveEntry const * rhs)->bool
+		{
+			auto const & left = *lhs->entry;
+			auto const & right = *rhs->entry;
+			return std::tuple(left.lastRequestedUpdate, left.residentMipLevel - left.targetMipLevel) >
+				std::tuple(right.lastRequestedUpdate, right.residentMipLevel - right.targetMipLevel);
+		});
+		size_t uploadCount = 0;
+		for (auto * liveEntry : upgrades)
+		{
+			if (uploadCount >= _options.maxUploadsPerUpdate)
+			{
+				break;
+			}
+			auto const bytes = ResidentBytes(*liveEntry->texture, liveEntry->entry->targetMipLevel);
+			if (allocatedBytes + bytes > _options.budgetInBytes)
+			{
+				continue;
+			}
+			allocatedBytes += bytes;
+			changes.emplace_back(liveEntry);
+			++uploadCount;
+		}
+
+		++_updateIndex;
+
+		if (changes.empty())
+		{
+			return false;
+		}
+
+		auto const * device = LogicalDevice::Instance;
+
+		PendingUpload upload{};
+		upload.commandBuffer = RB::BeginSingleTimeCommand(
+			device->GetVkDevice(),
+			device->GetGraphicCommandPool()
+		);
+
+		for (auto * liveEntry : changes)
+		{
+			auto & entry = *liveEntry->entry;
+			auto [gpuTexture, stageBuffer] = RB::CreateTexture(
+				*liveEntry->texture,
+				device->GetVkDevice(),
+				device->GetPhysicalDevice(),
+				upload.commandBuffer,
+				entry.targetMipLevel
+			);
+			upload.stagingBuffers.emplace_back(stageBuffer);
+
+			Retire(entry);
+			entry.gpuTexture = gpuTexture;
+			entry.residentMipLevel = entry.targetMipLevel;
+			entry.residentBytes = ResidentBytes(*liveEntry->texture, entry.residentMipLevel);
+			_residentBytes += entry.residentBytes;
+		}
+
+		// Frames that are submitted later to the same queue sample the new images after the copies are done, the
+		// staging buffers are released once the fence is signaled
+		if (_freeFences.empty())
+		{
+			upload.fence = RB::CreateFence(device->GetVkDevice(), 1)[0];
+		}
+		else
+		{
+			upload.fence = _freeFences.back();
+			_freeFences.pop_back();
+		}
+		RB::ResetFences(device->GetVkDevice(), {upload.fence});
+
+		RB::EndCommandBuffer(upload.commandBuffer);
+		VkSubmitInfo const submitInfo{
+			.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+			.commandBufferCount = 1,
+			.pCommandBuffers = &upload.commandBuffer,
+		};
+		RB::SubmitQueues(device->GetGraphicQueue(), 1, &submitInfo, upload.fence);
+
+		_pendingUploads.emplace_back(std::move(upload));
+
+		return true;
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	std::shared_ptr<RT::GpuTexture> TextureStreamer::GetGpuTexture(AS::Texture const & texture) const
+	{
+		auto const findResult = _entries.find(&texture);
+		if (findResult == _entries.end())
+		{
+			return nullptr;
+		}
+		return findResult->second.gpuTexture;
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	uint8_t TextureStreamer::GetResidentMipLevel(AS::Texture const & texture) const
+	{
+		auto const findResult = _entries.find(&texture);
+		MFA_ASSERT(findResult != _entries.end());
+		return findResult->second.residentMipLevel;
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	size_t TextureStreamer::GetResidentBytes() const noexcept
+	{
+		return _residentBytes;
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	size_t TextureStreamer::GetRetiredBytes() const noexcept
+	{
+		return _retiredBytes;
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	void TextureStreamer::SetBudget(size_t const budgetInBytes)
+	{
+		_options.budgetInBytes = budgetInBytes;
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	size_t TextureStreamer::ResidentBytes(AS::Texture const & texture, uint8_t const firstMipLevel)
+	{
+		// Levels are stored from the largest to the smallest, the resident ones are the tail of the buffer
+		return texture.GetBuffer()->Len() - texture.GetMipmap(firstMipLevel).offset;
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	void TextureStreamer::Retire(Entry & entry)
+	{
+		_residentBytes -= entry.residentBytes;
+		if (entry.gpuTexture != nullptr)
+		{
+			// Frames that are acquired from now on use the replacement, the ones before it may still sample this one
+			auto const * device = LogicalDevice::Instance;
+			_retiredTextures.emplace_back(RetiredTexture{
+				.gpuTexture = std::move(entry.gpuTexture),
+				.bytes = entry.residentBytes,
+				.releaseFrame = device->GetFrameNumber() + device->GetMaxFramePerFlight()
+			});
+			_retiredBytes += entry.residentBytes;
+		}
+		entry.gpuTexture = nullptr;
+		entry.residentBytes = 0;
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	void TextureStreamer::ReleaseFinishedWork()
+	{
+		auto const * device = LogicalDevice::Instance;
+
+		std::erase_if(_pendingUploads, [this, device](PendingUpload & upload)->bool
+		{
+			if (RB::IsFenceSignaled(device->GetVkDevice(), upload.fence) == false)
+			{
+				return false;
+			}
+			FreeUpload(upload);
+			return true;
+		});
+
+		auto const frameNumber = device->GetFrameNumber();
+		std::erase_if(_retiredTextures, [this, frameNumber](RetiredTexture const & retiredTexture)->bool
+		{
+			if (frameNumber < retiredTexture.releaseFrame)
+			{
+				return false;
+			}
+			_retiredBytes -= retiredTexture.bytes;
+			return true;
+		});
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	void TextureStreamer::FreeUpload(PendingUpload & upload)
+	{
+		auto const * device = LogicalDevice::Instance;
+		RB::DestroyCommandBuffers(device->GetVkDevice(), device->GetGraphicCommandPool(), 1, &upload.commandBuffer);
+		_freeFences.emplace_back(upload.fence);
+		upload.stagingBuffers.clear();
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	void TextureStreamer::FitTargetsInBudget(std::vector<LiveEntry> & liveEntries, size_t targetBytes) const
+	{
+		if (targetBytes <= _options.budgetInBytes)
+		{
+			return;
+		}
+
+		// Levels that are finer than needed go first, then the levels of the least recently requested textures.
+		// Between equals the largest level is dropped, so the textures of a frame lose resolution evenly.
+		auto const priority = [this](LiveEntry const & liveEntry)->std::tuple<bool, uint64_t, size_t>
+		{
+			auto const & entry = *liveEntry.entry;
+			return {
+				entry.targetMipLevel < entry.neededMipLevel,
+				_updateIndex - entry.lastRequestedUpdate,
+				liveEntry.texture->GetMipmap(entry.targetMipLevel).size
+			};
+		};
+		auto const compare = [&priority, &liveEntries](size_t const lhs, size_t const rhs)->bool
+		{
+			return priority(liveEntries[lhs]) < priority(liveEntries[rhs]);
+		};
+		std::priority_queue<size_t, std::vector<size_t>, decltype(compare)> candidates{compare};
+		for (size_t i = 0; i < liveEntries.size(); ++i)
+		{
+			auto const & entry = *liveEntries[i].entry;
+			if (entry.targetMipLevel < entry.initialMipLevel)
+			{
+				candidates.push(i);
+			}
+		}
+
+		while (targetBytes > _options.budgetInBytes && candidates.empty() == false)
+		{
+			auto const index = candidates.top();
+			candidates.pop();
+
+			auto & entry = *liveEntries[index].entry;
+			targetBytes -= liveEntries[index].texture->GetMipmap(entry.targetMipLevel).size;
+			++entry.targetMipLevel;
+			if (entry.targetMipLevel < entry.initialMipLevel)
+			{
+				candidates.push(index);
+			}
+		}
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "AssetTexture.hpp"
+#include "RenderTypes.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace MFA
+{
+
+    // Keeps only the mip levels that are sampled on screen resident on the gpu. A registered texture starts with its
+    // smallest levels, renderers request the finest level they need every frame and Update uploads the missing ones.
+    // When the resident levels do not fit in the budget, the textures that were requested least recently lose their
+    // largest level first. A change of residency creates a new image that starts at the new first level, the previous
+    // one is retired until the frames in flight are done with it and counts against the budget until then.
+    // Not thread safe, requests and updates have to come from the render thread.
+    class TextureStreamer
+    {
+    public:
+
+        struct Options
+        {
+            size_t budgetInBytes = 512 * 1024 * 1024;       // Device memory that the streamed textures share
+            uint32_t initialMaxDimension = 128;             // Textures start at the first level that fits this size
+            uint32_t maxUploadsPerUpdate = 4;               // Only limits the textures that gain levels
+            uint32_t evictAfterUpdates = 300;               // Unrequested textures drop back to their initial levels
+        };
+
+        explicit TextureStreamer(Options const & options);
+
+        // Waits for the uploads that are still pending
+        ~TextureStreamer();
+
+        TextureStreamer(TextureStreamer const&) noexcept = delete;
+        TextureStreamer(TextureStreamer&&) noexcept = delete;
+        TextureStreamer& operator= (TextureStreamer const& rhs) noexcept = delete;
+        TextureStreamer& operator= (TextureStreamer&& rhs) noexcept = delete;
+
+        // Nothing is uploaded until the next Update. Registering the same texture again has no effect.
+        void Register(std::shared_ptr<AS::Texture> const & texture);
+
+        // Finest level the texture is sampled at in the current frame, the finest request of the frame is kept
+        void RequestMipLevel(AS::Texture const & texture, uint8_t mipLevel);
+
+        // Applies the requests of the frame and the budget. The uploads are submitted to the graphic queue without
+        // waiting, so it has to be called outside of command recording and renderers have to switch to the new
+        // textures before the next frame is recorded. Returns true when the gpu texture of any entry has changed.
+        bool Update();
+
+        // nullptr until the first Update after the texture is registered
+        [[nodiscard]]
+        std::shared_ptr<RT::GpuTexture> GetGpuTexture(AS::Texture const & texture) const;
+
+        // Level of the texture that the gpu texture starts at
+        [[nodiscard]]
+        uint8_t GetResidentMipLevel(AS::Texture const & texture) const;
+
+        // Size of the levels that are resident, textures that were replaced but are still in use are not included
+        [[nodiscard]]
+        size_t GetResidentBytes() const noexcept;
+
+        // Size of the textures that were replaced but can still be sampled by frames in flight
+        [[nodiscard]]
+        size_t GetRetiredBytes() const noexcept;
+
+        void SetBudget(size_t budgetInBytes);
+
+    private:
+
+        static constexpr uint8_t NoRequest = 255;
+
+        struct Entry
+        {
+            std::weak_ptr<AS::Texture> texture{};       // Owned by the renderers, the entry is dropped once it expires
+            std::shared_ptr<RT::GpuTexture> gpuTexture{};
+            uint8_t initialMipLevel = 0;                // Never evicted below this level
+            uint8_t residentMipLevel = 0;               // Only valid while there is a gpu texture
+            uint8_t neededMipLevel = 0;                 // Finest level of the latest request
+            uint8_t requestedMipLevel = NoRequest;      // Finest level requested in the current frame
+            uint8_t targetMipLevel = 0;
+            size_t residentBytes = 0;
+            uint64_t lastRequestedUpdate = 0;
+        };
+
+        // Replaced image that a frame acquired before the replacement can still sample
+        struct RetiredTexture
+        {
+            std::shared_ptr<RT::GpuTexture> gpuTexture{};
+            size_t bytes = 0;
+            uint64_t releaseFrame = 0;                  // Released once the device reaches this frame number
+        };
+
+        struct PendingUpload
+        {
+            VkFence fence = VK_NULL_HANDLE;
+            VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+            std::vector<std::shared_ptr<RT::BufferAndMemory>> stagingBuffers{};
+        };
+
+        // Entry of a texture that is still alive during an update
+        struct LiveEntry
+        {
+            Entry * entry = nullptr;
+            std::shared_ptr<AS::Texture> texture{};
+        };
+
+        [[nodiscard]]
+        static size_t ResidentBytes(AS::Texture const & texture, uint8_t firstMipLevel);
+
+        // Drops the gpu texture of the entry, it is kept alive until the frames in flight are done with it
+        void Retire(Entry & entry);
+
+        // Frees the uploads that the gpu has finished and the retired textures that no frame can sample anymore
+        void ReleaseFinishedWork();
+
+        void FreeUpload(PendingUpload & upload);
+
+        // Picks the target level of every entry so that the sum of their sizes stays under the budget
+        void FitTargetsInBudget(std::vector<LiveEntry> & liveEntries, size_t targetBytes) const;
+
+        Options _options{};
+        std::unordered_map<AS::Texture const *, Entry> _entries{};
+        uint64_t _updateIndex = 0;
+        size_t _residentBytes = 0;
+        std::vector<RetiredTexture> _retiredTextures{};
+        size_t _retiredBytes = 0;
+        std::vector<PendingUpload> _pendingUploads{};
+        std::vector<VkFence> _freeFences{};
+
+    };
+
+}
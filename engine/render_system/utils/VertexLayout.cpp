@@ -0,0 +1,441 @@
+#include "VertexLayout.hpp"
+
+#include "BedrockAssert.hpp"
+#include "JobSystem.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include <glm/gtc/packing.hpp>
+
+namespace MFA
+{
+
+	namespace
+	{
+
+		inline static constexpr size_t StreamAlignment = 16;
+
+		//-------------------------------------------------------------------------------------------------
+
+		size_t AlignUp(size_t const value, size_t const alignment)
+		{
+			return (value + alignment - 1) / alignment * alignment;
+		}
+
+		//-------------------------------------------------------------------------------------------------
+
+		// Maps the unit sphere onto the [-1, 1] square. Cigolle et al. 2014.
+		glm::vec2 OctahedralEncode(glm::vec3 const & vector)
+		{
+			float const length = std::abs(vector.x) + std::abs(vector.y) + std::abs(vector.z);
+			if (length <= 0.0f)
+			{
+				return glm::vec2{0.0f};
+			}
+			glm::vec2 result = glm::vec2{vector.x, vector.y} / length;
+			if (vector.z < 0.0f)
+			{
+				result = glm::vec2{
+					(1.0f - std::abs(result.y)) * (result.x >= 0.0f ? 1.0f : -1.0f),
+					(1.0f - std::abs(result.x)) * (result.y >= 0.0f ? 1.0f : -1.0f)
+				};
+			}
+			return result;
+		}
+
+		//-------------------------------------------------------------------------------------------------
+
+		glm::vec2 const & GetUV(AS::GLTF::Vertex const & vertex, VertexLayout::Attribute const attribute)
+		{
+			using Attribute = VertexLayout::Attribute;
+			switch (attribute)
+			{
+			case Attribute::BaseColorUV:
+				return vertex.baseColorUV;
+			case Attribute::NormalMapUV:
+				return vertex.normalMapUV;
+			case Attribute::MetallicUV:
+				return vertex.metallicUV;
+			case Attribute::RoughnessUV:
+				return vertex.roughnessUV;
+			case Attribute::EmissionUV:
+				return vertex.emissionUV;
+			case Attribute::OcclusionUV:
+				return vertex.occlusionUV;
+			default:
+				MFA_CRASH("Attribute %d is not a uv", static_cast<int>(attribute));
+			}
+		}
+
+		//-------------------------------------------------------------------------------------------------
+
+		glm::vec3 const & GetVector(AS::GLTF::Vertex const & vertex, VertexLayout::Attribute const attribute)
+		{
+			using Attribute = VertexLayout::Attribute;
+			switch (attribute)
+			{
+			case Attribute::Position:
+				return vertex.position;
+			case Attribute::Normal:
+				return vertex.normal;
+			case Attribute::Tangent:
+				return vertex.tangent;
+			case Attribute::Color:
+				return vertex.color;
+			default:
+				MFA_CRASH("Attribute %d is not a vector", static_cast<int>(attribute));
+			}
+		}
+
+		//-------------------------------------------------------------------------------------------------
+
+		glm::vec4 GetVector4(AS::GLTF::Vertex const & vertex, VertexLayout::Attribute const attribute)
+		{
+			using Attribute = VertexLayout::Attribute;
+			switch (attribute)
+			{
+			case Attribute::JointIndices:
+				return glm::vec4{
+					vertex.jointIndices[0],
+					vertex.jointIndices[1],
+					vertex.jointIndices[2],
+					vertex.jointIndices[3]
+				};
+			case Attribute::JointWeights:
+				return glm::vec4{
+					vertex.jointWeights[0],
+					vertex.jointWeights[1],
+					vertex.jointWeights[2],
+					vertex.jointWeights[3]
+				};
+			case Attribute::Color:
+				return glm::vec4{vertex.color, 1.0f};
+			default:
+				return glm::vec4{GetVector(vertex, attribute), 1.0f};
+			}
+		}
+
+		//-------------------------------------------------------------------------------------------------
+
+		void EncodeElement(
+			AS::GLTF::Vertex const & vertex,
+			VertexLayout::Element const & element,
+			VertexLayout::Quantization const & quantization,
+			uint8_t * destination
+		)
+		{
+			using Encoding = VertexLayout::Encoding;
+			using Attribute = VertexLayout::Attribute;
+
+			bool const isUV = element.attribute >= Attribute::BaseColorUV && element.attribute <= Attribute::OcclusionUV;
+
+			switch (element.encoding)
+			{
+			case Encoding::Float32x2:
+			{
+				auto const value = isUV ? GetUV(vertex, element.attribute) : glm::vec2{GetVector4(vertex, element.attribute)};
+				std::memcpy(destination, &value, sizeof(value));
+				break;
+			}
+			case Encoding::Float32x3:
+			{
+				auto const value = glm::vec3{GetVector4(vertex, element.attribute)};
+				std::memcpy(destination, &value, sizeof(value));
+				break;
+			}
+			case Encoding::Float16x2:
+			{
+				auto const value = glm::packHalf2x16(isUV ? GetUV(vertex, element.attribute) : glm::vec2{GetVector4(vertex, element.attribute)});
+				std::memcpy(destination, &value, sizeof(value));
+				break;
+			}
+			case Encoding::Unorm16x4:
+			{
+				glm::vec4 normalized{GetVector4(vertex, element.attribute)};
+				if (element.attribute == Attribute::Position)
+				{
+					normalized = glm::vec4{
+						(glm::vec3{normalized} - glm::vec3{quantization.positionMin}) / glm::vec3{quantization.positionExtent},
+						1.0f
+					};
+				}
+				auto const value = glm::packUnorm4x16(normalized);
+				std::memcpy(destination, &value, sizeof(value));
+				break;
+			}
+			case Encoding::Octahedral16x2:
+			{
+				auto const value = glm::packSnorm2x16(OctahedralEncode(GetVector(vertex, element.attribute)));
+				std::memcpy(destination, &value, sizeof(value));
+				break;
+			}
+			case Encoding::Octahedral8x2:
+			{
+				auto const value = glm::packSnorm4x8(glm::vec4{OctahedralEncode(GetVector(vertex, element.attribute)), 0.0f, 0.0f});
+				std::memcpy(destination, &value, sizeof(value));
+				break;
+			}
+			case Encoding::Unorm8x4:
+			{
+				auto const value = glm::packUnorm4x8(GetVector4(vertex, element.attribute));
+				std::memcpy(destination, &value, sizeof(value));
+				break;
+			}
+			case Encoding::Uint8x4:
+			{
+				auto const joints = glm::clamp(GetVector4(vertex, element.attribute), glm::vec4{0.0f}, glm::vec4{255.0f});
+				MFA_ASSERT(joints == GetVector4(vertex, element.attribute));
+				uint8_t const value[4]{
+					static_cast<uint8_t>(joints.x),
+					static_cast<uint8_t>(joints.y),
+					static_cast<uint8_t>(joints.z),
+					static_cast<uint8_t>(joints.w)
+				};
+				std::memcpy(destination, value, sizeof(value));
+				break;
+			}
+			default:
+				MFA_CRASH("Unhandled vertex encoding %d", static_cast<int>(element.encoding));
+			}
+		}
+
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	VertexLayout::VertexLayout() = default;
+
+	//-------------------------------------------------------------------------------------------------
+
+	VertexLayout & VertexLayout::Add(Attribute const attribute, Encoding const encoding, uint32_t const binding)
+	{
+		if (binding >= _strides.size())
+		{
+			_strides.resize(binding + 1, 0);
+		}
+		_elements.emplace_back(Element{
+			.attribute = attribute,
+			.encoding = encoding,
+			.binding = binding,
+			.offset = _strides[binding]
+		});
+		_strides[binding] += GetEncodingSize(encoding);
+		return *this;
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	std::vector<VertexLayout::Element> const & VertexLayout::GetElements() const noexcept
+	{
+		return _elements;
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	uint32_t VertexLayout::GetStreamCount() const noexcept
+	{
+		return static_cast<uint32_t>(_strides.size());
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	uint32_t VertexLayout::GetStride(uint32_t const binding) const
+	{
+		MFA_ASSERT(binding < _strides.size());
+		return _strides[binding];
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	size_t VertexLayout::GetStreamOffset(uint32_t const binding, uint32_t const vertexCount) const
+	{
+		MFA_ASSERT(binding <= _strides.size());
+		size_t offset = 0;
+		for (uint32_t i = 0; i < binding; ++i)
+		{
+			offset = AlignUp(offset + static_cast<size_t>(_strides[i]) * vertexCount, StreamAlignment);
+		}
+		return offset;
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	size_t VertexLayout::GetBufferSize(uint32_t const vertexCount) const
+	{
+		return GetStreamOffset(GetStreamCount(), vertexCount);
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	std::vector<VkVertexInputBindingDescription> VertexLayout::GetBindingDescriptions() const
+	{
+		std::vector<VkVertexInputBindingDescription> descriptions{};
+		for (uint32_t binding = 0; binding < GetStreamCount(); ++binding)
+		{
+			descriptions.emplace_back(VkVertexInputBindingDescription{
+				.binding = binding,
+				.stride = _strides[binding],
+				.inputRate = VK_VERTEX_INPUT_RATE_VERTEX,
+			});
+		}
+		return descriptions;
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	std::vector<VkVertexInputAttributeDescription> VertexLayout::GetAttributeDescriptions() const
+	{
+		std::vector<VkVertexInputAttributeDescription> descriptions{};
+		for (auto const & element : _elements)
+		{
+			descriptions.emplace_back(VkVertexInputAttributeDescription{
+				.location = static_cast<uint32_t>(descriptions.size()),
+				.binding = element.binding,
+				.format = GetEncodingFormat(element.encoding),
+				.offset = element.offset,
+			});
+		}
+		return descriptions;
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	VertexLayout::Quantization VertexLayout::ComputeQuantization(
+		AS::GLTF::Vertex const * vertices,
+		uint32_t const vertexCount
+	)
+	{
+		Quantization quantization{};
+		if (vertexCount == 0)
+		{
+			return quantization;
+		}
+
+		glm::vec3 minimum = vertices[0].position;
+		glm::vec3 maximum = vertices[0].position;
+		for (uint32_t i = 1; i < vertexCount; ++i)
+		{
+			minimum = glm::min(minimum, vertices[i].position);
+			maximum = glm::max(maximum, vertices[i].position);
+		}
+
+		// Flat meshes still need a non zero extent to avoid dividing by zero
+		quantization.positionMin = glm::vec4{minimum, 0.0f};
+		quantization.positionExtent = glm::vec4{glm::max(maximum - minimum, glm::vec3{1e-6f}), 0.0f};
+		return quantization;
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	void VertexLayout::Write(
+		AS::GLTF::Vertex const * vertices,
+		uint32_t const vertexCount,
+		Quantization const & quantization,
+		uint8_t * destination
+	) const
+	{
+		MFA_ASSERT(destination != nullptr);
+
+		auto const writeRange = [&](int const begin, int const end)->void
+		{
+			WriteRange(vertices, begin, end, vertexCount, quantization, destination);
+		};
+
+		if (JS::Instance != nullptr)
+		{
+			JS::Instance->ParallelFor(static_cast<int>(vertexCount), 16 * 1024, writeRange);
+		}
+		else
+		{
+			writeRange(0, static_cast<int>(vertexCount));
+		}
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	uint32_t VertexLayout::GetEncodingSize(Encoding const encoding)
+	{
+		switch (encoding)
+		{
+		case Encoding::Float32x2:
+			return 8;
+		case Encoding::Float32x3:
+			return 12;
+		case Encoding::Float16x2:
+			return 4;
+		case Encoding::Unorm16x4:
+			return 8;
+		case Encoding::Octahedral16x2:
+			return 4;
+		case Encoding::Octahedral8x2:
+			return 4;
+		case Encoding::Unorm8x4:
+			return 4;
+		case Encoding::Uint8x4:
+			return 4;
+		default:
+			MFA_CRASH("Unhandled vertex encoding %d", static_cast<int>(encoding));
+		}
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	VkFormat VertexLayout::GetEncodingFormat(Encoding const encoding)
+	{
+		switch (encoding)
+		{
+		case Encoding::Float32x2:
+			return VK_FORMAT_R32G32_SFLOAT;
+		case Encoding::Float32x3:
+			return VK_FORMAT_R32G32B32_SFLOAT;
+		case Encoding::Float16x2:
+			return VK_FORMAT_R16G16_SFLOAT;
+		case Encoding::Unorm16x4:
+			return VK_FORMAT_R16G16B16A16_UNORM;
+		case Encoding::Octahedral16x2:
+			return VK_FORMAT_R16G16_SNORM;
+		case Encoding::Octahedral8x2:
+			return VK_FORMAT_R8G8B8A8_SNORM;
+		case Encoding::Unorm8x4:
+			return VK_FORMAT_R8G8B8A8_UNORM;
+		case Encoding::Uint8x4:
+			return VK_FORMAT_R8G8B8A8_UINT;
+		default:
+			MFA_CRASH("Unhandled vertex encoding %d", static_cast<int>(encoding));
+		}
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+	void VertexLayout::WriteRange(
+		AS::GLTF::Vertex const * vertices,
+		uint32_t const begin,
+		uint32_t const end,
+		uint32_t const vertexCount,
+		Quantization const & quantization,
+		uint8_t * destination
+	) const
+	{
+		// Streams are written one after another so each worker touches a few contiguous regions
+		for (uint32_t binding = 0; binding < GetStreamCount(); ++binding)
+		{
+			auto const stride = _strides[binding];
+			auto * stream = destination + GetStreamOffset(binding, vertexCount);
+			for (auto const & element : _elements)
+			{
+				if (element.binding != binding)
+				{
+					continue;
+				}
+				for (uint32_t i = begin; i < end; ++i)
+				{
+					EncodeElement(vertices[i], element, quantization, stream + static_cast<size_t>(i) * stride + element.offset);
+				}
+			}
+		}
+	}
+
+	//-------------------------------------------------------------------------------------------------
+
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "AssetGLTF_Mesh.hpp"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace MFA
+{
+
+    // Describes how a pipeline wants the mesh vertices on the gpu. Each binding is a separate stream, so an interleaved
+    // layout puts every attribute in binding zero and a SoA layout gives each attribute its own binding.
+    // Streams are packed one after another inside a single buffer.
+    class VertexLayout
+    {
+    public:
+
+        enum class Attribute : uint8_t
+        {
+            Position,
+            Normal,
+            Tangent,
+            Color,
+            BaseColorUV,
+            NormalMapUV,
+            MetallicUV,
+            RoughnessUV,
+            EmissionUV,
+            OcclusionUV,
+            JointIndices,
+            JointWeights
+        };
+
+        enum class Encoding : uint8_t
+        {
+            Float32x2,
+            Float32x3,
+            Float16x2,              // UVs
+            Unorm16x4,              // Positions normalized to the mesh bounds, w is always one
+            Octahedral16x2,         // Unit vectors as snorm16 octahedral coordinates
+            Octahedral8x2,          // Unit vectors as snorm8 octahedral coordinates, padded to four bytes
+            Unorm8x4,               // Colors and joint weights
+            Uint8x4,                // Joint indices, the skeleton can not have more than 256 joints
+        };
+
+        struct Element
+        {
+            Attribute attribute{};
+            Encoding encoding{};
+            uint32_t binding = 0;
+            uint32_t offset = 0;                    // Inside the vertex of its stream
+        };
+
+        // Values that the shader needs to decode the quantized positions: position = min + encoded * extent
+        struct Quantization
+        {
+            glm::vec4 positionMin{};
+            glm::vec4 positionExtent{1.0f};
+        };
+
+        explicit VertexLayout();
+
+        // Locations are assigned in the order that the elements are added
+        VertexLayout & Add(Attribute attribute, Encoding encoding, uint32_t binding = 0);
+
+        [[nodiscard]]
+        std::vector<Element> const & GetElements() const noexcept;
+
+        [[nodiscard]]
+        uint32_t GetStreamCount() const noexcept;
+
+        [[nodiscard]]
+        uint32_t GetStride(uint32_t binding) const;
+
+        // Every stream starts at a 16 byte aligned offset
+        [[nodiscard]]
+        size_t GetStreamOffset(uint32_t binding, uint32_t vertexCount) const;
+
+        [[nodiscard]]
+        size_t GetBufferSize(uint32_t vertexCount) const;
+
+        [[nodiscard]]
+        std::vector<VkVertexInputBindingDescription> GetBindingDescriptions() const;
+
+        [[nodiscard]]
+        std::vector<VkVertexInputAttributeDescription> GetAttributeDescriptions() const;
+
+        [[nodiscard]]
+        static Quantization ComputeQuantization(AS::GLTF::Vertex const * vertices, uint32_t vertexCount);
+
+        // Encodes every stream into destination, that is usually mapped staging memory, so there is no intermediate copy.
+        // Destination must hold GetBufferSize(vertexCount) bytes.
+        void Write(
+            AS::GLTF::Vertex const * vertices,
+            uint32_t vertexCount,
+            Quantization const & quantization,
+            uint8_t * destination
+        ) const;
+
+        [[nodiscard]]
+        static uint32_t GetEncodingSize(Encoding encoding);
+
+        [[nodiscard]]
+        static VkFormat GetEncodingFormat(Encoding encoding);
+
+    private:
+
+        void WriteRange(
+            AS::GLTF::Vertex const * vertices,
+            uint32_t begin,
+            uint32_t end,
+            uint32_t vertexCount,
+            Quantization const & quantization,
+            uint8_t * destination
+        ) const;
+
+        std::vector<Element> _elements{};
+        std::vector<uint32_t> _strides{};
+
+    };
+
+}
@@ -56,7 +56,8 @@ namespace MFA
         MFA_ASSERT(std::filesystem::exists(path));
         auto * chunk = Mix_LoadWAV(path.c_str());   
         MFA_ASSERT(chunk != nullptr);
-        auto const findResult = _chunkMap.find(name);
+        auto const nameId = StringId::Intern(name);
+        auto const findResult = _chunkMap.find(nameId);
         if (findResult != _chunkMap.end())
         {
             MFA_ASSERT(false);
@@ -65,7 +66,7 @@ namespace MFA
         }
         else
         {
-            _chunkMap[name] = chunk;
+            _chunkMap[nameId] = chunk;
         }
         return chunk;
     }
@@ -77,7 +78,8 @@ namespace MFA
         MFA_ASSERT(std::filesystem::exists(path));
         auto * music = Mix_LoadMUS(path.c_str());   
         MFA_ASSERT(music != nullptr);
-        auto const findResult = _musicMap.find(name);
+        auto const nameId = StringId::Intern(name);
+        auto const findResult = _musicMap.find(nameId);
         if (findResult != _musicMap.end())
         {
             MFA_ASSERT(false);
@@ -86,33 +88,35 @@ namespace MFA
         }
         else
         {
-            _musicMap[name] = music;
+            _musicMap[nameId] = music;
         }
         return music;
     }
 
     //====================================================================
 
-    Mix_Chunk * SoundSystem::GetChunk(std::string const & name)
+    Mix_Chunk * SoundSystem::GetChunk(StringId const name)
     {
         auto const findResult = _chunkMap.find(name);
         if (findResult != _chunkMap.end())
         {
             return findResult->second;
         }
+        MFA_LOG_ERROR("Sound %s is not loaded", name.GetDebugName());
         MFA_ASSERT(false);
         return nullptr;
     }
 
     //====================================================================
 
-    Mix_Music * SoundSystem::GetMusic(std::string const & name)
+    Mix_Music * SoundSystem::GetMusic(StringId const name)
     {
         auto const findResult = _musicMap.find(name);
         if (findResult != _musicMap.end())
         {
             return findResult->second;
         }
+        MFA_LOG_ERROR("Sound %s is not loaded", name.GetDebugName());
         MFA_ASSERT(false);
         return nullptr;
     }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "BedrockStringId.hpp"
+
 #include <SDL_mixer.h>
 
 #include <memory>
@@ -22,16 +24,17 @@ namespace MFA
 
         Mix_Music * AddMusic(std::string const & path, std::string const & name);
 
-        Mix_Chunk * GetChunk(std::string const & name);
+        // Literal names are hashed at compile time
+        Mix_Chunk * GetChunk(StringId name);
 
-        Mix_Music * GetMusic(std::string const & name);
+        Mix_Music * GetMusic(StringId name);
 
         inline static SoundSystem * Instance = nullptr;
 
     private:
 
-        std::unordered_map<std::string, Mix_Chunk *> _chunkMap{};
-        std::unordered_map<std::string, Mix_Music *> _musicMap{};
+        std::unordered_map<StringId, Mix_Chunk *> _chunkMap{};
+        std::unordered_map<StringId, Mix_Music *> _musicMap{};
 
     };
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include "BedrockLog.hpp"
 #include "BedrockPath.hpp"
+#include "JobSystem.hpp"
 #include "LogicalDevice.hpp"
 #include "pipeline/LinePipeline.hpp"
 #include "render_pass/DisplayRenderPass.hpp"
@@ -13,12 +14,17 @@
 #include "camera/ArcballCamera.hpp"
 #include "UI.hpp"
 #include "pipeline/FlatShadingPipeline.hpp"
+#include "ImportCache.hpp"
 #include "ImportTexture.hpp"
 #include "ImportGLTF.hpp"
 #include "camera/ObserverCamera.hpp"
 #include "utils/PointRenderer.hpp"
 #include "utils/MeshRenderer.hpp"
 #include "utils/LineRenderer.hpp"
+#include "utils/TextureStreamer.hpp"
+#include "utils/MeshComponents.hpp"
+#include "SystemScheduler.hpp"
+#include "World.hpp"
 
 #include <future>
 #include <glm/glm.hpp>
@@ -79,6 +85,8 @@ int main()
 	//MFA_LOG_INFO("Thread count is %d", omp_get_max_threads());
 
 	auto path = Path::Instantiate();
+	auto jobSystem = JS::Instantiate();
+	auto importCache = Importer::ImportCache::Instantiate(path->Get("import_cache"));
 	
 	LogicalDevice::InitParams params
 	{
@@ -128,7 +136,7 @@ int main()
 			cameraBuffer,
 			defaultSampler,
 			FlatShadingPipeline::Params{
-				.maxSets = 100,
+				.maxSets = 300,
 				.cullModeFlags = VK_CULL_MODE_BACK_BIT,
 			}
 		);
@@ -138,7 +146,7 @@ int main()
 			cameraBuffer,
 			defaultSampler,
 			FlatShadingPipeline::Params{
-				.maxSets = 100,
+				.maxSets = 300,
 				.cullModeFlags = VK_CULL_MODE_FRONT_BIT,
 			}
 		);
@@ -148,7 +156,7 @@ int main()
 			cameraBuffer,
 			defaultSampler,
 			FlatShadingPipeline::Params{
-				.maxSets = 100,
+				.maxSets = 300,
 				.cullModeFlags = VK_CULL_MODE_NONE,
 				.polygonMode = VK_POLYGON_MODE_LINE
 			}
@@ -164,28 +172,31 @@ int main()
 
 		auto errorTexture = CreateErrorTexture();
 
-		auto subMarineModel = Importer::GLTF_Model(Path::Instance->Get("models/submarine/scene.gltf"));
-
-		auto submarineRenderer = std::make_shared<MeshRenderer>(
-			shadingPipeline1,
-			subMarineModel,
-			errorTexture
-		);
-
-		auto submarineWireFrameRenderer = std::make_shared<MeshRenderer>(
-			wireFramePipeline,
-			subMarineModel,
-			errorTexture
+		// Only the texture levels that the camera can see are kept on the gpu
+		auto const textureStreamer = std::make_shared<TextureStreamer>(TextureStreamer::Options{});
+
+		// Streams in while the window is already responsive, renderers are created once the mesh is ready
+		auto const subMarineLoad = Importer::GLTF_ModelAsync(Path::Instance->Get("models/submarine/scene.gltf"));
+		std::shared_ptr<Importer::Model> subMarineModel{};
+		bool subMarineTexturesAreUpToDate = false;
+
+		std::shared_ptr<MeshRenderer> submarineRenderer{};
+		std::shared_ptr<MeshRenderer> submarineWireFrameRenderer{};
+
+		Transform submarineTransform{};
+		submarineTransform.Setscale({ 0.02f, 0.02f, 0.02f });
+
+		// Mesh instances are entities, the scheduled systems keep their bounds and node caches up to date.
+		// Their world bounds are mirrored in the bvh, which culls them against the camera frustum.
+		BVH bvh{};
+		World world{};
+		SystemScheduler scheduler{world};
+		scheduler.AddSystem("UpdateBounds", MeshSystems::UpdateBoundsAccess(), MeshSystems::UpdateBounds);
+		scheduler.AddSystem(
+			"UpdateNodeCaches",
+			MeshSystems::UpdateNodeCachesAccess(),
+			MeshSystems::UpdateNodeCaches
 		);
-
-		glm::mat4 submarineModelMat{};
-		{
-			auto const scale = glm::scale(glm::identity<glm::mat4>(), { 0.02f, 0.02f, 0.02f });
-			// auto const rotation1 = glm::angleAxis(glm::radians(180.0f), MFA::Math::UpVec3);
-			// auto const rotation2 = glm::angleAxis(glm::radians(-90.0f), MFA::Math::RightVec3);
-			// auto const rotation3 = glm::angleAxis(glm::radians(0.0f), MFA::Math::UpVec3);
-			submarineModelMat = /*glm::toMat4(rotation3) * glm::toMat4(rotation2) * glm::toMat4(rotation1) * */scale;
-		}
 		
 		const uint32_t MinDeltaTimeMs = 1000 / 60;
 
@@ -211,12 +222,82 @@ int main()
 
 			device->Update();
 
+			if (auto const latestModel = subMarineLoad->GetModel(); latestModel != subMarineModel)
+			{
+				subMarineModel = latestModel;
+				subMarineTexturesAreUpToDate = false;
+				if (submarineRenderer == nullptr)
+				{
+					submarineRenderer = std::make_shared<MeshRenderer>(
+						shadingPipeline1,
+						subMarineModel,
+						errorTexture,
+						false,
+						glm::vec4{},
+						textureStreamer
+					);
+					submarineWireFrameRenderer = std::make_shared<MeshRenderer>(
+						wireFramePipeline,
+						subMarineModel,
+						errorTexture,
+						false,
+						glm::vec4{},
+						textureStreamer
+					);
+					MeshSystems::CreateMeshEntity(world, *submarineRenderer, submarineTransform);
+				}
+			}
+			if (submarineRenderer != nullptr && subMarineTexturesAreUpToDate == false)
+			{
+				// One texture per frame keeps the uploads of large textures from stalling a single frame
+				bool const isShadedUpToDate = submarineRenderer->UpdateTextures(*subMarineModel, 1);
+				bool const isWireFrameUpToDate = submarineWireFrameRenderer->UpdateTextures(*subMarineModel, 1);
+				subMarineTexturesAreUpToDate = isShadedUpToDate && isWireFrameUpToDate;
+			}
+
+			// Residency follows the mip levels that the previous frame has requested
+			if (submarineRenderer != nullptr && textureStreamer->Update() == true)
+			{
+				submarineRenderer->UpdateStreamedTextures();
+				submarineWireFrameRenderer->UpdateStreamedTextures();
+			}
+
 			camera.Update(deltaTimeSec);
 			if (camera.IsDirty())
 			{
 				cameraBufferTracker->SetData(Alias{ camera.GetViewProjection() });
 			}
 
+			if (submarineRenderer != nullptr)
+			{
+				MeshRenderer::LodView const lodView{
+					.cameraPosition = glm::vec3(glm::inverse(camera.GetView())[3]),
+					.pixelsPerUnit = std::abs(camera.GetProjection()[1][1]) *
+						static_cast<float>(device->GetWindowHeight()) * 0.5f
+				};
+				submarineRenderer->SetLodView(lodView);
+				submarineWireFrameRenderer->SetLodView(lodView);
+			}
+
+			if (submarineRenderer != nullptr)
+			{
+				auto * renderer = displayWireframe ? submarineWireFrameRenderer.get() : submarineRenderer.get();
+				world.ForEach<MeshComponent>([renderer](Entity, MeshComponent & mesh)->void
+				{
+					mesh.renderer = renderer;
+				});
+			}
+			scheduler.Run();
+
+			// The bvh is only touched by the main thread, so it is synced after the systems are done
+			MeshSystems::SyncBVH(world, bvh);
+			bvh.TryFinishRebuild();
+			if (bvh.NeedsRebuild())
+			{
+				bvh.RebuildAsync();
+			}
+			MeshSystems::CullWithBVH(world, bvh, Frustum::FromViewProjection(camera.GetViewProjection()));
+
 			ui->Update();
 
 			auto recordState = device->AcquireRecordState(swapChainResource->GetSwapChainImages().swapChain);
@@ -237,14 +318,7 @@ int main()
 
 				displayRenderPass->Begin(recordState);
 
-				if (displayWireframe == true)
-				{
-					submarineWireFrameRenderer->Render(recordState, { submarineModelMat });
-				}
-				else
-				{
-					submarineRenderer->Render(recordState, { submarineModelMat });
-				}
+				MeshSystems::Render(world, recordState);
 				
 				ui->Render(recordState, deltaTimeSec);
 